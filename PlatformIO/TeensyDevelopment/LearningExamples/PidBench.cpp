@@ -0,0 +1,60 @@
+// Cycles per update for the PID variants on the Teensy 4.1 (Cortex-M7 @ 600 MHz).
+// The M7 FPU is single precision only, so the double AutoPID math runs in
+// software; this sketch measures what that costs against EVT_PID.
+// Host counterpart: tools/pid_bench.cpp.
+#include <Arduino.h>
+#include "EVT_PID.h"
+
+static const uint32_t ITERATIONS = 10000;
+
+// AutoPID::run() body with the millis() gate removed.
+struct LegacyPid {
+    double kp, ki, kd, outMin, outMax;
+    double integral = 0.0, previousError = 0.0;
+
+    double update(double setpoint, double input, unsigned long dT) {
+        double error = setpoint - input;
+        integral += (error + previousError) / 2 * dT / 1000.0;
+        double dError = (error - previousError) / dT / 1000.0;
+        previousError = error;
+        double pid = kp * error + ki * integral + kd * dError;
+        return constrain(pid, outMin, outMax);
+    }
+};
+
+template <typename F>
+static void bench(const char* name, F&& update) {
+    float y = 0.0f;
+    volatile float sink = 0.0f;
+    uint32_t start = ARM_DWT_CYCCNT;
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        float setpoint = (i / 2000) % 2 ? 1.0f : -1.0f;
+        float u = update(setpoint, y);
+        y += (u - y) * 0.01f;
+        sink = u;
+    }
+    uint32_t cycles = ARM_DWT_CYCCNT - start;
+    (void)sink;
+    Serial.printf("%-22s %8.1f cycles/update\n", name, (float)cycles / ITERATIONS);
+}
+
+void setup() {
+    Serial.begin(115200);
+    while (!Serial && millis() < 3000) {}
+
+    LegacyPid legacy = {2.0, 0.5, 0.01, -10.0, 10.0};
+    bench("AutoPID (double)", [&](float sp, float y) { return (float)legacy.update(sp, y, 1); });
+
+    PidController<float> pidF(2.0f, 0.5f, 0.01f, -10.0f, 10.0f);
+    pidF.setDerivativeFilter(0.005f);
+    pidF.setSetpointWeight(0.8f);
+    bench("PidController<float>", [&](float sp, float y) { return pidF.step(sp, y, 0.001f); });
+
+    PidController<util::q16> pidQ(2.0f, 0.5f, 0.01f, -10.0f, 10.0f);
+    pidQ.setDerivativeFilter(0.005f);
+    pidQ.setSetpointWeight(0.8f);
+    const util::q16 dtQ = pidSeconds(1000, util::q16());
+    bench("PidController<q16>", [&](float sp, float y) { return pidQ.step(sp, y, dtQ).toFloat(); });
+}
+
+void loop() {}
@@ -0,0 +1,41 @@
+#ifndef CONTROLPACKET_H
+#define CONTROLPACKET_H
+
+// Parsing of the autonomous command datagram "steering,throttle,emergency[,stamp]".
+
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct ControlPacket {
+    float steering;     ///< Steering gearbox turns, -2.4 to 2.4.
+    float throttle;     ///< Percent, -100 to 100.
+    bool  emergency;
+    uint64_t stampUs;   ///< Pi send time on the shared clock (ClockSync.h), 0 if the Pi sent none.
+};
+
+/**
+ * @brief Splits a command datagram on commas and converts the first three fields.
+ *
+ * @return false (and out untouched) if fewer than three fields were received.
+ */
+inline bool parseControlPacket(const std::string &udpData, ControlPacket &out) {
+    std::istringstream ss(udpData);
+    std::string token;
+    std::vector<std::string> tokens;
+
+    while (std::getline(ss, token, ',')) {
+        tokens.push_back(token);
+    }
+
+    if (tokens.size() < 3) return false;
+    out.steering = std::atof(tokens[0].c_str());
+    out.throttle = std::atof(tokens[1].c_str());
+    out.emergency = (std::atoi(tokens[2].c_str()) != 0);
+    out.stampUs = tokens.size() > 3 ? std::strtoull(tokens[3].c_str(), NULL, 10) : 0;
+    return true;
+}
+
+#endif // CONTROLPACKET_H
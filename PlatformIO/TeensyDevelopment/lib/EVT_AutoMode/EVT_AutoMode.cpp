@@ -4,6 +4,11 @@
 #include "EVT_StateMachine.h"
 #include "EVT_ODriver.h"
 #include "EVT_Ethernet.h"
+#include "EVT_FaultManager.h"
+#include "EVT_SteerTrajectory.h"
+#include "EVT_Drivetrain.h"
+#include "EVT_Throttle.h"
+#include "ControlPacket.h"
 
 // Global variable for UDP data processing.
 // fixed here
@@ -32,25 +37,12 @@ bool emergency = false;
 //     }
 //   }
 
-// Function to parse UDP data and update control variables.
-void setControls(const std::string &udpData) {
-    std::istringstream ss(udpData);
-    std::string token;
-    std::vector<std::string> tokens;
-
-    while (std::getline(ss, token, ',')) {
-        tokens.push_back(token);
-    }
-
-    if (tokens.size() >= 3) {
-        // fixed here
-        raw_steering_angle = std::atof(tokens[0].c_str());
-        raw_throttle = std::atof(tokens[1].c_str());
-        emergency = (std::atoi(tokens[2].c_str()) != 0);
-    } else {
-        Serial.print("Insufficient data received to set controls: ");
-        Serial.println(udpData.c_str());
-    }
+// Updates the control variables from a received command packet.
+void setControls(const ControlPacket &packet) {
+    // fixed here
+    raw_steering_angle = packet.steering;
+    raw_throttle = packet.throttle;
+    emergency = packet.emergency;
 }
 
 // Runs the mapped control commands using the RC center steering value captured from ODrive feedback.
@@ -61,40 +53,42 @@ void runMappedControls() {
 
     if (!centerCaptured) {
         // Capture the center from ODrive's current reported steering position.
-        ODriveFeedback fb = odrive.getFeedback();
-        autoCenterSteering = fb.pos;
+        autoCenterSteering = lastOdrvFeedback.pos;
         centerCaptured = true;
         Serial.print("Captured autonomous center steering value from ODrive: ");
         Serial.println(autoCenterSteering);
     }
 
     if (!emergency) {
-        // Map throttle percentage (0-100) to VESC RPM command (0-7500 RPM).
-        float rpmCommand = (raw_throttle / 100.0f) * 7500.0f;
-        float MappedSteering = (raw_throttle); // raw throttle values should be from -2.4 to 2.4, the amount of turns in the steering gearbox.
-        vesc1.setRPM(rpmCommand);
-        vesc2.setRPM(rpmCommand);
+        // Throttle percentage (-100..100) is ramped and mapped to RPM (or brake) by EVT_Throttle.
+        ThrottleCommand command = updateAutoThrottle(raw_throttle);
+        float MappedSteering = (raw_steering_angle); // raw steering values should be from -2.4 to 2.4, the amount of turns in the steering gearbox.
+        lastRpmCommand = command.type == THROTTLE_OUT_RPM ? command.value : 0.0f;
+        updateDrivetrain(command);
 
-        odrive.setPosition(MappedSteering, 15.0f); // setting the steering angle , with a velocity of 15 fasts.
+        setSteeringTarget(MappedSteering); // velocity/torque feedforward come from the trajectory generator.
     } else {
         // In an emergency, stop throttle and hold the steering at the captured center.
-        vesc1.setRPM(0);
-        vesc2.setRPM(0);
-        odrive.setPosition(autoCenterSteering, 27.0f);
+        lastRpmCommand = 0.0f;
+        resetThrottle();
+        vescSetRpm(0, 0);
+        vescSetRpm(1, 0);
+        setSteeringTarget(autoCenterSteering);
     }
+    serviceSteeringTrajectory();
 }
 
 void updateAutonomousMode() {
     // Set autonomous mode debug message.
-    odrvDebug = "Autonomous mode active.";
-    sendTelemetry();
-    std::string rawCommands = receiveUdp();
-    if (!rawCommands.empty()) {
-        setControls(rawCommands);
+    snprintf(odrvDebug, sizeof(odrvDebug), "Autonomous mode active.");
+    // Only the newest packet since the last tick is acted on.
+    ControlPacket packet;
+    if (receiveControlPacket(packet)) {
+        setControls(packet);
     }
     runMappedControls();
 
     if (emergency){
-        SetErrorState("AutoMode","Emergency Flag");
+        reportFault(FAULT_CRITICAL, "AutoMode", "Emergency Flag");
     }
 }
\ No newline at end of file
@@ -2,10 +2,11 @@
 #define EVT_AUTOMODE_H
 
 #include <Arduino.h>
+#include "ControlPacket.h"
 
 // Autonomous mode function prototype.
 void updateAutonomousMode();
-void setControls(const std::string &udpData);
+void setControls(const ControlPacket &packet);
 void runMappedControls();
 
 #endif // EVT_AUTOMODE_H
@@ -0,0 +1,219 @@
+#include "EVT_BlackBox.h"
+#include <SD.h>
+#include "EVT_RC.h"
+#include "EVT_VescDriver.h"
+#include "EVT_ODriver.h"
+#include "EVT_StateMachine.h"
+#include "EVT_EventLog.h"
+
+static const uint32_t BLACKBOX_PERIOD_US  = 1000000UL / BLACKBOX_RATE_HZ;
+static const uint32_t FREEZE_SAMPLES      = BLACKBOX_FREEZE_SECONDS * BLACKBOX_RATE_HZ;
+static const uint32_t FREEZE_POST_SAMPLES = FREEZE_SAMPLES / 2;
+static const uint32_t FLUSH_EVERY_CHUNKS  = 8;
+static const uint32_t WRITE_SLICE_BYTES   = 512;   // Written per serviceBlackBox() call, one SD sector.
+static_assert(BLACKBOX_CHUNK_SIZE % WRITE_SLICE_BYTES == 0, "Chunks are written in whole slices");
+
+// Double buffer: the loop fills one chunk while the other waits for the SD card.
+static BlackBoxChunk chunkBuffers[2];
+static uint8_t  activeChunk = 0;
+static int8_t   pendingChunk = -1;
+static uint32_t chunkSequence = 0;
+static uint32_t droppedChunks = 0;
+
+static File     logFile;
+static bool     blackBoxReady = false;
+static uint16_t logIndex = 0;
+static uint32_t lastSampleUs = 0;
+static uint32_t chunksSinceFlush = 0;
+static bool     flushDue = false;
+
+// The chunk on its way to the card, a slice per call; NULL when none is.
+static const uint8_t* writeData = NULL;
+static File*          writeFile = NULL;
+static uint32_t       writeOffset = 0;
+
+// Freeze-frame ring lives in OCRAM, it is too big for the tightly coupled RAM.
+DMAMEM static BlackBoxSample freezeRing[FREEZE_SAMPLES];
+static BlackBoxChunk freezeChunk;
+static File     freezeFile;
+static uint32_t freezeWritten = 0;     // Total samples pushed into the ring.
+static uint32_t freezePostRemaining = 0;
+static uint32_t freezeDumpIndex = 0;
+static uint32_t freezeDumpEnd = 0;
+static uint16_t freezeCount = 0;
+static uint32_t freezeSequence = 0;
+
+enum FREEZE_STATE { FREEZE_IDLE, FREEZE_POST_TRIGGER, FREEZE_DUMPING };
+static FREEZE_STATE freezeState = FREEZE_IDLE;
+
+static void sealChunk(BlackBoxChunk &chunk, uint16_t count, uint32_t &sequence) {
+    chunk.header.magic = BLACKBOX_MAGIC;
+    chunk.header.version = BLACKBOX_VERSION;
+    chunk.header.sampleCount = count;
+    chunk.header.sequence = sequence++;
+    chunk.header.crc32 = blackBoxCrc32((const uint8_t*)chunk.samples, count * sizeof(BlackBoxSample));
+    memset(&chunk.samples[count], 0, sizeof(chunk) - sizeof(chunk.header) - count * sizeof(BlackBoxSample));
+}
+
+static void beginChunkWrite(File &file, const BlackBoxChunk &chunk) {
+    writeFile = &file;
+    writeData = (const uint8_t*)&chunk;
+    writeOffset = 0;
+}
+
+// Writes the next slice. Returns true once the whole chunk is out.
+static bool continueChunkWrite() {
+    writeFile->write(writeData + writeOffset, WRITE_SLICE_BYTES);
+    writeOffset += WRITE_SLICE_BYTES;
+    if (writeOffset < sizeof(BlackBoxChunk)) return false;
+    writeData = NULL;
+    return true;
+}
+
+static void fillSample(BlackBoxSample &s, uint32_t now) {
+    s.timestampUs = now;
+    memcpy(s.channels, channels, sizeof(s.channels));
+    s.vescRpm[0]          = vesc1.data.rpm;
+    s.vescRpm[1]          = vesc2.data.rpm;
+    s.vescMotorCurrent[0] = vesc1.data.avgMotorCurrent;
+    s.vescMotorCurrent[1] = vesc2.data.avgMotorCurrent;
+    s.vescInputCurrent[0] = vesc1.data.avgInputCurrent;
+    s.vescInputCurrent[1] = vesc2.data.avgInputCurrent;
+    s.vescDuty[0]         = vesc1.data.dutyCycleNow;
+    s.vescDuty[1]         = vesc2.data.dutyCycleNow;
+    s.vescTempMosfet[0]   = vesc1.data.tempMosfet;
+    s.vescTempMosfet[1]   = vesc2.data.tempMosfet;
+    s.vescVoltage         = vesc1.data.inpVoltage;
+    s.odrvPos             = lastOdrvFeedback.pos;
+    s.odrvVel             = lastOdrvFeedback.vel;
+    s.steeringTarget      = lastTargetPosition;
+    s.rpmCommand          = lastRpmCommand;
+    s.vescFault[0]        = (uint8_t)vesc1.data.error;
+    s.vescFault[1]        = (uint8_t)vesc2.data.error;
+    s.state               = (uint8_t)CurrentState;
+    s.flags               = isSbusFailSafe() ? BLACKBOX_FLAG_SBUS_FAILSAFE : 0;
+}
+
+void setupBlackBox() {
+    if (!SD.begin(BUILTIN_SDCARD)) {
+        logEvent(EVT_BLACKBOX, LOC_BLACKBOX, BLACKBOX_STATUS_NO_CARD);
+        return;
+    }
+
+    char name[16];
+    for (logIndex = 0; logIndex < 1000; logIndex++) {
+        snprintf(name, sizeof(name), "LOG%03u.BIN", logIndex);
+        if (!SD.exists(name)) break;
+    }
+    logFile = SD.open(name, FILE_WRITE);
+    if (!logFile) {
+        logEvent(EVT_BLACKBOX, LOC_BLACKBOX, BLACKBOX_STATUS_OPEN_FAILED, logIndex);
+        return;
+    }
+    blackBoxReady = true;
+    logEvent(EVT_BLACKBOX, LOC_BLACKBOX, BLACKBOX_STATUS_RECORDING, logIndex);
+}
+
+void captureBlackBoxSample() {
+    if (!blackBoxReady) return;
+
+    uint32_t now = micros();
+    if (now - lastSampleUs < BLACKBOX_PERIOD_US) return;
+    lastSampleUs = now;
+
+    BlackBoxChunk &chunk = chunkBuffers[activeChunk];
+    uint16_t &count = chunk.header.sampleCount;
+    fillSample(chunk.samples[count], now);
+
+    // The freeze ring stops moving while it is being dumped.
+    if (freezeState != FREEZE_DUMPING) {
+        BlackBoxSample &f = freezeRing[freezeWritten % FREEZE_SAMPLES];
+        f = chunk.samples[count];
+        f.flags |= BLACKBOX_FLAG_FREEZE_FRAME;
+        freezeWritten++;
+
+        if (freezeState == FREEZE_POST_TRIGGER && --freezePostRemaining == 0) {
+            freezeDumpEnd = freezeWritten;
+            freezeDumpIndex = freezeWritten > FREEZE_SAMPLES ? freezeWritten - FREEZE_SAMPLES : 0;
+            freezeState = FREEZE_DUMPING;
+        }
+    }
+
+    if (++count < BLACKBOX_SAMPLES_PER_CHUNK) return;
+
+    sealChunk(chunk, count, chunkSequence);
+    if (pendingChunk < 0) {
+        pendingChunk = activeChunk;
+        activeChunk ^= 1;
+    } else {
+        // SD card fell behind; reuse this buffer rather than wait.
+        droppedChunks++;
+    }
+    chunkBuffers[activeChunk].header.sampleCount = 0;
+}
+
+void serviceBlackBox() {
+    if (!blackBoxReady) return;
+
+    // Each call does one bounded piece of work: a slice, a flush, an open or a close.
+    if (writeData != NULL) {
+        if (continueChunkWrite() && writeFile == &logFile) {
+            pendingChunk = -1;
+            flushDue = ++chunksSinceFlush >= FLUSH_EVERY_CHUNKS;
+        }
+        return;
+    }
+
+    if (flushDue) {
+        logFile.flush();
+        chunksSinceFlush = 0;
+        flushDue = false;
+        return;
+    }
+
+    if (pendingChunk >= 0) {
+        beginChunkWrite(logFile, chunkBuffers[pendingChunk]);
+        return;
+    }
+
+    if (freezeState != FREEZE_DUMPING) return;
+
+    if (!freezeFile) {
+        char name[20];
+        snprintf(name, sizeof(name), "LOG%03u_F%02u.BIN", logIndex, freezeCount);
+        freezeFile = SD.open(name, FILE_WRITE);
+        if (!freezeFile) {
+            logEvent(EVT_BLACKBOX, LOC_BLACKBOX, BLACKBOX_STATUS_OPEN_FAILED, freezeCount);
+            freezeState = FREEZE_IDLE;
+            return;
+        }
+        freezeSequence = 0;
+        return;
+    }
+
+    if (freezeDumpIndex >= freezeDumpEnd) {
+        freezeFile.close();
+        freezeFile = File();
+        logEvent(EVT_BLACKBOX, LOC_BLACKBOX, BLACKBOX_STATUS_FREEZE_SAVED, freezeCount);
+        freezeCount++;
+        freezeState = FREEZE_IDLE;
+        return;
+    }
+
+    uint16_t count = 0;
+    while (count < BLACKBOX_SAMPLES_PER_CHUNK && freezeDumpIndex < freezeDumpEnd) {
+        freezeChunk.samples[count++] = freezeRing[freezeDumpIndex++ % FREEZE_SAMPLES];
+    }
+    sealChunk(freezeChunk, count, freezeSequence);
+    beginChunkWrite(freezeFile, freezeChunk);
+}
+
+void blackBoxFreeze() {
+    if (!blackBoxReady || freezeState != FREEZE_IDLE) return;
+    freezePostRemaining = FREEZE_POST_SAMPLES;
+    freezeState = FREEZE_POST_TRIGGER;
+}
+
+uint32_t getBlackBoxDroppedChunks() {
+    return droppedChunks;
+}
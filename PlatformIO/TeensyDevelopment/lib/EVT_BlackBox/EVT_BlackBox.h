@@ -0,0 +1,56 @@
+#ifndef EVT_BLACKBOX_H
+#define EVT_BLACKBOX_H
+
+#include <Arduino.h>
+#include "EVT_BlackBoxFormat.h"
+
+#define BLACKBOX_RATE_HZ        200
+#define BLACKBOX_FREEZE_SECONDS 2   // Window kept around every SetErrorState().
+
+/**
+ * @brief Status codes logged as arg0 of EVT_BLACKBOX events.
+ */
+enum BLACKBOX_STATUS {
+    BLACKBOX_STATUS_NO_CARD,        ///< SD.begin() failed, recorder disabled.
+    BLACKBOX_STATUS_OPEN_FAILED,    ///< arg1 = log or freeze index that could not be created.
+    BLACKBOX_STATUS_RECORDING,      ///< arg1 = LOGnnn.BIN index.
+    BLACKBOX_STATUS_FREEZE_SAVED    ///< arg1 = freeze-frame index just written.
+};
+
+/**
+ * @brief Mounts the built-in SD card and opens the next free LOGnnn.BIN file.
+ *
+ * Without a card the recorder stays disabled and every other call is a no-op.
+ */
+void setupBlackBox();
+
+/**
+ * @brief Copies the current vehicle snapshot into the active chunk buffer.
+ *
+ * Call every loop; it only captures when a sample is due. Never touches the SD
+ * card, full chunks are handed to serviceBlackBox() through the second buffer.
+ */
+void captureBlackBoxSample();
+
+/**
+ * @brief Moves the SD card work on by one bounded step: a 512-byte slice of
+ *        the chunk being written (log or freeze-frame), a flush, or opening or
+ *        closing a freeze-frame file.
+ *
+ * This is the only place that touches storage; call it at the low-priority
+ * end of loop(). A 4 KB chunk takes eight calls, well inside the time the
+ * other buffer takes to fill.
+ */
+void serviceBlackBox();
+
+/**
+ * @brief Requests a freeze-frame dump around the current moment.
+ *
+ * Keeps recording for half the window, then writes the whole window to its own
+ * file. Further triggers are ignored until that dump is finished.
+ */
+void blackBoxFreeze();
+
+uint32_t getBlackBoxDroppedChunks();
+
+#endif // EVT_BLACKBOX_H
@@ -0,0 +1,70 @@
+#ifndef EVT_BLACKBOXFORMAT_H
+#define EVT_BLACKBOXFORMAT_H
+
+// On-disk layout of the black-box log, shared with tools/blackbox_decode.cpp.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <crc32.h>
+
+#define BLACKBOX_MAGIC            0x4B425645u   // "EVBK" little endian
+#define BLACKBOX_VERSION          1
+#define BLACKBOX_CHUNK_SIZE       4096          // Unit of the log file, a whole number of SD sectors.
+#define BLACKBOX_CHANNELS         10
+
+#define BLACKBOX_FLAG_SBUS_FAILSAFE  0x01
+#define BLACKBOX_FLAG_FREEZE_FRAME   0x02        // Sample belongs to a freeze-frame dump.
+
+/**
+ * @brief One snapshot of the vehicle, captured at the black-box rate.
+ */
+struct BlackBoxSample {
+    uint32_t timestampUs;
+    uint16_t channels[BLACKBOX_CHANNELS];
+    float    vescRpm[2];
+    float    vescMotorCurrent[2];
+    float    vescInputCurrent[2];
+    float    vescDuty[2];
+    float    vescTempMosfet[2];
+    float    vescVoltage;
+    float    odrvPos;
+    float    odrvVel;
+    float    steeringTarget;
+    float    rpmCommand;
+    uint8_t  vescFault[2];
+    uint8_t  state;
+    uint8_t  flags;
+};
+
+/**
+ * @brief Header at the start of every chunk. The CRC covers the samples only.
+ */
+struct BlackBoxChunkHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t sampleCount;
+    uint32_t sequence;
+    uint32_t crc32;
+};
+
+#define BLACKBOX_SAMPLES_PER_CHUNK \
+    ((BLACKBOX_CHUNK_SIZE - sizeof(BlackBoxChunkHeader)) / sizeof(BlackBoxSample))
+
+struct BlackBoxChunk {
+    BlackBoxChunkHeader header;
+    BlackBoxSample samples[BLACKBOX_SAMPLES_PER_CHUNK];
+    uint8_t padding[BLACKBOX_CHUNK_SIZE - sizeof(BlackBoxChunkHeader)
+                    - BLACKBOX_SAMPLES_PER_CHUNK * sizeof(BlackBoxSample)];
+};
+
+static_assert(sizeof(BlackBoxSample) == 88, "BlackBoxSample layout changed, bump BLACKBOX_VERSION");
+static_assert(sizeof(BlackBoxChunk) == BLACKBOX_CHUNK_SIZE, "BlackBoxChunk must fill one chunk exactly");
+
+/**
+ * @brief CRC stored in BlackBoxChunkHeader::crc32.
+ */
+static inline uint32_t blackBoxCrc32(const uint8_t* data, size_t len) {
+    return util::crc32(data, len);
+}
+
+#endif // EVT_BLACKBOXFORMAT_H
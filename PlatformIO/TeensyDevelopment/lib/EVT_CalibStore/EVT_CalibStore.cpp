@@ -0,0 +1,106 @@
+#include "EVT_CalibStore.h"
+#include <string.h>
+#include <crc32.h>
+
+#ifdef ARDUINO
+#include <EEPROM.h>
+
+bool EepromCalibStorage::read(uint32_t address, void* dst, size_t len) {
+    if (address + len > EEPROM.length()) return false;
+    uint8_t* out = (uint8_t*)dst;
+    for (size_t i = 0; i < len; i++) out[i] = EEPROM.read(address + i);
+    return true;
+}
+
+bool EepromCalibStorage::write(uint32_t address, const void* src, size_t len) {
+    if (address + len > EEPROM.length()) return false;
+    const uint8_t* in = (const uint8_t*)src;
+    // update() skips bytes that already match, sparing flash wear.
+    for (size_t i = 0; i < len; i++) EEPROM.update(address + i, in[i]);
+    return true;
+}
+
+static EepromCalibStorage defaultStorage;
+static CalibStorage* storage = &defaultStorage;
+
+#else
+#include <stdio.h>
+
+bool FileCalibStorage::read(uint32_t address, void* dst, size_t len) {
+    FILE* f = fopen(path_, "rb");
+    if (!f) return false;
+    bool ok = fseek(f, address, SEEK_SET) == 0 && fread(dst, 1, len, f) == len;
+    fclose(f);
+    return ok;
+}
+
+bool FileCalibStorage::write(uint32_t address, const void* src, size_t len) {
+    FILE* f = fopen(path_, "r+b");
+    if (!f) f = fopen(path_, "w+b");
+    if (!f) return false;
+    bool ok = fseek(f, address, SEEK_SET) == 0 && fwrite(src, 1, len, f) == len;
+    fclose(f);
+    return ok;
+}
+
+static CalibStorage* storage = nullptr;
+
+#endif
+
+static const uint16_t DEFAULT_SBUS_MIN = 172;
+static const uint16_t DEFAULT_SBUS_MAX = 1811;
+
+CalibRecord calibRecord;
+
+static uint32_t recordCrc(const CalibRecord& record) {
+    return util::crc32((const uint8_t*)&record, offsetof(CalibRecord, crc32));
+}
+
+void resetCalibrationDefaults() {
+    memset(&calibRecord, 0, sizeof(calibRecord));
+    calibRecord.magic = CALIB_MAGIC;
+    calibRecord.version = CALIB_VERSION;
+    calibRecord.size = sizeof(CalibRecord);
+    calibRecord.steeringLeftPos  = -2.33f;  // Hard left encoder reading
+    calibRecord.steeringRightPos = 1.0f;    // Hard right encoder reading
+    calibRecord.steeringZero = (calibRecord.steeringLeftPos + calibRecord.steeringRightPos) / 2.0f;
+    for (uint8_t i = 0; i < CALIB_SBUS_CHANNELS; i++) {
+        calibRecord.sbusMin[i] = DEFAULT_SBUS_MIN;
+        calibRecord.sbusMax[i] = DEFAULT_SBUS_MAX;
+    }
+    // Steering stick travel measured on our transmitter.
+    calibRecord.sbusMin[3] = 410;
+    calibRecord.sbusMax[3] = 1811;
+}
+
+void setCalibStorage(CalibStorage* newStorage) {
+    storage = newStorage;
+}
+
+bool loadCalibration() {
+    resetCalibrationDefaults();
+    if (storage == nullptr) return false;
+
+    CalibRecord stored;
+    if (!storage->read(CALIB_EEPROM_ADDR, &stored, sizeof(stored))) return false;
+    if (stored.magic != CALIB_MAGIC || stored.version != CALIB_VERSION ||
+        stored.size != sizeof(CalibRecord) || stored.crc32 != recordCrc(stored)) {
+        return false;
+    }
+    // A CRC-valid record can still hold values the steering map would divide by zero on.
+    if (!(stored.steeringLeftPos < stored.steeringRightPos) ||
+        stored.sbusMin[3] >= 1200 || stored.sbusMax[3] <= 1260) {
+        return false;
+    }
+    calibRecord = stored;
+    return true;
+}
+
+bool saveCalibration() {
+    if (storage == nullptr) return false;
+    calibRecord.magic = CALIB_MAGIC;
+    calibRecord.version = CALIB_VERSION;
+    calibRecord.size = sizeof(CalibRecord);
+    calibRecord.crc32 = recordCrc(calibRecord);
+    return storage->write(CALIB_EEPROM_ADDR, &calibRecord, sizeof(calibRecord));
+}
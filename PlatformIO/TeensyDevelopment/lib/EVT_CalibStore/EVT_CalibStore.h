@@ -0,0 +1,97 @@
+#ifndef EVT_CALIBSTORE_H
+#define EVT_CALIBSTORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CALIB_MAGIC        0x4C414345u   // "ECAL" little endian
+#define CALIB_VERSION      1
+#define CALIB_SBUS_CHANNELS 10
+#define CALIB_EEPROM_ADDR  0
+
+/**
+ * @brief Everything that used to be re-measured or hard-coded at every boot.
+ *
+ * Bump CALIB_VERSION whenever the layout changes; old records are then ignored.
+ */
+struct CalibRecord {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+
+    // Steering endpoints in ODrive turns.
+    float steeringLeftPos;
+    float steeringRightPos;
+    float steeringZero;
+
+    // What the ODrive reported after its last motor/encoder calibration.
+    float motorPhaseResistance;
+    float motorPhaseInductance;
+    float commutationOffset;
+
+    uint16_t sbusMin[CALIB_SBUS_CHANNELS];
+    uint16_t sbusMax[CALIB_SBUS_CHANNELS];
+
+    uint32_t crc32;   ///< Over every byte before this field.
+};
+
+/**
+ * @brief Byte storage the record is kept in.
+ *
+ * EEPROM on the Teensy; a file-backed fake on the host so the load/save logic
+ * can be exercised without hardware.
+ */
+class CalibStorage {
+public:
+    virtual ~CalibStorage() {}
+    virtual bool read(uint32_t address, void* dst, size_t len) = 0;
+    virtual bool write(uint32_t address, const void* src, size_t len) = 0;
+};
+
+#ifdef ARDUINO
+class EepromCalibStorage : public CalibStorage {
+public:
+    bool read(uint32_t address, void* dst, size_t len) override;
+    bool write(uint32_t address, const void* src, size_t len) override;
+};
+#else
+class FileCalibStorage : public CalibStorage {
+public:
+    explicit FileCalibStorage(const char* path) : path_(path) {}
+    bool read(uint32_t address, void* dst, size_t len) override;
+    bool write(uint32_t address, const void* src, size_t len) override;
+
+private:
+    const char* path_;
+};
+#endif
+
+/**
+ * @brief The active record. Holds defaults until loadCalibration() succeeds.
+ */
+extern CalibRecord calibRecord;
+
+/**
+ * @brief Swaps the backend (defaults to EEPROM on the Teensy). Call before loading.
+ */
+void setCalibStorage(CalibStorage* storage);
+
+/**
+ * @brief Reads and validates the stored record (magic, version, size, CRC).
+ *
+ * @return True if a valid record was loaded into calibRecord; otherwise the
+ *         defaults are kept.
+ */
+bool loadCalibration();
+
+/**
+ * @brief Seals calibRecord with a fresh CRC and writes it out.
+ */
+bool saveCalibration();
+
+/**
+ * @brief Restores the compile-time defaults in calibRecord (storage untouched).
+ */
+void resetCalibrationDefaults();
+
+#endif // EVT_CALIBSTORE_H
@@ -0,0 +1,89 @@
+#ifndef ENDPOINTCAPTURE_H
+#define ENDPOINTCAPTURE_H
+
+// Records the extremes the operator drives the steering and the sticks to,
+// then writes them into a CalibRecord. Driven by the CAL* link commands in
+// EVT_ODriver; tools/endpoint_capture checks the validation.
+
+#include <stdint.h>
+#include "EVT_CalibStore.h"
+
+#define CALIB_CAPTURE_MIN_STEER_SPAN  0.5f   // Turns between the hard stops, at least.
+#define CALIB_CAPTURE_MIN_STICK_SPAN  800    // SBUS counts a channel must move to be recorded.
+#define CALIB_CAPTURE_STEER_CHANNEL   3      // Must cross the 1200-1260 centre band (see updateOdrvControl()).
+
+class EndpointCapture {
+public:
+    void begin() {
+        active_ = true;
+        steerSamples_ = 0;
+        for (uint8_t i = 0; i < CALIB_SBUS_CHANNELS; i++) {
+            stickMin_[i] = UINT16_MAX;
+            stickMax_[i] = 0;
+        }
+    }
+
+    void cancel() { active_ = false; }
+    bool active() const { return active_; }
+
+    /** @brief One steering encoder reading, in ODrive turns. */
+    void addSteering(float pos) {
+        if (!active_ || pos != pos) return;
+        if (steerSamples_ == 0 || pos < steerMin_) steerMin_ = pos;
+        if (steerSamples_ == 0 || pos > steerMax_) steerMax_ = pos;
+        steerSamples_++;
+    }
+
+    /** @brief One SBUS frame. */
+    void addSticks(const uint16_t* channels) {
+        if (!active_) return;
+        for (uint8_t i = 0; i < CALIB_SBUS_CHANNELS; i++) {
+            if (channels[i] < stickMin_[i]) stickMin_[i] = channels[i];
+            if (channels[i] > stickMax_[i]) stickMax_[i] = channels[i];
+        }
+    }
+
+    /**
+     * @brief Ends the capture and writes what it saw into record.
+     *
+     * The steering endpoints and the steering stick are required; other
+     * channels are only written if they moved CALIB_CAPTURE_MIN_STICK_SPAN.
+     *
+     * @param reason  Set to a short word when it fails: idle, steering or stick.
+     * @return false, with record untouched, if the capture is not usable.
+     */
+    bool finish(CalibRecord& record, const char** reason) {
+        if (!active_) return fail(reason, "idle");
+        active_ = false;
+        if (steerSamples_ < 2 || steerMax_ - steerMin_ < CALIB_CAPTURE_MIN_STEER_SPAN) return fail(reason, "steering");
+        uint8_t s = CALIB_CAPTURE_STEER_CHANNEL;
+        if (stickMin_[s] >= 1200 || stickMax_[s] <= 1260) return fail(reason, "stick");
+
+        record.steeringLeftPos = steerMin_;
+        record.steeringRightPos = steerMax_;
+        record.steeringZero = (steerMin_ + steerMax_) / 2.0f;
+        for (uint8_t i = 0; i < CALIB_SBUS_CHANNELS; i++) {
+            if (i != s && (stickMax_[i] < stickMin_[i] || stickMax_[i] - stickMin_[i] < CALIB_CAPTURE_MIN_STICK_SPAN)) {
+                continue;
+            }
+            record.sbusMin[i] = stickMin_[i];
+            record.sbusMax[i] = stickMax_[i];
+        }
+        return true;
+    }
+
+private:
+    static bool fail(const char** reason, const char* why) {
+        if (reason) *reason = why;
+        return false;
+    }
+
+    bool active_ = false;
+    uint32_t steerSamples_ = 0;
+    float steerMin_ = 0.0f;
+    float steerMax_ = 0.0f;
+    uint16_t stickMin_[CALIB_SBUS_CHANNELS];
+    uint16_t stickMax_[CALIB_SBUS_CHANNELS];
+};
+
+#endif // ENDPOINTCAPTURE_H
@@ -0,0 +1,66 @@
+#include "EVT_CanBus.h"
+#include "ODriveFlexCAN.hpp"
+
+FlexCAN_T4<CAN1, RX_SIZE_256, TX_SIZE_16> canBus;
+
+static util::CanDispatcher<CAN_BUS_MAX_ROUTES> dispatcher;
+static bool canBusStarted = false;
+static uint32_t canBusTxErrors = 0;
+
+// Runs from canBus.events(), not from the interrupt.
+static void onCanFrame(const CAN_message_t& msg) {
+    dispatcher.dispatch(msg.id | (msg.flags.extended ? util::CAN_EXTENDED_FLAG : 0), msg.len, msg.buf);
+}
+
+void setupCanBus() {
+    if (canBusStarted) return;
+    canBus.begin();
+    canBus.setBaudRate(CAN_BUS_BAUD);
+    canBus.setMaxMB(16);
+    canBus.enableFIFO();
+    canBus.enableFIFOInterrupt();
+    canBus.onReceive(onCanFrame);
+    canBusStarted = true;
+}
+
+void serviceCanBus() {
+    canBus.events();
+}
+
+bool canBusAttach(uint32_t mask, uint32_t match, util::CanHandler handler, void* ctx) {
+    return dispatcher.attach(mask, match, handler, ctx);
+}
+
+static void odriveFrame(void* ctx, uint32_t id, uint8_t length, const uint8_t* data) {
+    static_cast<ODriveCAN*>(ctx)->onReceive(id, length, data);
+}
+
+bool canBusAttachOdrive(ODriveCAN& odrive, uint8_t nodeId) {
+    // CANSimple: 11-bit id = node_id << 5 | cmd_id. The extended flag is in
+    // the mask so VESC frames (always extended) never match.
+    return dispatcher.attach(util::CAN_EXTENDED_FLAG | 0x7E0, (uint32_t)nodeId << 5, odriveFrame, &odrive);
+}
+
+ODriveCanIntfWrapper canBusOdriveIntf() {
+    return wrap_can_intf(canBus);
+}
+
+bool canBusSend(void* ctx, uint32_t id, uint8_t length, const uint8_t* data) {
+    (void)ctx;
+    CAN_message_t msg;
+    msg.id = id & 0x1FFFFFFF;
+    msg.flags.extended = (id & util::CAN_EXTENDED_FLAG) != 0;
+    msg.len = length > 8 ? 8 : length;
+    memcpy(msg.buf, data, msg.len);
+    if (canBus.write(msg) > 0) return true;
+    canBusTxErrors++;
+    return false;
+}
+
+uint32_t getCanBusTxErrors() {
+    return canBusTxErrors;
+}
+
+uint32_t getCanBusUnrouted() {
+    return dispatcher.unroutedFrames();
+}
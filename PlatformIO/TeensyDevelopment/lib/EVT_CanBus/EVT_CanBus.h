@@ -0,0 +1,59 @@
+#ifndef EVT_CANBUS_H
+#define EVT_CANBUS_H
+
+#include <Arduino.h>
+#include <FlexCAN_T4.h>
+#include "CanDispatch.h"
+#include "ODriveCAN.h"
+
+#define CAN_BUS_BAUD        500000  // Must match the VESC and ODrive CAN baud settings.
+#define CAN_BUS_MAX_ROUTES  8       // Drivers that can attach to the dispatcher.
+
+/**
+ * @brief The CAN bus shared by every CAN device on the car (CAN1, pins 22/23).
+ *
+ * Received frames are queued by the FlexCAN interrupt and handed to the
+ * dispatcher from serviceCanBus(), so handlers run in loop context.
+ */
+extern FlexCAN_T4<CAN1, RX_SIZE_256, TX_SIZE_16> canBus;
+
+/**
+ * @brief Starts CAN1 at CAN_BUS_BAUD with the receive FIFO. Safe to call twice.
+ */
+void setupCanBus();
+
+/**
+ * @brief Delivers queued frames to the attached drivers. Call once per loop.
+ */
+void serviceCanBus();
+
+/**
+ * @brief Routes frames with (id & mask) == match to handler.
+ *
+ * Ids carry bit 31 for extended frames, as in ODriveCAN. The first matching
+ * route wins, so attach narrower filters first.
+ * @return false when CAN_BUS_MAX_ROUTES routes are already attached.
+ */
+bool canBusAttach(uint32_t mask, uint32_t match, util::CanHandler handler, void* ctx);
+
+/**
+ * @brief Attaches an ODriveCAN node: standard frames with its node ID in bits 5-10.
+ */
+bool canBusAttachOdrive(ODriveCAN& odrive, uint8_t nodeId);
+
+/**
+ * @brief Interface wrapper for constructing an ODriveCAN on this bus.
+ */
+ODriveCanIntfWrapper canBusOdriveIntf();
+
+/**
+ * @brief Queues one frame. Same signature as VescCan::SendFunction; ctx is unused.
+ *
+ * @return false if the transmit queue was full.
+ */
+bool canBusSend(void* ctx, uint32_t id, uint8_t length, const uint8_t* data);
+
+uint32_t getCanBusTxErrors();
+uint32_t getCanBusUnrouted();
+
+#endif // EVT_CANBUS_H
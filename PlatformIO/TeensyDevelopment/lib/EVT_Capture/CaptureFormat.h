@@ -0,0 +1,56 @@
+#ifndef EVT_CAPTUREFORMAT_H
+#define EVT_CAPTUREFORMAT_H
+
+// On-disk layout of the raw wire captures written by EVT_Capture, shared with
+// tools/replay.
+//
+// A capture file is one CaptureFileHeader followed by records back to back:
+// a CaptureRecordHeader and then `length` raw bytes exactly as they crossed the
+// wire. Records of one port are in order; records of different ports are in
+// timestamp order up to the staging delay of the tap.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CAPTURE_MAGIC           0x50435645u   // "EVCP" little endian
+#define CAPTURE_VERSION         1
+#define CAPTURE_MAX_RECORD      255           // Payload bytes per record.
+
+/**
+ * @brief Wire the bytes of a record belong to.
+ *
+ * Values are part of the file format, only ever append new ones.
+ */
+enum CAPTURE_PORT : uint8_t {
+    CAPTURE_PORT_SERIAL1 = 0,   ///< VESC 1 (left rear), VescUart framing.
+    CAPTURE_PORT_SERIAL2,       ///< SBUS receiver.
+    CAPTURE_PORT_SERIAL5,       ///< VESC 2 (right rear), VescUart framing.
+    CAPTURE_PORT_SERIAL6,       ///< ODrive ASCII protocol.
+    CAPTURE_PORT_UDP,           ///< One record per datagram.
+    CAPTURE_PORT_COUNT
+};
+
+enum CAPTURE_DIRECTION : uint8_t {
+    CAPTURE_RX = 0,             ///< Bytes the Teensy received.
+    CAPTURE_TX = 1              ///< Bytes the Teensy sent.
+};
+
+struct CaptureFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordHeaderSize;  ///< sizeof(CaptureRecordHeader), lets old readers skip new fields.
+    uint32_t startMicros;       ///< micros() when the file was opened.
+    uint32_t reserved;
+};
+
+struct CaptureRecordHeader {
+    uint32_t timestampUs;       ///< micros() of the first byte in the record.
+    uint8_t  port;              ///< CAPTURE_PORT
+    uint8_t  direction;         ///< CAPTURE_DIRECTION
+    uint16_t length;            ///< Payload bytes that follow, at most CAPTURE_MAX_RECORD.
+};
+
+static_assert(sizeof(CaptureFileHeader) == 16, "CaptureFileHeader must stay 16 bytes");
+static_assert(sizeof(CaptureRecordHeader) == 8, "CaptureRecordHeader must stay 8 bytes");
+
+#endif // EVT_CAPTUREFORMAT_H
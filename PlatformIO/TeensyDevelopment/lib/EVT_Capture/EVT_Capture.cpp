@@ -0,0 +1,176 @@
+#include "EVT_Capture.h"
+#include <SD.h>
+#include "EVT_EventLog.h"
+
+static const uint32_t CAPTURE_WRITE_BLOCK   = 4096;    // Most bytes handed to the SD card per service call.
+static const uint32_t CAPTURE_FLUSH_BLOCKS  = 16;
+static const uint32_t CAPTURE_STAGE_BYTES   = 64;      // Per port and direction, UART bursts are short.
+
+static_assert((CAPTURE_RING_BYTES & (CAPTURE_RING_BYTES - 1)) == 0, "CAPTURE_RING_BYTES must be a power of two");
+
+// Records are packed into the ring exactly as they go into the file.
+DMAMEM static uint8_t captureRing[CAPTURE_RING_BYTES];
+static uint32_t ringHead = 0;  // Next byte to write, never wraps back.
+static uint32_t ringTail = 0;  // Next byte to hand to the SD card.
+
+struct CaptureStage {
+    uint32_t timestampUs;
+    uint16_t length;
+    uint8_t  data[CAPTURE_STAGE_BYTES];
+};
+static CaptureStage stages[CAPTURE_PORT_COUNT][2];
+
+static File     captureFile;
+static bool     capturing = false;
+static uint16_t captureIndex = 0;
+static uint32_t droppedBytes = 0;
+static uint32_t blocksSinceFlush = 0;
+
+static void ringPut(const uint8_t* data, uint32_t length) {
+    uint32_t offset = ringHead & (CAPTURE_RING_BYTES - 1);
+    uint32_t first = CAPTURE_RING_BYTES - offset;
+    if (first > length) first = length;
+    memcpy(&captureRing[offset], data, first);
+    memcpy(captureRing, data + first, length - first);
+    ringHead += length;
+}
+
+static void commitRecord(uint32_t timestampUs, uint8_t port, uint8_t direction, const uint8_t* data, uint16_t length) {
+    if (length == 0) return;
+    if (CAPTURE_RING_BYTES - (ringHead - ringTail) < sizeof(CaptureRecordHeader) + length) {
+        // SD card fell behind; lose this record rather than stall the loop.
+        droppedBytes += length;
+        return;
+    }
+    CaptureRecordHeader header = { timestampUs, port, direction, length };
+    ringPut((const uint8_t*)&header, sizeof(header));
+    ringPut(data, length);
+}
+
+static void sealStage(uint8_t port, uint8_t direction) {
+    CaptureStage &stage = stages[port][direction];
+    commitRecord(stage.timestampUs, port, direction, stage.data, stage.length);
+    stage.length = 0;
+}
+
+int CaptureStream::read() {
+    int b = inner_.read();
+    if (b >= 0) captureByte(port_, CAPTURE_RX, (uint8_t)b);
+    return b;
+}
+
+size_t CaptureStream::write(uint8_t b) {
+    captureByte(port_, CAPTURE_TX, b);
+    return inner_.write(b);
+}
+
+size_t CaptureStream::write(const uint8_t* buffer, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        captureByte(port_, CAPTURE_TX, buffer[i]);
+    }
+    return inner_.write(buffer, size);
+}
+
+void setupCapture() {
+#if CAPTURE_AT_BOOT
+    startCapture();
+#endif
+}
+
+bool startCapture() {
+    if (capturing) return true;
+
+    char name[16];
+    for (captureIndex = 0; captureIndex < 1000; captureIndex++) {
+        snprintf(name, sizeof(name), "CAP%03u.BIN", captureIndex);
+        if (!SD.exists(name)) break;
+    }
+    captureFile = SD.open(name, FILE_WRITE);
+    if (!captureFile) {
+        logEvent(EVT_CAPTURE, LOC_CAPTURE, CAPTURE_STATUS_OPEN_FAILED, captureIndex);
+        return false;
+    }
+
+    CaptureFileHeader header = { CAPTURE_MAGIC, CAPTURE_VERSION, sizeof(CaptureRecordHeader), micros(), 0 };
+    captureFile.write((const uint8_t*)&header, sizeof(header));
+
+    memset(stages, 0, sizeof(stages));
+    ringHead = ringTail = 0;
+    droppedBytes = 0;
+    blocksSinceFlush = 0;
+    capturing = true;
+    logEvent(EVT_CAPTURE, LOC_CAPTURE, CAPTURE_STATUS_RECORDING, captureIndex);
+    return true;
+}
+
+void stopCapture() {
+    if (!capturing) return;
+
+    for (uint8_t port = 0; port < CAPTURE_PORT_COUNT; port++) {
+        sealStage(port, CAPTURE_RX);
+        sealStage(port, CAPTURE_TX);
+    }
+    capturing = false;
+    while (ringTail != ringHead) {
+        serviceCapture();
+    }
+    captureFile.close();
+    captureFile = File();
+    logEvent(EVT_CAPTURE, LOC_CAPTURE, CAPTURE_STATUS_STOPPED, droppedBytes);
+}
+
+bool isCapturing() {
+    return capturing;
+}
+
+void captureByte(CAPTURE_PORT port, CAPTURE_DIRECTION direction, uint8_t b) {
+    if (!capturing) return;
+
+    // The other direction is sealed first so a request always lands before its reply.
+    if (stages[port][direction ^ 1].length > 0) {
+        sealStage(port, direction ^ 1);
+    }
+    CaptureStage &stage = stages[port][direction];
+    if (stage.length == 0) {
+        stage.timestampUs = micros();
+    }
+    stage.data[stage.length++] = b;
+    if (stage.length == CAPTURE_STAGE_BYTES) {
+        sealStage(port, direction);
+    }
+}
+
+void captureDatagram(CAPTURE_PORT port, CAPTURE_DIRECTION direction, const uint8_t* data, size_t length) {
+    if (!capturing) return;
+    sealStage(port, direction);
+    commitRecord(micros(), port, direction, data, length > CAPTURE_MAX_RECORD ? CAPTURE_MAX_RECORD : (uint16_t)length);
+}
+
+void serviceCapture() {
+    if (!captureFile) return;
+
+    if (capturing) {
+        for (uint8_t port = 0; port < CAPTURE_PORT_COUNT; port++) {
+            sealStage(port, CAPTURE_RX);
+            sealStage(port, CAPTURE_TX);
+        }
+    }
+    if (ringTail == ringHead) return;
+
+    // One contiguous piece per call, it stops at the end of the ring.
+    uint32_t offset = ringTail & (CAPTURE_RING_BYTES - 1);
+    uint32_t length = ringHead - ringTail;
+    if (length > CAPTURE_RING_BYTES - offset) length = CAPTURE_RING_BYTES - offset;
+    if (length > CAPTURE_WRITE_BLOCK) length = CAPTURE_WRITE_BLOCK;
+    captureFile.write(&captureRing[offset], length);
+    ringTail += length;
+
+    if (++blocksSinceFlush >= CAPTURE_FLUSH_BLOCKS) {
+        captureFile.flush();
+        blocksSinceFlush = 0;
+    }
+}
+
+uint32_t getCaptureDroppedBytes() {
+    return droppedBytes;
+}
@@ -0,0 +1,89 @@
+#ifndef EVT_CAPTURE_H
+#define EVT_CAPTURE_H
+
+#include <Arduino.h>
+#include "CaptureFormat.h"
+
+#define CAPTURE_AT_BOOT     0       // 1 = start a CAPnnn.BIN capture from setupCapture().
+#define CAPTURE_RING_BYTES  32768   // Staging ring between the taps and the SD card.
+
+/**
+ * @brief Status codes logged as arg0 of EVT_CAPTURE events.
+ */
+enum CAPTURE_STATUS {
+    CAPTURE_STATUS_OPEN_FAILED,     ///< No card or CAPnnn.BIN could not be created.
+    CAPTURE_STATUS_RECORDING,       ///< arg1 = CAPnnn.BIN index.
+    CAPTURE_STATUS_STOPPED,         ///< arg1 = bytes dropped during the capture.
+};
+
+/**
+ * @brief Stream wrapper that records every byte read from or written to a port.
+ *
+ * Drivers that talk through a Stream (VescUart, ODriveUART) are handed one of
+ * these instead of the HardwareSerial. It forwards everything unchanged and
+ * costs one extra virtual call per byte while no capture is running.
+ */
+class CaptureStream : public Stream {
+public:
+    CaptureStream(Stream& inner, CAPTURE_PORT port) : inner_(inner), port_(port) {}
+
+    int available() override { return inner_.available(); }
+    int peek() override { return inner_.peek(); }
+    int read() override;
+    size_t write(uint8_t b) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    int availableForWrite() override { return inner_.availableForWrite(); }
+    void flush() override { inner_.flush(); }
+    using Print::write;
+
+private:
+    Stream& inner_;
+    CAPTURE_PORT port_;
+};
+
+/**
+ * @brief Starts a capture at boot when CAPTURE_AT_BOOT is set.
+ *
+ * Call after setupBlackBox(), which mounts the SD card.
+ */
+void setupCapture();
+
+/**
+ * @brief Opens the next free CAPnnn.BIN and starts recording all taps.
+ *
+ * @return false if there is no card or the file could not be created.
+ */
+bool startCapture();
+
+/**
+ * @brief Writes out everything still staged and closes the capture file.
+ */
+void stopCapture();
+
+bool isCapturing();
+
+/**
+ * @brief Records one byte of a byte stream (UART) port.
+ *
+ * Bytes are staged per port and direction and sealed into a record when the
+ * stage fills, the port turns around, or serviceCapture() runs.
+ */
+void captureByte(CAPTURE_PORT port, CAPTURE_DIRECTION direction, uint8_t b);
+
+/**
+ * @brief Records one datagram as a single record.
+ *
+ * Datagrams longer than CAPTURE_MAX_RECORD are truncated.
+ */
+void captureDatagram(CAPTURE_PORT port, CAPTURE_DIRECTION direction, const uint8_t* data, size_t length);
+
+/**
+ * @brief Seals the staged bytes and writes at most one block of the ring to the SD card.
+ *
+ * Call at the low-priority end of loop(), next to serviceBlackBox().
+ */
+void serviceCapture();
+
+uint32_t getCaptureDroppedBytes();
+
+#endif // EVT_CAPTURE_H
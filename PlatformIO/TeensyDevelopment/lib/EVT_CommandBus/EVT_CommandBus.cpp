@@ -0,0 +1,200 @@
+#include "EVT_CommandBus.h"
+
+struct CommandSlot {
+    uint8_t  data[COMMAND_SLOT_BYTES];
+    uint8_t  length;
+    uint32_t canId;
+    bool     staged;
+    bool     overflow;
+    uint32_t stagedCount;      // Commands staged since the last flush.
+    uint32_t stagedBytes;      // Their total size, as if each had been written.
+
+    uint8_t  sent[COMMAND_SLOT_BYTES];
+    uint8_t  sentLength;
+    uint32_t sentCanId;
+    uint32_t sentMs;
+    uint32_t confirmedMs;
+
+    volatile uint32_t resendRequests;  // Bumped from interrupts by forceCommandResend().
+    uint32_t resendSeen;
+};
+
+static COMMAND_PORT slotPort[COMMAND_SLOT_COUNT] = {
+    COMMAND_PORT_VESC1,
+    COMMAND_PORT_VESC2,
+    COMMAND_PORT_ODRIVE,
+    COMMAND_PORT_ODRIVE
+};
+
+static CommandSlot slots[COMMAND_SLOT_COUNT];
+static Print* portOut[COMMAND_PORT_COUNT] = {NULL, NULL, NULL, NULL};
+static CommandFrameSend canSend = NULL;
+static CommandPortStats portStats[COMMAND_PORT_COUNT];
+
+static uint32_t rateWindowMs = 0;
+static uint32_t windowWritten[COMMAND_PORT_COUNT];
+static uint32_t windowRequested[COMMAND_PORT_COUNT];
+
+// Collects a text command into the slot beginCommand() picked.
+class SlotPrint : public Print {
+public:
+    CommandSlot* slot = NULL;
+
+    size_t write(uint8_t b) override {
+        if (slot == NULL) return 0;
+        slot->stagedBytes++;
+        if (slot->length >= COMMAND_SLOT_BYTES) {
+            slot->overflow = true;
+            return 0;
+        }
+        slot->data[slot->length++] = b;
+        return 1;
+    }
+    using Print::write;
+};
+
+static SlotPrint slotPrint;
+
+// Starts a new command in the slot; an earlier one this tick is dropped.
+static CommandSlot& restartSlot(COMMAND_SLOT slot) {
+    CommandSlot& s = slots[slot];
+    s.length = 0;
+    s.canId = 0;
+    s.overflow = false;
+    s.staged = true;
+    s.stagedCount++;
+    slotPrint.slot = NULL;
+    return s;
+}
+
+void bindCommandPort(COMMAND_PORT port, Print* out) {
+    if (port >= COMMAND_PORT_COUNT) return;
+    portOut[port] = out;
+}
+
+void bindCommandCanPort(CommandFrameSend send) {
+    canSend = send;
+}
+
+void routeCommandSlot(COMMAND_SLOT slot, COMMAND_PORT port) {
+    if (slot >= COMMAND_SLOT_COUNT || port >= COMMAND_PORT_COUNT) return;
+    slotPort[slot] = port;
+}
+
+void stageCommand(COMMAND_SLOT slot, const uint8_t* data, uint8_t length) {
+    if (slot >= COMMAND_SLOT_COUNT) return;
+    CommandSlot& s = restartSlot(slot);
+    s.stagedBytes += length;
+    if (length > COMMAND_SLOT_BYTES) {
+        s.overflow = true;
+        return;
+    }
+    memcpy(s.data, data, length);
+    s.length = length;
+}
+
+Print& beginCommand(COMMAND_SLOT slot) {
+    if (slot < COMMAND_SLOT_COUNT) slotPrint.slot = &restartSlot(slot);
+    return slotPrint;
+}
+
+bool cancelCommand(COMMAND_SLOT slot) {
+    if (slot >= COMMAND_SLOT_COUNT || !slots[slot].staged) return false;
+    CommandSlot& s = slots[slot];
+    s.staged = false;
+    s.stagedBytes = 0;
+    s.stagedCount = 0;
+    if (slotPrint.slot == &s) slotPrint.slot = NULL;
+    return true;
+}
+
+bool stageCanCommand(void* ctx, uint32_t id, uint8_t length, const uint8_t* data) {
+    COMMAND_SLOT slot = (COMMAND_SLOT)(uintptr_t)ctx;
+    stageCommand(slot, data, length);
+    if (slot < COMMAND_SLOT_COUNT) slots[slot].canId = id;
+    return true;
+}
+
+static void updateRates(uint32_t now) {
+    uint32_t elapsed = now - rateWindowMs;
+    if (elapsed < COMMAND_BUS_RATE_WINDOW_MS) return;
+    for (uint8_t p = 0; p < COMMAND_PORT_COUNT; p++) {
+        CommandPortStats& stats = portStats[p];
+        stats.bytesWrittenPerSec = (stats.bytesWritten - windowWritten[p]) * 1000.0f / elapsed;
+        stats.bytesRequestedPerSec = (stats.bytesRequested - windowRequested[p]) * 1000.0f / elapsed;
+        windowWritten[p] = stats.bytesWritten;
+        windowRequested[p] = stats.bytesRequested;
+    }
+    rateWindowMs = now;
+}
+
+void flushCommandBus() {
+    uint32_t now = millis();
+    slotPrint.slot = NULL;
+
+    for (uint8_t p = 0; p < COMMAND_PORT_COUNT; p++) {
+        CommandPortStats& stats = portStats[p];
+        uint8_t batch[COMMAND_SLOT_COUNT * COMMAND_SLOT_BYTES];
+        size_t batchLength = 0;
+
+        for (uint8_t i = 0; i < COMMAND_SLOT_COUNT; i++) {
+            CommandSlot& s = slots[i];
+            if (slotPort[i] != p || !s.staged) continue;
+            s.staged = false;
+            stats.bytesRequested += s.stagedBytes;
+            stats.commandsCoalesced += s.stagedCount - 1;
+            s.stagedBytes = 0;
+            s.stagedCount = 0;
+
+            if (s.overflow) {
+                stats.overflows++;
+                continue;
+            }
+            uint32_t resend = s.resendRequests;
+            bool unchanged = s.sentMs != 0 && resend == s.resendSeen && s.length == s.sentLength &&
+                             s.canId == s.sentCanId && memcmp(s.data, s.sent, s.length) == 0;
+            if (unchanged && now - s.sentMs < COMMAND_BUS_KEEPALIVE_MS) {
+                stats.commandsSuppressed++;
+                s.confirmedMs = now;
+                continue;
+            }
+
+            if (p == COMMAND_PORT_CAN) {
+                // Frames cannot be joined; each is its own write.
+                if (canSend == NULL || !canSend(NULL, s.canId, s.length, s.data)) continue;
+                stats.writes++;
+                stats.bytesWritten += s.length;
+            } else {
+                if (portOut[p] == NULL) continue;
+                memcpy(batch + batchLength, s.data, s.length);
+                batchLength += s.length;
+            }
+            memcpy(s.sent, s.data, s.length);
+            s.sentLength = s.length;
+            s.sentCanId = s.canId;
+            s.sentMs = now == 0 ? 1 : now;
+            s.confirmedMs = s.sentMs;
+            s.resendSeen = resend;
+            stats.commandsSent++;
+        }
+
+        if (batchLength > 0) {
+            portOut[p]->write(batch, batchLength);
+            stats.writes++;
+            stats.bytesWritten += batchLength;
+        }
+    }
+    updateRates(now);
+}
+
+const CommandPortStats& getCommandPortStats(COMMAND_PORT port) {
+    return portStats[port < COMMAND_PORT_COUNT ? port : 0];
+}
+
+uint32_t getCommandConfirmedMs(COMMAND_SLOT slot) {
+    return slot < COMMAND_SLOT_COUNT ? slots[slot].confirmedMs : 0;
+}
+
+void forceCommandResend(COMMAND_SLOT slot) {
+    if (slot < COMMAND_SLOT_COUNT) slots[slot].resendRequests++;
+}
@@ -0,0 +1,121 @@
+#ifndef EVT_COMMANDBUS_H
+#define EVT_COMMANDBUS_H
+
+#include <Arduino.h>
+
+#define COMMAND_SLOT_BYTES         48    // Longest staged command; the ODrive "p" line is ~30.
+#define COMMAND_BUS_KEEPALIVE_MS   100   // Unchanged commands are resent this often. Well inside the VESC timeout.
+#define COMMAND_BUS_RATE_WINDOW_MS 1000  // Averaging window for the bytes/sec counters.
+
+/**
+ * @brief One setpoint per actuator, plus the ODrive feedback poll. Each tick's
+ *        command replaces the last one.
+ */
+enum COMMAND_SLOT {
+    COMMAND_SLOT_VESC1,
+    COMMAND_SLOT_VESC2,
+    COMMAND_SLOT_STEERING,
+    COMMAND_SLOT_ODRIVE_FEEDBACK,  ///< "f 0", written after the steering line.
+    COMMAND_SLOT_COUNT
+};
+
+/**
+ * @brief Where slots are written. The VESC slots start on the port of the same
+ *        name, the steering and feedback slots on COMMAND_PORT_ODRIVE.
+ */
+enum COMMAND_PORT {
+    COMMAND_PORT_VESC1,   ///< Serial1
+    COMMAND_PORT_VESC2,   ///< Serial5
+    COMMAND_PORT_ODRIVE,  ///< Serial6
+    COMMAND_PORT_CAN,     ///< EVT_CanBus, one frame per slot
+    COMMAND_PORT_COUNT
+};
+
+/**
+ * @brief Per-port traffic, for telemetry and for judging the bus.
+ *
+ * "Requested" is what the same commands would have cost written one by one
+ * as they were issued, so requested minus written is the saving.
+ */
+struct CommandPortStats {
+    uint32_t bytesWritten;
+    uint32_t bytesRequested;
+    uint32_t writes;              ///< write() calls (frames on the CAN port).
+    uint32_t commandsSent;
+    uint32_t commandsCoalesced;   ///< Replaced by a newer command before the flush.
+    uint32_t commandsSuppressed;  ///< Unchanged and not due for a keepalive.
+    uint32_t overflows;           ///< Commands longer than COMMAND_SLOT_BYTES, dropped.
+    float    bytesWrittenPerSec;
+    float    bytesRequestedPerSec;
+};
+
+typedef bool (*CommandFrameSend)(void* ctx, uint32_t id, uint8_t length, const uint8_t* data);
+
+/**
+ * @brief Sets the stream a serial port is written to. Until then its slots are dropped at flush.
+ */
+void bindCommandPort(COMMAND_PORT port, Print* out);
+
+/**
+ * @brief Sets how COMMAND_PORT_CAN frames are sent (canBusSend). ctx is passed as NULL.
+ */
+void bindCommandCanPort(CommandFrameSend send);
+
+/**
+ * @brief Moves a slot to another port, e.g. the VESCs to COMMAND_PORT_CAN.
+ */
+void routeCommandSlot(COMMAND_SLOT slot, COMMAND_PORT port);
+
+/**
+ * @brief Stages an encoded command, replacing anything staged in the slot since the last flush.
+ */
+void stageCommand(COMMAND_SLOT slot, const uint8_t* data, uint8_t length);
+
+/**
+ * @brief Starts a text command in the slot and returns a Print to write it into.
+ *
+ * Everything printed until the next stage or flush is one command.
+ */
+Print& beginCommand(COMMAND_SLOT slot);
+
+/**
+ * @brief Drops the slot's staged command if it has not been flushed yet.
+ *
+ * @return True if there was one. For a request whose reply is waited for.
+ */
+bool cancelCommand(COMMAND_SLOT slot);
+
+/**
+ * @brief Stages a CAN frame. Same signature as VescCan::SendFunction; ctx is the COMMAND_SLOT.
+ *
+ * @return Always true, the frame is sent at the next flush.
+ */
+bool stageCanCommand(void* ctx, uint32_t id, uint8_t length, const uint8_t* data);
+
+/**
+ * @brief Writes every slot staged this tick, one write() per port.
+ *
+ * A slot whose bytes equal what was last sent is skipped unless
+ * COMMAND_BUS_KEEPALIVE_MS has passed. A slot nobody staged this tick sends
+ * nothing, so an actuator the loop stops commanding is not kept alive.
+ * Call once per loop, after the control code.
+ */
+void flushCommandBus();
+
+const CommandPortStats& getCommandPortStats(COMMAND_PORT port);
+
+/**
+ * @brief millis() of the last flush after which the device held the slot's
+ *        newest command, whether it was written or was unchanged. 0 before the first.
+ */
+uint32_t getCommandConfirmedMs(COMMAND_SLOT slot);
+
+/**
+ * @brief Makes the next staged command in the slot go out even if unchanged.
+ *
+ * For code that wrote to the device behind the bus's back, and for a query
+ * that must go out every time it is staged. Interrupt safe.
+ */
+void forceCommandResend(COMMAND_SLOT slot);
+
+#endif // EVT_COMMANDBUS_H
@@ -0,0 +1,147 @@
+#ifndef DRIVETRAIN_H
+#define DRIVETRAIN_H
+
+// Electronic differential and traction control for the two rear VESCs.
+
+#include <math.h>
+
+/**
+ * @brief Vehicle geometry and traction-control tuning.
+ */
+struct DrivetrainConfig {
+    float trackWidth;      ///< m, between the driven wheels
+    float wheelBase;       ///< m
+    float steerRadPerTurn; ///< Road-wheel angle per ODrive turn from centre; positive turns steer right.
+    float slipThreshold;   ///< Fractional overspeed vs the other wheel that counts as slip.
+    float slipRpmFloor;    ///< rpm, below this the slip ratio uses the floor to avoid noise at standstill.
+    float currentRatio;    ///< A wheel drawing less than this fraction of the other's current is unloaded.
+    float currentFloor;    ///< A, the other wheel must draw at least this before the current check applies.
+    float cutRate;         ///< Per second, how fast a slipping wheel's scale drops.
+    float recoverRate;     ///< Per second, how fast it comes back once gripping.
+    float minScale;        ///< Never cut a wheel below this fraction of its command.
+    float redistributeGain;///< Fraction of the cut handed to the other wheel.
+    float maxBoost;        ///< Cap on the other wheel's scale.
+};
+
+/**
+ * @brief Values for the vehicle. Geometry is measured; the traction-control
+ *        numbers come from tools/drivetrain_sim.cpp and want confirming on track.
+ *        Rpm fields are in the units sent to setRPM (ERPM).
+ */
+constexpr DrivetrainConfig DRIVETRAIN_CONFIG = {
+    1.00f,    // trackWidth, m
+    1.05f,    // wheelBase, m
+    0.262f,   // steerRadPerTurn, ~25 deg at the 1.665 turn full lock
+    0.15f,    // slipThreshold
+    300.0f,   // slipRpmFloor, ERPM
+    0.4f,     // currentRatio
+    10.0f,    // currentFloor, A
+    3.0f,     // cutRate, 1/s
+    0.5f,     // recoverRate, 1/s
+    0.3f,     // minScale
+    0.5f,     // redistributeGain
+    1.15f     // maxBoost
+};
+
+enum WHEEL {
+    WHEEL_LEFT,
+    WHEEL_RIGHT,
+    WHEEL_COUNT
+};
+
+/**
+ * @brief Splits one drive command into left/right commands.
+ *
+ * The differential scales each wheel by its turning radius, r / R = 1 -+ T / 2R
+ * with R = L / tan(angle). Traction control compares the wheels after removing
+ * that geometric ratio: a wheel faster than the other by more than
+ * slipThreshold, or one drawing much less current while both are driven, is
+ * taken as spinning. Its command is cut at cutRate and part of the cut is
+ * handed to the gripping wheel. The command may be rpm or current; only ratios are applied.
+ */
+class Drivetrain {
+public:
+    explicit Drivetrain(const DrivetrainConfig& config) : cfg_(config) { reset(); }
+
+    void reset() {
+        for (int w = 0; w < WHEEL_COUNT; w++) {
+            scale_[w] = 1.0f;
+            slip_[w] = 0.0f;
+            slipping_[w] = false;
+        }
+    }
+
+    void setTractionControl(bool enabled) { tcEnabled_ = enabled; }
+
+    /**
+     * @brief Runs one tick.
+     *
+     * @param command     Drive command for the vehicle centreline (rpm or A).
+     * @param steerTurns  Steering position relative to centre, ODrive turns.
+     * @param rpm         Measured rpm per wheel.
+     * @param current     Measured motor current per wheel.
+     * @param out         Command per wheel.
+     */
+    void update(float command, float steerTurns, const float rpm[WHEEL_COUNT],
+                const float current[WHEEL_COUNT], float dt, float out[WHEEL_COUNT]) {
+        float angle = steerTurns * cfg_.steerRadPerTurn;
+        float halfTrackOverR = fabsf(angle) < 1e-3f ? 0.0f
+                               : 0.5f * cfg_.trackWidth * tanf(angle) / cfg_.wheelBase;
+        // Steering right: right wheel is inside.
+        diff_[WHEEL_LEFT] = 1.0f + halfTrackOverR;
+        diff_[WHEEL_RIGHT] = 1.0f - halfTrackOverR;
+
+        if (tcEnabled_) {
+            detectSlip(command, rpm, current);
+            for (int w = 0; w < WHEEL_COUNT; w++) {
+                float rate = slipping_[w] ? -cfg_.cutRate : cfg_.recoverRate;
+                scale_[w] = clamp(scale_[w] + rate * dt, cfg_.minScale, 1.0f);
+            }
+        } else {
+            reset();
+        }
+
+        for (int w = 0; w < WHEEL_COUNT; w++) {
+            int other = 1 - w;
+            float boost = cfg_.redistributeGain * (1.0f - scale_[other]);
+            float s = scale_[w] < 1.0f ? scale_[w] : clamp(1.0f + boost, 1.0f, cfg_.maxBoost);
+            out[w] = command * diff_[w] * s;
+        }
+    }
+
+    float slip(WHEEL w) const { return slip_[w]; }
+    float scale(WHEEL w) const { return scale_[w]; }
+    float diffRatio(WHEEL w) const { return diff_[w]; }
+    bool slipping(WHEEL w) const { return slipping_[w]; }
+
+private:
+    void detectSlip(float command, const float rpm[WHEEL_COUNT], const float current[WHEEL_COUNT]) {
+        // Ground speed each wheel implies once the differential ratio is taken out.
+        float implied[WHEEL_COUNT];
+        for (int w = 0; w < WHEEL_COUNT; w++) {
+            implied[w] = diff_[w] > 0.05f ? fabsf(rpm[w]) / diff_[w] : fabsf(rpm[w]);
+        }
+        float reference = fmaxf(fminf(implied[WHEEL_LEFT], implied[WHEEL_RIGHT]), cfg_.slipRpmFloor);
+        bool driving = fabsf(command) > 0.0f;
+
+        for (int w = 0; w < WHEEL_COUNT; w++) {
+            int other = 1 - w;
+            slip_[w] = (implied[w] - reference) / reference;
+            bool overspeed = slip_[w] > cfg_.slipThreshold;
+            bool unloaded = fabsf(current[other]) > cfg_.currentFloor &&
+                            fabsf(current[w]) < cfg_.currentRatio * fabsf(current[other]);
+            slipping_[w] = driving && (overspeed || unloaded);
+        }
+    }
+
+    static float clamp(float v, float lo, float hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+    DrivetrainConfig cfg_;
+    bool tcEnabled_ = true;
+    float diff_[WHEEL_COUNT] = {1.0f, 1.0f};
+    float scale_[WHEEL_COUNT];
+    float slip_[WHEEL_COUNT];
+    bool slipping_[WHEEL_COUNT];
+};
+
+#endif // DRIVETRAIN_H
@@ -0,0 +1,58 @@
+#include "EVT_Drivetrain.h"
+#include "EVT_VescDriver.h"
+#include "EVT_SteerTrajectory.h"
+#include "EVT_CalibStore.h"
+
+static Drivetrain drivetrain(DRIVETRAIN_CONFIG);
+static const uint8_t wheelVescIndex[WHEEL_COUNT] = { DRIVETRAIN_LEFT_VESC, DRIVETRAIN_RIGHT_VESC };
+static VescUart* const wheelVesc[WHEEL_COUNT] = {
+    DRIVETRAIN_LEFT_VESC == 0 ? &vesc1 : &vesc2,
+    DRIVETRAIN_RIGHT_VESC == 0 ? &vesc1 : &vesc2
+};
+static float wheelCommand[WHEEL_COUNT] = {0.0f, 0.0f};
+static uint32_t lastUpdateUs = 0;
+
+void updateDrivetrain(const ThrottleCommand& command) {
+    uint32_t now = micros();
+    // Cap dt so a long stall (e.g. in IDLE) does not cut or restore a wheel in one step.
+    float dt = lastUpdateUs == 0 ? 0.0f : fminf((now - lastUpdateUs) * 1e-6f, 0.1f);
+    lastUpdateUs = now;
+
+    float rpm[WHEEL_COUNT], current[WHEEL_COUNT];
+    for (uint8_t w = 0; w < WHEEL_COUNT; w++) {
+        rpm[w] = wheelVesc[w]->data.rpm;
+        current[w] = wheelVesc[w]->data.avgMotorCurrent;
+    }
+    float steerTurns = getSteeringSetpoint().pos - calibRecord.steeringZero;
+
+    if (command.type == THROTTLE_OUT_BRAKE) {
+        // Braking is shared evenly; the traction scales recover meanwhile.
+        drivetrain.update(0.0f, steerTurns, rpm, current, dt, wheelCommand);
+        for (uint8_t w = 0; w < WHEEL_COUNT; w++) {
+            wheelCommand[w] = command.value;
+            vescSetBrakeCurrent(wheelVescIndex[w], command.value);
+        }
+        return;
+    }
+
+    drivetrain.update(command.value, steerTurns, rpm, current, dt, wheelCommand);
+    for (uint8_t w = 0; w < WHEEL_COUNT; w++) {
+        if (command.type == THROTTLE_OUT_CURRENT) {
+            vescSetCurrent(wheelVescIndex[w], wheelCommand[w]);
+        } else {
+            vescSetRpm(wheelVescIndex[w], wheelCommand[w]);
+        }
+    }
+}
+
+void setTractionControl(bool enabled) {
+    drivetrain.setTractionControl(enabled);
+}
+
+float getWheelCommand(WHEEL wheel) {
+    return wheelCommand[wheel];
+}
+
+const Drivetrain& getDrivetrain() {
+    return drivetrain;
+}
@@ -0,0 +1,37 @@
+#ifndef EVT_DRIVETRAIN_H
+#define EVT_DRIVETRAIN_H
+
+#include <Arduino.h>
+#include "Drivetrain.h"
+#include "ThrottlePipeline.h"
+
+// Which VESC drives which rear wheel.
+#define DRIVETRAIN_LEFT_VESC  0   // vesc1, Serial1
+#define DRIVETRAIN_RIGHT_VESC 1   // vesc2, Serial5
+
+/**
+ * @brief Splits a throttle command across both VESCs through the electronic
+ *        differential and traction control, then sends it.
+ *
+ * RPM and current commands go through the split; brake current is applied to
+ * both wheels equally. Uses the telemetry serviceVescTelemetry() keeps fresh
+ * and the current steering setpoint, so it never waits on a UART.
+ */
+void updateDrivetrain(const ThrottleCommand& command);
+
+/**
+ * @brief Enables or bypasses traction control (the differential always applies).
+ */
+void setTractionControl(bool enabled);
+
+/**
+ * @brief Value sent to each wheel on the last update (RPM, A or brake A), indexed by WHEEL.
+ */
+float getWheelCommand(WHEEL wheel);
+
+/**
+ * @brief The drivetrain state, for telemetry and the black box.
+ */
+const Drivetrain& getDrivetrain();
+
+#endif // EVT_DRIVETRAIN_H
@@ -0,0 +1,113 @@
+#include "EVT_ErrorCodes.h"
+#include <stddef.h>
+
+// Every name gets its own fixed-size field in one PROGMEM struct, so the
+// strings stay in flash with the tables instead of being copied into RAM.
+struct OdriveErrorNames {
+#define X(code, text) char code##_name[sizeof(text)];
+    ODRIVE_ERROR_LIST(X)
+#undef X
+};
+
+PROGMEM static const OdriveErrorNames odriveErrorNames = {
+#define X(code, text) text,
+    ODRIVE_ERROR_LIST(X)
+#undef X
+};
+
+struct VescFaultNames {
+#define X(code, text) char code##_name[sizeof(text)];
+    VESC_FAULT_LIST(X)
+#undef X
+};
+
+PROGMEM static const VescFaultNames vescFaultNames = {
+#define X(code, text) text,
+    VESC_FAULT_LIST(X)
+#undef X
+};
+
+// ODrive errors are single bits, so the bit position is a perfect hash:
+// one offset per bit, 0xFFFF where the firmware defines nothing.
+static const uint16_t NO_NAME = 0xFFFF;
+
+struct OdriveBitTable {
+    uint16_t offset[32];
+};
+
+static constexpr uint8_t bitPosition(uint32_t bit) {
+    return bit <= 1 ? 0 : 1 + bitPosition(bit >> 1);
+}
+
+static constexpr OdriveBitTable makeOdriveBitTable() {
+    OdriveBitTable t = {};
+    for (uint8_t i = 0; i < 32; i++) t.offset[i] = NO_NAME;
+#define X(code, text) t.offset[bitPosition(code)] = offsetof(OdriveErrorNames, code##_name);
+    ODRIVE_ERROR_LIST(X)
+#undef X
+    return t;
+}
+
+PROGMEM static constexpr OdriveBitTable odriveBitTable = makeOdriveBitTable();
+
+// The VESC list must be dense and in enum order for direct indexing.
+static const uint16_t vescFaultOffsets[] PROGMEM = {
+#define X(code, text) offsetof(VescFaultNames, code##_name),
+    VESC_FAULT_LIST(X)
+#undef X
+};
+
+static constexpr uint8_t vescFaultOrder[] = {
+#define X(code, text) (uint8_t)code,
+    VESC_FAULT_LIST(X)
+#undef X
+};
+static constexpr size_t VESC_FAULT_COUNT = sizeof(vescFaultOrder);
+
+static constexpr bool vescFaultsInOrder(size_t i = 0) {
+    return i == VESC_FAULT_COUNT || (vescFaultOrder[i] == i && vescFaultsInOrder(i + 1));
+}
+static_assert(vescFaultsInOrder(), "VESC_FAULT_LIST must follow mc_fault_code order");
+
+const char* odriveErrorBitName(uint32_t bit) {
+    if (bit == 0 || (bit & (bit - 1)) != 0) return nullptr;
+    uint16_t offset = odriveBitTable.offset[__builtin_ctz(bit)];
+    if (offset == NO_NAME) return nullptr;
+    return (const char*)&odriveErrorNames + offset;
+}
+
+uint32_t nextOdriveErrorBit(uint32_t &remaining) {
+    uint32_t bit = remaining & (~remaining + 1);  // Lowest set bit.
+    remaining &= ~bit;
+    return bit;
+}
+
+size_t odriveErrorToString(uint32_t err, char* buf, size_t len) {
+    if (len == 0) return 0;
+    if (err == ODRIVE_ERROR_NONE) {
+        snprintf(buf, len, "None");
+        return strlen(buf);
+    }
+
+    size_t used = 0;
+    buf[0] = '\0';
+    uint32_t remaining = err;
+    while (remaining && used < len - 1) {
+        uint32_t bit = nextOdriveErrorBit(remaining);
+        const char* name = odriveErrorBitName(bit);
+        int n;
+        if (name) {
+            n = snprintf(buf + used, len - used, "%s%s", used ? ", " : "", name);
+        } else {
+            n = snprintf(buf + used, len - used, "%sUnknown(0x%08lx)", used ? ", " : "", (unsigned long)bit);
+        }
+        if (n < 0) break;
+        used += (size_t)n < len - used ? (size_t)n : len - used - 1;
+    }
+    return used;
+}
+
+const char* vescFaultToString(uint32_t code) {
+    if (code >= VESC_FAULT_COUNT) return "Unknown";
+    return (const char*)&vescFaultNames + vescFaultOffsets[code];
+}
@@ -0,0 +1,99 @@
+#ifndef EVT_ERRORCODES_H
+#define EVT_ERRORCODES_H
+
+#include <Arduino.h>
+#include <ODriveUART.h>  // Pulls in the ODriveEnums.h that matches the UART driver.
+#include <VescUart.h>
+
+// Single registry of ODrive axis error bits and VESC fault codes, shared by
+// the fault checks, the event log decoder and telemetry. Tables are generated
+// from the lists below and live in flash; nothing is built at startup.
+
+#define ODRIVE_ERROR_LIST(X) \
+    X(ODRIVE_ERROR_INITIALIZING,             "Initializing") \
+    X(ODRIVE_ERROR_SYSTEM_LEVEL,             "System Level") \
+    X(ODRIVE_ERROR_TIMING_ERROR,             "Timing Error") \
+    X(ODRIVE_ERROR_MISSING_ESTIMATE,         "Missing Estimate") \
+    X(ODRIVE_ERROR_BAD_CONFIG,               "Bad Config") \
+    X(ODRIVE_ERROR_DRV_FAULT,                "DRV Fault") \
+    X(ODRIVE_ERROR_MISSING_INPUT,            "Missing Input") \
+    X(ODRIVE_ERROR_DC_BUS_OVER_VOLTAGE,      "DC Bus Over Voltage") \
+    X(ODRIVE_ERROR_DC_BUS_UNDER_VOLTAGE,     "DC Bus Under Voltage") \
+    X(ODRIVE_ERROR_DC_BUS_OVER_CURRENT,      "DC Bus Over Current") \
+    X(ODRIVE_ERROR_DC_BUS_OVER_REGEN_CURRENT, "DC Bus Over Regen Current") \
+    X(ODRIVE_ERROR_CURRENT_LIMIT_VIOLATION,  "Current Limit Violation") \
+    X(ODRIVE_ERROR_MOTOR_OVER_TEMP,          "Motor Over Temp") \
+    X(ODRIVE_ERROR_INVERTER_OVER_TEMP,       "Inverter Over Temp") \
+    X(ODRIVE_ERROR_VELOCITY_LIMIT_VIOLATION, "Velocity Limit Violation") \
+    X(ODRIVE_ERROR_POSITION_LIMIT_VIOLATION, "Position Limit Violation") \
+    X(ODRIVE_ERROR_WATCHDOG_TIMER_EXPIRED,   "Watchdog Timer Expired") \
+    X(ODRIVE_ERROR_ESTOP_REQUESTED,          "Estop Requested") \
+    X(ODRIVE_ERROR_SPINOUT_DETECTED,         "Spinout Detected") \
+    X(ODRIVE_ERROR_BRAKE_RESISTOR_DISARMED,  "Brake Resistor Disarmed") \
+    X(ODRIVE_ERROR_THERMISTOR_DISCONNECTED,  "Thermistor Disconnected") \
+    X(ODRIVE_ERROR_CALIBRATION_ERROR,        "Calibration Error")
+
+// Must stay in mc_fault_code order, the table is indexed by the code itself.
+#define VESC_FAULT_LIST(X) \
+    X(FAULT_CODE_NONE,                              "None") \
+    X(FAULT_CODE_OVER_VOLTAGE,                      "Overvoltage") \
+    X(FAULT_CODE_UNDER_VOLTAGE,                     "Undervoltage") \
+    X(FAULT_CODE_DRV,                               "DRV Fault") \
+    X(FAULT_CODE_ABS_OVER_CURRENT,                  "Absolute Overcurrent") \
+    X(FAULT_CODE_OVER_TEMP_FET,                     "Overtemperature FET") \
+    X(FAULT_CODE_OVER_TEMP_MOTOR,                   "Overtemperature Motor") \
+    X(FAULT_CODE_GATE_DRIVER_OVER_VOLTAGE,          "Gate Driver Overvoltage") \
+    X(FAULT_CODE_GATE_DRIVER_UNDER_VOLTAGE,         "Gate Driver Undervoltage") \
+    X(FAULT_CODE_MCU_UNDER_VOLTAGE,                 "MCU Undervoltage") \
+    X(FAULT_CODE_BOOTING_FROM_WATCHDOG_RESET,       "Booting from Watchdog Reset") \
+    X(FAULT_CODE_ENCODER_SPI,                       "Encoder SPI Fault") \
+    X(FAULT_CODE_ENCODER_SINCOS_BELOW_MIN_AMPLITUDE, "Encoder SinCos Below Min Amplitude") \
+    X(FAULT_CODE_ENCODER_SINCOS_ABOVE_MAX_AMPLITUDE, "Encoder SinCos Above Max Amplitude") \
+    X(FAULT_CODE_FLASH_CORRUPTION,                  "Flash Corruption") \
+    X(FAULT_CODE_HIGH_OFFSET_CURRENT_SENSOR_1,      "High Offset Current Sensor 1") \
+    X(FAULT_CODE_HIGH_OFFSET_CURRENT_SENSOR_2,      "High Offset Current Sensor 2") \
+    X(FAULT_CODE_HIGH_OFFSET_CURRENT_SENSOR_3,      "High Offset Current Sensor 3") \
+    X(FAULT_CODE_UNBALANCED_CURRENTS,               "Unbalanced Currents") \
+    X(FAULT_CODE_BRK,                               "Brake Fault") \
+    X(FAULT_CODE_RESOLVER_LOT,                      "Resolver Loss of Tracking") \
+    X(FAULT_CODE_RESOLVER_DOS,                      "Resolver Degradation of Signal") \
+    X(FAULT_CODE_RESOLVER_LOS,                      "Resolver Loss of Signal") \
+    X(FAULT_CODE_FLASH_CORRUPTION_APP_CFG,          "Flash Corruption App Config") \
+    X(FAULT_CODE_FLASH_CORRUPTION_MC_CFG,           "Flash Corruption MC Config") \
+    X(FAULT_CODE_ENCODER_NO_MAGNET,                 "Encoder No Magnet") \
+    X(FAULT_CODE_ENCODER_MAGNET_TOO_STRONG,         "Encoder Magnet Too Strong") \
+    X(FAULT_CODE_PHASE_FILTER,                      "Phase Filter Fault")
+
+/**
+ * @brief Name of a single ODrive error bit, or nullptr if the bit is not known.
+ */
+const char* odriveErrorBitName(uint32_t bit);
+
+/**
+ * @brief Pops the lowest set bit out of an ODrive error mask.
+ *
+ * Lets callers walk a mask without building any strings:
+ * @code
+ * uint32_t remaining = err;
+ * while (remaining) { uint32_t bit = nextOdriveErrorBit(remaining); ... odriveErrorBitName(bit) ... }
+ * @endcode
+ *
+ * @return The bit that was removed, or 0 if the mask was already empty.
+ */
+uint32_t nextOdriveErrorBit(uint32_t &remaining);
+
+/**
+ * @brief Writes a comma separated description of an ODrive error mask into buf.
+ *
+ * Always NUL terminates, truncating if needed. Unknown bits are printed in hex.
+ *
+ * @return Number of characters written, excluding the terminator.
+ */
+size_t odriveErrorToString(uint32_t err, char* buf, size_t len);
+
+/**
+ * @brief Name of a VESC mc_fault_code, "Unknown" for codes outside the table.
+ */
+const char* vescFaultToString(uint32_t code);
+
+#endif // EVT_ERRORCODES_H
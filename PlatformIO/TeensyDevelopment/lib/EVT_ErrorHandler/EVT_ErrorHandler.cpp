@@ -1,10 +1,70 @@
-#include "EVT_Errorhandler.h"
+#include "EVT_ErrorHandler.h"
 #include "EVT_VescDriver.h"
 #include "EVT_ODriver.h"
+
+// Soft limit on declared check cost per loop, in microseconds.
+static const uint32_t HEALTH_LOOP_BUDGET_US = 3000;
+
+// Ordered by severity so the scan below is also the priority order.
+static HealthCheck healthChecks[] = {
+    // name        run              period  cost   severity
+    { "vesc",     vescErrorCheck,     50,   500,   HEALTH_CRITICAL },  // Reuses control telemetry when fresh.
+    { "odrive",   odrvErrorCheck,    100,  2000,   HEALTH_CRITICAL },  // One ASCII round trip.
+    { "ethernet", checkConnection,   500,    50,   HEALTH_LOW      },
+};
+static const uint8_t HEALTH_CHECK_COUNT = sizeof(healthChecks) / sizeof(healthChecks[0]);
+
+static_assert(HEALTH_CHECK_COUNT <= TELEMETRY_HEALTH_CHECKS, "More health checks than TelemetryHealth has room for");
+
+// Checking skipped versus running every check every loop, estimated from each
+// check's last measured cost on the loops where it did not run. 64 bits: it
+// grows by a few ms per loop, which would wrap 32 bits in about half an hour.
+static uint64_t healthTimeSavedUs = 0;
+static uint64_t healthTimeSampledUs = 0;
+
+static void sampleHealthTopic(void* payload) {
+    TelemetryHealth &t = *(TelemetryHealth*)payload;
+    memset(&t, 0, sizeof(t));
+    t.timeSavedUs = (uint32_t)(healthTimeSavedUs - healthTimeSampledUs);
+    healthTimeSampledUs = healthTimeSavedUs;
+    t.checks = HEALTH_CHECK_COUNT;
+    for (uint8_t i = 0; i < HEALTH_CHECK_COUNT; i++) {
+        t.check[i].lastCostUs = healthChecks[i].lastCostUs;
+        t.check[i].maxCostUs = healthChecks[i].maxCostUs;
+        t.check[i].runs = healthChecks[i].runs;
+        t.check[i].deferred = healthChecks[i].deferred;
+    }
+}
+
+void setupHealthMonitor() {
+    addTelemetryTopic(TELEMETRY_TOPIC_HEALTH, HEALTH_TOPIC_HZ, sampleHealthTopic, sizeof(TelemetryHealth));
+}
+
 void CheckForErrors() {
-    checkConnection(); // Check Ethernet connection status.
-    // Check for ODrive errors.
-    odrvErrorCheck();
-    // Check for VESC errors.
-    vescErrorCheck();
-}
\ No newline at end of file
+    uint32_t now = millis();
+    uint32_t budgetUsed = 0;
+
+    for (uint8_t i = 0; i < HEALTH_CHECK_COUNT; i++) {
+        HealthCheck &check = healthChecks[i];
+
+        if (check.runs > 0 && now - check.lastRunMs < check.periodMs) {
+            healthTimeSavedUs += check.lastCostUs;
+            continue;
+        }
+        if (check.severity != HEALTH_CRITICAL && budgetUsed + check.declaredCostUs > HEALTH_LOOP_BUDGET_US) {
+            check.deferred++;
+            healthTimeSavedUs += check.lastCostUs;
+            continue;
+        }
+
+        uint32_t start = micros();
+        check.run();
+        uint32_t cost = micros() - start;
+
+        check.lastRunMs = now;
+        check.lastCostUs = cost;
+        if (cost > check.maxCostUs) check.maxCostUs = cost;
+        check.runs++;
+        budgetUsed += check.declaredCostUs;
+    }
+}
@@ -1,10 +1,54 @@
+#ifndef EVT_ERRORHANDLER_H
+#define EVT_ERRORHANDLER_H
+
 #include "EVT_VescDriver.h"
 #include "EVT_ODriver.h"
 #include "EVT_Ethernet.h"
 #include <Arduino.h>
-#include <ODriveUART.h>
-#include <SoftwareSerial.h>
-#include <map> // Include for std::map
 
+#define HEALTH_TOPIC_HZ 2   // Health topic on the UDP telemetry publisher.
+
+/**
+ * @brief How important a health check is. Higher severity runs first.
+ */
+enum HEALTH_SEVERITY {
+    HEALTH_LOW,        ///< Informational, only runs when the loop budget allows.
+    HEALTH_HIGH,       ///< Runs when due unless the loop budget is already spent.
+    HEALTH_CRITICAL    ///< Always runs when due.
+};
+
+/**
+ * @brief One entry of the health monitor table.
+ *
+ * The first five fields are the declaration, the rest is filled in at runtime
+ * and published on the health telemetry topic (TelemetryHealth).
+ */
+struct HealthCheck {
+    const char*     name;
+    void          (*run)();
+    uint32_t        periodMs;        ///< Minimum time between two runs.
+    uint32_t        declaredCostUs;  ///< Expected cost, used for the per-loop budget.
+    HEALTH_SEVERITY severity;
 
+    uint32_t lastRunMs;
+    uint32_t lastCostUs;             ///< Measured cost of the most recent run.
+    uint32_t maxCostUs;
+    uint32_t runs;
+    uint32_t deferred;               ///< Times it was due but the budget was spent.
+};
+
+/**
+ * @brief Registers the health telemetry topic: per-check cost and counters,
+ *        and the checking time skipped since the previous sample.
+ */
+void setupHealthMonitor();
+
+/**
+ * @brief Runs the health checks that are due this loop.
+ *
+ * Checks are visited in severity order. Critical ones always run when due, the
+ * others only while the sum of declared costs stays under the loop budget.
+ */
 void CheckForErrors();
+
+#endif // EVT_ERRORHANDLER_H
@@ -0,0 +1,256 @@
+#ifndef CLOCKSYNC_H
+#define CLOCKSYNC_H
+
+// NTP-style clock sync with the Pi over the command socket. The Pi's
+// monotonic clock in microseconds is the shared timebase: it stamps commands
+// with it, the Teensy estimates its offset and drift from request/reply
+// exchanges and stamps telemetry with it.
+//
+// Messages are text like the command datagram. They start with a letter, which
+// keeps them out of the control packet path (isTaggedDatagram()):
+//   Teensy -> Pi  "SYNC,<seq>,<t1>"              t1 Teensy send time
+//   Pi -> Teensy  "SYNCR,<seq>,<t1>,<t2>,<t3>"   t1 echoed; t2 Pi receive, t3 Pi send time
+//   Teensy -> Pi  "LAT,<rtt p50>,<rtt p99>,<rtt max>,<oneway p50>,<oneway p99>,<oneway max>,<offset>,<drift ppb>,<shared time>"
+// All times and latencies in microseconds.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define CLOCK_SYNC_FAST_MS     100     // Request period until CLOCK_SYNC_FILTER exchanges have been tried.
+#define CLOCK_SYNC_PERIOD_MS   1000    // Request period after that.
+#define CLOCK_SYNC_REPORT_MS   1000    // LAT message period.
+#define CLOCK_SYNC_FILTER      8       // Exchanges the minimum-RTT filter picks from.
+#define CLOCK_SYNC_MAX_RTT_US  50000   // Slower exchanges are not used.
+#define CLOCK_SYNC_STEP_US     20000   // Offset error that restarts the estimate (Pi rebooted, clock stepped).
+#define CLOCK_SYNC_MAX_PPM     500     // Drift estimate clamp; crystals are well inside this.
+#define CLOCK_SYNC_TAU_S       8       // Loop time constant; longer is smoother but slower to track.
+#define LATENCY_WINDOW         64      // Samples the latency percentiles are taken over.
+
+/**
+ * @brief Widens a wrapping 32-bit micros() to 64 bits. Call at least once per
+ *        wrap (71 minutes).
+ */
+class MonotonicUs {
+public:
+    uint64_t extend(uint32_t nowUs) {
+        if (nowUs < last_) high_ += 1ULL << 32;
+        last_ = nowUs;
+        return high_ | nowUs;
+    }
+
+private:
+    uint32_t last_ = 0;
+    uint64_t high_ = 0;
+};
+
+/**
+ * @brief The last LATENCY_WINDOW samples of one latency, for percentiles.
+ */
+class LatencyWindow {
+public:
+    void add(int64_t us) {
+        if (us < 0) us = 0;
+        samples_[next_] = us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+        next_ = (next_ + 1) % LATENCY_WINDOW;
+        if (count_ < LATENCY_WINDOW) count_++;
+    }
+
+    int size() const { return count_; }
+
+    /** @return The p-th percentile (0..1) of the window, 0 when empty. */
+    uint32_t percentile(float p) const {
+        if (count_ == 0) return 0;
+        uint32_t sorted[LATENCY_WINDOW];
+        memcpy(sorted, samples_, count_ * sizeof(uint32_t));
+        int k = (int)(p * (count_ - 1) + 0.5f);
+        std::nth_element(sorted, sorted + k, sorted + count_);
+        return sorted[k];
+    }
+
+    uint32_t max() const {
+        return count_ ? *std::max_element(samples_, samples_ + count_) : 0;
+    }
+
+private:
+    uint32_t samples_[LATENCY_WINDOW];
+    int next_ = 0;
+    int count_ = 0;
+};
+
+struct LinkLatency {
+    uint32_t rttP50, rttP99, rttMax;           ///< Sync exchanges, Pi turnaround excluded.
+    uint32_t oneWayP50, oneWayP99, oneWayMax;  ///< Pi command stamp to the Teensy draining it.
+    int64_t  offsetUs;                         ///< Shared minus local time.
+    float    driftPpm;                         ///< Local clock rate against the Pi's, positive when it runs fast.
+    bool     synced;
+};
+
+class ClockSync {
+public:
+    /**
+     * @brief Formats a SYNC request when one is due.
+     * @return Its length, 0 if none is due.
+     */
+    int pollRequest(uint64_t localUs, char* out, size_t size) {
+        uint32_t periodMs = tried_ < CLOCK_SYNC_FILTER ? CLOCK_SYNC_FAST_MS : CLOCK_SYNC_PERIOD_MS;
+        if (requested_ && localUs - lastRequestUs_ < periodMs * 1000ULL) return 0;
+        requested_ = true;
+        lastRequestUs_ = localUs;
+        pendingSeq_ = ++seq_;
+        tried_++;
+        return snprintf(out, size, "SYNC,%lu,%llu", (unsigned long)pendingSeq_, (unsigned long long)localUs);
+    }
+
+    /**
+     * @brief Takes a SYNCR reply received at localUs.
+     * @return false if data is not a reply to the outstanding request.
+     */
+    bool handleReply(const char* data, uint16_t length, uint64_t localUs) {
+        if (length < 6 || strncmp(data, "SYNCR,", 6) != 0) return false;
+        char text[96];
+        if (length >= sizeof(text)) return false;
+        memcpy(text, data, length);
+        text[length] = '\0';
+
+        unsigned long seq;
+        unsigned long long t1, t2, t3;
+        if (sscanf(text, "SYNCR,%lu,%llu,%llu,%llu", &seq, &t1, &t2, &t3) != 4) return false;
+        if (seq != pendingSeq_ || pendingSeq_ == 0) return false;  // Late, duplicate or not ours.
+        pendingSeq_ = 0;
+
+        int64_t rtt = (int64_t)(localUs - t1) - (int64_t)(t3 - t2);
+        if (rtt < 0 || rtt > CLOCK_SYNC_MAX_RTT_US) return true;
+        rtt_.add(rtt);
+        int64_t offset = ((int64_t)(t2 - t1) + (int64_t)(t3 - localUs)) / 2;
+        addExchange(offset, (uint32_t)rtt, localUs);
+        return true;
+    }
+
+    /**
+     * @brief Records the one-way latency of a command stamped stampUs on the
+     *        shared clock and drained at localUs. Ignored until synced.
+     */
+    void noteCommand(uint64_t stampUs, uint64_t localUs) {
+        if (synced_ && stampUs != 0) oneWay_.add((int64_t)(toShared(localUs) - stampUs));
+    }
+
+    /**
+     * @brief Formats a LAT report when one is due.
+     * @return Its length, 0 if none is due.
+     */
+    int pollReport(uint64_t localUs, char* out, size_t size) {
+        if (reported_ && localUs - lastReportUs_ < CLOCK_SYNC_REPORT_MS * 1000ULL) return 0;
+        reported_ = true;
+        lastReportUs_ = localUs;
+        LinkLatency l = latency();
+        return snprintf(out, size, "LAT,%lu,%lu,%lu,%lu,%lu,%lu,%lld,%ld,%llu",
+                        (unsigned long)l.rttP50, (unsigned long)l.rttP99, (unsigned long)l.rttMax,
+                        (unsigned long)l.oneWayP50, (unsigned long)l.oneWayP99, (unsigned long)l.oneWayMax,
+                        (long long)l.offsetUs, (long)(l.driftPpm * 1000.0f),
+                        (unsigned long long)(synced_ ? toShared(localUs) : 0));
+    }
+
+    bool synced() const { return synced_; }
+
+    /** @brief Local time on the shared clock. Meaningless until synced(). */
+    uint64_t toShared(uint64_t localUs) const {
+        double elapsed = (double)(int64_t)(localUs - refUs_);
+        return localUs + offsetUs_ + (int64_t)(drift_ * elapsed);
+    }
+
+    LinkLatency latency() const {
+        LinkLatency l;
+        l.rttP50 = rtt_.percentile(0.5f);
+        l.rttP99 = rtt_.percentile(0.99f);
+        l.rttMax = rtt_.max();
+        l.oneWayP50 = oneWay_.percentile(0.5f);
+        l.oneWayP99 = oneWay_.percentile(0.99f);
+        l.oneWayMax = oneWay_.max();
+        l.offsetUs = offsetUs_;
+        l.driftPpm = (float)(-drift_ * 1e6);
+        l.synced = synced_;
+        return l;
+    }
+
+    uint32_t restarts() const { return restarts_; }
+
+private:
+    struct Exchange {
+        int64_t  offsetUs;
+        uint32_t rttUs;
+        uint64_t localUs;
+    };
+
+    // Queueing only ever adds delay, so of the last few exchanges the one with
+    // the shortest round trip has the truest offset. Each exchange is used at
+    // most once, and only if it is newer than the last one used.
+    void addExchange(int64_t offset, uint32_t rtt, uint64_t localUs) {
+        exchanges_[nextExchange_] = { offset, rtt, localUs };
+        nextExchange_ = (nextExchange_ + 1) % CLOCK_SYNC_FILTER;
+        if (exchangeCount_ < CLOCK_SYNC_FILTER) exchangeCount_++;
+
+        const Exchange* best = &exchanges_[0];
+        for (int i = 1; i < exchangeCount_; i++)
+            if (exchanges_[i].rttUs < best->rttUs) best = &exchanges_[i];
+        if (synced_ && best->localUs <= refUs_) return;
+
+        if (!synced_) {
+            offsetUs_ = best->offsetUs;
+            refUs_ = best->localUs;
+            drift_ = 0.0;
+            synced_ = true;
+            return;
+        }
+
+        // Second-order loop on the offset, with the drift as its rate. Gains
+        // scale with the time since the last update, so the 100 ms exchanges
+        // at startup cannot kick the drift around.
+        int64_t predicted = (int64_t)(toShared(best->localUs) - best->localUs);
+        int64_t error = best->offsetUs - predicted;
+        if (error > CLOCK_SYNC_STEP_US || error < -CLOCK_SYNC_STEP_US) {
+            restart();
+            addExchange(offset, rtt, localUs);
+            return;
+        }
+        double dt = (double)(best->localUs - refUs_);
+        double tau = CLOCK_SYNC_TAU_S * 1e6;
+        offsetUs_ = predicted + (int64_t)(std::min(1.0, dt / tau) * error);
+        drift_ += error * dt / (tau * tau);
+        drift_ = std::max(-CLOCK_SYNC_MAX_PPM * 1e-6, std::min(CLOCK_SYNC_MAX_PPM * 1e-6, drift_));
+        refUs_ = best->localUs;
+    }
+
+    void restart() {
+        synced_ = false;
+        exchangeCount_ = 0;
+        nextExchange_ = 0;
+        tried_ = 0;
+        restarts_++;
+    }
+
+    Exchange exchanges_[CLOCK_SYNC_FILTER];
+    int exchangeCount_ = 0;
+    int nextExchange_ = 0;
+
+    bool synced_ = false;
+    int64_t offsetUs_ = 0;   ///< At refUs_.
+    uint64_t refUs_ = 0;
+    double drift_ = 0.0;     ///< Shared clock seconds gained per local second.
+    uint32_t restarts_ = 0;
+
+    uint32_t seq_ = 0;
+    uint32_t pendingSeq_ = 0;
+    uint32_t tried_ = 0;
+    bool requested_ = false;
+    uint64_t lastRequestUs_ = 0;
+    bool reported_ = false;
+    uint64_t lastReportUs_ = 0;
+
+    LatencyWindow rtt_;
+    LatencyWindow oneWay_;
+};
+
+#endif // CLOCKSYNC_H
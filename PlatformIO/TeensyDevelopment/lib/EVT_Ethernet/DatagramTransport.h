@@ -0,0 +1,43 @@
+#ifndef DATAGRAMTRANSPORT_H
+#define DATAGRAMTRANSPORT_H
+
+// Datagram link between the Teensy and the Pi. NativeEthernetTransport is the
+// one on the car; PosixUdpTransport runs the same command/telemetry code on a
+// Linux host over loopback.
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Where the link listens and where it sends.
+ */
+struct DatagramConfig {
+    uint8_t  localIp[4];   ///< Only used by backends that own the interface (NativeEthernet).
+    uint16_t localPort;
+    uint8_t  peerIp[4];
+    uint16_t peerPort;
+};
+
+class DatagramTransport {
+public:
+    virtual ~DatagramTransport() {}
+
+    /**
+     * @brief Opens the link.
+     * @return false if the socket could not be opened or bound.
+     */
+    virtual bool begin(const DatagramConfig& config) = 0;
+
+    /**
+     * @brief Reads one pending datagram, truncated to size. Never blocks.
+     * @return Its length, or -1 if nothing is pending.
+     */
+    virtual int receive(char* buffer, size_t size) = 0;
+
+    /**
+     * @brief Sends one datagram to the configured peer.
+     */
+    virtual bool send(const uint8_t* data, size_t length) = 0;
+};
+
+#endif // DATAGRAMTRANSPORT_H
@@ -4,30 +4,71 @@
 #include <sstream>
 #include <vector>
 #include <cstdlib>
-#include "EVT_VescDriver.h"
 #include "EVT_StateMachine.h"
-#include "EVT_ODriver.h"
+#include "EVT_FaultManager.h"
+#include "EVT_Capture.h"
 #include "EVT_Ethernet.h"
+#include "NativeEthernetTransport.h"
+#include "ClockSync.h"
 
-// Global object definitions.
-EthernetUDP Udp;
-IPAddress ip(192, 168, 0, 177); // teensy ip defined here
-byte mac[] = { 0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED };
+static const uint8_t mac[6] = { ETHERNET_MAC };
+static const DatagramConfig linkConfig = {
+  { ETHERNET_LOCAL_IP }, ETHERNET_LOCAL_PORT,
+  { ETHERNET_PEER_IP }, ETHERNET_PEER_PORT
+};
+static NativeEthernetTransport nativeLink(mac);
 
 // Internal buffers for UDP packets.
-char autoBuffer[UDP_TX_PACKET_MAX_SIZE];
-static char telemetryPacketBuffer[UDP_TX_PACKET_MAX_SIZE];
+static UdpRxRing udpRxRing;
+static ControlPacket pendingControl;
+static bool     controlPending = false;
+static uint32_t pendingRxUs = 0;
+static uint32_t controlRxUs = 0;
+static bool     controlReceived = false;
+static uint32_t udpRxDiscarded = 0;
+static uint32_t udpRxRejected = 0;
 
+static MonotonicUs localClock;
+static ClockSync clockSync;
+static uint64_t drainLocalUs = 0;
 
-// Telemetry destination details.
-static IPAddress telemetryDestIP(192, 168, 0, 132); // pi ip defined here
-static const uint16_t TELEMETRY_DEST_PORT = 8888;
+static TelemetryPublisher publisher;
+
+static LinkMessageHandler linkHandlers[LINK_HANDLER_MAX];
+static uint8_t linkHandlerCount = 0;
+
+// Loop topic: serviceTelemetry() runs once per loop, so it times the loop too.
+static uint32_t lastTelemetryUs = 0;
+static uint32_t loopTicks = 0;
+static uint32_t loopPeriodSumUs = 0;
+static uint32_t loopPeriodMaxUs = 0;
+
+static void sampleLoopTopic(void* payload) {
+  TelemetryLoop &t = *(TelemetryLoop*)payload;
+  t.ticks = loopTicks;
+  t.periodAvgUs = loopTicks ? loopPeriodSumUs / loopTicks : 0;
+  t.periodMaxUs = loopPeriodMaxUs;
+  t.udpRxDiscarded = udpRxDiscarded;
+  t.telemetryDropped = publisher.stats().dropped;
+  loopTicks = loopPeriodSumUs = loopPeriodMaxUs = 0;
+}
+
+static void captureTelemetry(const uint8_t *data, uint16_t length) {
+  captureDatagram(CAPTURE_PORT_UDP, CAPTURE_TX, data, length);
+}
+
+DatagramTransport& telemetryLink() {
+  return nativeLink;
+}
 
 // Setup function for initializing Ethernet and UDP.
 void setupTelemetryUDP() {
   Serial.println("Initializing Telemetry UDP...");
-  Ethernet.begin(mac, ip);
-  Udp.begin(8888);
+  if (!nativeLink.begin(linkConfig)) {
+    Serial.println("No free socket for the UDP link.");
+  }
+  publisher.setBudget(TELEMETRY_BUDGET_BYTES_PER_S);
+  addTelemetryTopic(TELEMETRY_TOPIC_LOOP, TELEMETRY_TOPIC_LOOP_HZ, sampleLoopTopic, sizeof(TelemetryLoop));
   
   if (Ethernet.hardwareStatus() == EthernetNoHardware) {
     Serial.println("No Ethernet hardware found.");
@@ -43,58 +84,127 @@ void setupTelemetryUDP() {
   delay(1000);
 }
 
-// Function to send telemetry data over UDP and display on Serial.
-void sendTelemetry() {
-  // Retrieve current ODrive telemetry values.
-  // The velocity is obtained here but not used in the current telemetry packet.
-  float velocity = odrive.getVelocity();
-  
-  // Get current ODrive feedback.
-  ODriveFeedback fb = odrive.getFeedback();
-  float steeringAngle = fb.pos;
-  
-  // Get ODrive parameters.
-  float odrvCurrent = odrive.getParameterAsFloat("ibus");
-  float odrvVoltage = odrive.getParameterAsFloat("vbus_voltage");
-  
-  // Update VESC telemetry.
-  vesc1.getVescValues();
-  float rpm = vesc1.data.rpm;  // VESC2 will be identical so it doesn't matter.
-  float vescVoltage = vesc1.data.inpVoltage;  // VESCs are in parallel so voltage is the same.
-  float avgMotorCurrent = vesc1.data.avgInputCurrent + vesc2.data.avgInputCurrent;
-    
-  // Format telemetry packet.
-  snprintf(telemetryPacketBuffer, sizeof(telemetryPacketBuffer),
-           "%s,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f, %.2f",
-           StateToString(CurrentState), rpm, vescVoltage, odrvVoltage, avgMotorCurrent, odrvCurrent, steeringAngle, velocity);
-  
-  // Send telemetry packet over UDP.
-  Udp.beginPacket(telemetryDestIP, TELEMETRY_DEST_PORT);
-  Udp.write(telemetryPacketBuffer);
-  Udp.endPacket();
+bool addTelemetryTopic(TELEMETRY_TOPIC topic, uint16_t rateHz, TelemetrySampler sample, uint8_t length) {
+  return publisher.addTopic(topic, rateHz, sample, length);
+}
+
+void serviceTelemetry() {
+  uint32_t now = micros();
+  if (lastTelemetryUs != 0) {
+    uint32_t period = now - lastTelemetryUs;
+    loopTicks++;
+    loopPeriodSumUs += period;
+    if (period > loopPeriodMaxUs) loopPeriodMaxUs = period;
+  }
+  lastTelemetryUs = now;
+  publisher.service(now, getSharedTimeUs(), nativeLink, captureTelemetry);
+}
+
+bool addLinkHandler(LinkMessageHandler handler) {
+  if (linkHandlerCount >= LINK_HANDLER_MAX) return false;
+  linkHandlers[linkHandlerCount++] = handler;
+  return true;
+}
+
+TelemetryStats getTelemetryStats() {
+  return publisher.stats();
+}
+
+TelemetryTopicStats getTelemetryTopicStats(TELEMETRY_TOPIC topic) {
+  return publisher.topicStats(topic);
 }
 
 void checkConnection() {
   // Check if the Ethernet cable is connected.
   if (Ethernet.hardwareStatus() == EthernetNoHardware) {
-    Serial.println("No Ethernet hardware found.");
-    SetErrorState(ERR_ETHERNET, "Ethernet connection severed");
-  
+    // Only autonomous mode needs the link; there, limit throttle until it comes back.
+    reportFault(GetState() == AUTO ? FAULT_DEGRADED : FAULT_WARNING,
+                ERR_ETHERNET, "Ethernet connection severed");
   }
 }
-std::string receiveUdp() {
-  int packetSize = Udp.parsePacket();
-  if (packetSize > 0) {
-    int len = Udp.read(autoBuffer, sizeof(autoBuffer) - 1);
-    if (len > 0) {
-      autoBuffer[len] = '\0';
-    }
-    Serial.print("Received packet: ");
-    Serial.println(autoBuffer);
-    return std::string(autoBuffer);
+
+static void sendLinkMessage(const char *text, int length) {
+  if (length <= 0) return;
+  nativeLink.send((const uint8_t*)text, length);
+  captureDatagram(CAPTURE_PORT_UDP, CAPTURE_TX, (const uint8_t*)text, length);
+}
+
+static bool handleLinkMessage(const UdpDatagram &d) {
+  if (!d.truncated && clockSync.handleReply(d.data, d.length, drainLocalUs)) return true;
+  static char reply[TELEMETRY_DATAGRAM_MAX];
+  for (uint8_t i = 0; i < linkHandlerCount; i++) {
+    int length = linkHandlers[i](d.data, d.length, d.truncated, reply, sizeof(reply));
+    if (length < 0) continue;
+    if (length >= (int)sizeof(reply)) length = sizeof(reply) - 1;  // Truncated by snprintf.
+    sendLinkMessage(reply, length);
+    return true;
+  }
+  return false;
+}
+
+// Tagged messages are handled as they are read; the ring may overwrite them.
+static void onRxDatagram(const UdpDatagram &d) {
+  captureDatagram(CAPTURE_PORT_UDP, CAPTURE_RX, (const uint8_t*)d.data, d.length);
+  if (isTaggedDatagram(d.data, d.length) && !handleLinkMessage(d)) {
+    udpRxRejected++;  // Unknown tag, or a sync reply that came too late.
   }
-  // Return an empty string if no packet is received.
-  return std::string();
 }
 
+void serviceUdpLink() {
+  uint32_t nowUs = micros();
+  drainLocalUs = localClock.extend(nowUs);
+  if (controlPending) {
+    // Not picked up last tick (not in AUTO); never act on it later.
+    udpRxDiscarded++;
+    controlPending = false;
+  }
+
+  udpRxRing.clear();
+  uint32_t overwritten = udpRxRing.overwritten();
+  drainDatagrams(nativeLink, udpRxRing, nowUs, onRxDatagram);
+  udpRxDiscarded += udpRxRing.overwritten() - overwritten;
+
+  ControlRx rx;
+  bool found = newestControlPacket(udpRxRing, rx);
+  udpRxDiscarded += rx.superseded;
+  udpRxRejected += rx.rejected;
+  if (found) {
+    pendingControl = rx.packet;
+    pendingRxUs = rx.rxUs;
+    controlPending = true;
+    clockSync.noteCommand(rx.packet.stampUs, drainLocalUs);
+  }
+
+  char message[128];
+  sendLinkMessage(message, clockSync.pollRequest(drainLocalUs, message, sizeof(message)));
+  sendLinkMessage(message, clockSync.pollReport(drainLocalUs, message, sizeof(message)));
+}
 
+bool receiveControlPacket(ControlPacket &packet) {
+  if (!controlPending) return false;
+  packet = pendingControl;
+  controlRxUs = pendingRxUs;
+  controlReceived = true;
+  controlPending = false;
+  return true;
+}
+
+uint64_t getSharedTimeUs() {
+  return clockSync.synced() ? clockSync.toShared(localClock.extend(micros())) : 0;
+}
+
+LinkLatency getLinkLatency() {
+  return clockSync.latency();
+}
+
+uint32_t getControlPacketAgeMs() {
+  return controlReceived ? (micros() - controlRxUs) / 1000 : UINT32_MAX;
+}
+
+uint32_t getUdpRxDiscarded() {
+  return udpRxDiscarded;
+}
+
+uint32_t getUdpRxRejected() {
+  return udpRxRejected;
+}
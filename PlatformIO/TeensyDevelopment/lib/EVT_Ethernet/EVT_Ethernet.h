@@ -2,20 +2,104 @@
 #define EVT_TELEMETRY_H
 
 #include <Arduino.h>
-#include <NativeEthernet.h>
-#include <NativeEthernetUdp.h>
 #include <string>
+#include "ClockSync.h"
+#include "DatagramTransport.h"
+#include "TelemetryPublisher.h"
+#include "UdpRxRing.h"
 
-// Global Telemetry objects and variables.
-extern EthernetUDP Udp;
-extern IPAddress ip;
-extern byte mac[];
+// Car network. The Pi sends commands to ETHERNET_LOCAL_PORT and listens for
+// telemetry on ETHERNET_PEER_PORT.
+#define ETHERNET_MAC         0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED
+#define ETHERNET_LOCAL_IP    192, 168, 0, 177   // Teensy
+#define ETHERNET_LOCAL_PORT  8888
+#define ETHERNET_PEER_IP     192, 168, 0, 132   // Pi
+#define ETHERNET_PEER_PORT   8888
+
+#define TELEMETRY_BUDGET_BYTES_PER_S  100000   // ~0.8 Mbit/s of the 100 Mbit link; the Pi also streams sensors.
+#define TELEMETRY_TOPIC_LOOP_HZ       10
+#define LINK_HANDLER_MAX              4
+
+/**
+ * @brief Answers a tagged message (one starting with a letter) into reply.
+ *        A truncated message only holds its first UDP_RX_DATAGRAM_MAX bytes
+ *        and must be refused, not acted on.
+ * @return Reply length, 0 for no reply, -1 if the message is not for this handler.
+ */
+typedef int (*LinkMessageHandler)(const char *data, uint16_t length, bool truncated, char *reply, size_t size);
+
+/**
+ * @brief The link commands arrive on and telemetry leaves by (NativeEthernet).
+ */
+DatagramTransport& telemetryLink();
 
 // Telemetry function prototypes.
 void setupTelemetryUDP();
-void sendTelemetry();
 void checkConnection();
-std::string receiveUdp();
+
+/**
+ * @brief Registers a telemetry topic; modules call it from their setup.
+ *
+ * The sampler fills the topic's payload struct from TelemetryFormat.h at
+ * rateHz and must not block (read cached values, no bus round trips).
+ */
+bool addTelemetryTopic(TELEMETRY_TOPIC topic, uint16_t rateHz, TelemetrySampler sample, uint8_t length);
+
+/**
+ * @brief Samples the topics that are due and sends full or aged batches
+ *        within TELEMETRY_BUDGET_BYTES_PER_S. Call once per loop in every state.
+ */
+void serviceTelemetry();
+
+TelemetryStats getTelemetryStats();
+TelemetryTopicStats getTelemetryTopicStats(TELEMETRY_TOPIC topic);
+
+/**
+ * @brief Offers every tagged message clock sync does not take to handler,
+ *        from inside serviceUdpLink(); the reply goes back to the Pi at once.
+ *
+ * @return false when LINK_HANDLER_MAX handlers are already registered.
+ */
+bool addLinkHandler(LinkMessageHandler handler);
+
+/**
+ * @brief Drains every datagram waiting on the socket, answers clock sync and
+ *        keeps the newest control packet for receiveControlPacket(). Call once
+ *        per tick in every state, before the state machine.
+ *
+ * Older control packets from the same drain are discarded (their emergency
+ * flag is kept). Also sends the SYNC requests and LAT reports of ClockSync.h.
+ */
+void serviceUdpLink();
+
+/**
+ * @brief The newest control packet from this tick's serviceUdpLink().
+ *
+ * @return false if none arrived this tick. A packet that is not picked up
+ *         in the tick it arrived is discarded.
+ */
+bool receiveControlPacket(ControlPacket &packet);
+
+/**
+ * @brief Now on the Pi's clock (the shared timebase), in microseconds;
+ *        0 until the first clock sync exchange has completed.
+ */
+uint64_t getSharedTimeUs();
+
+/**
+ * @brief Round-trip and one-way latency percentiles over the last
+ *        LATENCY_WINDOW samples, plus the clock estimate.
+ */
+LinkLatency getLinkLatency();
+
+/**
+ * @brief ms since the control packet last returned by receiveControlPacket()
+ *        was drained from the socket; UINT32_MAX before the first one.
+ */
+uint32_t getControlPacketAgeMs();
+
+uint32_t getUdpRxDiscarded();  ///< Superseded by a newer packet in the same drain, or overwritten in the ring.
+uint32_t getUdpRxRejected();   ///< Did not parse, or a tagged message nobody handles.
 
 
 #endif // EVT_TELEMETRY_H
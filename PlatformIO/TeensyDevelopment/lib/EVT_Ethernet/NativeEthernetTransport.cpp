@@ -0,0 +1,27 @@
+#include "NativeEthernetTransport.h"
+
+NativeEthernetTransport::NativeEthernetTransport(const uint8_t mac[6]) {
+    memcpy(mac_, mac, sizeof(mac_));
+}
+
+bool NativeEthernetTransport::begin(const DatagramConfig& config) {
+    const uint8_t* local = config.localIp;
+    const uint8_t* peer = config.peerIp;
+    Ethernet.begin(mac_, IPAddress(local[0], local[1], local[2], local[3]));
+    peerIp_ = IPAddress(peer[0], peer[1], peer[2], peer[3]);
+    peerPort_ = config.peerPort;
+    return udp_.begin(config.localPort) != 0;
+}
+
+int NativeEthernetTransport::receive(char* buffer, size_t size) {
+    // parsePacket() drops whatever was left unread of the previous datagram.
+    if (udp_.parsePacket() <= 0) return -1;
+    int length = udp_.read(buffer, size);
+    return length > 0 ? length : 0;
+}
+
+bool NativeEthernetTransport::send(const uint8_t* data, size_t length) {
+    if (!udp_.beginPacket(peerIp_, peerPort_)) return false;
+    udp_.write(data, length);
+    return udp_.endPacket() != 0;
+}
@@ -0,0 +1,28 @@
+#ifndef NATIVEETHERNETTRANSPORT_H
+#define NATIVEETHERNETTRANSPORT_H
+
+#include <Arduino.h>
+#include <NativeEthernet.h>
+#include <NativeEthernetUdp.h>
+#include "DatagramTransport.h"
+
+/**
+ * @brief The Teensy 4.1 Ethernet port through NativeEthernet's EthernetUDP.
+ */
+class NativeEthernetTransport : public DatagramTransport {
+public:
+    explicit NativeEthernetTransport(const uint8_t mac[6]);
+
+    /** Also brings the interface up at config.localIp. */
+    bool begin(const DatagramConfig& config) override;
+    int receive(char* buffer, size_t size) override;
+    bool send(const uint8_t* data, size_t length) override;
+
+private:
+    uint8_t mac_[6];
+    EthernetUDP udp_;
+    IPAddress peerIp_;
+    uint16_t peerPort_ = 0;
+};
+
+#endif // NATIVEETHERNETTRANSPORT_H
@@ -0,0 +1,64 @@
+// Host only; PlatformIO builds every file in lib/, so the Teensy build skips it here.
+#ifndef ARDUINO
+
+#include "PosixUdpTransport.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+PosixUdpTransport::~PosixUdpTransport() {
+    close();
+}
+
+bool PosixUdpTransport::begin(const DatagramConfig& config) {
+    close();
+    fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd_ < 0) return false;
+
+    int reuse = 1;
+    setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (receiveBuffer_ > 0) setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &receiveBuffer_, sizeof(receiveBuffer_));
+
+    sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(config.localPort);
+    if (bind(fd_, (const sockaddr*)&local, sizeof(local)) != 0 ||
+        fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL, 0) | O_NONBLOCK) != 0) {
+        close();
+        return false;
+    }
+    memcpy(peerIp_, config.peerIp, sizeof(peerIp_));
+    peerPort_ = config.peerPort;
+    return true;
+}
+
+int PosixUdpTransport::receive(char* buffer, size_t size) {
+    if (fd_ < 0) return -1;
+    // MSG_TRUNC makes recv() report the full length; clamp to what was copied.
+    ssize_t length = recv(fd_, buffer, size, MSG_TRUNC);
+    if (length < 0) return -1;
+    return length > (ssize_t)size ? (int)size : (int)length;
+}
+
+bool PosixUdpTransport::send(const uint8_t* data, size_t length) {
+    if (fd_ < 0) return false;
+    sockaddr_in peer;
+    memset(&peer, 0, sizeof(peer));
+    peer.sin_family = AF_INET;
+    memcpy(&peer.sin_addr.s_addr, peerIp_, sizeof(peerIp_));
+    peer.sin_port = htons(peerPort_);
+    return sendto(fd_, data, length, 0, (const sockaddr*)&peer, sizeof(peer)) == (ssize_t)length;
+}
+
+void PosixUdpTransport::close() {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+}
+
+#endif // ARDUINO
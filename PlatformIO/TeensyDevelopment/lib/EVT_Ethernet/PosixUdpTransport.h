@@ -0,0 +1,36 @@
+#ifndef POSIXUDPTRANSPORT_H
+#define POSIXUDPTRANSPORT_H
+
+#ifndef ARDUINO
+
+#include "DatagramTransport.h"
+
+/**
+ * @brief Non-blocking UDP socket for host tools, e.g. a process standing in
+ *        for the Pi on loopback.
+ *
+ * Binds to INADDR_ANY:localPort; localIp is ignored since the host owns its
+ * interfaces.
+ */
+class PosixUdpTransport : public DatagramTransport {
+public:
+    ~PosixUdpTransport() override;
+
+    bool begin(const DatagramConfig& config) override;
+    int receive(char* buffer, size_t size) override;
+    bool send(const uint8_t* data, size_t length) override;
+    void close();
+
+    /** Socket receive buffer in bytes; call before begin(). 0 keeps the OS default. */
+    void setReceiveBuffer(int bytes) { receiveBuffer_ = bytes; }
+
+private:
+    int fd_ = -1;
+    int receiveBuffer_ = 0;
+    uint8_t peerIp_[4] = {0, 0, 0, 0};
+    uint16_t peerPort_ = 0;
+};
+
+#endif // ARDUINO
+
+#endif // POSIXUDPTRANSPORT_H
@@ -0,0 +1,112 @@
+#ifndef TELEMETRYFORMAT_H
+#define TELEMETRYFORMAT_H
+
+// Wire layout of the telemetry datagrams, shared with the Pi's decoder.
+//
+// A datagram is one TelemetryBatchHeader followed by `records` records, each a
+// TelemetryRecordHeader and `length` bytes of the topic's payload struct.
+// Everything is little endian and naturally aligned; payload lengths are
+// multiples of 4. The magic starts with 'E', so the datagram counts as a
+// tagged message (UdpRxRing.h) should it ever be looped back.
+
+#include <stdint.h>
+
+#define TELEMETRY_MAGIC    0x4D545645u   // "EVTM" little endian
+#define TELEMETRY_VERSION  1
+
+/**
+ * @brief Topic ids. Append only; the Pi's decoder keys on them.
+ */
+enum TELEMETRY_TOPIC {
+    TELEMETRY_TOPIC_DRIVE,      ///< TelemetryDrive
+    TELEMETRY_TOPIC_STEERING,   ///< TelemetrySteering
+    TELEMETRY_TOPIC_POWER,      ///< TelemetryPower
+    TELEMETRY_TOPIC_RC_LINK,    ///< TelemetryRcLink
+    TELEMETRY_TOPIC_LOOP,       ///< TelemetryLoop
+    TELEMETRY_TOPIC_HEALTH,     ///< TelemetryHealth
+    TELEMETRY_TOPIC_COUNT
+};
+
+struct TelemetryBatchHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t  records;
+    uint8_t  reserved;
+    uint32_t sequence;    ///< Per datagram; a gap is a lost datagram.
+    uint32_t localUs;     ///< Teensy micros() when the datagram was sent.
+    uint64_t sharedUs;    ///< The same instant on the shared clock (ClockSync.h), 0 until synced.
+};
+
+struct TelemetryRecordHeader {
+    uint8_t  topic;
+    uint8_t  length;      ///< Payload bytes after this header.
+    uint16_t reserved;
+    uint32_t localUs;     ///< Teensy micros() when sampled; shared time is sharedUs - (localUs of the batch - this).
+};
+
+struct TelemetryDrive {
+    float rpm[2];
+    float motorCurrent[2];
+    float duty[2];
+    float rpmCommand;
+};
+
+struct TelemetrySteering {
+    float   pos;              ///< ODrive turns.
+    float   vel;
+    float   target;
+    uint8_t calibrationProgress;   ///< 0-100.
+    uint8_t reserved[3];
+};
+
+struct TelemetryPower {
+    float   vescVoltage;
+    float   inputCurrent[2];
+    float   tempMosfet[2];
+    uint8_t vescFault[2];
+    uint8_t reserved[2];
+};
+
+struct TelemetryRcLink {
+    uint16_t channels[10];
+    uint32_t frames;          ///< SBUS frames received since boot.
+    uint32_t lostFrames;      ///< Frames the receiver flagged as lost.
+    uint8_t  failSafe;
+    uint8_t  state;           ///< STATE from EVT_StateMachine.
+    uint8_t  reserved[2];
+};
+
+struct TelemetryLoop {
+    uint32_t ticks;           ///< Loop iterations since the last sample.
+    uint32_t periodAvgUs;
+    uint32_t periodMaxUs;
+    uint32_t udpRxDiscarded;
+    uint32_t telemetryDropped;  ///< Samples that did not fit the budget, all topics.
+};
+
+#define TELEMETRY_HEALTH_CHECKS 4
+
+struct TelemetryHealthCheck {
+    uint32_t lastCostUs;      ///< Measured cost of the most recent run.
+    uint32_t maxCostUs;       ///< Since boot.
+    uint32_t runs;            ///< Since boot.
+    uint32_t deferred;        ///< Times it was due but the loop budget was spent, since boot.
+};
+
+struct TelemetryHealth {
+    uint32_t timeSavedUs;     ///< Checking skipped since the last sample versus running every check every loop.
+    uint8_t  checks;          ///< Entries of check[] in use, in the order of the EVT_ErrorHandler table.
+    uint8_t  reserved[3];
+    TelemetryHealthCheck check[TELEMETRY_HEALTH_CHECKS];
+};
+
+static_assert(sizeof(TelemetryBatchHeader) == 24, "TelemetryBatchHeader layout changed, bump TELEMETRY_VERSION");
+static_assert(sizeof(TelemetryRecordHeader) == 8, "TelemetryRecordHeader layout changed, bump TELEMETRY_VERSION");
+static_assert(sizeof(TelemetryDrive) == 28, "TelemetryDrive layout changed, bump TELEMETRY_VERSION");
+static_assert(sizeof(TelemetrySteering) == 16, "TelemetrySteering layout changed, bump TELEMETRY_VERSION");
+static_assert(sizeof(TelemetryPower) == 24, "TelemetryPower layout changed, bump TELEMETRY_VERSION");
+static_assert(sizeof(TelemetryRcLink) == 32, "TelemetryRcLink layout changed, bump TELEMETRY_VERSION");
+static_assert(sizeof(TelemetryLoop) == 20, "TelemetryLoop layout changed, bump TELEMETRY_VERSION");
+static_assert(sizeof(TelemetryHealth) == 72, "TelemetryHealth layout changed, bump TELEMETRY_VERSION");
+
+#endif // TELEMETRYFORMAT_H
@@ -0,0 +1,193 @@
+#ifndef TELEMETRYPUBLISHER_H
+#define TELEMETRYPUBLISHER_H
+
+// Topic-based telemetry: each topic is sampled at its own rate into a shared
+// batch, and the batch goes out as one datagram (TelemetryFormat.h) when it
+// is full or its oldest sample has waited TELEMETRY_MAX_HOLD_US. A token
+// bucket keeps the sender inside a bytes-per-second budget; samples that find
+// the batch full while the budget is spent are dropped and counted, never
+// queued.
+
+#include <stdint.h>
+#include <string.h>
+#include "DatagramTransport.h"
+#include "TelemetryFormat.h"
+
+#define TELEMETRY_DATAGRAM_MAX   1472      // Ethernet MTU less the IP and UDP headers.
+#define TELEMETRY_MAX_HOLD_US    20000     // Longest a sample waits for its batch to fill.
+#define TELEMETRY_BURST_BYTES    (2 * TELEMETRY_DATAGRAM_MAX)   // Token bucket depth.
+
+/**
+ * @brief Fills one payload struct of the topic (TelemetryDrive, ...).
+ *        Runs in the loop; must not block.
+ */
+typedef void (*TelemetrySampler)(void* payload);
+
+typedef void (*TelemetrySendHook)(const uint8_t* data, uint16_t length);
+
+struct TelemetryTopicStats {
+    uint16_t rateHz;     ///< 0 when the topic is not registered.
+    uint32_t samples;    ///< Made it into a batch.
+    uint32_t dropped;    ///< Batch full and budget spent.
+};
+
+struct TelemetryStats {
+    uint32_t datagrams;
+    uint32_t bytes;
+    uint32_t samples;
+    uint32_t dropped;
+    uint32_t budgetStalls;  ///< Sends put off because the budget was spent.
+};
+
+class TelemetryPublisher {
+public:
+    TelemetryPublisher() {
+        memset(topics_, 0, sizeof(topics_));
+    }
+
+    /**
+     * @brief Registers a topic, replacing an earlier registration of the same id.
+     * @return false for an unknown topic, a zero rate or a payload that is not
+     *         a multiple of 4 bytes or too long for one record.
+     */
+    bool addTopic(uint8_t topic, uint16_t rateHz, TelemetrySampler sample, uint8_t length) {
+        if (topic >= TELEMETRY_TOPIC_COUNT || rateHz == 0 || sample == NULL || length % 4 != 0 ||
+            sizeof(TelemetryBatchHeader) + sizeof(TelemetryRecordHeader) + length > TELEMETRY_DATAGRAM_MAX)
+            return false;
+        Topic& t = topics_[topic];
+        t.sample = sample;
+        t.length = length;
+        t.periodUs = 1000000UL / rateHz;
+        t.stats.rateHz = rateHz;
+        t.scheduled = false;
+        return true;
+    }
+
+    /** @brief Bytes per second on the wire, UDP payload only. */
+    void setBudget(uint32_t bytesPerSec) {
+        budget_ = bytesPerSec;
+    }
+
+    /**
+     * @brief Samples every topic that is due, then sends the batch if it is
+     *        full or old enough and the budget allows. Call once per loop.
+     *
+     * @param sharedUs  nowUs on the shared clock, 0 until synced.
+     * @param onSend    Called with every datagram sent (wire capture), may be NULL.
+     * @return Datagrams sent.
+     */
+    int service(uint32_t nowUs, uint64_t sharedUs, DatagramTransport& link, TelemetrySendHook onSend = NULL) {
+        refill(nowUs);
+        int sent = 0;
+        for (uint8_t i = 0; i < TELEMETRY_TOPIC_COUNT; i++) {
+            Topic& t = topics_[i];
+            if (t.sample == NULL) continue;
+            if (!t.scheduled) {
+                t.nextUs = nowUs;
+                t.scheduled = true;
+            }
+            if ((int32_t)(nowUs - t.nextUs) < 0) continue;
+            // Late by more than a period (a stall): skip ahead rather than burst.
+            t.nextUs += t.periodUs;
+            if ((int32_t)(nowUs - t.nextUs) >= 0) t.nextUs = nowUs + t.periodUs;
+
+            if (!fits(t.length)) sent += flush(nowUs, sharedUs, link, onSend);
+            if (!fits(t.length)) {
+                t.stats.dropped++;
+                stats_.dropped++;
+                continue;
+            }
+            append(i, t, nowUs);
+        }
+        if (records_ > 0 && (!fits(minLength_) || nowUs - oldestUs_ >= TELEMETRY_MAX_HOLD_US))
+            sent += flush(nowUs, sharedUs, link, onSend);
+        return sent;
+    }
+
+    const TelemetryStats& stats() const { return stats_; }
+
+    TelemetryTopicStats topicStats(uint8_t topic) const {
+        TelemetryTopicStats none = { 0, 0, 0 };
+        return topic < TELEMETRY_TOPIC_COUNT ? topics_[topic].stats : none;
+    }
+
+private:
+    struct Topic {
+        TelemetrySampler sample;
+        uint8_t  length;
+        uint32_t periodUs;
+        uint32_t nextUs;
+        bool     scheduled;
+        TelemetryTopicStats stats;
+    };
+
+    bool fits(uint8_t length) const {
+        return used_ + sizeof(TelemetryRecordHeader) + length <= TELEMETRY_DATAGRAM_MAX && records_ < 255;
+    }
+
+    void append(uint8_t topic, Topic& t, uint32_t nowUs) {
+        if (records_ == 0) {
+            used_ = sizeof(TelemetryBatchHeader);
+            oldestUs_ = nowUs;
+            minLength_ = 255;
+        }
+        TelemetryRecordHeader record = { topic, t.length, 0, nowUs };
+        memcpy(batch_ + used_, &record, sizeof(record));
+        t.sample(batch_ + used_ + sizeof(record));
+        used_ += sizeof(record) + t.length;
+        records_++;
+        if (t.length < minLength_) minLength_ = t.length;
+        t.stats.samples++;
+        stats_.samples++;
+    }
+
+    int flush(uint32_t nowUs, uint64_t sharedUs, DatagramTransport& link, TelemetrySendHook onSend) {
+        if (records_ == 0) return 0;
+        if (tokensMicroBytes_ < (uint64_t)used_ * 1000000ULL) {
+            stats_.budgetStalls++;
+            return 0;
+        }
+        TelemetryBatchHeader header = { TELEMETRY_MAGIC, TELEMETRY_VERSION, (uint8_t)records_, 0,
+                                        sequence_++, nowUs, sharedUs };
+        memcpy(batch_, &header, sizeof(header));
+        link.send(batch_, used_);
+        if (onSend) onSend(batch_, used_);
+        tokensMicroBytes_ -= (uint64_t)used_ * 1000000ULL;
+        stats_.datagrams++;
+        stats_.bytes += used_;
+        records_ = 0;
+        used_ = sizeof(TelemetryBatchHeader);
+        return 1;
+    }
+
+    // The bucket holds microbytes so slow budgets still refill between ticks.
+    void refill(uint32_t nowUs) {
+        if (!refilled_) {
+            lastRefillUs_ = nowUs;
+            tokensMicroBytes_ = (uint64_t)TELEMETRY_BURST_BYTES * 1000000ULL;
+            refilled_ = true;
+            return;
+        }
+        tokensMicroBytes_ += (uint64_t)(nowUs - lastRefillUs_) * budget_;
+        lastRefillUs_ = nowUs;
+        uint64_t cap = (uint64_t)TELEMETRY_BURST_BYTES * 1000000ULL;
+        if (tokensMicroBytes_ > cap) tokensMicroBytes_ = cap;
+    }
+
+    Topic topics_[TELEMETRY_TOPIC_COUNT];
+    alignas(8) uint8_t batch_[TELEMETRY_DATAGRAM_MAX];   // Samplers write payload structs in place.
+    uint16_t used_ = sizeof(TelemetryBatchHeader);
+    uint16_t records_ = 0;
+    uint8_t  minLength_ = 255;
+    uint32_t oldestUs_ = 0;
+    uint32_t sequence_ = 0;
+
+    uint32_t budget_ = 0;
+    uint64_t tokensMicroBytes_ = 0;
+    uint32_t lastRefillUs_ = 0;
+    bool     refilled_ = false;
+
+    TelemetryStats stats_ = { 0, 0, 0, 0, 0 };
+};
+
+#endif // TELEMETRYPUBLISHER_H
@@ -0,0 +1,155 @@
+#ifndef UDPRXRING_H
+#define UDPRXRING_H
+
+// Receive side of the autonomous command link: every datagram pending on the
+// socket is drained into this ring once per tick, then only the newest one of
+// each message type is acted on.
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include "ControlPacket.h"
+#include "DatagramTransport.h"
+
+#define UDP_RX_RING_SIZE     8     // Datagrams kept per drain; older ones are overwritten.
+#define UDP_RX_DATAGRAM_MAX  512   // Longer datagrams are cut here and flagged truncated; fits a parameter PSET.
+#define UDP_RX_DRAIN_MAX     32    // Datagrams read per tick at most, so a flood cannot stall the loop.
+
+/**
+ * @brief Datagrams that start with a letter are tagged messages (e.g. the
+ *        clock sync in ClockSync.h); control packets start with a number.
+ */
+inline bool isTaggedDatagram(const char* data, uint16_t length) {
+    return length > 0 && ((data[0] >= 'A' && data[0] <= 'Z') || (data[0] >= 'a' && data[0] <= 'z'));
+}
+
+struct UdpDatagram {
+    uint32_t rxUs;     ///< micros() when it was drained from the socket.
+    uint16_t length;
+    bool     truncated;  ///< Longer than UDP_RX_DATAGRAM_MAX; data holds only the start and must not be acted on.
+    char     data[UDP_RX_DATAGRAM_MAX + 1];  ///< NUL terminated.
+};
+
+class UdpRxRing {
+public:
+    void clear() {
+        count_ = 0;
+        lostEmergency_ = false;
+    }
+
+    /**
+     * @brief Slot for the next datagram. When the ring is full the oldest is
+     *        given up and counted in overwritten().
+     */
+    UdpDatagram& next() {
+        if (count_ == UDP_RX_RING_SIZE) {
+            // A stop must survive even when the ring overflows.
+            const UdpDatagram& oldest = slots_[head_];
+            ControlPacket packet;
+            if (!isTaggedDatagram(oldest.data, oldest.length) &&
+                parseControlPacket(std::string(oldest.data, oldest.length), packet) && packet.emergency)
+                lostEmergency_ = true;
+            head_ = (head_ + 1) % UDP_RX_RING_SIZE;
+            count_--;
+            overwritten_++;
+        }
+        UdpDatagram& d = slots_[(head_ + count_) % UDP_RX_RING_SIZE];
+        count_++;
+        return d;
+    }
+
+    void push(const char* data, uint16_t length, uint32_t rxUs) {
+        UdpDatagram& d = next();
+        d.truncated = length > UDP_RX_DATAGRAM_MAX;
+        if (d.truncated) length = UDP_RX_DATAGRAM_MAX;
+        memcpy(d.data, data, length);
+        d.data[length] = '\0';
+        d.length = length;
+        d.rxUs = rxUs;
+    }
+
+    uint8_t size() const { return count_; }
+    /** 0 is the oldest. */
+    const UdpDatagram& at(uint8_t i) const { return slots_[(head_ + i) % UDP_RX_RING_SIZE]; }
+    uint32_t overwritten() const { return overwritten_; }
+    /** An overwritten datagram since clear() was a control packet with emergency set. */
+    bool lostEmergency() const { return lostEmergency_; }
+
+private:
+    UdpDatagram slots_[UDP_RX_RING_SIZE];
+    uint8_t head_ = 0;
+    uint8_t count_ = 0;
+    uint32_t overwritten_ = 0;
+    bool lostEmergency_ = false;
+};
+
+typedef void (*DatagramHook)(const UdpDatagram& datagram);
+
+/**
+ * @brief Reads up to UDP_RX_DRAIN_MAX pending datagrams into the ring.
+ *
+ * @param onDatagram  Called for each one as it is read (wire capture, tagged
+ *                    message handlers), may be NULL. Tagged messages are
+ *                    handled here since the ring may overwrite them.
+ * @return How many were read.
+ */
+inline int drainDatagrams(DatagramTransport& link, UdpRxRing& ring, uint32_t nowUs, DatagramHook onDatagram = NULL) {
+    int n = 0;
+    // One byte more than a slot holds, so a longer datagram shows up as truncated.
+    char buffer[UDP_RX_DATAGRAM_MAX + 1];
+    while (n < UDP_RX_DRAIN_MAX) {
+        int length = link.receive(buffer, sizeof(buffer));
+        if (length < 0) break;
+        ring.push(buffer, (uint16_t)length, nowUs);
+        if (onDatagram) onDatagram(ring.at(ring.size() - 1));
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @brief What one drain produced for the control message type.
+ */
+struct ControlRx {
+    ControlPacket packet;
+    uint32_t rxUs;
+    uint16_t superseded;  ///< Older valid control packets in the same drain, not acted on.
+    uint16_t rejected;    ///< Datagrams that did not parse or were truncated.
+};
+
+/**
+ * @brief Picks the newest control packet in the ring.
+ *
+ * An emergency flag set in any packet of the drain, overwritten ones included,
+ * is kept, so a stop the Pi sent is never lost to a newer packet that arrived
+ * in the same tick.
+ *
+ * @return false if the ring holds no valid control packet.
+ */
+inline bool newestControlPacket(const UdpRxRing& ring, ControlRx& out) {
+    bool found = false;
+    bool emergency = ring.lostEmergency();
+    out.superseded = 0;
+    out.rejected = 0;
+    for (int i = ring.size() - 1; i >= 0; i--) {
+        const UdpDatagram& d = ring.at(i);
+        if (isTaggedDatagram(d.data, d.length)) continue;
+        ControlPacket packet;
+        if (d.truncated || !parseControlPacket(std::string(d.data, d.length), packet)) {
+            out.rejected++;
+            continue;
+        }
+        emergency |= packet.emergency;
+        if (found) {
+            out.superseded++;
+            continue;
+        }
+        out.packet = packet;
+        out.rxUs = d.rxUs;
+        found = true;
+    }
+    if (found) out.packet.emergency = emergency;
+    return found;
+}
+
+#endif // UDPRXRING_H
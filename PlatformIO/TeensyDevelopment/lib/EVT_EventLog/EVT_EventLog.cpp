@@ -0,0 +1,223 @@
+#include "EVT_EventLog.h"
+#include "EVT_StateMachine.h"
+#include "EVT_ErrorCodes.h"
+#include <strings.h>
+
+// Ring size must be a power of two so the index wrap is a mask.
+static const uint32_t EVENT_LOG_SIZE = 256;
+static const uint32_t EVENT_REASON_SLOTS = 8;
+
+static EventRecord eventRing[EVENT_LOG_SIZE];
+static volatile uint32_t eventHead = 0;  // Next slot to write.
+static volatile uint32_t eventTail = 0;  // Next slot to drain.
+static volatile uint32_t eventDropped = 0;
+static uint16_t eventSequence = 0;
+
+static char eventReasons[EVENT_REASON_SLOTS][EVENT_REASON_LEN];
+static uint32_t eventReasonNumbers[EVENT_REASON_SLOTS];  // Which reason each slot holds now.
+static uint32_t eventReasonNext = 0;
+static uint32_t eventReasonsOverwritten = 0;
+
+static const char* const event_names[EVENT_ID_COUNT] = {
+    "NONE",
+    "STATE",
+    "ERROR",
+    "STEER",
+    "BLACKBOX",
+    "ODRIVE_ERR",
+    "VESC_FAULT",
+    "FAULT",
+    "FAULT_CLEARED",
+    "CALIBRATION",
+    "CAPTURE",
+    "VESC_STOP",
+    "PARAM",
+    "TUNE"
+};
+
+static const char* const location_names[EVENT_LOCATION_COUNT] = {
+    "unknown",
+    "main",
+    "vesc",
+    "odrive",
+    "sbus",
+    "ethernet",
+    "automode",
+    "blackbox",
+    "capture"
+};
+
+void logEvent(EVENT_ID id, EVENT_LOCATION location, int32_t arg0, int32_t arg1) {
+    noInterrupts();
+    if (eventHead - eventTail >= EVENT_LOG_SIZE) {
+        // Full: drop the oldest record so the newest ones are always kept.
+        eventTail++;
+        eventDropped++;
+    }
+    EventRecord &rec = eventRing[eventHead & (EVENT_LOG_SIZE - 1)];
+    rec.timestampUs = micros();
+    rec.sequence = eventSequence++;
+    rec.eventId = id;
+    rec.locationId = location;
+    rec.arg0 = arg0;
+    rec.arg1 = arg1;
+    eventHead++;
+    interrupts();
+}
+
+int32_t storeEventReason(const char* reason) {
+    uint32_t number = eventReasonNext++;
+    uint32_t slot = number % EVENT_REASON_SLOTS;
+    strncpy(eventReasons[slot], reason ? reason : "", EVENT_REASON_LEN - 1);
+    eventReasons[slot][EVENT_REASON_LEN - 1] = '\0';
+    eventReasonNumbers[slot] = number;
+    return (int32_t)number;
+}
+
+static bool eventHasReason(uint8_t id) {
+    return id == EVT_ERROR || id == EVT_FAULT;
+}
+
+// The reason a drained record refers to, nullptr if it has none or the slot
+// has been reused since (counted).
+static const char* takeEventReason(const EventRecord& rec) {
+    if (!eventHasReason(rec.eventId)) return nullptr;
+    uint32_t slot = (uint32_t)rec.arg1 % EVENT_REASON_SLOTS;
+    if (eventReasonNumbers[slot] != (uint32_t)rec.arg1) {
+        eventReasonsOverwritten++;
+        return nullptr;
+    }
+    return eventReasons[slot];
+}
+
+EVENT_LOCATION eventLocationFromString(const char* location) {
+    if (location == nullptr) return LOC_UNKNOWN;
+    for (uint8_t i = 1; i < EVENT_LOCATION_COUNT; i++) {
+        if (strcasecmp(location, location_names[i]) == 0) {
+            return (EVENT_LOCATION)i;
+        }
+    }
+    return LOC_UNKNOWN;
+}
+
+// Copies the oldest pending record out of the ring. Returns false if empty.
+static bool popEvent(EventRecord &out) {
+    noInterrupts();
+    if (eventTail == eventHead) {
+        interrupts();
+        return false;
+    }
+    out = eventRing[eventTail & (EVENT_LOG_SIZE - 1)];
+    eventTail++;
+    interrupts();
+    return true;
+}
+
+size_t drainEventLog(Print& out, size_t maxRecords) {
+    static const uint8_t recordSync[2] = { EVENT_FRAME_SYNC, EVENT_FRAME_RECORD };
+    size_t count = 0;
+    EventRecord rec;
+    while (count < maxRecords && popEvent(rec)) {
+        out.write(recordSync, sizeof(recordSync));
+        out.write((const uint8_t*)&rec, sizeof(rec));
+        if (eventHasReason(rec.eventId)) {
+            const char* reason = takeEventReason(rec);
+            uint8_t header[3] = { EVENT_FRAME_SYNC, EVENT_FRAME_REASON, (uint8_t)(reason ? strlen(reason) : 0) };
+            out.write(header, sizeof(header));
+            if (reason) out.write((const uint8_t*)reason, header[2]);
+        }
+        count++;
+    }
+    return count;
+}
+
+void formatEventRecord(const EventRecord& rec, const char* reason, char* line, size_t size) {
+    const char* name = rec.eventId < EVENT_ID_COUNT ? event_names[rec.eventId] : "?";
+    const char* loc = rec.locationId < EVENT_LOCATION_COUNT ? location_names[rec.locationId] : "?";
+    if (reason == nullptr) reason = "(reason overwritten)";
+
+    switch (rec.eventId) {
+    case EVT_STATE_CHANGE:
+        snprintf(line, size, "[%lu us #%u] %s %s: %s -> %s",
+                 (unsigned long)rec.timestampUs, rec.sequence, name, loc,
+                 StateToString((STATE)rec.arg0), StateToString((STATE)rec.arg1));
+        break;
+    case EVT_ERROR:
+        snprintf(line, size, "[%lu us #%u] %s %s (in %s): %s",
+                 (unsigned long)rec.timestampUs, rec.sequence, name, loc,
+                 StateToString((STATE)rec.arg0), reason);
+        break;
+    case EVT_FAULT: {
+        static const char* const severity_names[] = { "warning", "degraded", "critical" };
+        snprintf(line, size, "[%lu us #%u] %s %s (%s): %s",
+                 (unsigned long)rec.timestampUs, rec.sequence, name, loc,
+                 (uint32_t)rec.arg0 < 3 ? severity_names[rec.arg0] : "?", reason);
+        break;
+    }
+    case EVT_ODRIVE_ERROR: {
+        int n = snprintf(line, size, "[%lu us #%u] %s %s: ",
+                         (unsigned long)rec.timestampUs, rec.sequence, name, loc);
+        if (n > 0 && (size_t)n < size) {
+            odriveErrorToString((uint32_t)rec.arg0, line + n, size - n);
+        }
+        break;
+    }
+    case EVT_VESC_FAULT:
+        snprintf(line, size, "[%lu us #%u] %s %s: vesc%ld %s",
+                 (unsigned long)rec.timestampUs, rec.sequence, name, loc,
+                 (long)rec.arg0 + 1, vescFaultToString((uint32_t)rec.arg1));
+        break;
+    case EVT_PARAM:
+        if ((rec.arg0 >> 16) == 0) {  // PARAM_FLOAT
+            snprintf(line, size, "[%lu us #%u] %s %s: %ld = %.3f",
+                     (unsigned long)rec.timestampUs, rec.sequence, name, loc,
+                     (long)(rec.arg0 & 0xFFFF), rec.arg1 / 1000.0);
+        } else {
+            snprintf(line, size, "[%lu us #%u] %s %s: %ld = %ld",
+                     (unsigned long)rec.timestampUs, rec.sequence, name, loc,
+                     (long)(rec.arg0 & 0xFFFF), (long)rec.arg1);
+        }
+        break;
+    default:
+        snprintf(line, size, "[%lu us #%u] %s %s: %ld, %ld",
+                 (unsigned long)rec.timestampUs, rec.sequence, name, loc,
+                 (long)rec.arg0, (long)rec.arg1);
+        break;
+    }
+}
+
+size_t printEventLog(Print& out, size_t maxRecords) {
+    size_t count = 0;
+    EventRecord rec;
+    char line[128];
+    while (count < maxRecords && popEvent(rec)) {
+        formatEventRecord(rec, takeEventReason(rec), line, sizeof(line));
+        out.println(line);
+        count++;
+    }
+    static uint32_t reportedDropped = 0;
+    uint32_t dropped = eventDropped;
+    if (dropped != reportedDropped) {
+        snprintf(line, sizeof(line), "[event log] %lu records dropped",
+                 (unsigned long)(dropped - reportedDropped));
+        out.println(line);
+        reportedDropped = dropped;
+    }
+    static uint32_t reportedOverwritten = 0;
+    uint32_t overwritten = eventReasonsOverwritten;
+    if (overwritten != reportedOverwritten) {
+        snprintf(line, sizeof(line), "[event log] %lu reasons overwritten before they were drained",
+                 (unsigned long)(overwritten - reportedOverwritten));
+        out.println(line);
+        reportedOverwritten = overwritten;
+    }
+    return count;
+}
+
+uint32_t getDroppedEventCount() {
+    return eventDropped;
+}
+
+uint32_t getOverwrittenReasonCount() {
+    return eventReasonsOverwritten;
+}
@@ -0,0 +1,120 @@
+#ifndef EVT_EVENTLOG_H
+#define EVT_EVENTLOG_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Identifiers for the events stored in the log.
+ *
+ * Values are part of the binary record format, only ever append new ones.
+ */
+enum EVENT_ID : uint8_t {
+    EVT_NONE = 0,       ///< Unused slot.
+    EVT_STATE_CHANGE,   ///< arg0 = previous state, arg1 = new state.
+    EVT_ERROR,          ///< arg0 = state when the error hit, arg1 = reason number.
+    EVT_STEERING,       ///< arg0 = target pos, arg1 = measured pos (both in milli-turns).
+    EVT_BLACKBOX,       ///< arg0 = BLACKBOX_STATUS, arg1 = file index.
+    EVT_ODRIVE_ERROR,   ///< arg0 = axis error bitmask.
+    EVT_VESC_FAULT,     ///< arg0 = VESC index (0 or 1), arg1 = mc_fault_code.
+    EVT_FAULT,          ///< arg0 = FAULT_SEVERITY, arg1 = reason number.
+    EVT_FAULT_CLEARED,  ///< arg0 = how long the degraded fault lasted in ms.
+    EVT_CALIBRATION,    ///< arg0 = CALIB_STEP entered, arg1 = ms since calibration start.
+    EVT_CAPTURE,        ///< arg0 = CAPTURE_STATUS, arg1 = file index or dropped bytes.
+    EVT_VESC_STOP,      ///< arg0 = VESC index, arg1 = ms since its last command when the supervisor stopped it.
+    EVT_PARAM,          ///< arg0 = PARAM_ID | PARAM_TYPE << 16, arg1 = the value applied (thousandths for a float).
+    EVT_TUNE,           ///< arg0 = steering Ku in thousandths, arg1 = Pu in us, from a finished auto-tune.
+    EVENT_ID_COUNT
+};
+
+/**
+ * @brief Identifiers for where an event came from.
+ */
+enum EVENT_LOCATION : uint8_t {
+    LOC_UNKNOWN = 0,
+    LOC_MAIN,
+    LOC_VESC,
+    LOC_ODRIVE,
+    LOC_SBUS,
+    LOC_ETHERNET,
+    LOC_AUTOMODE,
+    LOC_BLACKBOX,
+    LOC_CAPTURE,
+    EVENT_LOCATION_COUNT
+};
+
+/**
+ * @brief Fixed-size binary log record (16 bytes, little endian on the wire).
+ */
+struct EventRecord {
+    uint32_t timestampUs;   ///< micros() when the event was logged.
+    uint16_t sequence;      ///< Running counter, gaps mean records were overwritten.
+    uint8_t  eventId;       ///< EVENT_ID
+    uint8_t  locationId;    ///< EVENT_LOCATION
+    int32_t  arg0;
+    int32_t  arg1;
+};
+static_assert(sizeof(EventRecord) == 16, "EventRecord must stay 16 bytes");
+
+// Binary frames from drainEventLog(): EVENT_FRAME_SYNC, a type byte, then the payload.
+#define EVENT_FRAME_SYNC    0xA5
+#define EVENT_FRAME_RECORD  0x5A   // Payload: one EventRecord.
+#define EVENT_FRAME_REASON  0x5B   // Payload: length byte, then the text. Follows the record it belongs to.
+#define EVENT_REASON_LEN    48     // Longest reason kept, including the terminator.
+
+/**
+ * @brief Appends a record to the RAM ring buffer.
+ *
+ * Constant time and safe to call from the control loop. When the ring is full
+ * the oldest record is overwritten and the dropped counter goes up.
+ */
+void logEvent(EVENT_ID id, EVENT_LOCATION location, int32_t arg0 = 0, int32_t arg1 = 0);
+
+/**
+ * @brief Stores an error reason string and returns the number to log with it.
+ *
+ * Reasons are kept in a small ring of fixed buffers, so only the most recent
+ * few survive until the log is drained. A record whose reason has already
+ * been overwritten is drained without it and counted in
+ * getOverwrittenReasonCount().
+ */
+int32_t storeEventReason(const char* reason);
+
+/**
+ * @brief Maps one of the ERR_* location strings onto an EVENT_LOCATION.
+ */
+EVENT_LOCATION eventLocationFromString(const char* location);
+
+/**
+ * @brief Writes up to maxRecords pending records as binary frames.
+ *
+ * Each record is an EVENT_FRAME_RECORD frame; EVT_ERROR and EVT_FAULT records
+ * are followed by an EVENT_FRAME_REASON frame with the text (empty if it was
+ * overwritten). Meant for a UDP socket or a dedicated serial port;
+ * tools/eventlog_decode turns the stream back into printEventLog() lines.
+ *
+ * @return Number of records written.
+ */
+size_t drainEventLog(Print& out, size_t maxRecords);
+
+/**
+ * @brief Decodes up to maxRecords pending records as text lines.
+ *
+ * Call from the low-priority end of the loop; this is where the Serial cost is paid.
+ *
+ * @return Number of records printed.
+ */
+size_t printEventLog(Print& out, size_t maxRecords);
+
+/**
+ * @brief Formats one record as the text line printEventLog() prints.
+ *
+ * @param reason  The record's reason text, or nullptr if it has none or it was lost.
+ */
+void formatEventRecord(const EventRecord& rec, const char* reason, char* line, size_t size);
+
+uint32_t getDroppedEventCount();
+
+/** @brief Reasons overwritten before the record that referred to them was drained. */
+uint32_t getOverwrittenReasonCount();
+
+#endif // EVT_EVENTLOG_H
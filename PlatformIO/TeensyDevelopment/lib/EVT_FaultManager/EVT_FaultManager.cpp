@@ -0,0 +1,108 @@
+#include "EVT_FaultManager.h"
+#include "EVT_StateMachine.h"
+#include "EVT_EventLog.h"
+
+static uint32_t degradedSinceMs[EVENT_LOCATION_COUNT];
+static uint32_t degradedLastMs[EVENT_LOCATION_COUNT];
+static uint32_t warningLastMs[EVENT_LOCATION_COUNT];
+static uint16_t degradedMask = 0;     // One bit per EVENT_LOCATION.
+static uint16_t criticalMask = 0;     // Locations with a critical fault since the last reset.
+static uint8_t  faultRelayMask = 0;   // Relays the last critical fault wants open.
+static uint8_t  openRelayMask = 0;    // Relays currently open.
+
+// Which relays a critical fault opens, by where it came from. The ODrive
+// disarms itself on its own errors, so it keeps power and does not need a
+// full recalibration afterwards; losing steering still stops the drivetrain.
+static uint8_t relaysForLocation(EVENT_LOCATION location) {
+    switch (location) {
+    case LOC_VESC:
+    case LOC_ODRIVE:
+        return RELAY_VESC | RELAY_CONTACTOR;
+    default:
+        return RELAY_ALL;
+    }
+}
+
+static void writeRelays(uint8_t open) {
+    digitalWrite(RELAY_ODRIVE_PIN,    (open & RELAY_ODRIVE)    ? LOW : HIGH);
+    digitalWrite(RELAY_VESC_PIN,      (open & RELAY_VESC)      ? LOW : HIGH);
+    digitalWrite(RELAY_CONTACTOR_PIN, (open & RELAY_CONTACTOR) ? LOW : HIGH);
+    openRelayMask = open;
+}
+
+void setupRelays() {
+    pinMode(RELAY_ODRIVE_PIN, OUTPUT);
+    pinMode(RELAY_VESC_PIN, OUTPUT);
+    pinMode(RELAY_CONTACTOR_PIN, OUTPUT);
+    writeRelays(0);
+}
+
+void reportFault(FAULT_SEVERITY severity, const char* location, const char* reason) {
+    EVENT_LOCATION loc = eventLocationFromString(location);
+
+    switch (severity) {
+    case FAULT_WARNING: {
+        // Checks report every loop; one warning per location per hysteresis window is plenty.
+        uint32_t now = millis();
+        if (warningLastMs[loc] == 0 || now - warningLastMs[loc] > FAULT_CLEAR_HYSTERESIS_MS) {
+            warningLastMs[loc] = now;
+            logEvent(EVT_FAULT, loc, severity, storeEventReason(reason));
+        }
+        break;
+    }
+
+    case FAULT_DEGRADED: {
+        uint32_t now = millis();
+        if (!(degradedMask & (1u << loc))) {
+            degradedMask |= (1u << loc);
+            degradedSinceMs[loc] = now;
+            logEvent(EVT_FAULT, loc, severity, storeEventReason(reason));
+        }
+        degradedLastMs[loc] = now;
+        break;
+    }
+
+    case FAULT_CRITICAL:
+        // Checks keep reporting a latched fault every loop; while in ERR only
+        // the first report from each location is logged and freezes the black box.
+        if (GetState() == ERR && (criticalMask & (1u << loc))) break;
+        criticalMask |= (1u << loc);
+        faultRelayMask |= relaysForLocation(loc);
+        SetErrorState(location, reason);
+        break;
+    }
+}
+
+void updateFaultManager() {
+    if (degradedMask == 0) return;
+
+    uint32_t now = millis();
+    for (uint8_t loc = 0; loc < EVENT_LOCATION_COUNT; loc++) {
+        if ((degradedMask & (1u << loc)) && now - degradedLastMs[loc] > FAULT_CLEAR_HYSTERESIS_MS) {
+            degradedMask &= ~(1u << loc);
+            logEvent(EVT_FAULT_CLEARED, (EVENT_LOCATION)loc, (int32_t)(now - degradedSinceMs[loc]));
+        }
+    }
+}
+
+float getThrottleLimit() {
+    return degradedMask ? DEGRADED_THROTTLE_LIMIT : 1.0f;
+}
+
+bool isDegraded() {
+    return degradedMask != 0;
+}
+
+void applyFaultRelays() {
+    // Errors raised straight through SetErrorState() have no mask; treat as worst case.
+    uint8_t open = faultRelayMask ? faultRelayMask : RELAY_ALL;
+    if (open != openRelayMask) writeRelays(open);
+}
+
+bool restoreFaultRelays() {
+    bool odriveLostPower = openRelayMask & RELAY_ODRIVE;
+    writeRelays(0);
+    faultRelayMask = 0;
+    criticalMask = 0;
+    return odriveLostPower;
+}
@@ -0,0 +1,73 @@
+#ifndef EVT_FAULTMANAGER_H
+#define EVT_FAULTMANAGER_H
+
+#include <Arduino.h>
+
+// Relay outputs, HIGH = energised.
+#define RELAY_ODRIVE_PIN     3
+#define RELAY_VESC_PIN       4
+#define RELAY_CONTACTOR_PIN  5
+
+#define RELAY_ODRIVE     0x01
+#define RELAY_VESC       0x02
+#define RELAY_CONTACTOR  0x04
+#define RELAY_ALL        (RELAY_ODRIVE | RELAY_VESC | RELAY_CONTACTOR)
+
+// Degraded faults clear themselves once they have not been reported for this long.
+#define FAULT_CLEAR_HYSTERESIS_MS 2000
+// Throttle scale applied while any degraded fault is active.
+#define DEGRADED_THROTTLE_LIMIT   0.3f
+
+/**
+ * @brief How bad a fault is, which decides what the system does about it.
+ */
+enum FAULT_SEVERITY {
+    FAULT_WARNING,   ///< Logged only, driving continues.
+    FAULT_DEGRADED,  ///< Throttle limited until the fault stops being reported.
+    FAULT_CRITICAL   ///< SetErrorState(), relays for the affected subsystem open.
+};
+
+/**
+ * @brief Configures the relay pins and energises all relays.
+ */
+void setupRelays();
+
+/**
+ * @brief Single entry point for modules to report a problem.
+ *
+ * Degraded faults have to keep being reported by their check to stay active;
+ * once they go quiet for FAULT_CLEAR_HYSTERESIS_MS they recover on their own.
+ * A critical fault enters ERR once per location; repeats while in ERR are
+ * ignored until restoreFaultRelays() resets them.
+ *
+ * @param severity How to react.
+ * @param location One of the ERR_* location strings.
+ * @param reason Human readable reason, copied into the event log.
+ */
+void reportFault(FAULT_SEVERITY severity, const char* location, const char* reason);
+
+/**
+ * @brief Expires degraded faults that have gone quiet. Call once per loop.
+ */
+void updateFaultManager();
+
+/**
+ * @brief Scale (0..1) that throttle commands must be multiplied by.
+ */
+float getThrottleLimit();
+
+bool isDegraded();
+
+/**
+ * @brief Opens the relays that the active critical fault requires. Used in ERR.
+ */
+void applyFaultRelays();
+
+/**
+ * @brief Re-energises any relays opened by applyFaultRelays() and forgets the fault.
+ *
+ * @return True if the ODrive lost power, meaning it needs calibrating again.
+ */
+bool restoreFaultRelays();
+
+#endif // EVT_FAULTMANAGER_H
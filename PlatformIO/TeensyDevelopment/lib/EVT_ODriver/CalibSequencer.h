@@ -0,0 +1,214 @@
+#ifndef CALIBSEQUENCER_H
+#define CALIBSEQUENCER_H
+
+// ODrive motor/encoder calibration and closed-loop arming as a step sequencer.
+// Each phase is finished when the ODrive reports it back in IDLE, not after a
+// fixed sleep, so the rest of the loop (SBUS, VESC, Ethernet) keeps running.
+// EVT_ODriver drives it from updateOdrvControl(); tools/calib_sim runs it
+// against a simulated ODrive.
+
+#include "ODriveUART.h"
+
+#define CALIB_POLL_MS           50     // One getState() round trip per poll.
+#define CALIB_PHASE_TIMEOUT_MS  8000
+#define CALIB_ARM_TIMEOUT_MS    5000
+#define CALIB_START_GRACE_MS    500    // Time for the ODrive to enter a requested state.
+
+/**
+ * @brief Steps of the sequencer. Logged as EVT_CALIBRATION; append only.
+ */
+enum CALIB_STEP {
+    CALIB_STEP_IDLE,         ///< Never started.
+    CALIB_STEP_MOTOR,        ///< AXIS_STATE_MOTOR_CALIBRATION requested, waiting for IDLE.
+    CALIB_STEP_ENCODER,      ///< AXIS_STATE_ENCODER_OFFSET_CALIBRATION requested, waiting for IDLE.
+    CALIB_STEP_CLOSED_LOOP,  ///< Requesting closed loop until the axis reports it.
+    CALIB_STEP_DONE,
+    CALIB_STEP_ABORTED,      ///< Cancelled from SBUS channel 5.
+    CALIB_STEP_FAILED        ///< A phase timed out or the axis disarmed with an error (axisError()).
+};
+
+/** @brief Told about every step entered, e.g. for the event log. */
+typedef void (*CalibStepHook)(CALIB_STEP step, uint32_t msSinceStart);
+
+class CalibSequencer {
+public:
+    explicit CalibSequencer(ODriveUART& odrive, CalibStepHook onStep = NULL) : odrive_(odrive), onStep_(onStep) {}
+
+    /**
+     * @brief Starts a run and returns immediately.
+     * @param closedLoopOnly  Skip motor/encoder calibration and only arm closed loop.
+     */
+    void start(bool closedLoopOnly, uint32_t nowMs) {
+        odrive_.clearErrors();
+        startMs_ = nowMs;
+        lastPollMs_ = nowMs - CALIB_POLL_MS;
+        axisError_ = 0;
+        // The switch that started this run has to be released before it can start another.
+        waitRelease_ = true;
+        // Capture the current encoder reading BEFORE doing any calibration.
+        startPos_ = odrive_.getFeedback().pos;
+        if (closedLoopOnly) {
+            odrive_.setState(AXIS_STATE_CLOSED_LOOP_CONTROL);
+            enter(CALIB_STEP_CLOSED_LOOP, nowMs);
+        } else {
+            // Perform motor calibration. Note that this step might move the motor.
+            odrive_.setState(AXIS_STATE_MOTOR_CALIBRATION);
+            enter(CALIB_STEP_MOTOR, nowMs);
+        }
+    }
+
+    void abort(uint32_t nowMs) {
+        if (!running()) return;
+        odrive_.setState(AXIS_STATE_IDLE);
+        enter(CALIB_STEP_ABORTED, nowMs);
+    }
+
+    /**
+     * @brief Advances the run; polls the ODrive at most every CALIB_POLL_MS.
+     *
+     * @param startSwitch  Channel 5 is above its start threshold. Starts a run
+     *                     when none is going, once per press: after any run
+     *                     the switch has to drop before it starts the next.
+     * @param abortSwitch  Channel 5 is pulled back to off; aborts the run.
+     * @return The current step.
+     */
+    CALIB_STEP service(bool startSwitch, bool abortSwitch, uint32_t nowMs) {
+        if (!running()) {
+            if (!startSwitch) {
+                waitRelease_ = false;
+            } else if (!waitRelease_) {
+                start(storeMatches_, nowMs);
+            }
+            return step_;
+        }
+
+        if (abortSwitch) {
+            abort(nowMs);
+            return step_;
+        }
+
+        if (nowMs - lastPollMs_ < CALIB_POLL_MS) return step_;
+        lastPollMs_ = nowMs;
+
+        uint32_t timeout = step_ == CALIB_STEP_CLOSED_LOOP ? CALIB_ARM_TIMEOUT_MS : CALIB_PHASE_TIMEOUT_MS;
+        if (nowMs - phaseMs_ > timeout) {
+            fail(0, nowMs);
+            return step_;
+        }
+
+        switch (step_) {
+        case CALIB_STEP_MOTOR:
+            if (phaseDone(AXIS_STATE_MOTOR_CALIBRATION, nowMs)) {
+                // Now run the encoder offset calibration.
+                odrive_.clearErrors();
+                odrive_.setState(AXIS_STATE_ENCODER_OFFSET_CALIBRATION);
+                enter(CALIB_STEP_ENCODER, nowMs);
+            }
+            break;
+
+        case CALIB_STEP_ENCODER:
+            if (phaseDone(AXIS_STATE_ENCODER_OFFSET_CALIBRATION, nowMs)) {
+                odrive_.clearErrors();
+                odrive_.setState(AXIS_STATE_CLOSED_LOOP_CONTROL);
+                enter(CALIB_STEP_CLOSED_LOOP, nowMs);
+            }
+            break;
+
+        case CALIB_STEP_CLOSED_LOOP:
+            if (odrive_.getState() == AXIS_STATE_CLOSED_LOOP_CONTROL) {
+                // Input mode 1 = PASSTHROUGH, setpoints are applied as sent.
+                odrive_.setParameter("axis0.controller.config.input_mode", "1");
+                // The setpoint stream has to start from where the axis actually is.
+                armedPos_ = odrive_.getFeedback().pos;
+                enter(CALIB_STEP_DONE, nowMs);
+            } else {
+                // Keep retrying, the axis may refuse while errors are still latched.
+                odrive_.clearErrors();
+                odrive_.setState(AXIS_STATE_CLOSED_LOOP_CONTROL);
+            }
+            break;
+
+        default:
+            break;
+        }
+        return step_;
+    }
+
+    bool running() const {
+        return step_ == CALIB_STEP_MOTOR || step_ == CALIB_STEP_ENCODER || step_ == CALIB_STEP_CLOSED_LOOP;
+    }
+
+    CALIB_STEP step() const { return step_; }
+
+    /** @brief 0-100, for telemetry. */
+    uint8_t progress() const {
+        switch (step_) {
+        case CALIB_STEP_MOTOR:       return 10;
+        case CALIB_STEP_ENCODER:     return 50;
+        case CALIB_STEP_CLOSED_LOOP: return 90;
+        case CALIB_STEP_DONE:        return 100;
+        default:                     return 0;
+        }
+    }
+
+    /**
+     * @brief The ODrive still holds the calibration we stored, so a run started
+     *        from the switch only arms closed loop. Cleared when a run fails.
+     */
+    bool storeMatches() const { return storeMatches_; }
+    void setStoreMatches(bool matches) { storeMatches_ = matches; }
+
+    float startPos() const { return startPos_; }   ///< Encoder reading when the run started.
+    float armedPos() const { return armedPos_; }   ///< Encoder reading when closed loop was reached.
+    uint32_t axisError() const { return axisError_; }   ///< disarm_reason behind CALIB_STEP_FAILED, 0 for a timeout.
+
+private:
+    void enter(CALIB_STEP step, uint32_t nowMs) {
+        step_ = step;
+        phaseMs_ = nowMs;
+        phaseSeen_ = false;
+        if (onStep_) onStep_(step, nowMs - startMs_);
+    }
+
+    // A failed closed-loop-only arm means the ODrive no longer holds what we stored;
+    // the next run does the full sequence instead of retrying the same arm.
+    void fail(uint32_t axisError, uint32_t nowMs) {
+        odrive_.setState(AXIS_STATE_IDLE);
+        axisError_ = axisError;
+        storeMatches_ = false;
+        enter(CALIB_STEP_FAILED, nowMs);
+    }
+
+    // True once the ODrive has run the phase and dropped back to IDLE without an error.
+    bool phaseDone(ODriveAxisState phaseState, uint32_t nowMs) {
+        ODriveAxisState state = odrive_.getState();
+        if (state == phaseState) {
+            phaseSeen_ = true;
+            return false;
+        }
+        // Either we watched it run, or it finished before the first poll caught it.
+        if (state != AXIS_STATE_IDLE || !(phaseSeen_ || nowMs - phaseMs_ > CALIB_START_GRACE_MS)) return false;
+        // A phase that failed ends in IDLE as well; only the disarm reason tells them apart.
+        uint32_t error = (uint32_t)odrive_.getParameterAsInt("axis0.disarm_reason");
+        if (error != 0) {
+            fail(error, nowMs);
+            return false;
+        }
+        return true;
+    }
+
+    ODriveUART& odrive_;
+    CalibStepHook onStep_;
+    CALIB_STEP step_ = CALIB_STEP_IDLE;
+    uint32_t startMs_ = 0;
+    uint32_t phaseMs_ = 0;
+    uint32_t lastPollMs_ = 0;
+    bool phaseSeen_ = false;   // ODrive has been seen in the requested state.
+    bool storeMatches_ = false;
+    bool waitRelease_ = false;
+    float startPos_ = 0.0f;
+    float armedPos_ = 0.0f;
+    uint32_t axisError_ = 0;
+};
+
+#endif // CALIBSEQUENCER_H
@@ -2,76 +2,432 @@
 #include "EVT_ODriver.h"
 #include "EVT_RC.h"           // For channels array
 #include "EVT_StateMachine.h" // For SetErrorState function
+#include "EVT_EventLog.h"
+#include "EVT_ErrorCodes.h"
+#include "EVT_FaultManager.h"
+#include "EVT_CalibStore.h"
+#include "EndpointCapture.h"
+#include "CalibSequencer.h"
+#include "RelayAutoTune.h"
+#include "EVT_SteerTrajectory.h"
+#include "EVT_Capture.h"
+#include "EVT_CommandBus.h"
+#include "EVT_Ethernet.h"
+#include "EVT_Params.h"
 // Create a reference to Serial6 for ODrive.
 HardwareSerial &odrive_serial = Serial6;
+static CaptureStream odrive_capture(odrive_serial, CAPTURE_PORT_SERIAL6);
 
-// Define the ODriveUART object.
-ODriveUART odrive(odrive_serial);
+// Define the ODriveUART object. It talks through the capture tap so a wire capture sees both directions.
+ODriveUART odrive(odrive_capture);
 
 // Define global variables.
 bool systemInitialized = false;
-String odrvDebug = "";  // Added definition for odrvDebug.
+char odrvDebug[ODRV_DEBUG_LEN] = "";
 float lastTargetPosition = 0.0f;
+ODriveFeedback lastOdrvFeedback = {0.0f, 0.0f};
 float steeringZeroOffset  = 0.0f;  // Will be set to the midpoint (‑0.665) after calibration.
 
 static bool   errorClearFlag          = false;
 static float  currentSteeringOffset   = 0.0f;
+static bool   midpointSet             = false;  // Steering re-centred on calibRecord.steeringZero since the last arm.
+
+// -------------------------------------------------------------------------------------------------
+//                                         FEEDBACK
+// -------------------------------------------------------------------------------------------------
+// Position and velocity are requested at ODRV_FEEDBACK_HZ and the reply is parsed as
+// it arrives on later loops, so lastOdrvFeedback follows the axis for telemetry and
+// the black box without a blocking round trip in the control path. The request is
+// staged on the command bus and goes out with the steering line in the loop's one
+// ODrive write. Anything that makes a blocking ODriveUART read calls
+// settleOdrvFeedback() first, or it would take the outstanding reply for its own.
+static const uint32_t ODRV_FEEDBACK_PERIOD_MS  = 1000 / ODRV_FEEDBACK_HZ;
+static const uint32_t ODRV_FEEDBACK_TIMEOUT_MS = 20;   // Reply lost; ask again.
+
+static bool     feedbackPending   = false;
+static uint32_t feedbackRequestMs = 0;
+static char     feedbackLine[32];
+static uint8_t  feedbackLength    = 0;
+static uint32_t feedbackReadMs    = 0;     // millis() of the last parsed reply.
+
+// Consumes what has arrived of the reply. True once the whole line was read.
+static bool readFeedbackReply() {
+    while (odrive_capture.available()) {
+        char c = odrive_capture.read();
+        if (c == '\n') {
+            feedbackLine[feedbackLength] = '\0';
+            char* end;
+            float pos = strtof(feedbackLine, &end);
+            if (end != feedbackLine && *end == ' ') {
+                lastOdrvFeedback.pos = pos;
+                lastOdrvFeedback.vel = strtof(end + 1, NULL);
+                feedbackReadMs = millis();
+            }
+            feedbackLength = 0;
+            feedbackPending = false;
+            return true;
+        }
+        if (c != '\r' && feedbackLength < sizeof(feedbackLine) - 1) {
+            feedbackLine[feedbackLength++] = c;
+        }
+    }
+    return false;
+}
+
+static void settleOdrvFeedback() {
+    // A request still waiting for the flush gets no reply; withdraw it instead.
+    if (cancelCommand(COMMAND_SLOT_ODRIVE_FEEDBACK)) feedbackPending = false;
+    uint32_t start = millis();
+    while (feedbackPending && !readFeedbackReply() && millis() - start < ODRV_FEEDBACK_TIMEOUT_MS) {
+    }
+    feedbackPending = false;
+    feedbackLength = 0;
+}
+
+void serviceOdrvFeedback() {
+    // The sequencer makes blocking reads of its own while it runs.
+    if (!systemInitialized || isCalibrationRunning()) return;
+    uint32_t now = millis();
+    if (feedbackPending && !readFeedbackReply()) {
+        if (now - feedbackRequestMs < ODRV_FEEDBACK_TIMEOUT_MS) return;
+        feedbackPending = false;
+        feedbackLength = 0;
+    }
+    if (now - feedbackRequestMs < ODRV_FEEDBACK_PERIOD_MS) return;
+    // Drop a late reply to an earlier request so the next line is the answer to this one.
+    while (odrive_capture.available()) {
+        odrive_capture.read();
+    }
+    // The text never changes, so it has to be forced past the bus's unchanged-command check.
+    forceCommandResend(COMMAND_SLOT_ODRIVE_FEEDBACK);
+    beginCommand(COMMAND_SLOT_ODRIVE_FEEDBACK).print("f 0\n");
+    feedbackPending = true;
+    feedbackRequestMs = now;
+}
 
 // -------------------------------------------------------------------------------------------------
 //                                   CALIBRATION ROUTINES
 // -------------------------------------------------------------------------------------------------
-void initCalibration() {
-    // Ensure no previous errors are interfering.
-    odrive.clearErrors();
-    Serial.println("Init Calibration Triggered via SBUS Channel 5!");
+// Calibration runs as a step sequencer (CalibSequencer.h) driven from
+// updateOdrvControl(); these wrap it with the firmware's side effects.
 
-    // Capture the current encoder reading BEFORE doing any calibration.
-    ODriveFeedback fb = odrive.getFeedback();
-    float originalZero = fb.pos;
-    delay(1000);  // Small delay for stability.
+// How far the ODrive's calibration may drift from the stored record and still count as the same.
+static const float CALIB_MATCH_RESISTANCE = 0.005f;  // Ohm
+static const float CALIB_MATCH_OFFSET     = 0.01f;   // Turns
 
-    // Perform motor calibration. Note that this step might move the motor.
-    Serial.println("Running motor calibration...");
-    odrive.setState(AXIS_STATE_MOTOR_CALIBRATION);
-    delay(4000);
-    odrive.clearErrors();
+static void logCalibrationStep(CALIB_STEP step, uint32_t msSinceStart) {
+    logEvent(EVT_CALIBRATION, LOC_ODRIVE, step, (int32_t)msSinceStart);
+}
 
-    // Now run the encoder offset calibration.
-    Serial.println("Running encoder offset calibration...");
-    odrive.setState(AXIS_STATE_ENCODER_OFFSET_CALIBRATION);
-    delay(4000);
-    odrive.clearErrors();
+static CalibSequencer calibration(odrive, logCalibrationStep);
+
+static bool calibrationValuesMatch() {
+    float resistance = odrive.getParameterAsFloat("axis0.config.motor.phase_resistance");
+    float offset     = odrive.getParameterAsFloat("axis0.commutation_mapper.config.offset");
+    return calibRecord.motorPhaseResistance > 0.0f &&
+           fabsf(resistance - calibRecord.motorPhaseResistance) < CALIB_MATCH_RESISTANCE &&
+           fabsf(offset - calibRecord.commutationOffset) < CALIB_MATCH_OFFSET;
+}
 
-    // For diagnostic purposes, we read the post‑calibration encoder value.
-    fb = odrive.getFeedback();
-    Serial.print("Post‑calibration encoder reading (for diagnostics): ");
-    Serial.println(String(fb.pos, 2));
+// Records what the ODrive measured so the next boot can skip motor/encoder calibration.
+static void storeCalibrationValues() {
+    calibRecord.motorPhaseResistance = odrive.getParameterAsFloat("axis0.config.motor.phase_resistance");
+    calibRecord.motorPhaseInductance = odrive.getParameterAsFloat("axis0.config.motor.phase_inductance");
+    calibRecord.commutationOffset    = odrive.getParameterAsFloat("axis0.commutation_mapper.config.offset");
+    if (!saveCalibration()) {
+        reportFault(FAULT_WARNING, ERR_ODRIVE, "Calibration store write failed");
+    }
+    calibration.setStoreMatches(true);
+}
 
-    // Use the captured value for diagnostics only; the functional zero will be set later.
-    steeringZeroOffset = originalZero;
-    Serial.print("Steering zero offset set to pre‑calibration value: ");
-    Serial.println(String(steeringZeroOffset, 2));
+static void onCalibrationStarted() {
+    // Use the captured value for diagnostics only; the functional zero is set once armed.
+    steeringZeroOffset = calibration.startPos();
     lastTargetPosition = steeringZeroOffset;
+}
 
-    // Enable closed‑loop control with a retry loop.
-    unsigned long startTime = millis();
-    while (odrive.getState() != AXIS_STATE_CLOSED_LOOP_CONTROL && (millis() - startTime < 5000)) {
-        odrive.clearErrors();
-        odrive.setState(AXIS_STATE_CLOSED_LOOP_CONTROL);
-        Serial.println("Attempting to enable closed loop control...");
-        delay(10);
+void startCalibration() {
+    settleOdrvFeedback();
+    calibration.start(false, millis());
+    onCalibrationStarted();
+}
+
+void startClosedLoopOnly() {
+    settleOdrvFeedback();
+    calibration.start(true, millis());
+    onCalibrationStarted();
+}
+
+void prepareOdrvRearm() {
+    odrive.clearErrors();
+    odrive.setState(AXIS_STATE_IDLE);
+    // Without a power cycle the ODrive still holds the motor/encoder calibration it armed with.
+    if (systemInitialized) {
+        calibration.setStoreMatches(true);
     }
+    systemInitialized = false;
+}
 
-    // Set the controller's input mode to TRAP_TRAJ.
-    Serial.println("Setting input mode to TRAP_TRAJ...");
-    odrive_serial.println("w axis0.controller.config.input_mode 1");
-    delay(100);
+void abortCalibration() {
+    calibration.abort(millis());
+}
 
-    Serial.println("ODrive calibration complete. Running in closed loop control at the pre‑calibration zero.");
+bool isCalibrationRunning() {
+    return calibration.running();
+}
+
+CALIB_STEP getCalibrationStep() {
+    return calibration.step();
+}
+
+uint8_t getCalibrationProgress() {
+    return calibration.progress();
+}
+
+CALIB_STEP serviceCalibration() {
+    settleOdrvFeedback();
+    CALIB_STEP before = calibration.step();
+    bool wasRunning = calibration.running();
+    CALIB_STEP step = calibration.service(channels[5] > rcSwitches.calibStart,
+                                          channels[5] < rcSwitches.calibAbort, millis());
+    if (!wasRunning && calibration.running()) {
+        onCalibrationStarted();
+    }
+    if (step == before) return step;
+
+    if (step == CALIB_STEP_DONE) {
+        if (!calibration.storeMatches()) {
+            storeCalibrationValues();
+        }
+        // Start the setpoint stream from where the axis actually is.
+        resetSteeringTrajectory(calibration.armedPos());
+    } else if (step == CALIB_STEP_FAILED) {
+        uint32_t errorCode = calibration.axisError();
+        if (errorCode != ODRIVE_ERROR_NONE) {
+            char description[128];
+            odriveErrorToString(errorCode, description, sizeof(description));
+            logEvent(EVT_ODRIVE_ERROR, LOC_ODRIVE, (int32_t)errorCode);
+            reportFault(FAULT_WARNING, ERR_ODRIVE, description);
+        } else {
+            reportFault(FAULT_WARNING, ERR_ODRIVE, "Calibration step timed out");
+        }
+    }
+    return step;
+}
+
+// -------------------------------------------------------------------------------------------------
+//                                   ENDPOINT CAPTURE
+// -------------------------------------------------------------------------------------------------
+// In IDLE the Pi can record the steering hard stops and the stick travel:
+//   CALBEGIN   -> CALOK    disarms the axis; turn the wheels stop to stop and move every stick
+//   CALSAVE    -> CALOK,<left>,<right>,<stick min>,<stick max> or CALERR,<reason>
+//   CALCANCEL  -> CALOK
+// Reasons: busy, idle, steering, stick, storage, format. Leaving IDLE cancels.
+static const uint32_t CAPTURE_POLL_MS = 20;   // One getFeedback() round trip per poll.
+
+static EndpointCapture endpointCapture;
+
+static int handleEndpointMessage(const char* data, uint16_t length, bool truncated, char* reply, size_t size) {
+    if (length < 3 || strncmp(data, "CAL", 3) != 0) return -1;
+    if (truncated || length > 16) return snprintf(reply, size, "CALERR,format");
+    char text[17];
+    memcpy(text, data, length);
+    text[length] = '\0';
+
+    if (strcmp(text, "CALBEGIN") == 0) {
+        if (GetState() != IDLE || isCalibrationRunning()) return snprintf(reply, size, "CALERR,busy");
+        // The axis has to be idle for the wheels to be turned by hand; the next trigger re-arms it.
+        prepareOdrvRearm();
+        endpointCapture.begin();
+        return snprintf(reply, size, "CALOK");
+    }
+    if (strcmp(text, "CALSAVE") == 0) {
+        const char* reason = "";
+        CalibRecord captured = calibRecord;
+        if (!endpointCapture.finish(captured, &reason)) return snprintf(reply, size, "CALERR,%s", reason);
+        calibRecord = captured;
+        if (!saveCalibration()) return snprintf(reply, size, "CALERR,storage");
+        const uint8_t s = CALIB_CAPTURE_STEER_CHANNEL;
+        return snprintf(reply, size, "CALOK,%.4f,%.4f,%u,%u", calibRecord.steeringLeftPos,
+                        calibRecord.steeringRightPos, calibRecord.sbusMin[s], calibRecord.sbusMax[s]);
+    }
+    if (strcmp(text, "CALCANCEL") == 0) {
+        endpointCapture.cancel();
+        return snprintf(reply, size, "CALOK");
+    }
+    return -1;
+}
+
+void serviceEndpointCapture() {
+    if (!endpointCapture.active()) return;
+    if (GetState() != IDLE) {
+        endpointCapture.cancel();
+        return;
+    }
+    static uint32_t lastPollMs = 0;
+    if (millis() - lastPollMs < CAPTURE_POLL_MS) return;
+    lastPollMs = millis();
+    settleOdrvFeedback();
+    endpointCapture.addSteering(odrive.getFeedback().pos);
+    endpointCapture.addSticks(channels);
+}
+
+// -------------------------------------------------------------------------------------------------
+//                                   STEERING AUTO-TUNE
+// -------------------------------------------------------------------------------------------------
+// In RC, with the axis armed and the stick centred, the Pi can measure the rack's
+// ultimate gain and period with RelayAutoTune (tools/autotune_loop_sim.cpp runs the
+// same path on a host):
+//   TUNEBEGIN  -> TUNEOK   ODrive to velocity control, relay around the midpoint
+//   TUNEABORT  -> TUNEOK
+//   TUNESTATUS -> TUNEOK,idle | TUNEOK,running,<cycles> | TUNEOK,done,<ku>,<pu>,<kp>,<ki>,<kd>
+//                 | TUNEOK,failed,<reason>
+// TUNEBEGIN answers TUNEERR,<reason> when a guard is already tripped. Reasons:
+// busy, state, stick, feedback, limit, swing, abort, timeout, format. The gains are
+// for the position loop around the ODrive's velocity loop (pos_gain units); they
+// are reported, not applied. Whatever ends a run, the rack is held where it
+// stopped and position control is restored.
+static const float    TUNE_AMPLITUDE     = 1.0f;      // Relay velocity, turns/s.
+static const float    TUNE_HYSTERESIS    = 0.002f;    // Turns.
+static const float    TUNE_MAX_SWING     = 0.3f;      // Turns from the midpoint; a limit cycle stays far inside.
+static const float    TUNE_LIMIT_MARGIN  = 0.2f;      // Turns inside each stored hard stop.
+static const uint32_t TUNE_STALE_MS      = 50;        // Feedback older than this stops the run.
+static const uint32_t TUNE_TIMEOUT_US    = 20000000;
+
+static RelayAutoTune steeringTune(0.0f, TUNE_AMPLITUDE, TUNE_HYSTERESIS);
+static float         tuneSetpoint  = 0.0f;
+static float         tuneOutput    = 0.0f;
+static uint32_t      tuneFeedbackMs = 0;   // feedbackReadMs the tuner last saw.
+static const char*   tuneReason    = "";   // Why the last run stopped early.
+
+static bool steeringTuneRunning() {
+    return steeringTune.status() == TUNE_RUNNING;
+}
+
+// The dead-band updateOdrvControl() snaps to centre.
+static bool steeringStickCentred() {
+    return channels[3] >= 1200 && channels[3] <= 1260;
+}
+
+// The first guard that trips, or NULL. Checked before a run and on every loop of it.
+static const char* steeringTuneGuard() {
+    if (GetState() != RC || !systemInitialized || isCalibrationRunning()) return "state";
+    if (!steeringStickCentred()) return "stick";
+    if (feedbackReadMs == 0 || millis() - feedbackReadMs > TUNE_STALE_MS) return "feedback";
+    float pos = lastOdrvFeedback.pos;
+    if (pos < calibRecord.steeringLeftPos + TUNE_LIMIT_MARGIN ||
+        pos > calibRecord.steeringRightPos - TUNE_LIMIT_MARGIN) return "limit";
+    if (steeringTuneRunning() && fabsf(pos - tuneSetpoint) > TUNE_MAX_SWING) return "swing";
+    return NULL;
+}
+
+// Holds the rack where it is and hands the axis back to the steering map.
+static void stopSteeringTune(const char* reason) {
+    if (steeringTuneRunning()) steeringTune.cancel();
+    tuneReason = reason;
+    settleOdrvFeedback();
+    float pos = lastOdrvFeedback.pos;
+    // "p" zeroes input_vel while still in velocity control, so the rack stops
+    // before the mode changes. Both go out at once, behind the bus's back.
+    odrive.setPosition(pos);
+    // Control mode 3 = POSITION_CONTROL.
+    odrive.setParameter("axis0.controller.config.control_mode", "3");
+    forceCommandResend(COMMAND_SLOT_STEERING);
+    resetSteeringTrajectory(pos);
+}
+
+static int handleTuneMessage(const char* data, uint16_t length, bool truncated, char* reply, size_t size) {
+    if (length < 4 || strncmp(data, "TUNE", 4) != 0) return -1;
+    if (truncated || length > 16) return snprintf(reply, size, "TUNEERR,format");
+    char text[17];
+    memcpy(text, data, length);
+    text[length] = '\0';
+
+    if (strcmp(text, "TUNEBEGIN") == 0) {
+        if (steeringTuneRunning() || endpointCapture.active()) return snprintf(reply, size, "TUNEERR,busy");
+        const char* reason = steeringTuneGuard();
+        if (reason != NULL) return snprintf(reply, size, "TUNEERR,%s", reason);
+        settleOdrvFeedback();
+        // Control mode 2 = VELOCITY_CONTROL; input mode stays PASSTHROUGH.
+        odrive.setParameter("axis0.controller.config.control_mode", "2");
+        tuneSetpoint = calibRecord.steeringZero;
+        tuneOutput = 0.0f;
+        tuneFeedbackMs = feedbackReadMs;
+        tuneReason = "";
+        steeringTune.setTimeout(TUNE_TIMEOUT_US);
+        steeringTune.start(tuneSetpoint, micros());
+        return snprintf(reply, size, "TUNEOK");
+    }
+    if (strcmp(text, "TUNEABORT") == 0) {
+        if (steeringTuneRunning()) stopSteeringTune("abort");
+        return snprintf(reply, size, "TUNEOK");
+    }
+    if (strcmp(text, "TUNESTATUS") == 0) {
+        if (steeringTuneRunning()) return snprintf(reply, size, "TUNEOK,running,%u", steeringTune.cycles());
+        if (steeringTune.status() == TUNE_DONE) {
+            const TuneResult& r = steeringTune.result();
+            return snprintf(reply, size, "TUNEOK,done,%.4f,%.4f,%.4f,%.4f,%.5f", r.ku, r.pu, r.kp, r.ki, r.kd);
+        }
+        if (tuneReason[0] != '\0') return snprintf(reply, size, "TUNEOK,failed,%s", tuneReason);
+        return snprintf(reply, size, "TUNEOK,idle");
+    }
+    return -1;
+}
+
+void serviceSteeringTune() {
+    if (!steeringTuneRunning()) return;
+    const char* reason = steeringTuneGuard();
+    if (reason != NULL) {
+        stopSteeringTune(reason);
+        return;
+    }
+    // The relay only switches on a fresh position, as it would on a sampled loop.
+    if (feedbackReadMs != tuneFeedbackMs) {
+        tuneFeedbackMs = feedbackReadMs;
+        tuneOutput = steeringTune.update(lastOdrvFeedback.pos, micros());
+    }
+    if (steeringTune.status() == TUNE_DONE) {
+        const TuneResult& r = steeringTune.result();
+        logEvent(EVT_TUNE, LOC_ODRIVE, (int32_t)(r.ku * 1000.0f), (int32_t)(r.pu * 1e6f));
+        stopSteeringTune("");
+        return;
+    }
+    if (steeringTune.status() == TUNE_FAILED) {
+        stopSteeringTune("timeout");
+        return;
+    }
+    ODriveUART::printVelocity(beginCommand(COMMAND_SLOT_STEERING), tuneOutput, 0.0f);
+}
+
+// Position and velocity are the last feedback read; sampling never adds an ODrive round trip.
+static void sampleSteeringTopic(void* payload) {
+    TelemetrySteering &t = *(TelemetrySteering*)payload;
+    t.pos = lastOdrvFeedback.pos;
+    t.vel = lastOdrvFeedback.vel;
+    t.target = lastTargetPosition;
+    t.calibrationProgress = getCalibrationProgress();
+    memset(t.reserved, 0, sizeof(t.reserved));
+}
+
+// A new endpoint moves the midpoint the steering map centres on.
+static void applySteeringEndpoints() {
+    calibRecord.steeringZero = (calibRecord.steeringLeftPos + calibRecord.steeringRightPos) / 2.0f;
+    if (systemInitialized) {
+        steeringZeroOffset = calibRecord.steeringZero;
+    }
 }
 
 void setupOdrv() {
+    // Defaults first, so the endpoints below register valid values even without an ODrive.
+    resetCalibrationDefaults();
+    addParameter(PARAM_STEER_LEFT_POS, "steer.left_pos", &calibRecord.steeringLeftPos, -5.0f, -0.1f,
+                 applySteeringEndpoints, false);
+    addParameter(PARAM_STEER_RIGHT_POS, "steer.right_pos", &calibRecord.steeringRightPos, 0.1f, 5.0f,
+                 applySteeringEndpoints, false);
+
     odrive_serial.begin(115200);
+    bindCommandPort(COMMAND_PORT_ODRIVE, &odrive_capture);
+    addTelemetryTopic(TELEMETRY_TOPIC_STEERING, ODRV_TOPIC_STEERING_HZ, sampleSteeringTopic, sizeof(TelemetrySteering));
     Serial.println("Established ODrive communication");
     delay(500);
     Serial.println("Waiting for ODrive...");
@@ -83,38 +439,42 @@ void setupOdrv() {
         Serial.println("ODrive not found! Proceeding without ODrive.");
     } else {
         Serial.println("Found ODrive! Waiting for calibration trigger via SBUS channel 5...");
+        if (!loadCalibration()) {
+            Serial.println("No valid stored calibration, full calibration required.");
+        } else if (calibrationValuesMatch()) {
+            calibration.setStoreMatches(true);
+            Serial.println("Stored calibration matches ODrive, motor/encoder calibration will be skipped.");
+        } else {
+            Serial.println("Stored calibration does not match ODrive, full calibration required.");
+        }
     }
+    addLinkHandler(handleEndpointMessage);
+    addLinkHandler(handleTuneMessage);
     Serial.println("ODrive setup complete. System idle until calibration.");
 }
 
 // -------------------------------------------------------------------------------------------------
 //                                   ERROR‑HANDLING HELPERS
 // -------------------------------------------------------------------------------------------------
-String odriveErrorToString(uint32_t err) {
-    if (err == ODRIVE_ERROR_NONE) return "None";
-    String s = "";
-    for (const auto& [errorCode, errorString] : odrvErrorMap) {
-        if (err & errorCode) {
-            if (s != "") s += ", ";
-            s += errorString;
-        }
-    }
-    return s;
-}
-
 void printOdriveError() {
+    settleOdrvFeedback();
     uint32_t errorCode = odrive.getParameterAsInt("axis0.error");
+    char description[128];
+    odriveErrorToString(errorCode, description, sizeof(description));
     Serial.print("ODrive Error: ");
-    Serial.println(odriveErrorToString(errorCode));
+    Serial.println(description);
 }
 
 void odrvErrorCheck() {
+    // Calibration clears errors between phases itself and reports its own failures.
+    if (isCalibrationRunning()) return;
+    settleOdrvFeedback();
     uint32_t errorCode = odrive.getParameterAsInt("axis0.error");
     if (errorCode != ODRIVE_ERROR_NONE) {
-        String errorDescription = odriveErrorToString(errorCode);
-        Serial.print("ODrive Error: ");
-        Serial.println(errorDescription);
-        SetErrorState(ERR_ODRIVE, errorDescription.c_str());
+        char description[128];
+        odriveErrorToString(errorCode, description, sizeof(description));
+        logEvent(EVT_ODRIVE_ERROR, LOC_ODRIVE, (int32_t)errorCode);
+        reportFault(FAULT_CRITICAL, ERR_ODRIVE, description);
     }
 }
 
@@ -127,48 +487,49 @@ void updateOdrvControl() {
 
     // Handle SBUS channel 5 for error clear / re‑cal.
     int ch_clear = channels[5];
-    if (ch_clear > 1500 && !errorClearFlag) {
+    if (ch_clear > rcSwitches.recalibrate && !errorClearFlag) {
         errorClearFlag = true;
-        if (odrive.getState() != AXIS_STATE_CLOSED_LOOP_CONTROL) {
-            Serial.println("ODrive fault reset trigger hit. Recalibrating...");
-            odrive.clearErrors();
+        if (!isCalibrationRunning()) {
+            // Recalibrate whether or not the axis is currently in closed loop.
             systemInitialized = false;
-            initCalibration();
-            systemInitialized = true;
-        } else {
-            Serial.println("SBUS channel 4 activated: Clearing ODrive errors.");
-            odrive.clearErrors();
-            initCalibration();
+            calibration.setStoreMatches(false);
+            startCalibration();
         }
     }
-    if (ch_clear < 1500 && errorClearFlag) {
+    if (ch_clear < rcSwitches.recalibrate && errorClearFlag) {
         errorClearFlag = false;
     }
 
-    // Wait for first‑time calibration.
-    if (!systemInitialized) {
-        if (channels[5] > 900) {
-            initCalibration();
+    // Steering is not commanded until the sequencer has armed the ODrive; channel 5 starts it.
+    if (!systemInitialized || isCalibrationRunning()) {
+        CALIB_STEP before = getCalibrationStep();
+        if (serviceCalibration() == CALIB_STEP_DONE && before != CALIB_STEP_DONE) {
             systemInitialized = true;
-        } else {
-            Serial.print("Waiting for calibration trigger, SBUS channel 5: ");
-            Serial.println(String(channels[5]));
-            return;
+            midpointSet = false;
         }
+        return;
     }
 
+    // The auto-tuner has the axis until serviceSteeringTune() hands it back.
+    if (steeringTuneRunning()) return;
+
     // ----------------------------------------------------------
     // NEW STEERING MAPPING (no decay)
     // ----------------------------------------------------------
 
-    // Encoder extrema and derived midpoint
-    const float MAX_LEFT_POS  =  -2.33f;   // Hard left encoder reading
-    const float MAX_RIGHT_POS = 1.0f;  // Hard right encoder reading
-    const float MID_POS       = (MAX_LEFT_POS + MAX_RIGHT_POS) / 2.0f;   // -0.665
-    const float MAX_OFFSET    = MAX_LEFT_POS - MID_POS;                  // 1.665 (magnitude)
+    // Encoder extrema and derived midpoint, from the calibration store (defaults -2.33 / 1.0)
+    const float MAX_LEFT_POS  = calibRecord.steeringLeftPos;
+    const float MAX_RIGHT_POS = calibRecord.steeringRightPos;
+    const float MID_POS       = calibRecord.steeringZero;               // -0.665 by default
+    // Signed travel from the midpoint to each stop; the rack need not be symmetric.
+    const float LEFT_OFFSET   = MAX_LEFT_POS - MID_POS;                  // -1.665 by default
+    const float RIGHT_OFFSET  = MAX_RIGHT_POS - MID_POS;                 // +1.665 by default
+
+    // Stick endpoints for CH3; the centre dead-band 1200-1260 stays fixed.
+    const float STEER_MIN = calibRecord.sbusMin[3];   // 410 by default
+    const float STEER_MAX = calibRecord.sbusMax[3];   // 1811 by default
 
-    // One‑time midpoint assignment after calibration
-    static bool midpointSet = false;
+    // Midpoint assignment once after each calibration or re-arm
     if (!midpointSet) {
         steeringZeroOffset  = MID_POS;
         lastTargetPosition  = steeringZeroOffset;
@@ -179,14 +540,14 @@ void updateOdrvControl() {
     int ch_steer = channels[3];
 
     if (ch_steer < 1200) {
-        // Map 410‑>MAX_LEFT_POS, 1200‑>MID_POS
-        float normalized = (1200.0f - ch_steer) / float(1200 - 410); // 0‑>1
-        currentSteeringOffset =  normalized * MAX_OFFSET;
+        // Map STEER_MIN‑>MAX_LEFT_POS, 1200‑>MID_POS
+        float normalized = (1200.0f - ch_steer) / (1200.0f - STEER_MIN); // 0‑>1
+        currentSteeringOffset = normalized * LEFT_OFFSET;
 
     } else if (ch_steer > 1260) {
-        // Map 1260‑>MID_POS, 1811‑>MAX_RIGHT_POS
-        float normalized = (ch_steer - 1260.0f) / float(1811 - 1260);
-        currentSteeringOffset = -normalized * MAX_OFFSET;
+        // Map 1260‑>MID_POS, STEER_MAX‑>MAX_RIGHT_POS
+        float normalized = (ch_steer - 1260.0f) / (STEER_MAX - 1260.0f);
+        currentSteeringOffset = normalized * RIGHT_OFFSET;
 
     } else {
         // Dead‑band – snap to centre
@@ -195,18 +556,18 @@ void updateOdrvControl() {
 
     // Compute and send target
     lastTargetPosition = steeringZeroOffset + currentSteeringOffset;
-    odrive.setPosition(lastTargetPosition, 0.0f);   // zero velocity‑FF to avoid overshoot
+    // The trajectory generator turns the raw target into a jerk-limited
+    // pos/vel/torque stream, so stick steps no longer overshoot.
+    setSteeringTarget(lastTargetPosition);
+    serviceSteeringTrajectory();
 
     // Non‑blocking debug print every 1000 ms with carriage return.
     static unsigned long lastDebugPrint = 0;
     if (millis() - lastDebugPrint > 1000) {
-        ODriveFeedback fb = odrive.getFeedback();
-        odrvDebug = String("Steering Target: ") + String(lastTargetPosition, 2) +
-                    " | ODrive Pos: " + String(fb.pos, 2) +
-                    " | CH3: " + String(ch_steer);
-                   
-                    
-        Serial.print(odrvDebug + "\r");
+        ODriveFeedback fb = lastOdrvFeedback;
+        snprintf(odrvDebug, sizeof(odrvDebug), "Steering Target: %.2f | ODrive Pos: %.2f | CH3: %d",
+                 lastTargetPosition, fb.pos, ch_steer);
+        logEvent(EVT_STEERING, LOC_ODRIVE, (int32_t)(lastTargetPosition * 1000.0f), (int32_t)(fb.pos * 1000.0f));
         lastDebugPrint = millis();
     }
 }
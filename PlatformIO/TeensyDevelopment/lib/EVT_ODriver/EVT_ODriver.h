@@ -3,14 +3,22 @@
 
 #include <Arduino.h>
 #include <ODriveUART.h>
+#include "CalibSequencer.h"
 #include <SoftwareSerial.h>
-#include <map> // Include for std::map
 
 #define STATUS_LED_PIN 13
+#define ODRV_DEBUG_LEN 96
+#define ODRV_TOPIC_STEERING_HZ 50  // Steering topic on the UDP telemetry publisher.
+#define ODRV_FEEDBACK_HZ 200       // Position/velocity polls, the black box rate.
 
 // Global ODrive flag and debug string.
 extern bool systemInitialized;
-extern String odrvDebug;
+extern char odrvDebug[ODRV_DEBUG_LEN];
+
+// Last commanded steering target and the most recent feedback read from the ODrive
+// (refreshed at ODRV_FEEDBACK_HZ by serviceOdrvFeedback() once the axis is armed).
+extern float lastTargetPosition;
+extern ODriveFeedback lastOdrvFeedback;
 
 // Declare the ODriveUART object so it can be used across modules.
 extern ODriveUART odrive;
@@ -20,31 +28,60 @@ void setupOdrv();
 void odrvErrorCheck() ;
 void updateOdrvControl();
 void printOdriveError();
-void initCalibration();
-
-// Map of error codes to their corresponding strings
-static const std::map<uint32_t, String> odrvErrorMap = {
-    {ODRIVE_ERROR_INITIALIZING, "Initializing"},
-    {ODRIVE_ERROR_SYSTEM_LEVEL, "System Level"},
-    {ODRIVE_ERROR_TIMING_ERROR, "Timing Error"},
-    {ODRIVE_ERROR_MISSING_ESTIMATE, "Missing Estimate"},
-    {ODRIVE_ERROR_BAD_CONFIG, "Bad Config"},
-    {ODRIVE_ERROR_DRV_FAULT, "DRV Fault"},
-    {ODRIVE_ERROR_MISSING_INPUT, "Missing Input"},
-    {ODRIVE_ERROR_DC_BUS_OVER_VOLTAGE, "DC Bus Over Voltage"},
-    {ODRIVE_ERROR_DC_BUS_UNDER_VOLTAGE, "DC Bus Under Voltage"},
-    {ODRIVE_ERROR_DC_BUS_OVER_CURRENT, "DC Bus Over Current"},
-    {ODRIVE_ERROR_DC_BUS_OVER_REGEN_CURRENT, "DC Bus Over Regen Current"},
-    {ODRIVE_ERROR_CURRENT_LIMIT_VIOLATION, "Current Limit Violation"},
-    {ODRIVE_ERROR_MOTOR_OVER_TEMP, "Motor Over Temp"},
-    {ODRIVE_ERROR_INVERTER_OVER_TEMP, "Inverter Over Temp"},
-    {ODRIVE_ERROR_VELOCITY_LIMIT_VIOLATION, "Velocity Limit Violation"},
-    {ODRIVE_ERROR_POSITION_LIMIT_VIOLATION, "Position Limit Violation"},
-    {ODRIVE_ERROR_WATCHDOG_TIMER_EXPIRED, "Watchdog Timer Expired"},
-    {ODRIVE_ERROR_ESTOP_REQUESTED, "Estop Requested"},
-    {ODRIVE_ERROR_SPINOUT_DETECTED, "Spinout Detected"},
-    {ODRIVE_ERROR_BRAKE_RESISTOR_DISARMED, "Brake Resistor Disarmed"},
-    {ODRIVE_ERROR_THERMISTOR_DISCONNECTED, "Thermistor Disconnected"},
-    {ODRIVE_ERROR_CALIBRATION_ERROR, "Calibration Error"}
-    };
+
+/**
+ * @brief Keeps lastOdrvFeedback fresh without blocking: stages a feedback
+ *        request on the command bus at ODRV_FEEDBACK_HZ and reads the reply
+ *        on later calls. Call once per loop, before flushCommandBus(); does
+ *        nothing until the axis is armed.
+ */
+void serviceOdrvFeedback();
+
+/**
+ * @brief Kicks off motor + encoder calibration and returns immediately.
+ */
+void startCalibration();
+
+/**
+ * @brief Skips motor/encoder calibration and only arms closed loop.
+ *
+ * Used when the stored calibration record matches what the ODrive reports.
+ */
+void startClosedLoopOnly();
+
+/**
+ * @brief After an error reset where the ODrive kept power: clears its errors
+ *        and leaves the axis idle. If it had been armed, the next calibration
+ *        trigger only re-arms closed loop, from the measured position.
+ */
+void prepareOdrvRearm();
+
+/**
+ * @brief Samples the steering and sticks while a CALBEGIN endpoint capture
+ *        runs (see EVT_ODriver.cpp). Call once per loop.
+ */
+void serviceEndpointCapture();
+
+/**
+ * @brief Runs a TUNEBEGIN steering auto-tune (see EVT_ODriver.cpp) and stops
+ *        it when a guard trips. Call once per loop, before the state machine.
+ */
+void serviceSteeringTune();
+
+/**
+ * @brief Advances the sequencer; polls the ODrive at most every 50 ms.
+ *
+ * Channel 5 above rcSwitches.calibStart starts a run, once per press; after
+ * a failed or aborted run it has to drop and rise again. Pulling it back to
+ * off aborts the run. A failure reports a warning fault, with the axis error
+ * if the ODrive disarmed.
+ *
+ * @return The current step.
+ */
+CALIB_STEP serviceCalibration();
+void abortCalibration();
+bool isCalibrationRunning();
+CALIB_STEP getCalibrationStep();
+uint8_t getCalibrationProgress();  ///< 0-100, for telemetry.
+
 #endif // EVT_ODRIVER_H
@@ -0,0 +1,116 @@
+#ifndef EVT_PID_H
+#define EVT_PID_H
+
+// PID controller for the vehicle loops. Replaces AutoPID, whose double math has
+// no FPU support on the Cortex-M7 and whose derivative term was mis-scaled.
+
+#include <stdint.h>
+#include <qformat.h>
+
+/**
+ * @brief Converts a loop period in microseconds to seconds in the controller's number type.
+ */
+inline float pidSeconds(uint32_t dtUs, float) { return dtUs * 1e-6f; }
+inline util::q16 pidSeconds(uint32_t dtUs, util::q16) { return util::q16::fromRatio((int32_t)dtUs, 1000000); }
+
+/**
+ * @brief PID with the usual practical fixes, for float or util::q16.
+ *
+ * - dt comes from the caller's micros() so irregular loop timing is handled exactly.
+ * - Conditional integration: the integral only moves when the output is not
+ *   saturated, or when the error would pull it back out of saturation.
+ * - Derivative acts on the measurement (no kick on setpoint steps) through a
+ *   first-order low-pass with time constant derivTau.
+ * - Setpoint weighting: P acts on (b * setpoint - measurement); b < 1 softens
+ *   the response to setpoint steps without changing disturbance rejection.
+ */
+template <typename T>
+class PidController {
+public:
+    PidController(T kp, T ki, T kd, T outMin, T outMax)
+        : kp_(kp), ki_(ki), kd_(kd), outMin_(outMin), outMax_(outMax) {}
+
+    void setGains(T kp, T ki, T kd) {
+        kp_ = kp;
+        ki_ = ki;
+        kd_ = kd;
+    }
+    void setOutputRange(T outMin, T outMax) {
+        outMin_ = outMin;
+        outMax_ = outMax;
+    }
+    void setSetpointWeight(T b) { b_ = b; }
+    void setDerivativeFilter(T tauSeconds) { derivTau_ = tauSeconds; }
+
+    /**
+     * @brief Clears integral and derivative state. The next update() only primes the timing.
+     */
+    void reset() {
+        integral_ = T(0.0f);
+        deriv_ = T(0.0f);
+        primed_ = false;
+    }
+
+    /**
+     * @brief Runs one step.
+     *
+     * @param nowUs Caller's micros(); the first call after reset() just latches it.
+     * @return The new output, clamped to the output range.
+     */
+    T update(T setpoint, T measurement, uint32_t nowUs) {
+        if (!primed_) {
+            lastUs_ = nowUs;
+            lastMeasurement_ = measurement;
+            primed_ = true;
+        }
+        uint32_t dtUs = nowUs - lastUs_;
+        lastUs_ = nowUs;
+        return step(setpoint, measurement, pidSeconds(dtUs, T()));
+    }
+
+    /**
+     * @brief Runs one step with an explicit dt, for fixed-rate callers.
+     */
+    T step(T setpoint, T measurement, T dt) {
+        T error = setpoint - measurement;
+        T p = kp_ * (b_ * setpoint - measurement);
+
+        if (dt > T(0.0f)) {
+            // Filtered derivative of -measurement: d += (target - d) * dt / (tau + dt).
+            T dRaw = -(measurement - lastMeasurement_) / dt;
+            deriv_ += (dRaw - deriv_) * (dt / (derivTau_ + dt));
+        }
+        lastMeasurement_ = measurement;
+        T d = kd_ * deriv_;
+
+        T candidate = integral_ + ki_ * error * dt;
+        T unclamped = p + candidate + d;
+        bool pushingHigh = unclamped > outMax_ && error > T(0.0f);
+        bool pushingLow = unclamped < outMin_ && error < T(0.0f);
+        if (!pushingHigh && !pushingLow) {
+            integral_ = candidate;
+        }
+
+        T out = p + integral_ + d;
+        output_ = out > outMax_ ? outMax_ : (out < outMin_ ? outMin_ : out);
+        return output_;
+    }
+
+    T output() const { return output_; }
+    T integral() const { return integral_; }
+    void setIntegral(T integral) { integral_ = integral; }
+
+private:
+    T kp_, ki_, kd_;
+    T outMin_, outMax_;
+    T b_ = T(1.0f);
+    T derivTau_ = T(0.0f);
+    T integral_ = T(0.0f);
+    T deriv_ = T(0.0f);
+    T lastMeasurement_ = T(0.0f);
+    T output_ = T(0.0f);
+    uint32_t lastUs_ = 0;
+    bool primed_ = false;
+};
+
+#endif // EVT_PID_H
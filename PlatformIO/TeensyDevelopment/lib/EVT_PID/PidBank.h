@@ -0,0 +1,106 @@
+#ifndef PIDBANK_H
+#define PIDBANK_H
+
+// N float PID loops updated in one pass. Same control law as
+// PidController<float> (EVT_PID.h), but gains, limits and state live in
+// contiguous arrays so the inner loop is branch-free and streams through memory.
+
+#include <stdint.h>
+#include <math.h>
+
+/**
+ * @brief Structure-of-arrays PID bank sharing one dt per tick.
+ *
+ * Channels are addressed by index; callers keep their own enum of which loop is
+ * which (e.g. wheel speed 0/1, steering, current limit). Setpoints and
+ * measurements are passed as arrays too, so gathering them is the caller's one
+ * job per tick instead of every controller dereferencing its own pointers.
+ */
+template <int N>
+class PidBank {
+public:
+    PidBank() {
+        for (int i = 0; i < N; i++) {
+            kp[i] = ki[i] = kd[i] = 0.0f;
+            weight[i] = 1.0f;
+            derivTau[i] = 0.0f;
+            outMin[i] = -1.0f;
+            outMax[i] = 1.0f;
+        }
+        reset();
+    }
+
+    void configure(int i, float p, float in, float d, float lo, float hi) {
+        kp[i] = p;
+        ki[i] = in;
+        kd[i] = d;
+        outMin[i] = lo;
+        outMax[i] = hi;
+        cachedDt_ = -1.0f;
+    }
+    void setSetpointWeight(int i, float b) { weight[i] = b; }
+    void setDerivativeFilter(int i, float tauSeconds) {
+        derivTau[i] = tauSeconds;
+        cachedDt_ = -1.0f;
+    }
+
+    void reset() {
+        for (int i = 0; i < N; i++) {
+            integral[i] = deriv[i] = lastMeasurement[i] = output[i] = 0.0f;
+        }
+        primed_ = false;
+    }
+
+    /**
+     * @brief Steps every channel by dt seconds and writes the clamped outputs into output[].
+     */
+    void update(const float* setpoint, const float* measurement, float dt) {
+        if (!primed_) {
+            for (int i = 0; i < N; i++) lastMeasurement[i] = measurement[i];
+            primed_ = true;
+        }
+        if (dt <= 0.0f) return;
+        if (dt != cachedDt_) {
+            // The filter coefficient only changes with dt, so it is not recomputed every tick.
+            for (int i = 0; i < N; i++) derivAlpha[i] = dt / (derivTau[i] + dt);
+            cachedDt_ = dt;
+        }
+        const float invDt = 1.0f / dt;
+
+        for (int i = 0; i < N; i++) {
+            float error = setpoint[i] - measurement[i];
+            float p = kp[i] * (weight[i] * setpoint[i] - measurement[i]);
+
+            float dRaw = (lastMeasurement[i] - measurement[i]) * invDt;
+            deriv[i] += (dRaw - deriv[i]) * derivAlpha[i];
+            lastMeasurement[i] = measurement[i];
+            float d = kd[i] * deriv[i];
+
+            // Conditional integration as a select, so the loop has no branches.
+            float candidate = integral[i] + ki[i] * error * dt;
+            float unclamped = p + candidate + d;
+            // Non-short-circuit & and | keep this a select the compiler can vectorize.
+            bool windup = ((unclamped > outMax[i]) & (error > 0.0f)) | ((unclamped < outMin[i]) & (error < 0.0f));
+            float held = windup ? integral[i] : candidate;
+            integral[i] = held;
+
+            float out = p + held + d;
+            out = out > outMax[i] ? outMax[i] : out;
+            output[i] = out < outMin[i] ? outMin[i] : out;
+        }
+    }
+
+    // Public so telemetry and the auto-tuner can read or patch a channel directly.
+    float kp[N], ki[N], kd[N];
+    float weight[N], derivTau[N];
+    float outMin[N], outMax[N];
+    float integral[N], deriv[N], lastMeasurement[N];
+    float output[N];
+
+private:
+    float derivAlpha[N];
+    float cachedDt_ = -1.0f;
+    bool primed_ = false;
+};
+
+#endif // PIDBANK_H
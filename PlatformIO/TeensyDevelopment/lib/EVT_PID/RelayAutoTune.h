@@ -0,0 +1,164 @@
+#ifndef RELAYAUTOTUNE_H
+#define RELAYAUTOTUNE_H
+
+// Relay-feedback (Astrom-Hagglund) auto-tuner.
+
+#include <stdint.h>
+#include <math.h>
+
+/**
+ * @brief Tuning rule applied to the measured ultimate gain and period.
+ */
+enum TUNE_RULE {
+    TUNE_ZIEGLER_NICHOLS,  ///< Aggressive, ~25% overshoot.
+    TUNE_TYREUS_LUYBEN     ///< Slower, far less overshoot; the usual pick for steering.
+};
+
+enum TUNE_STATUS {
+    TUNE_IDLE,
+    TUNE_RUNNING,
+    TUNE_DONE,
+    TUNE_FAILED            ///< Timed out before the oscillation settled.
+};
+
+struct TuneResult {
+    float ku;   ///< Ultimate gain
+    float pu;   ///< Ultimate period, seconds
+    float kp, ki, kd;
+};
+
+/**
+ * @brief Drives the loop with a relay around the setpoint and measures the limit cycle.
+ *
+ * Non-blocking: call update() every loop with the latest measurement and feed
+ * the returned output to the actuator. The relay switches between
+ * bias + amplitude and bias - amplitude with +-hysteresis around the setpoint,
+ * the same on/off shape AutoPIDRelay drives through its relayState pointer
+ * (see relayState()). After minCycles periods whose amplitude and period agree
+ * within 5%, the ultimate gain Ku = 4d / (pi * sqrt(a^2 - eps^2)) and period
+ * Pu give the PID gains.
+ */
+class RelayAutoTune {
+public:
+    static const uint8_t MAX_CYCLES = 12;
+
+    RelayAutoTune(float bias, float amplitude, float hysteresis)
+        : bias_(bias), amplitude_(amplitude), hysteresis_(hysteresis) {}
+
+    void setRule(TUNE_RULE rule) { rule_ = rule; }
+    void setMinCycles(uint8_t cycles) { minCycles_ = cycles < 2 ? 2 : (cycles > MAX_CYCLES ? MAX_CYCLES : cycles); }
+    void setTimeout(uint32_t timeoutUs) { timeoutUs_ = timeoutUs; }
+
+    void start(float setpoint, uint32_t nowUs) {
+        setpoint_ = setpoint;
+        startUs_ = nowUs;
+        relayHigh_ = true;
+        cycles_ = 0;
+        haveRise_ = false;
+        peakHigh_ = -1e30f;
+        peakLow_ = 1e30f;
+        status_ = TUNE_RUNNING;
+    }
+
+    void cancel() { status_ = TUNE_IDLE; }
+
+    /**
+     * @brief Advances the tuner. Returns the actuator output (bias while not running).
+     */
+    float update(float measurement, uint32_t nowUs) {
+        if (status_ != TUNE_RUNNING) return bias_;
+        if (nowUs - startUs_ > timeoutUs_) {
+            status_ = TUNE_FAILED;
+            return bias_;
+        }
+
+        if (measurement > peakHigh_) peakHigh_ = measurement;
+        if (measurement < peakLow_) peakLow_ = measurement;
+
+        if (relayHigh_ && measurement > setpoint_ + hysteresis_) {
+            relayHigh_ = false;
+        } else if (!relayHigh_ && measurement < setpoint_ - hysteresis_) {
+            relayHigh_ = true;
+            // A full cycle ends at each low->high switch.
+            if (haveRise_) {
+                recordCycle(nowUs - lastRiseUs_);
+            }
+            haveRise_ = true;
+            lastRiseUs_ = nowUs;
+            peakHigh_ = -1e30f;
+            peakLow_ = 1e30f;
+        }
+        return relayHigh_ ? bias_ + amplitude_ : bias_ - amplitude_;
+    }
+
+    bool relayState() const { return relayHigh_; }
+    TUNE_STATUS status() const { return status_; }
+    const TuneResult& result() const { return result_; }
+    uint8_t cycles() const { return cycles_; }
+
+private:
+    void recordCycle(uint32_t periodUs) {
+        uint8_t slot = cycles_ % MAX_CYCLES;
+        periods_[slot] = periodUs * 1e-6f;
+        amplitudes_[slot] = 0.5f * (peakHigh_ - peakLow_);
+        cycles_++;
+        // The first cycle carries the start-up transient, so it never counts.
+        if (cycles_ > minCycles_ && converged()) finish();
+    }
+
+    // Last minCycles cycles agree with their mean within 5%.
+    bool converged() {
+        float pSum = 0.0f, aSum = 0.0f;
+        for (uint8_t k = 0; k < minCycles_; k++) {
+            uint8_t slot = (cycles_ - 1 - k) % MAX_CYCLES;
+            pSum += periods_[slot];
+            aSum += amplitudes_[slot];
+        }
+        meanPeriod_ = pSum / minCycles_;
+        meanAmplitude_ = aSum / minCycles_;
+        for (uint8_t k = 0; k < minCycles_; k++) {
+            uint8_t slot = (cycles_ - 1 - k) % MAX_CYCLES;
+            if (fabsf(periods_[slot] - meanPeriod_) > 0.05f * meanPeriod_) return false;
+            if (fabsf(amplitudes_[slot] - meanAmplitude_) > 0.05f * meanAmplitude_) return false;
+        }
+        return true;
+    }
+
+    void finish() {
+        float a = meanAmplitude_;
+        float effective = a > hysteresis_ ? sqrtf(a * a - hysteresis_ * hysteresis_) : a;
+        float ku = 4.0f * amplitude_ / (3.14159265f * effective);
+        float pu = meanPeriod_;
+        result_.ku = ku;
+        result_.pu = pu;
+        if (rule_ == TUNE_ZIEGLER_NICHOLS) {
+            result_.kp = 0.6f * ku;
+            result_.ki = 1.2f * ku / pu;        // Kp / (Pu / 2)
+            result_.kd = 0.075f * ku * pu;      // Kp * Pu / 8
+        } else {
+            result_.kp = ku / 2.2f;
+            result_.ki = result_.kp / (2.2f * pu);
+            result_.kd = result_.kp * pu / 6.3f;
+        }
+        status_ = TUNE_DONE;
+    }
+
+    float bias_, amplitude_, hysteresis_;
+    float setpoint_ = 0.0f;
+    TUNE_RULE rule_ = TUNE_TYREUS_LUYBEN;
+    TUNE_STATUS status_ = TUNE_IDLE;
+    uint8_t minCycles_ = 3;
+    uint32_t timeoutUs_ = 60000000;   // 60 s
+    uint32_t startUs_ = 0;
+    uint32_t lastRiseUs_ = 0;
+    bool relayHigh_ = true;
+    bool haveRise_ = false;
+    uint8_t cycles_ = 0;
+    float peakHigh_ = 0.0f, peakLow_ = 0.0f;
+    float periods_[MAX_CYCLES] = {};
+    float amplitudes_[MAX_CYCLES] = {};
+    float meanPeriod_ = 0.0f, meanAmplitude_ = 0.0f;
+    TuneResult result_ = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+};
+
+#endif // RELAYAUTOTUNE_H
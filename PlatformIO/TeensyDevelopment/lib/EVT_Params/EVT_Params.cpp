@@ -0,0 +1,59 @@
+#include "EVT_Params.h"
+#include "EVT_CalibStore.h"
+#include "EVT_Ethernet.h"
+#include "EVT_EventLog.h"
+#include "EVT_StateMachine.h"
+
+static_assert(CALIB_EEPROM_ADDR + sizeof(CalibRecord) <= PARAM_EEPROM_ADDR, "Parameter record overlaps the calibration record");
+static_assert(UDP_RX_DATAGRAM_MAX + 1 >= PARAM_MESSAGE_MAX, "The UDP ring cuts parameter messages short");
+
+static ParamRegistry registry;
+static EepromCalibStorage paramStorage;
+
+bool addParameter(PARAM_ID id, const char* name, float* value, float min, float max, ParamApplyHook onApply,
+                  bool saved) {
+    return registry.add(id, name, value, min, max, onApply, saved);
+}
+
+bool addParameter(PARAM_ID id, const char* name, int32_t* value, int32_t min, int32_t max, ParamApplyHook onApply,
+                  bool saved) {
+    return registry.add(id, name, value, min, max, onApply, saved);
+}
+
+bool addParameterCheck(ParamCheckHook check) {
+    return registry.addCheck(check);
+}
+
+static int handleParamMessage(const char* data, uint16_t length, bool truncated, char* reply, size_t size) {
+    return registry.handle(data, length, truncated, reply, size, &paramStorage, PARAM_EEPROM_ADDR);
+}
+
+// Floats are logged in thousandths so the record reads without knowing the type.
+static void logParamChange(uint16_t id, uint8_t type, ParamValue value) {
+    int32_t logged = value.i;
+    if (type == PARAM_FLOAT) {
+        float milli = value.f * 1000.0f;
+        logged = milli > 2147483000.0f ? INT32_MAX : milli < -2147483000.0f ? INT32_MIN : (int32_t)lroundf(milli);
+    }
+    logEvent(EVT_PARAM, LOC_ETHERNET, (int32_t)id | ((int32_t)type << 16), logged);
+}
+
+void setupParams() {
+    int restored = registry.load(paramStorage, PARAM_EEPROM_ADDR);
+    if (restored < 0) {
+        Serial.println("No saved parameters, using defaults.");
+    } else {
+        Serial.print("Restored ");
+        Serial.print(restored);
+        Serial.println(" saved parameters.");
+    }
+    registry.setSaveHook(saveCalibration);
+    addLinkHandler(handleParamMessage);
+}
+
+void applyParams() {
+    // An EEPROM write can stall the loop for milliseconds; only save while stopped.
+    STATE state = GetState();
+    registry.setSaveAllowed(state != RC && state != AUTO);
+    registry.apply(logParamChange);
+}
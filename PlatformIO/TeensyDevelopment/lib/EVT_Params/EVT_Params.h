@@ -0,0 +1,85 @@
+#ifndef EVT_PARAMS_H
+#define EVT_PARAMS_H
+
+#include <Arduino.h>
+#include "ParamRegistry.h"
+
+#define PARAM_EEPROM_ADDR 256   // After the calibration record (EVT_CalibStore).
+
+/**
+ * @brief Parameter ids. Append only; saved records and the Pi's tuning scripts
+ *        key on them. Groups start on a multiple of 20.
+ */
+enum PARAM_ID {
+    PARAM_NONE = 0,
+
+    // RC throttle, THROTTLE_RC_CONFIG (EVT_Throttle).
+    PARAM_RC_THROTTLE_NEUTRAL = 1,
+    PARAM_RC_THROTTLE_FORWARD_FULL,
+    PARAM_RC_THROTTLE_REVERSE_FULL,
+    PARAM_RC_THROTTLE_DEADBAND,
+    PARAM_RC_THROTTLE_EXPO,
+    PARAM_RC_THROTTLE_RISE_RATE,
+    PARAM_RC_THROTTLE_FALL_RATE,
+    PARAM_RC_THROTTLE_MAX_RPM,
+    PARAM_RC_THROTTLE_MAX_CURRENT,
+    PARAM_RC_THROTTLE_MAX_BRAKE_CURRENT,
+    PARAM_RC_THROTTLE_BRAKE_RPM,
+
+    // AUTO throttle, THROTTLE_AUTO_CONFIG (EVT_Throttle).
+    PARAM_AUTO_THROTTLE_RISE_RATE = 20,
+    PARAM_AUTO_THROTTLE_FALL_RATE,
+    PARAM_AUTO_THROTTLE_MAX_RPM,
+
+    // Steering trajectory, STEER_TRAJ_CONFIG (EVT_SteerTrajectory).
+    PARAM_STEER_MAX_VEL = 40,
+    PARAM_STEER_MAX_ACC,
+    PARAM_STEER_MAX_JERK,
+    PARAM_STEER_INERTIA,
+
+    // SBUS switch thresholds, rcSwitches (EVT_RC).
+    PARAM_RC_AUTO_SWITCH = 60,
+    PARAM_RC_ERROR_RESET,
+    PARAM_RC_ARM,
+    PARAM_RC_CALIB_START,
+    PARAM_RC_RECALIBRATE,
+    PARAM_RC_CALIB_ABORT,
+
+    // Steering endpoints, calibRecord (EVT_CalibStore). Saved with the calibration record.
+    PARAM_STEER_LEFT_POS = 80,
+    PARAM_STEER_RIGHT_POS
+};
+
+/**
+ * @brief Registers a parameter; modules call it from their setup.
+ *
+ * The variable's value at registration is the default. It is only ever
+ * written by applyParams(), so the control code reads it directly. onApply
+ * runs after a change, for modules that copy the value into another object.
+ * Pass saved = false for a field of the calibration record; PSAVE then
+ * writes that record instead of listing the field in the parameter record.
+ */
+bool addParameter(PARAM_ID id, const char* name, float* value, float min, float max, ParamApplyHook onApply = NULL,
+                  bool saved = true);
+bool addParameter(PARAM_ID id, const char* name, int32_t* value, int32_t min, int32_t max, ParamApplyHook onApply = NULL,
+                  bool saved = true);
+
+/**
+ * @brief Refuses a PSET, with PERR,0,conflict, when check returns false for
+ *        the values it would leave. For limits that span several parameters.
+ */
+bool addParameterCheck(ParamCheckHook check);
+
+/**
+ * @brief Restores the saved values and starts answering P* messages on the
+ *        UDP link. Call once, after every module has registered its parameters.
+ */
+void setupParams();
+
+/**
+ * @brief Applies everything a P* message staged since the last call and logs
+ *        each change. Call at the top of loop(), so a tick never sees half a change.
+ */
+void applyParams();
+
+#endif // EVT_PARAMS_H
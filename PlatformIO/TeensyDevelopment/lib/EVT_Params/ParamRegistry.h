@@ -0,0 +1,410 @@
+#ifndef PARAMREGISTRY_H
+#define PARAMREGISTRY_H
+
+// Runtime parameters: typed values with stable ids, range checks, staged
+// writes and a persisted record. Each entry points at the variable the control
+// code already reads, so the hot path never looks a parameter up; a set only
+// stages the value and apply() copies everything staged in one go at the tick
+// boundary.
+//
+// Messages are text like clock sync and start with a letter, which keeps them
+// out of the control packet path (isTaggedDatagram()):
+//   PGET,<id>                           -> PVAL,<id>,<name>,<f|i>,<value>,<min>,<max>,<default>
+//   PSET,<id>,<value>[,<id>,<value>...] -> POK,<pairs>, or PERR,<id>,<reason> and nothing is staged
+//   PLIST,<from>                        -> PLIST,<from>,<total> and a PVAL line per parameter from
+//                                          index <from>, '\n' separated, as many as fit one reply
+//   PSAVE                               -> POK,<saved> or PERR,0,<reason>
+//   PDEFAULTS                           -> POK,<staged>
+// PGET and PLIST show a staged value until it is applied; PSAVE stores the
+// applied ones. Parameters registered as not saved live in another record
+// (e.g. the calibration record), which the save hook writes on PSAVE.
+// Reasons: unknown, range, format, busy, storage, and conflict for a PSET whose
+// values are each in range but fail a check across parameters (PERR,0,conflict).
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <crc32.h>
+#include "EVT_CalibStore.h"
+
+#define PARAM_MAX          48
+#define PARAM_CHECK_MAX    8
+#define PARAM_MESSAGE_MAX  512     // Longest request handled, e.g. a PSET of many pairs. Must fit UDP_RX_DATAGRAM_MAX.
+#define PARAM_MAGIC        0x50545645u   // "EVTP" little endian
+#define PARAM_VERSION      1
+
+enum PARAM_TYPE {
+    PARAM_FLOAT,
+    PARAM_INT     ///< int32_t
+};
+
+/**
+ * @brief Called once per apply() for every hook whose parameters changed, so a
+ *        module can push a config struct into the object that copies it.
+ */
+typedef void (*ParamApplyHook)();
+
+union ParamValue {
+    float   f;
+    int32_t i;
+};
+
+/** @brief Told about every value apply() writes, e.g. for the event log. type is PARAM_TYPE. */
+typedef void (*ParamChangeHook)(uint16_t id, uint8_t type, ParamValue value);
+
+class ParamRegistry;
+
+/**
+ * @brief Checks values that must agree with each other, e.g. throttle endpoints
+ *        against the deadband. Runs on every PSET before anything is staged;
+ *        registry.next(&variable) is what the variable would hold once applied.
+ * @return false to refuse the PSET.
+ */
+typedef bool (*ParamCheckHook)(const ParamRegistry& registry);
+
+/** @brief Writes the records of parameters registered as not saved; false on a storage error. */
+typedef bool (*ParamSaveHook)();
+
+// Persisted record: a header and one entry per parameter, keyed by id so
+// parameters can be added or dropped without invalidating what was saved.
+struct ParamRecordHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    uint32_t crc32;       ///< Over the entries.
+};
+
+struct ParamRecordEntry {
+    uint16_t id;
+    uint8_t  type;
+    uint8_t  reserved;
+    uint32_t bits;        ///< ParamValue.
+};
+
+static_assert(sizeof(ParamRecordHeader) == 12, "ParamRecordHeader layout changed, bump PARAM_VERSION");
+static_assert(sizeof(ParamRecordEntry) == 8, "ParamRecordEntry layout changed, bump PARAM_VERSION");
+
+class ParamRegistry {
+public:
+    /**
+     * @brief Registers *value under id; its current value becomes the default.
+     *
+     * @param saved  false if the variable is persisted elsewhere; it is then
+     *               left out of this record and the save hook writes it.
+     * @return false for id 0, a duplicate id, a full table or a default outside min..max.
+     */
+    bool add(uint16_t id, const char* name, float* value, float min, float max, ParamApplyHook onApply = NULL,
+             bool saved = true) {
+        ParamValue lo, hi, def;
+        lo.f = min;
+        hi.f = max;
+        def.f = *value;
+        return add(id, name, PARAM_FLOAT, value, lo, hi, def, onApply, saved);
+    }
+
+    bool add(uint16_t id, const char* name, int32_t* value, int32_t min, int32_t max, ParamApplyHook onApply = NULL,
+             bool saved = true) {
+        ParamValue lo, hi, def;
+        lo.i = min;
+        hi.i = max;
+        def.i = *value;
+        return add(id, name, PARAM_INT, value, lo, hi, def, onApply, saved);
+    }
+
+    int size() const { return count_; }
+
+    /** @brief Adds a check run on every PSET; false if PARAM_CHECK_MAX are registered. */
+    bool addCheck(ParamCheckHook check) {
+        if (checkCount_ >= PARAM_CHECK_MAX) return false;
+        checks_[checkCount_++] = check;
+        return true;
+    }
+
+    /**
+     * @brief For check hooks: the value *value would hold after the next apply(),
+     *        counting the PSET being checked and anything already staged.
+     */
+    float next(const float* value) const {
+        for (int i = checkPairs_ - 1; i >= 0; i--)
+            if (checkParams_[i]->target == value) return checkValues_[i].f;
+        for (int i = 0; i < count_; i++)
+            if (params_[i].target == value && params_[i].staged) return params_[i].pending.f;
+        return *value;
+    }
+
+    /**
+     * @brief Validates and stages one value. Nothing changes until apply().
+     * @return NULL on success, otherwise the PERR reason.
+     */
+    const char* set(uint16_t id, const char* text) {
+        Param* p = find(id);
+        if (p == NULL) return "unknown";
+        ParamValue v;
+        const char* reason = parse(*p, text, v);
+        if (reason) return reason;
+        if (!checksPass(&p, &v, 1)) return "conflict";
+        stage(*p, v);
+        return NULL;
+    }
+
+    /**
+     * @brief Copies every staged value into its variable and runs the hooks of
+     *        the parameters that changed. Call once per tick, before the control code.
+     * @return Parameters applied.
+     */
+    int apply(ParamChangeHook onChange = NULL) {
+        if (!pending_) return 0;
+        ParamApplyHook hooks[PARAM_MAX];
+        int hookCount = 0;
+        int applied = 0;
+        for (int i = 0; i < count_; i++) {
+            Param& p = params_[i];
+            if (!p.staged) continue;
+            memcpy(p.target, &p.pending, sizeof(ParamValue));
+            p.staged = false;
+            applied++;
+            if (onChange) onChange(p.id, p.type, p.pending);
+            if (p.onApply == NULL) continue;
+            bool seen = false;
+            for (int h = 0; h < hookCount; h++) seen |= hooks[h] == p.onApply;
+            if (!seen) hooks[hookCount++] = p.onApply;
+        }
+        for (int h = 0; h < hookCount; h++) hooks[h]();
+        pending_ = false;
+        return applied;
+    }
+
+    /** @brief Stages every default. */
+    int stageDefaults() {
+        for (int i = 0; i < count_; i++) stage(params_[i], params_[i].def);
+        return count_;
+    }
+
+    /** @brief Whether PSAVE may write now; flash writes can stall the loop. */
+    void setSaveAllowed(bool allowed) { saveAllowed_ = allowed; }
+
+    /** @brief Run by PSAVE after this record is written. */
+    void setSaveHook(ParamSaveHook onSave) { onSave_ = onSave; }
+
+    /**
+     * @brief Answers one request.
+     *
+     * @param truncated  The transport cut the datagram short; it is refused
+     *                   with PERR,0,format so a PSET never stages a cut-off value.
+     * @return Reply length, 0 for no reply, -1 if data is not a parameter message.
+     */
+    int handle(const char* data, uint16_t length, bool truncated, char* reply, size_t size, CalibStorage* storage,
+               uint32_t address) {
+        if (length < 4 || data[0] != 'P') return -1;
+        char text[PARAM_MESSAGE_MAX];
+        if (truncated || length >= sizeof(text)) return snprintf(reply, size, "PERR,0,format");
+        memcpy(text, data, length);
+        text[length] = '\0';
+
+        char* rest = strchr(text, ',');
+        if (rest) *rest++ = '\0';
+        if (strcmp(text, "PGET") == 0) {
+            long id = rest ? strtol(rest, NULL, 10) : 0;
+            const Param* p = find((uint16_t)id);
+            if (p == NULL) return snprintf(reply, size, "PERR,%ld,unknown", id);
+            return format(*p, reply, size);
+        }
+        if (strcmp(text, "PSET") == 0) return handleSet(rest, reply, size);
+        if (strcmp(text, "PLIST") == 0) return handleList(rest ? atoi(rest) : 0, reply, size);
+        if (strcmp(text, "PSAVE") == 0) {
+            if (!saveAllowed_) return snprintf(reply, size, "PERR,0,busy");
+            int saved = storage ? save(*storage, address) : -1;
+            if (saved < 0 || (onSave_ && !onSave_())) return snprintf(reply, size, "PERR,0,storage");
+            return snprintf(reply, size, "POK,%d", saved);
+        }
+        if (strcmp(text, "PDEFAULTS") == 0) return snprintf(reply, size, "POK,%d", stageDefaults());
+        return -1;
+    }
+
+    /**
+     * @brief Writes the applied value of every saved parameter.
+     * @return Parameters written, -1 on a storage error.
+     */
+    int save(CalibStorage& storage, uint32_t address) const {
+        ParamRecordEntry entries[PARAM_MAX];
+        int count = 0;
+        for (int i = 0; i < count_; i++) {
+            if (!params_[i].saved) continue;
+            entries[count].id = params_[i].id;
+            entries[count].type = params_[i].type;
+            entries[count].reserved = 0;
+            memcpy(&entries[count].bits, params_[i].target, sizeof(uint32_t));
+            count++;
+        }
+        ParamRecordHeader header = { PARAM_MAGIC, PARAM_VERSION, (uint16_t)count,
+                                     util::crc32((const uint8_t*)entries, count * sizeof(ParamRecordEntry)) };
+        bool ok = storage.write(address, &header, sizeof(header)) &&
+                  storage.write(address + sizeof(header), entries, count * sizeof(ParamRecordEntry));
+        return ok ? count : -1;
+    }
+
+    /**
+     * @brief Restores saved values straight into their variables and runs the
+     *        hooks. Entries for unknown ids, of another type or out of range
+     *        are skipped, so the defaults stand for them.
+     * @return Parameters restored, -1 if there is no valid record.
+     */
+    int load(CalibStorage& storage, uint32_t address) {
+        ParamRecordHeader header;
+        if (!storage.read(address, &header, sizeof(header))) return -1;
+        if (header.magic != PARAM_MAGIC || header.version != PARAM_VERSION || header.count > PARAM_MAX) return -1;
+        ParamRecordEntry entries[PARAM_MAX];
+        if (!storage.read(address + sizeof(header), entries, header.count * sizeof(ParamRecordEntry))) return -1;
+        if (header.crc32 != util::crc32((const uint8_t*)entries, header.count * sizeof(ParamRecordEntry))) return -1;
+
+        int restored = 0;
+        for (int i = 0; i < header.count; i++) {
+            Param* p = find(entries[i].id);
+            ParamValue v;
+            memcpy(&v, &entries[i].bits, sizeof(v));
+            if (p == NULL || !p->saved || p->type != entries[i].type || !inRange(*p, v)) continue;
+            stage(*p, v);
+            restored++;
+        }
+        apply();
+        return restored;
+    }
+
+private:
+    struct Param {
+        uint16_t       id;
+        uint8_t        type;
+        bool           staged;
+        bool           saved;
+        const char*    name;
+        void*          target;
+        ParamValue     min, max, def, pending;
+        ParamApplyHook onApply;
+    };
+
+    bool add(uint16_t id, const char* name, uint8_t type, void* target, ParamValue min, ParamValue max,
+             ParamValue def, ParamApplyHook onApply, bool saved) {
+        if (id == 0 || count_ >= PARAM_MAX || find(id) != NULL) return false;
+        Param& p = params_[count_];
+        p.id = id;
+        p.type = type;
+        p.staged = false;
+        p.saved = saved;
+        p.name = name;
+        p.target = target;
+        p.min = min;
+        p.max = max;
+        p.def = def;
+        p.onApply = onApply;
+        if (!inRange(p, def)) return false;
+        count_++;
+        return true;
+    }
+
+    Param* find(uint16_t id) {
+        for (int i = 0; i < count_; i++)
+            if (params_[i].id == id) return &params_[i];
+        return NULL;
+    }
+
+    const Param* find(uint16_t id) const {
+        return const_cast<ParamRegistry*>(this)->find(id);
+    }
+
+    // The negated compare also rejects NaN.
+    static bool inRange(const Param& p, ParamValue v) {
+        if (p.type == PARAM_FLOAT) return !(v.f < p.min.f || v.f > p.max.f || v.f != v.f);
+        return v.i >= p.min.i && v.i <= p.max.i;
+    }
+
+    static const char* parse(const Param& p, const char* text, ParamValue& v) {
+        char* end;
+        if (p.type == PARAM_FLOAT) v.f = strtof(text, &end);
+        else v.i = (int32_t)strtol(text, &end, 10);
+        if (end == text || *end != '\0') return "format";
+        return inRange(p, v) ? NULL : "range";
+    }
+
+    void stage(Param& p, ParamValue v) {
+        p.pending = v;
+        p.staged = true;
+        pending_ = true;
+    }
+
+    bool checksPass(Param* const* params, const ParamValue* values, int pairs) {
+        checkParams_ = params;
+        checkValues_ = values;
+        checkPairs_ = pairs;
+        bool ok = true;
+        for (int i = 0; i < checkCount_ && ok; i++) ok = checks_[i](*this);
+        checkPairs_ = 0;
+        return ok;
+    }
+
+    // All pairs are checked before any is staged, so a PSET never half applies.
+    int handleSet(char* rest, char* reply, size_t size) {
+        Param* params[PARAM_MAX];
+        ParamValue values[PARAM_MAX];
+        int pairs = 0;
+        while (rest != NULL && *rest != '\0') {
+            char* idText = rest;
+            char* valueText = strchr(idText, ',');
+            if (valueText == NULL) return snprintf(reply, size, "PERR,0,format");
+            *valueText++ = '\0';
+            rest = strchr(valueText, ',');
+            if (rest) *rest++ = '\0';
+
+            long id = strtol(idText, NULL, 10);
+            Param* p = find((uint16_t)id);
+            if (p == NULL) return snprintf(reply, size, "PERR,%ld,unknown", id);
+            if (pairs == PARAM_MAX) return snprintf(reply, size, "PERR,%ld,format", id);
+            const char* reason = parse(*p, valueText, values[pairs]);
+            if (reason) return snprintf(reply, size, "PERR,%ld,%s", id, reason);
+            params[pairs++] = p;
+        }
+        if (pairs == 0) return snprintf(reply, size, "PERR,0,format");
+        if (!checksPass(params, values, pairs)) return snprintf(reply, size, "PERR,0,conflict");
+        for (int i = 0; i < pairs; i++) stage(*params[i], values[i]);
+        return snprintf(reply, size, "POK,%d", pairs);
+    }
+
+    int handleList(int from, char* reply, size_t size) {
+        if (from < 0) from = 0;
+        int used = snprintf(reply, size, "PLIST,%d,%d", from, count_);
+        char line[128];
+        for (int i = from; i < count_; i++) {
+            int length = format(params_[i], line, sizeof(line));
+            if (used + 1 + length >= (int)size) break;
+            reply[used++] = '\n';
+            memcpy(reply + used, line, length + 1);
+            used += length;
+        }
+        return used;
+    }
+
+    static int format(const Param& p, char* out, size_t size) {
+        ParamValue value;
+        if (p.staged) value = p.pending;
+        else memcpy(&value, p.target, sizeof(value));
+        if (p.type == PARAM_FLOAT)
+            return snprintf(out, size, "PVAL,%u,%s,f,%.7g,%.7g,%.7g,%.7g", p.id, p.name, value.f, p.min.f, p.max.f,
+                            p.def.f);
+        return snprintf(out, size, "PVAL,%u,%s,i,%ld,%ld,%ld,%ld", p.id, p.name, (long)value.i, (long)p.min.i,
+                        (long)p.max.i, (long)p.def.i);
+    }
+
+    Param params_[PARAM_MAX];
+    int  count_ = 0;
+    bool pending_ = false;
+    bool saveAllowed_ = true;
+    ParamSaveHook onSave_ = NULL;
+    ParamCheckHook checks_[PARAM_CHECK_MAX];
+    int checkCount_ = 0;
+    // The PSET under check, for next().
+    Param* const* checkParams_ = NULL;
+    const ParamValue* checkValues_ = NULL;
+    int checkPairs_ = 0;
+};
+
+#endif // PARAMREGISTRY_H
@@ -1,17 +1,53 @@
 #include "EVT_RC.h"
+#include "EVT_Capture.h"
+#include "EVT_Ethernet.h"
+#include "EVT_StateMachine.h"
+#include "EVT_Params.h"
 
 // Create SBUS instance on Serial2.
 SBUS sbus(Serial2);
 uint16_t channels[10] = {0};
+RcSwitches rcSwitches = { 1000, 1000, 400, 900, 1500, 400 };
 static bool sbusFailSafe = false;
 static bool sbusLostFrame = false;
+static uint32_t sbusFrames = 0;
+static uint32_t sbusLostFrames = 0;
+
+static void captureSbusByte(uint8_t b) {
+    captureByte(CAPTURE_PORT_SERIAL2, CAPTURE_RX, b);
+}
+
+static void sampleRcLinkTopic(void* payload) {
+    TelemetryRcLink &t = *(TelemetryRcLink*)payload;
+    memcpy(t.channels, channels, sizeof(t.channels));
+    t.frames = sbusFrames;
+    t.lostFrames = sbusLostFrames;
+    t.failSafe = sbusFailSafe;
+    t.state = (uint8_t)CurrentState;
+    t.reserved[0] = t.reserved[1] = 0;
+}
 
 void setupSbus() {
     Serial2.begin(100000, SERIAL_8E2);
     sbus.begin();
+    sbus.setTap(captureSbusByte);
+    addTelemetryTopic(TELEMETRY_TOPIC_RC_LINK, SBUS_TOPIC_RC_LINK_HZ, sampleRcLinkTopic, sizeof(TelemetryRcLink));
+    addParameter(PARAM_RC_AUTO_SWITCH, "rc.auto_switch", &rcSwitches.autoOn, 400, 1600);
+    addParameter(PARAM_RC_ERROR_RESET, "rc.error_reset", &rcSwitches.errorReset, 400, 1600);
+    addParameter(PARAM_RC_ARM, "rc.arm", &rcSwitches.arm, 200, 1600);
+    addParameter(PARAM_RC_CALIB_START, "rc.calib_start", &rcSwitches.calibStart, 800, 1400);
+    addParameter(PARAM_RC_RECALIBRATE, "rc.recalibrate", &rcSwitches.recalibrate, 1401, 1811);
+    addParameter(PARAM_RC_CALIB_ABORT, "rc.calib_abort", &rcSwitches.calibAbort, 172, 799);
     delay(500);
 }
 
 bool updateSbusData() {
-    return sbus.read(channels, &sbusFailSafe, &sbusLostFrame);
+    if (!sbus.read(channels, &sbusFailSafe, &sbusLostFrame)) return false;
+    sbusFrames++;
+    if (sbusLostFrame) sbusLostFrames++;
+    return true;
+}
+
+bool isSbusFailSafe() {
+    return sbusFailSafe;
 }
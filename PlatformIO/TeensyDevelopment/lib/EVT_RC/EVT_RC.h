@@ -4,11 +4,28 @@
 #include <Arduino.h>
 #include <SBUS.h>
 
+#define SBUS_TOPIC_RC_LINK_HZ 50   // RC link topic on the UDP telemetry publisher.
+
 // Global SBUS channel array.
 extern uint16_t channels[10];
 
+/**
+ * @brief Where the switch channels flip, in raw SBUS counts. Runtime
+ *        parameters (EVT_Params); the ranges keep the CH5 levels in order.
+ */
+struct RcSwitches {
+    int32_t autoOn;        ///< CH6 above: AUTO, below: back to RC.
+    int32_t errorReset;    ///< CH4 above clears an error.
+    int32_t arm;           ///< CH8 above leaves IDLE for RC.
+    int32_t calibStart;    ///< CH5 above starts the first calibration.
+    int32_t recalibrate;   ///< CH5 above forces a full recalibration.
+    int32_t calibAbort;    ///< CH5 below aborts a running calibration.
+};
+extern RcSwitches rcSwitches;
+
 // SBUS function prototypes.
 void setupSbus();
 bool updateSbusData();
+bool isSbusFailSafe();
 
 #endif // EVT_RC_H
@@ -1,5 +1,7 @@
 #include "EVT_StateMachine.h"
 #include "EVT_VescDriver.h"
+#include "EVT_EventLog.h"
+#include "EVT_BlackBox.h"
 // Define the global state variable.
 STATE CurrentState = NONE;
 
@@ -9,45 +11,19 @@ STATE GetState() {
 
 
 void SetState(STATE newState) {
+    STATE previous = CurrentState;
     CurrentState = newState;
-    if (newState == ERR) {
-        Serial.println("=========================== ERROR OCCURRED ===========================");
-        Serial.println("=========================== ERROR OCCURRED ===========================");
-        Serial.println("=========================== ERROR OCCURRED ===========================");
-    } else {
-        Serial.println("======================================================================");
-        Serial.print("SETTING STATE: ");
-        Serial.println(StateToString(CurrentState));  // Print the state as a string.
-        Serial.println("======================================================================");
-    }
+    // Logged instead of printed so the control loop never waits on Serial here.
+    logEvent(EVT_STATE_CHANGE, LOC_MAIN, previous, newState);
 }
 
 void SetErrorState(const char* location, const char* reason) {
+    STATE previous = CurrentState;
     CurrentState = ERR;
-    Serial.println("=========================== ERROR OCCURRED ===========================");
-    Serial.println("=========================== ERROR OCCURRED ===========================");
-    Serial.println("=========================== ERROR OCCURRED ===========================");
-    Serial.println("======================================================================");
-    Serial.print("Reason: ");
-    Serial.println(reason);
-    Serial.print("Location: ");
-    Serial.println(location);
-    Serial.println("======================================================================");
-    Serial.println("=========================== ERROR OCCURRED ===========================");
-    Serial.println("=========================== ERROR OCCURRED ===========================");
-    Serial.println("=========================== ERROR OCCURRED ===========================");
+    logEvent(EVT_ERROR, eventLocationFromString(location), previous, storeEventReason(reason));
+    blackBoxFreeze();
 }
 
 void PrintState(){
     Serial.println(StateToString(CurrentState)); 
 }
-
-const char* StateToString(STATE s) {
-    if (s >= 0 && s < STATE_COUNT) {
-        return state_names[s];
-    } else {
-        return "INVALID_STATE"; // Handle out-of-range values
-    }
-}
-
-    
@@ -16,14 +16,6 @@ enum STATE {
     ERR,     ///< Error state.
     STATE_COUNT ///< Provides us with the number of states we have defined
 };
-const char *state_names[] = {
-    "None",
-    "Initialization",
-    "Calibration",
-    "RC",
-    "Autonomous",
-    "ERROR!"
-};
 /**
  * @brief The current state of the system.
  *
@@ -42,15 +34,17 @@ STATE GetState();
 /**
  * @brief Sets the system state.
  * 
- * This function updates the global state and prints a message via Serial.
- * If the new state is ERR, it prints an error message.
+ * This function updates the global state and records the transition in the
+ * event log. Nothing is printed here, the log is drained at the end of loop().
  * 
  * @param newState The new state to set.
  */
 void SetState(STATE newState);
 
 /**
- * @brief Sets the error state and prints detailed error information.
+ * @brief Sets the error state and records the location and reason in the event log.
+ *
+ * The reason string is copied, so temporaries such as String::c_str() are fine.
  * 
  * @param location A C-style string indicating where the error occurred.
  * @param reason A C-style string explaining the reason for the error.
@@ -0,0 +1,22 @@
+#include "EVT_StateMachine.h"
+
+// Kept apart from the state machine so host tools (tools/eventlog_decode) can
+// name states without linking its dependencies.
+
+static const char* const state_names[STATE_COUNT] = {
+    "None",
+    "Initialization",
+    "Idle",
+    "Calibration",
+    "RC",
+    "Autonomous",
+    "ERROR!"
+};
+
+const char* StateToString(STATE s) {
+    if (s >= 0 && s < STATE_COUNT) {
+        return state_names[s];
+    } else {
+        return "INVALID_STATE"; // Handle out-of-range values
+    }
+}
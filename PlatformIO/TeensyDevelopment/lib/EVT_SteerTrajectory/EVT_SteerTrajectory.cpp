@@ -0,0 +1,51 @@
+#include "EVT_SteerTrajectory.h"
+#include "EVT_ODriver.h"
+#include "EVT_CommandBus.h"
+#include "EVT_Params.h"
+
+static SteerTrajectory trajectory(STEER_TRAJ_CONFIG);
+static SteerTrajectoryConfig trajectoryConfig = STEER_TRAJ_CONFIG;   // Parameter targets.
+static SteerSetpoint lastSetpoint = {0.0f, 0.0f, 0.0f};
+static float steeringTarget = 0.0f;
+static uint32_t lastTickUs = 0;
+
+static void applyTrajectoryParams() {
+    trajectory.setConfig(trajectoryConfig);
+}
+
+void setupSteeringTrajectory() {
+    addParameter(PARAM_STEER_MAX_VEL, "steer.max_vel", &trajectoryConfig.maxVel, 0.5f, 20.0f, applyTrajectoryParams);
+    addParameter(PARAM_STEER_MAX_ACC, "steer.max_acc", &trajectoryConfig.maxAcc, 1.0f, 200.0f, applyTrajectoryParams);
+    addParameter(PARAM_STEER_MAX_JERK, "steer.max_jerk", &trajectoryConfig.maxJerk, 10.0f, 2000.0f, applyTrajectoryParams);
+    addParameter(PARAM_STEER_INERTIA, "steer.inertia", &trajectoryConfig.inertia, 0.0f, 1.0f, applyTrajectoryParams);
+}
+
+void resetSteeringTrajectory(float pos) {
+    trajectory.reset(pos);
+    steeringTarget = pos;
+    lastSetpoint.pos = pos;
+    lastSetpoint.vel = 0.0f;
+    lastSetpoint.torque = 0.0f;
+    lastTickUs = micros();
+}
+
+void setSteeringTarget(float target) {
+    steeringTarget = target;
+}
+
+bool serviceSteeringTrajectory() {
+    uint32_t now = micros();
+    uint32_t elapsed = now - lastTickUs;
+    if (elapsed < STEER_TRAJ_PERIOD_US) return false;
+
+    // Keep a fixed step even if the loop ran late; a long stall (e.g. a blocking
+    // UART read) is clamped so the setpoint does not leap ahead.
+    lastTickUs = elapsed > 4 * STEER_TRAJ_PERIOD_US ? now : lastTickUs + STEER_TRAJ_PERIOD_US;
+    lastSetpoint = trajectory.step(steeringTarget, STEER_TRAJ_PERIOD_US * 1e-6f);
+    ODriveUART::printPosition(beginCommand(COMMAND_SLOT_STEERING), lastSetpoint.pos, lastSetpoint.vel, lastSetpoint.torque);
+    return true;
+}
+
+SteerSetpoint getSteeringSetpoint() {
+    return lastSetpoint;
+}
@@ -0,0 +1,35 @@
+#ifndef EVT_STEERTRAJECTORY_H
+#define EVT_STEERTRAJECTORY_H
+
+#include <Arduino.h>
+#include "SteerTrajectory.h"
+
+/**
+ * @brief Registers the trajectory limits as parameters, STEER_TRAJ_CONFIG being the defaults.
+ */
+void setupSteeringTrajectory();
+
+/**
+ * @brief Resets the generator to pos at rest. Call whenever the ODrive is (re)armed.
+ */
+void resetSteeringTrajectory(float pos);
+
+/**
+ * @brief Sets where the steering should go. Takes effect on the next tick.
+ */
+void setSteeringTarget(float target);
+
+/**
+ * @brief Steps the generator and stages setPosition(pos, vel_ff, torque_ff) on the
+ *        command bus once per STEER_TRAJ_PERIOD_US. Safe to call every loop.
+ *
+ * @return True if a setpoint was staged this call.
+ */
+bool serviceSteeringTrajectory();
+
+/**
+ * @brief The last setpoint sent to the ODrive.
+ */
+SteerSetpoint getSteeringSetpoint();
+
+#endif // EVT_STEERTRAJECTORY_H
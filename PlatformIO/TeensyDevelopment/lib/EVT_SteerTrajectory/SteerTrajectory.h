@@ -0,0 +1,159 @@
+#ifndef STEERTRAJECTORY_H
+#define STEERTRAJECTORY_H
+
+// Jerk-limited steering setpoint generator.
+
+#include <math.h>
+
+/**
+ * @brief Limits for the steering trajectory, in ODrive units (turns, turns/s, ...).
+ */
+struct SteerTrajectoryConfig {
+    float maxVel;    ///< turns/s
+    float maxAcc;    ///< turns/s^2
+    float maxJerk;   ///< turns/s^3
+    float inertia;   ///< Nm per turn/s^2, scales the torque feedforward. 0 disables it.
+    float settleTol; ///< turns, snap to the target once inside this and nearly stopped.
+};
+
+/**
+ * @brief One setpoint triple for ODriveUART::setPosition(pos, vel_ff, torque_ff).
+ */
+struct SteerSetpoint {
+    float pos;
+    float vel;
+    float torque;
+};
+
+#define STEER_TRAJ_PERIOD_US 5000   // 200 Hz setpoint stream to the ODrive.
+
+/**
+ * @brief Limits used on the vehicle. Tune maxVel/maxAcc against the rack, and
+ *        inertia from a torque step before enabling torque feedforward.
+ */
+constexpr SteerTrajectoryConfig STEER_TRAJ_CONFIG = {
+    8.0f,    // maxVel, turns/s
+    40.0f,   // maxAcc, turns/s^2
+    200.0f,  // maxJerk, turns/s^3. Accel ramps over ~0.2 s, slower than the rack resonance.
+    0.0f,    // inertia, Nm/(turn/s^2)
+    0.002f   // settleTol, turns
+};
+
+/**
+ * @brief Online S-curve tracker.
+ *
+ * Each step() moves the setpoint towards the target with velocity, acceleration
+ * and jerk bounded by the config. The target may change at any time; the
+ * generator re-plans from its current state without a velocity discontinuity.
+ */
+class SteerTrajectory {
+public:
+    explicit SteerTrajectory(const SteerTrajectoryConfig& config) : cfg_(config) {}
+
+    /** @brief Takes new limits; the next step() re-plans from the current state. */
+    void setConfig(const SteerTrajectoryConfig& config) { cfg_ = config; }
+
+    /**
+     * @brief Jumps the setpoint to pos at rest, e.g. to the measured position after calibration.
+     */
+    void reset(float pos) {
+        pos_ = pos;
+        vel_ = 0.0f;
+        acc_ = 0.0f;
+    }
+
+    /**
+     * @brief Advances the generator by dt seconds towards target.
+     */
+    SteerSetpoint step(float target, float dt) {
+        // Work in a frame where the target lies ahead, so only one direction
+        // needs the braking logic.
+        float dir = target - pos_ >= 0.0f ? 1.0f : -1.0f;
+        float dist = dir * (target - pos_);
+        float v = dir * vel_;
+        float a = dir * acc_;
+        float jMax = cfg_.maxJerk;
+
+        // Accelerate towards maxVel, easing acceleration off so velocity does not overshoot it.
+        float velError = cfg_.maxVel - v;
+        float accTarget = (velError >= 0.0f ? 1.0f : -1.0f) * fminf(cfg_.maxAcc, sqrtf(2.0f * jMax * fabsf(velError)));
+        float jerk = clamp((accTarget - a) / dt, -jMax, jMax);
+
+        // If one more tick of that would leave us unable to stop in time, brake instead.
+        float nextA = a + jerk * dt;
+        float nextV = v + 0.5f * (a + nextA) * dt;
+        if (stoppingDistance(nextV, nextA) >= dist - 0.5f * (v + nextV) * dt) {
+            jerk = brakingJerk(v, a, dt);
+            jerk = clamp(jerk, (-cfg_.maxAcc - a) / dt, jMax);
+        }
+
+        float newA = a + jerk * dt;
+        float newV = clamp(v + 0.5f * (a + newA) * dt, -cfg_.maxVel, cfg_.maxVel);
+        pos_ += dir * 0.5f * (v + newV) * dt;
+        vel_ = dir * newV;
+        acc_ = dir * newA;
+
+        if (fabsf(target - pos_) < cfg_.settleTol && fabsf(vel_) < cfg_.maxAcc * dt) {
+            pos_ = target;
+            vel_ = 0.0f;
+            acc_ = 0.0f;
+        }
+
+        SteerSetpoint sp = {pos_, vel_, acc_ * cfg_.inertia};
+        return sp;
+    }
+
+    float position() const { return pos_; }
+    float velocity() const { return vel_; }
+    float acceleration() const { return acc_; }
+
+private:
+    // Peak deceleration of the fastest stop from (v, a): jerk down to -peak, hold, jerk back to 0.
+    float brakingPeak(float v, float a) const {
+        float peakSq = cfg_.maxJerk * v + 0.5f * a * a;
+        return peakSq > 0.0f ? fminf(cfg_.maxAcc, sqrtf(peakSq)) : 0.0f;
+    }
+
+    // Jerk to apply now while following that stop.
+    float brakingJerk(float v, float a, float dt) const {
+        float peak = brakingPeak(v, a);
+        if (-a >= peak) {
+            // Last phase: unwind the deceleration, but not past zero.
+            return fminf(cfg_.maxJerk, -a / dt);
+        }
+        return -cfg_.maxJerk;
+    }
+
+    // Distance covered by the fastest jerk-limited stop from (v, a).
+    float stoppingDistance(float v, float a) const {
+        float j = cfg_.maxJerk;
+        if (j * v + 0.5f * a * a <= 0.0f) return v;   // Heading away from the target, nothing to brake.
+
+        float peak = brakingPeak(v, a);
+        if (-a >= peak) {
+            float t = -a / j;
+            return v * t + 0.5f * a * t * t + j * t * t * t / 6.0f;
+        }
+
+        float t1 = (a + peak) / j;
+        float x = v * t1 + 0.5f * a * t1 * t1 - j * t1 * t1 * t1 / 6.0f;
+        float v1 = v + a * t1 - 0.5f * j * t1 * t1;
+
+        float t2 = peak < cfg_.maxAcc ? 0.0f : fmaxf(0.0f, (v1 - peak * peak / (2.0f * j)) / peak);
+        x += v1 * t2 - 0.5f * peak * t2 * t2;
+        float v2 = v1 - peak * t2;
+
+        float t3 = peak / j;
+        x += v2 * t3 - 0.5f * peak * t3 * t3 + j * t3 * t3 * t3 / 6.0f;
+        return x;
+    }
+
+    static float clamp(float v, float lo, float hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+    SteerTrajectoryConfig cfg_;
+    float pos_ = 0.0f;
+    float vel_ = 0.0f;
+    float acc_ = 0.0f;
+};
+
+#endif // STEERTRAJECTORY_H
@@ -0,0 +1,85 @@
+#include "EVT_Throttle.h"
+#include "EVT_RC.h"
+#include "EVT_VescDriver.h"
+#include "EVT_FaultManager.h"
+#include "EVT_Params.h"
+
+// A pipeline not run for this long starts again from zero, so switching
+// between RC and AUTO never resumes a stale ramp.
+static const uint32_t THROTTLE_STALE_US = 100000;
+
+struct ThrottleSource {
+    ThrottlePipeline pipeline;
+    uint32_t lastUs;
+};
+
+static ThrottleSource rcThrottle = { ThrottlePipeline(THROTTLE_RC_CONFIG), 0 };
+static ThrottleSource autoThrottle = { ThrottlePipeline(THROTTLE_AUTO_CONFIG), 0 };
+
+// Parameter targets; the pipelines keep their own copy, refreshed on apply.
+static ThrottleConfig rcConfig = THROTTLE_RC_CONFIG;
+static ThrottleConfig autoConfig = THROTTLE_AUTO_CONFIG;
+
+// SBUS counts each side of the stick must keep past the deadband. The
+// parameter ranges alone allow neutral 1200, forward 1300 and deadband 100.
+static const float RC_THROTTLE_MIN_SPAN = 200.0f;
+
+static void applyThrottleParams() {
+    rcThrottle.pipeline.setConfig(rcConfig);
+    autoThrottle.pipeline.setConfig(autoConfig);
+}
+
+static bool checkThrottleParams(const ParamRegistry& registry) {
+    ThrottleConfig next = rcConfig;
+    next.neutral = registry.next(&rcConfig.neutral);
+    next.forwardFull = registry.next(&rcConfig.forwardFull);
+    next.reverseFull = registry.next(&rcConfig.reverseFull);
+    next.deadband = registry.next(&rcConfig.deadband);
+    return throttleSpan(next, true) >= RC_THROTTLE_MIN_SPAN && throttleSpan(next, false) >= RC_THROTTLE_MIN_SPAN;
+}
+
+void setupThrottle() {
+    addParameter(PARAM_RC_THROTTLE_NEUTRAL, "rc_throttle.neutral", &rcConfig.neutral, 800.0f, 1200.0f, applyThrottleParams);
+    addParameter(PARAM_RC_THROTTLE_FORWARD_FULL, "rc_throttle.forward_full", &rcConfig.forwardFull, 1300.0f, 1811.0f, applyThrottleParams);
+    addParameter(PARAM_RC_THROTTLE_REVERSE_FULL, "rc_throttle.reverse_full", &rcConfig.reverseFull, 172.0f, 700.0f, applyThrottleParams);
+    addParameter(PARAM_RC_THROTTLE_DEADBAND, "rc_throttle.deadband", &rcConfig.deadband, 0.0f, 100.0f, applyThrottleParams);
+    addParameter(PARAM_RC_THROTTLE_EXPO, "rc_throttle.expo", &rcConfig.expo, 0.0f, 1.0f, applyThrottleParams);
+    addParameter(PARAM_RC_THROTTLE_RISE_RATE, "rc_throttle.rise_rate", &rcConfig.riseRate, 0.1f, 20.0f, applyThrottleParams);
+    addParameter(PARAM_RC_THROTTLE_FALL_RATE, "rc_throttle.fall_rate", &rcConfig.fallRate, 0.1f, 50.0f, applyThrottleParams);
+    addParameter(PARAM_RC_THROTTLE_MAX_RPM, "rc_throttle.max_rpm", &rcConfig.maxRpm, 0.0f, 10000.0f, applyThrottleParams);
+    addParameter(PARAM_RC_THROTTLE_MAX_CURRENT, "rc_throttle.max_current", &rcConfig.maxCurrent, 0.0f, 80.0f, applyThrottleParams);
+    addParameter(PARAM_RC_THROTTLE_MAX_BRAKE_CURRENT, "rc_throttle.max_brake_current", &rcConfig.maxBrakeCurrent, 0.0f, 60.0f, applyThrottleParams);
+    addParameter(PARAM_RC_THROTTLE_BRAKE_RPM, "rc_throttle.brake_rpm", &rcConfig.brakeRpm, 0.0f, 3000.0f, applyThrottleParams);
+    addParameter(PARAM_AUTO_THROTTLE_RISE_RATE, "auto_throttle.rise_rate", &autoConfig.riseRate, 0.1f, 20.0f, applyThrottleParams);
+    addParameter(PARAM_AUTO_THROTTLE_FALL_RATE, "auto_throttle.fall_rate", &autoConfig.fallRate, 0.1f, 50.0f, applyThrottleParams);
+    addParameter(PARAM_AUTO_THROTTLE_MAX_RPM, "auto_throttle.max_rpm", &autoConfig.maxRpm, 0.0f, 10000.0f, applyThrottleParams);
+    addParameterCheck(checkThrottleParams);
+}
+
+static ThrottleCommand runThrottle(ThrottleSource& source, float raw) {
+    uint32_t now = micros();
+    uint32_t elapsed = now - source.lastUs;
+    if (source.lastUs == 0 || elapsed > THROTTLE_STALE_US) {
+        source.pipeline.reset();
+        elapsed = 0;
+    }
+    source.lastUs = now;
+
+    // Vehicle speed for the brake decision: the slower wheel, so one spinning
+    // wheel does not turn a reverse request into braking.
+    float rpmNow = fminf(vesc1.data.rpm, vesc2.data.rpm);
+    return source.pipeline.update(raw, rpmNow, getThrottleLimit(), elapsed * 1e-6f);
+}
+
+ThrottleCommand updateRcThrottle() {
+    return runThrottle(rcThrottle, channels[1]);
+}
+
+ThrottleCommand updateAutoThrottle(float percent) {
+    return runThrottle(autoThrottle, percent);
+}
+
+void resetThrottle() {
+    rcThrottle.pipeline.reset();
+    autoThrottle.pipeline.reset();
+}
@@ -0,0 +1,28 @@
+#ifndef EVT_THROTTLE_H
+#define EVT_THROTTLE_H
+
+#include <Arduino.h>
+#include "ThrottlePipeline.h"
+
+/**
+ * @brief Registers the throttle shaping parameters, THROTTLE_RC_CONFIG and
+ *        THROTTLE_AUTO_CONFIG being the defaults.
+ */
+void setupThrottle();
+
+/**
+ * @brief Shapes SBUS channel 1 through THROTTLE_RC_CONFIG.
+ */
+ThrottleCommand updateRcThrottle();
+
+/**
+ * @brief Shapes the UDP throttle (percent, -100..100) through THROTTLE_AUTO_CONFIG.
+ */
+ThrottleCommand updateAutoThrottle(float percent);
+
+/**
+ * @brief Drops both ramps back to zero, e.g. after an emergency stop.
+ */
+void resetThrottle();
+
+#endif // EVT_THROTTLE_H
@@ -0,0 +1,145 @@
+#ifndef THROTTLEPIPELINE_H
+#define THROTTLEPIPELINE_H
+
+// Throttle shaping: deadband -> expo -> slew limit -> RPM / current / brake.
+// Every stage is a fixed handful of float operations, so a tick costs the same
+// whatever the input.
+
+#include <math.h>
+
+enum THROTTLE_MODE {
+    THROTTLE_MODE_RPM,      ///< setRPM, the VESC closes the speed loop.
+    THROTTLE_MODE_CURRENT   ///< setCurrent, throttle is a torque request.
+};
+
+/**
+ * @brief What the VESCs should be told this tick.
+ */
+enum THROTTLE_OUTPUT {
+    THROTTLE_OUT_RPM,
+    THROTTLE_OUT_CURRENT,
+    THROTTLE_OUT_BRAKE      ///< setBrakeCurrent, value is a positive current.
+};
+
+struct ThrottleCommand {
+    THROTTLE_OUTPUT type;
+    float value;
+};
+
+struct ThrottleConfig {
+    // Input mapping: raw units (SBUS counts, or percent for UDP) to -1..1.
+    float neutral;
+    float forwardFull;       ///< Raw value for full forward.
+    float reverseFull;       ///< Raw value for full reverse.
+    float deadband;          ///< Raw units either side of neutral.
+
+    float expo;              ///< 0 = linear, 1 = cubic. y = (1 - e) x + e x^3.
+    float riseRate;          ///< Max |command| increase per second (full scale = 1).
+    float fallRate;          ///< Max |command| decrease per second; releasing should be quicker.
+
+    THROTTLE_MODE mode;
+    float maxRpm;
+    float maxCurrent;        ///< A, current mode.
+    float maxBrakeCurrent;   ///< A, regen when pulling back while rolling forward.
+    float brakeRpm;          ///< Above this forward rpm, pulling back brakes instead of reversing. 0 disables braking.
+};
+
+/**
+ * @brief SBUS channel 1: same endpoints, deadband and 7500 RPM as before, with
+ *        mild expo, a ramp and regen braking added.
+ */
+constexpr ThrottleConfig THROTTLE_RC_CONFIG = {
+    990.0f, 1700.0f, 350.0f, 20.0f,
+    0.3f, 2.0f, 6.0f,
+    THROTTLE_MODE_RPM, 7500.0f, 60.0f, 40.0f, 500.0f
+};
+
+/**
+ * @brief UDP raw_throttle in percent: linear, no deadband; only the ramp and
+ *        braking are added so planner steps do not hit the VESCs instantly.
+ */
+constexpr ThrottleConfig THROTTLE_AUTO_CONFIG = {
+    0.0f, 100.0f, -100.0f, 0.0f,
+    0.0f, 2.0f, 6.0f,
+    THROTTLE_MODE_RPM, 7500.0f, 60.0f, 40.0f, 500.0f
+};
+
+/**
+ * @brief Raw travel from the deadband edge to full forward (or full reverse),
+ *        which normalize() scales to 0..1. Zero or less leaves nothing to scale.
+ */
+inline float throttleSpan(const ThrottleConfig& config, bool forward) {
+    return forward ? config.forwardFull - config.neutral - config.deadband
+                   : config.neutral - config.reverseFull - config.deadband;
+}
+
+class ThrottlePipeline {
+public:
+    explicit ThrottlePipeline(const ThrottleConfig& config) : cfg_(config) {}
+
+    void reset() { shaped_ = 0.0f; }
+
+    /** @brief Takes new limits; the ramp carries on from where it is. */
+    void setConfig(const ThrottleConfig& config) { cfg_ = config; }
+
+    /**
+     * @brief Raw input to -1..1 with the deadband removed and the rest rescaled,
+     *        so the first count past the deadband is a small command, not a jump.
+     *        A side with no span left past the deadband gives 0.
+     */
+    float normalize(float raw) const {
+        float offset = raw - cfg_.neutral;
+        if (fabsf(offset) <= cfg_.deadband) return 0.0f;
+        float span = throttleSpan(cfg_, offset > 0.0f);
+        if (span <= 0.0f) return 0.0f;
+        float x = (fabsf(offset) - cfg_.deadband) / span;
+        x = x > 1.0f ? 1.0f : x;
+        return offset > 0.0f ? x : -x;
+    }
+
+    float expo(float x) const { return (1.0f - cfg_.expo) * x + cfg_.expo * x * x * x; }
+
+    /**
+     * @brief Moves the shaped command towards x. Growing |command| is limited
+     *        by riseRate, shrinking it (or crossing zero) by fallRate.
+     */
+    float slew(float x, float dt) {
+        float delta = x - shaped_;
+        bool growing = fabsf(x) > fabsf(shaped_) && x * shaped_ >= 0.0f;
+        float limit = (growing ? cfg_.riseRate : cfg_.fallRate) * dt;
+        shaped_ += delta > limit ? limit : (delta < -limit ? -limit : delta);
+        return shaped_;
+    }
+
+    /**
+     * @brief Runs every stage for one tick.
+     *
+     * @param raw       Input in the config's raw units.
+     * @param rpmNow    Measured forward speed, for deciding brake vs reverse.
+     * @param limit     Extra scale from the fault manager (getThrottleLimit()).
+     */
+    ThrottleCommand update(float raw, float rpmNow, float limit, float dt) {
+        float x = slew(expo(normalize(raw)), dt);
+        ThrottleCommand cmd;
+        if (x < 0.0f && cfg_.brakeRpm > 0.0f && rpmNow > cfg_.brakeRpm) {
+            // Braking is never reduced by the degraded-mode limit.
+            cmd.type = THROTTLE_OUT_BRAKE;
+            cmd.value = -x * cfg_.maxBrakeCurrent;
+        } else if (cfg_.mode == THROTTLE_MODE_CURRENT) {
+            cmd.type = THROTTLE_OUT_CURRENT;
+            cmd.value = x * cfg_.maxCurrent * limit;
+        } else {
+            cmd.type = THROTTLE_OUT_RPM;
+            cmd.value = x * cfg_.maxRpm * limit;
+        }
+        return cmd;
+    }
+
+    float shaped() const { return shaped_; }
+
+private:
+    ThrottleConfig cfg_;
+    float shaped_ = 0.0f;
+};
+
+#endif // THROTTLEPIPELINE_H
@@ -1,70 +1,364 @@
 #include "EVT_VescDriver.h"
 #include "EVT_RC.h"
 #include "EVT_StateMachine.h"
+#include "EVT_EventLog.h"
+#include "EVT_ErrorCodes.h"
+#include "EVT_FaultManager.h"
+#include "EVT_Drivetrain.h"
+#include "EVT_Throttle.h"
+#include "EVT_Capture.h"
+#include "EVT_CanBus.h"
+#include "EVT_CommandBus.h"
+#include "EVT_Ethernet.h"
 VescUart vesc1;
 VescUart vesc2;
+VescCan vescCan1(VESC1_CAN_ID, vesc1.data);
+VescCan vescCan2(VESC2_CAN_ID, vesc2.data);
 String vescDebug = "";
+float lastRpmCommand = 0.0f;
+
+// millis() of the last successful getVescValues() per controller, so fault
+// checks and telemetry can reuse what the control loop already fetched.
+static uint32_t vescDataMs[2] = {0, 0};
+static VescUart* const vescs[2] = { &vesc1, &vesc2 };
+static VescCan* const vescCans[2] = { &vescCan1, &vescCan2 };
+static const COMMAND_SLOT vescSlots[2] = { COMMAND_SLOT_VESC1, COMMAND_SLOT_VESC2 };
+
+static uint32_t vescRequestMs[2] = {0, 0};
+static bool     vescRequestPending[2] = {false, false};
+static uint32_t vescTelemetryMisses[2] = {0, 0};
+static mc_fault_code vescLoggedFault[2] = {FAULT_CODE_NONE, FAULT_CODE_NONE};
+
+// The VESCs talk through capture taps so a wire capture sees both directions.
+// busy tells the supervisor interrupt not to cut into a frame being written.
+class VescPort : public CaptureStream {
+public:
+    VescPort(HardwareSerial& serial, CAPTURE_PORT port) : CaptureStream(serial, port), raw(serial) {}
+
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        busy = true;
+        size_t written = CaptureStream::write(buffer, size);
+        busy = false;
+        return written;
+    }
+    using Print::write;
+
+    HardwareSerial& raw;
+    volatile bool busy = false;
+};
+
+static VescPort vesc1Port(Serial1, CAPTURE_PORT_SERIAL1);
+static VescPort vesc2Port(Serial5, CAPTURE_PORT_SERIAL5);
+static VescPort* const vescPorts[2] = { &vesc1Port, &vesc2Port };
+
+// ---- Command timeout supervisor ----
+static IntervalTimer vescSupervisorTimer;
+static volatile bool     vescStopped[2] = {false, false};
+static volatile uint32_t vescStops[2] = {0, 0};
+static volatile uint32_t vescStopAgeMs[2] = {0, 0};  // Command age when the stop began, for the event log.
+static uint32_t vescStopSentMs[2] = {0, 0};
+static bool     vescStopLogged[2] = {false, false};
+
+#if VESC_USE_CAN
+// The interrupt sends straight to the bus. These never receive.
+static vesc::Values vescStopScratch;
+static VescCan vescStopCan[2] = { VescCan(VESC1_CAN_ID, vescStopScratch), VescCan(VESC2_CAN_ID, vescStopScratch) };
+static volatile bool vescCanBusy = false;
+
+static bool vescCanSend(void* ctx, uint32_t id, uint8_t length, const uint8_t* data) {
+    vescCanBusy = true;
+    bool sent = canBusSend(ctx, id, length, data);
+    vescCanBusy = false;
+    return sent;
+}
+
+static bool sendVescStop(uint8_t index) {
+    if (vescCanBusy) return false;
+    return vescStopCan[index].setCurrent(0.0f);
+}
+#else
+// Packed once so the interrupt only copies bytes. It writes to the raw port:
+// the capture ring is not interrupt safe, so these frames are not captured.
+static uint8_t vescStopFrame[16];
+static int vescStopFrameLength = 0;
+
+static bool sendVescStop(uint8_t index) {
+    if (vescPorts[index]->busy) return false;
+    vescPorts[index]->raw.write(vescStopFrame, vescStopFrameLength);
+    return true;
+}
+#endif
+
+static void vescSupervisorTick() {
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < 2; i++) {
+        uint32_t confirmedMs = getCommandConfirmedMs(vescSlots[i]);
+        // Never commanded since boot: nothing to stop.
+        if (confirmedMs == 0) continue;
+        uint32_t age = now - confirmedMs;
+        if ((int32_t)age <= VESC_COMMAND_TIMEOUT_MS) {
+            vescStopped[i] = false;
+            continue;
+        }
+        if (!vescStopped[i]) {
+            vescStopped[i] = true;
+            vescStops[i]++;
+            vescStopAgeMs[i] = age;
+        } else if (now - vescStopSentMs[i] < VESC_STOP_REFRESH_MS) {
+            continue;
+        }
+        if (sendVescStop(i)) {
+            vescStopSentMs[i] = now;
+            // The VESC no longer holds what the bus last sent it.
+            forceCommandResend(vescSlots[i]);
+        }
+    }
+}
+
+static void setupVescSupervisor() {
+#if VESC_USE_CAN
+    for (uint8_t i = 0; i < 2; i++) vescStopCan[i].setSender(vescCanSend, NULL);
+#else
+    vesc::SetCurrent stop;
+    stop.current = 0.0f;
+    vescStopFrameLength = VescUart::packPacket(stop, vescStopFrame, sizeof(vescStopFrame));
+#endif
+    vescSupervisorTimer.begin(vescSupervisorTick, VESC_SUPERVISOR_PERIOD_US);
+}
+
+// Logs supervisor takeovers from loop context.
+static void reportVescStops() {
+    for (uint8_t i = 0; i < 2; i++) {
+        if (vescStopped[i] && !vescStopLogged[i]) {
+            logEvent(EVT_VESC_STOP, LOC_VESC, i, (int32_t)vescStopAgeMs[i]);
+            vescStopLogged[i] = true;
+        } else if (!vescStopped[i]) {
+            vescStopLogged[i] = false;
+        }
+    }
+}
+
+bool isVescStopped(uint8_t index) {
+    return index > 1 ? false : vescStopped[index];
+}
+
+uint32_t getVescSupervisorStops(uint8_t index) {
+    return index > 1 ? 0 : vescStops[index];
+}
+
+bool refreshVescValues(uint8_t index) {
+    if (index > 1) return false;
+    // The blocking read consumes any reply still in flight.
+    vescRequestPending[index] = false;
+    if (!vescs[index]->getVescValues()) return false;
+    vescDataMs[index] = millis();
+    return true;
+}
+
+bool ensureVescValues(uint8_t index, uint32_t maxAgeMs) {
+    if (index > 1) return false;
+    if (vescDataMs[index] != 0 && millis() - vescDataMs[index] <= maxAgeMs) return true;
+    return refreshVescValues(index);
+}
+
+#if VESC_USE_CAN
+static const uint32_t vescPollPeriodMs = VESC_FAULT_POLL_PERIOD_MS;
+static const int vescPollReply = COMM_GET_VALUES_SELECTIVE;
+#else
+static const uint32_t vescPollPeriodMs = VESC_TELEMETRY_PERIOD_MS;
+static const int vescPollReply = COMM_GET_VALUES;
+#endif
+
+static void requestVescPoll(uint8_t index) {
+#if VESC_USE_CAN
+    vescs[index]->requestVescValuesSelective(1UL << vesc::Values::FIELD_error);
+#else
+    vescs[index]->requestVescValues();
+#endif
+}
+
+void serviceVescTelemetry() {
+    reportVescStops();
+#if VESC_USE_CAN
+    // Delivers the status frames, which update vescN.data directly.
+    serviceCanBus();
+#endif
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < 2; i++) {
+#if VESC_USE_CAN
+        uint32_t statusMs = vescCans[i]->lastStatusMs();
+        if (statusMs != 0 && (int32_t)(statusMs - vescDataMs[i]) > 0) vescDataMs[i] = statusMs;
+#endif
+        if (vescRequestPending[i]) {
+            if (vescs[i]->pollMessage() == vescPollReply) {
+                // A fault-only reply does not make the rest of data fresh.
+                if (vescPollReply == COMM_GET_VALUES) vescDataMs[i] = now;
+                vescRequestPending[i] = false;
+            } else if (now - vescRequestMs[i] > VESC_TELEMETRY_TIMEOUT_MS) {
+                vescTelemetryMisses[i]++;
+                vescRequestPending[i] = false;
+            }
+        }
+        if (!vescRequestPending[i] && now - vescRequestMs[i] >= vescPollPeriodMs) {
+            requestVescPoll(i);
+            vescRequestMs[i] = now;
+            vescRequestPending[i] = true;
+        }
+    }
+}
+
+uint32_t getVescTelemetryMisses(uint8_t index) {
+    return index > 1 ? 0 : vescTelemetryMisses[index];
+}
+
+#if VESC_USE_CAN
+static void vescCanFrame(void* ctx, uint32_t id, uint8_t length, const uint8_t* data) {
+    static_cast<VescCan*>(ctx)->onReceive(id, length, data);
+}
+#endif
+
+// Telemetry topics read the cached values serviceVescTelemetry() keeps fresh.
+static void sampleDriveTopic(void* payload) {
+    TelemetryDrive &t = *(TelemetryDrive*)payload;
+    for (uint8_t i = 0; i < 2; i++) {
+        t.rpm[i]          = vescs[i]->data.rpm;
+        t.motorCurrent[i] = vescs[i]->data.avgMotorCurrent;
+        t.duty[i]         = vescs[i]->data.dutyCycleNow;
+    }
+    t.rpmCommand = lastRpmCommand;
+}
+
+static void samplePowerTopic(void* payload) {
+    TelemetryPower &t = *(TelemetryPower*)payload;
+    t.vescVoltage = vesc1.data.inpVoltage;  // VESCs are in parallel so voltage is the same.
+    for (uint8_t i = 0; i < 2; i++) {
+        t.inputCurrent[i] = vescs[i]->data.avgInputCurrent;
+        t.tempMosfet[i]   = vescs[i]->data.tempMosfet;
+        t.vescFault[i]    = (uint8_t)vescs[i]->data.error;
+    }
+    t.reserved[0] = t.reserved[1] = 0;
+}
 
 void setupVesc() {
     Serial1.begin(115200);
-    vesc1.setSerialPort(&Serial1);
+    vesc1.setSerialPort(&vesc1Port);
     
     Serial5.begin(115200);
-    vesc2.setSerialPort(&Serial5);
+    vesc2.setSerialPort(&vesc2Port);
+
+#if VESC_USE_CAN
+    setupCanBus();
+    bindCommandCanPort(vescCanSend);
+    for (uint8_t i = 0; i < 2; i++) {
+        // Commands are staged and go out as frames from flushCommandBus().
+        routeCommandSlot(vescSlots[i], COMMAND_PORT_CAN);
+        vescCans[i]->setSender(stageCanCommand, (void*)(uintptr_t)vescSlots[i]);
+        canBusAttach(vescCans[i]->filterMask(), vescCans[i]->filterMatch(), vescCanFrame, vescCans[i]);
+    }
+#else
+    bindCommandPort(COMMAND_PORT_VESC1, &vesc1Port);
+    bindCommandPort(COMMAND_PORT_VESC2, &vesc2Port);
+#endif
+    setupVescSupervisor();
+
+    addTelemetryTopic(TELEMETRY_TOPIC_DRIVE, VESC_TOPIC_DRIVE_HZ, sampleDriveTopic, sizeof(TelemetryDrive));
+    addTelemetryTopic(TELEMETRY_TOPIC_POWER, VESC_TOPIC_POWER_HZ, samplePowerTopic, sizeof(TelemetryPower));
+}
+
+#if !VESC_USE_CAN
+template <typename Packet>
+static void stageVescPacket(uint8_t index, const Packet& packet) {
+    uint8_t frame[COMMAND_SLOT_BYTES];
+    int length = VescUart::packPacket(packet, frame, sizeof(frame));
+    if (length > 0) stageCommand(vescSlots[index], frame, length);
+}
+#endif
+
+void vescSetCurrent(uint8_t index, float current) {
+    if (index > 1) return;
+#if VESC_USE_CAN
+    vescCans[index]->setCurrent(current);
+#else
+    vesc::SetCurrent command;
+    command.current = current;
+    stageVescPacket(index, command);
+#endif
+}
+
+void vescSetBrakeCurrent(uint8_t index, float brakeCurrent) {
+    if (index > 1) return;
+#if VESC_USE_CAN
+    vescCans[index]->setBrakeCurrent(brakeCurrent);
+#else
+    vesc::SetCurrentBrake command;
+    command.current = brakeCurrent;
+    stageVescPacket(index, command);
+#endif
+}
+
+void vescSetRpm(uint8_t index, float rpm) {
+    if (index > 1) return;
+#if VESC_USE_CAN
+    vescCans[index]->setRPM(rpm);
+#else
+    vesc::SetRpm command;
+    command.rpm = rpm;
+    stageVescPacket(index, command);
+#endif
 }
 void printVescError() {
     // Update the VESC values first
-    vesc1.getVescValues();
-    vesc2.getVescValues();
+    refreshVescValues(0);
+    refreshVescValues(1);
     
     // Print error information for VESC1.
     Serial.print("VESC1 error: ");
-    Serial.println(vesc1.data.error);
+    Serial.println(vescFaultToString(vesc1.data.error));
     
     // Print error information for VESC2.
     Serial.print("VESC2 error: ");
-    Serial.println(vesc2.data.error);
+    Serial.println(vescFaultToString(vesc2.data.error));
 }
-void vescErrorCheck() {
-    vesc1.getVescValues();
-    vesc2.getVescValues();
-    
-    if (vesc1.data.error > 0) {
-        SetErrorState(ERR_VESC, String(vesc1.data.error).c_str());
-    }
-    if (vesc2.data.error > 0) {
-        SetErrorState(ERR_VESC, String(vesc2.data.error).c_str());
+FAULT_SEVERITY vescFaultSeverity(mc_fault_code fault) {
+    switch (fault) {
+    case FAULT_CODE_NONE:
+        return FAULT_WARNING;
+    // Supply sag and temperature: the VESC recovers by itself, keep driving gently.
+    case FAULT_CODE_UNDER_VOLTAGE:
+    case FAULT_CODE_OVER_TEMP_FET:
+    case FAULT_CODE_OVER_TEMP_MOTOR:
+        return FAULT_DEGRADED;
+    default:
+        return FAULT_CRITICAL;
     }
 }
-void updateVescControl() {
 
-    vesc1.getVescValues();
-    if (vesc1.data.error > 0) {
-        SetErrorState(ERR_VESC, String(vesc1.data.error).c_str());
+// A VESC keeps reporting its fault until it is cleared, so the code is only
+// logged when it changes; reportFault() rate-limits the reaction itself.
+static void reportVescFault(uint8_t index, mc_fault_code fault) {
+    if (fault != vescLoggedFault[index]) {
+        vescLoggedFault[index] = fault;
+        if (fault != FAULT_CODE_NONE) logEvent(EVT_VESC_FAULT, LOC_VESC, index, fault);
     }
+    if (fault != FAULT_CODE_NONE) reportFault(vescFaultSeverity(fault), ERR_VESC, vescFaultToString(fault));
+}
 
-    int ch_vesc = channels[1];
-    const int neutral = 990;
-    const int deadband = 20;
-    
-    float rpmCommand = 0.0f;
-    
-    if (ch_vesc > (neutral + deadband)) {
-        float forwardRange = 1700.0f - (neutral + deadband);
-        rpmCommand = ((float)ch_vesc - (neutral + deadband)) / forwardRange * 7500.0f;
-        if (rpmCommand < 0.0f) rpmCommand = 0.0f;
-        if (rpmCommand > 7500.0f) rpmCommand = 7500.0f;
-    } else if (ch_vesc < (neutral - deadband)) {
-        float reverseRange = (neutral - deadband) - 350.0f;
-        float reverseProportion = ((neutral - deadband) - (float)ch_vesc) / reverseRange;
-        if (reverseProportion < 0.0f) reverseProportion = 0.0f;
-        if (reverseProportion > 1.0f) reverseProportion = 1.0f;
-        rpmCommand = -reverseProportion * 7500.0f;
-    } else {
-        rpmCommand = 0.0f;
-    }
-    
-    vesc1.setRPM(rpmCommand);
-    vesc2.setRPM(rpmCommand);
+void vescErrorCheck() {
+    // Only query a controller if the control loop has not done so recently.
+    ensureVescValues(0, VESC_DATA_MAX_AGE_MS);
+    ensureVescValues(1, VESC_DATA_MAX_AGE_MS);
     
+    for (uint8_t i = 0; i < 2; i++) reportVescFault(i, vescs[i]->data.error);
+}
+void updateVescControl() {
+
+    // Data comes from serviceVescTelemetry(); only block if it has gone stale.
+    ensureVescValues(0, VESC_DATA_MAX_AGE_MS);
+    reportVescFault(0, vesc1.data.error);
+
+    // Deadband, expo, ramp and brake/reverse mapping live in EVT_Throttle.
+    ThrottleCommand command = updateRcThrottle();
+    lastRpmCommand = command.type == THROTTLE_OUT_RPM ? command.value : 0.0f;
+    updateDrivetrain(command);
 }
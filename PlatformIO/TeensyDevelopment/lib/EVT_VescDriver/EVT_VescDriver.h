@@ -3,50 +3,80 @@
 
 #include <Arduino.h>
 #include <VescUart.h>
+#include <VescCan.h>
 #include <SoftwareSerial.h>
-#include <map> // Include for std::map
+#include "EVT_FaultManager.h"
 
 // VESC function prototypes.
 void setupVesc();
 void vescErrorCheck();
 void updateVescControl();
 void printVescError();
+FAULT_SEVERITY vescFaultSeverity(mc_fault_code fault);
+
+// Telemetry older than this is refetched by the fault check.
+#define VESC_DATA_MAX_AGE_MS 50
+
+// Fetches COMM_GET_VALUES for vesc1 (index 0) or vesc2 (index 1) and stamps it.
+bool refreshVescValues(uint8_t index);
+// Same, but skips the round trip if the cached data is younger than maxAgeMs.
+bool ensureVescValues(uint8_t index, uint32_t maxAgeMs);
+
+// Non-blocking telemetry: each VESC is asked for COMM_GET_VALUES every
+// VESC_TELEMETRY_PERIOD_MS and the reply is picked up on later calls, so the
+// loop never waits on the UART. Call once per loop.
+#define VESC_TELEMETRY_PERIOD_MS  10   // 100 Hz per controller
+#define VESC_TELEMETRY_TIMEOUT_MS 25
+void serviceVescTelemetry();
+
+// Rates of the drive and power topics on the UDP telemetry publisher.
+#define VESC_TOPIC_DRIVE_HZ       100  // Matches VESC_TELEMETRY_PERIOD_MS; faster only repeats samples.
+#define VESC_TOPIC_POWER_HZ       10
+
+// 1 = telemetry comes from the VESCs' CAN status broadcasts (STATUS 1-5, set
+// the rate in VESC Tool) and commands go out as CAN frames on the shared
+// EVT_CanBus. The status frames carry no fault code, so the UART then only
+// polls that with COMM_GET_VALUES_SELECTIVE every VESC_FAULT_POLL_PERIOD_MS.
+// Can be set from build_flags (-DVESC_USE_CAN=1) instead of here.
+#ifndef VESC_USE_CAN
+#define VESC_USE_CAN              0
+#endif
+#define VESC1_CAN_ID              1    // VESC Tool > App Settings > General > VESC ID
+#define VESC2_CAN_ID              2
+#define VESC_FAULT_POLL_PERIOD_MS 100
+// Requests that went unanswered within the timeout.
+uint32_t getVescTelemetryMisses(uint8_t index);
+
+// Motor commands for vesc1 (index 0) or vesc2 (index 1), over CAN or UART
+// depending on VESC_USE_CAN. They are staged on EVT_CommandBus, so only the
+// last one per controller each loop is sent, from flushCommandBus().
+void vescSetCurrent(uint8_t index, float current);
+void vescSetBrakeCurrent(uint8_t index, float brakeCurrent);
+void vescSetRpm(uint8_t index, float rpm);
+
+// Command timeout supervisor. An IntervalTimer checks every
+// VESC_SUPERVISOR_PERIOD_US how long ago each VESC last got the command the
+// loop wanted. Past VESC_COMMAND_TIMEOUT_MS (loop stalled, or it stopped
+// commanding that VESC, as in IDLE and ERR) it sends zero current from the
+// interrupt, repeated every VESC_STOP_REFRESH_MS, until commands flow again.
+// Zero current rather than COMM_ALIVE: an alive packet would keep the last
+// RPM running, which is what the timeout is there to prevent.
+#define VESC_SUPERVISOR_PERIOD_US 5000  // 200 Hz
+#define VESC_COMMAND_TIMEOUT_MS   100   // Control loop deadline; above the worst normal loop (SD flushes take tens of ms).
+#define VESC_STOP_REFRESH_MS      50
+// True while the supervisor holds the VESC at zero current.
+bool isVescStopped(uint8_t index);
+// Times the supervisor took over a VESC.
+uint32_t getVescSupervisorStops(uint8_t index);
 
 extern String vescDebug;
+extern float lastRpmCommand;  // RPM requested on the last update, before the drivetrain splits it.
 
 // VESC objects declared for external use.
 extern VescUart vesc1;
 extern VescUart vesc2;
+// CAN side of the same controllers; they decode into vesc1.data / vesc2.data.
+extern VescCan vescCan1;
+extern VescCan vescCan2;
 
-static const std::map<uint32_t, String> vescErrorMap = {
-         { 0, "None" },
-        {FAULT_CODE_OVER_VOLTAGE,"Overvoltage" },
-        {FAULT_CODE_UNDER_VOLTAGE, "Undervoltage" },
-        {FAULT_CODE_DRV, "DRV Fault" },
-        {FAULT_CODE_ABS_OVER_CURRENT, "Absolute Overcurrent" },
-        {FAULT_CODE_OVER_TEMP_FET, "Overtemperature FET" },
-        {FAULT_CODE_OVER_TEMP_MOTOR, "Overtemperature Motor" },
-        {FAULT_CODE_GATE_DRIVER_OVER_VOLTAGE, "Gate Driver Overvoltage" },
-        {FAULT_CODE_GATE_DRIVER_UNDER_VOLTAGE, "Gate Driver Undervoltage" },
-        {FAULT_CODE_MCU_UNDER_VOLTAGE, "MCU Undervoltage" },
-        {FAULT_CODE_BOOTING_FROM_WATCHDOG_RESET, "Booting from Watchdog Reset" },
-        {FAULT_CODE_ENCODER_SPI, "Encoder SPI Fault" },
-        {FAULT_CODE_ENCODER_SINCOS_BELOW_MIN_AMPLITUDE, "Encoder SinCos Below Min Amplitude" },
-        {FAULT_CODE_ENCODER_SINCOS_ABOVE_MAX_AMPLITUDE, "Encoder SinCos Above Max Amplitude" },
-        {FAULT_CODE_FLASH_CORRUPTION, "Flash Corruption" },
-        {FAULT_CODE_HIGH_OFFSET_CURRENT_SENSOR_1, "High Offset Current Sensor 1" },
-        {FAULT_CODE_HIGH_OFFSET_CURRENT_SENSOR_2, "High Offset Current Sensor 2" },
-        {FAULT_CODE_HIGH_OFFSET_CURRENT_SENSOR_3, "High Offset Current Sensor 3" },
-        {FAULT_CODE_UNBALANCED_CURRENTS, "Unbalanced Currents" },
-        {FAULT_CODE_BRK, "Brake Fault" },
-        {FAULT_CODE_RESOLVER_LOT, "Resolver Loss of Tracking" },
-        {FAULT_CODE_RESOLVER_DOS, "Resolver Loss of Signal" },
-        {FAULT_CODE_RESOLVER_LOS, "Resolver Loss of Signal" },
-        {FAULT_CODE_FLASH_CORRUPTION_APP_CFG, "Flash Corruption App Config" },
-        {FAULT_CODE_FLASH_CORRUPTION_MC_CFG, "Flash Corruption MC Config" },
-        {FAULT_CODE_ENCODER_NO_MAGNET, "Encoder No Magnet" },
-        {FAULT_CODE_ENCODER_MAGNET_TOO_STRONG, "Encoder Magnet Too Strong" },
-        {FAULT_CODE_PHASE_FILTER, "Phase Filter Fault" },
-    } ;
-       
 #endif // EVT_VESCDRIVER_H
@@ -39,6 +39,13 @@ public:
      */
     void setPosition(float position, float velocity_feedforward, float torque_feedforward);
 
+    /**
+     * @brief Writes the line setPosition(position, velocity_feedforward,
+     * torque_feedforward) would send to out instead, e.g. to batch it with
+     * other output.
+     */
+    static void printPosition(Print& out, float position, float velocity_feedforward, float torque_feedforward);
+
     /**
      * @brief Sends a new velocity setpoint.
      */
@@ -49,6 +56,12 @@ public:
      */
     void setVelocity(float velocity, float torque_feedforward);
 
+    /**
+     * @brief Writes the line setVelocity(velocity, torque_feedforward) would
+     * send to out instead, as printPosition() does.
+     */
+    static void printVelocity(Print& out, float velocity, float torque_feedforward);
+
     /**
      * @brief Sends a new torque setpoint.
      */
@@ -321,6 +321,9 @@ SBUS::~SBUS() {
   }
 }
 
+/* set a callback that sees every received byte */
+void SBUS::setTap(void (*tap)(uint8_t b)) { _tap = tap; }
+
 /* parse the SBUS data */
 bool SBUS::parse() {
   // reset the parser state if too much time has passed
@@ -332,6 +335,9 @@ bool SBUS::parse() {
   while (_bus->available() > 0) {
     _sbusTime = 0;
     _curByte = _bus->read();
+    if (_tap) {
+      _tap(_curByte);
+    }
     // find the header
     if (_parserState == 0) {
       if ((_curByte == _sbusHeader) &&
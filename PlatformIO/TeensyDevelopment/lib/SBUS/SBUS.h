@@ -52,6 +52,8 @@ public:
   void getReadCal(uint8_t channel, float* coeff, uint8_t len);
   void setWriteCal(uint8_t channel, float* coeff, uint8_t len);
   void getWriteCal(uint8_t channel, float* coeff, uint8_t len);
+  // called with every received byte, used by the wire capture
+  void setTap(void (*tap)(uint8_t b));
   ~SBUS();
 
 private:
@@ -73,10 +75,11 @@ private:
   uint16_t _sbusMax[_numChannels];
   float _sbusScale[_numChannels];
   float _sbusBias[_numChannels];
-  float **_readCoeff, **_writeCoeff;
+  float **_readCoeff = nullptr, **_writeCoeff = nullptr;
   uint8_t _readLen[_numChannels], _writeLen[_numChannels];
   bool _useReadCoeff[_numChannels], _useWriteCoeff[_numChannels];
   HardwareSerial* _bus;
+  void (*_tap)(uint8_t b) = nullptr;
   bool parse();
   void scaleBias(uint8_t channel);
   float PolyVal(size_t PolySize, float* Coefficients, float X);
@@ -0,0 +1,97 @@
+#include "VescCan.h"
+
+// VESC CAN ids are extended: packet id in bits 8-15, controller id in bits 0-7.
+static const uint32_t VESC_CAN_EXTENDED = 0x80000000;
+static const uint32_t VESC_CAN_ID_MASK = 0x1FFFFFFF;
+
+VescCan::VescCan(uint8_t controllerId, vesc::Values& data) : _controllerId(controllerId), _data(data) {}
+
+void VescCan::setSender(SendFunction send, void* ctx) {
+	_send = send;
+	_sendCtx = ctx;
+}
+
+uint32_t VescCan::filterMask() const {
+	return VESC_CAN_EXTENDED | 0xFF;
+}
+
+uint32_t VescCan::filterMatch() const {
+	return VESC_CAN_EXTENDED | _controllerId;
+}
+
+template <typename Status>
+bool VescCan::decodeStatus(uint8_t length, const uint8_t* data) {
+	// Checked up front so a short frame never leaves data half written.
+	if (length < Status::WIRE_SIZE) {
+		_shortFrames++;
+		return false;
+	}
+	util::BufReader in(data, length);
+	vesc::decode(in, _data, Status());
+	return true;
+}
+
+bool VescCan::onReceive(uint32_t id, uint8_t length, const uint8_t* data) {
+	if ((id & filterMask()) != filterMatch())
+		return false;
+
+	bool decoded;
+	switch ((id & VESC_CAN_ID_MASK) >> 8) {
+		case CAN_PACKET_STATUS:		decoded = decodeStatus<vesc::CanStatus1>(length, data); break;
+		case CAN_PACKET_STATUS_2:	decoded = decodeStatus<vesc::CanStatus2>(length, data); break;
+		case CAN_PACKET_STATUS_3:	decoded = decodeStatus<vesc::CanStatus3>(length, data); break;
+		case CAN_PACKET_STATUS_4:	decoded = decodeStatus<vesc::CanStatus4>(length, data); break;
+		case CAN_PACKET_STATUS_5:	decoded = decodeStatus<vesc::CanStatus5>(length, data); break;
+		// STATUS_6 (ADC/PPM inputs) has no place in the values; everything else is not telemetry.
+		default:
+			return false;
+	}
+	if (!decoded)
+		return false;
+
+	_statusFrames++;
+	_lastStatusMs = millis();
+	return true;
+}
+
+template <typename Packet>
+bool VescCan::send(uint8_t canPacketId, const Packet& packet) {
+	if (_send == NULL)
+		return false;
+	uint8_t payload[8];
+	util::BufWriter out(payload, sizeof(payload));
+	vesc::encode(out, packet);
+	uint32_t id = VESC_CAN_EXTENDED | ((uint32_t)canPacketId << 8) | _controllerId;
+	return _send(_sendCtx, id, out.size(), payload);
+}
+
+// The CAN command payloads are the UART ones without the COMM_PACKET_ID byte.
+bool VescCan::setCurrent(float current) {
+	vesc::SetCurrent command;
+	command.current = current;
+	return send(CAN_PACKET_SET_CURRENT, command);
+}
+
+bool VescCan::setBrakeCurrent(float brakeCurrent) {
+	vesc::SetCurrentBrake command;
+	command.current = brakeCurrent;
+	return send(CAN_PACKET_SET_CURRENT_BRAKE, command);
+}
+
+bool VescCan::setRPM(float rpm) {
+	vesc::SetRpm command;
+	command.rpm = rpm;
+	return send(CAN_PACKET_SET_RPM, command);
+}
+
+bool VescCan::setDuty(float duty) {
+	vesc::SetDuty command;
+	command.duty = duty;
+	return send(CAN_PACKET_SET_DUTY, command);
+}
+
+bool VescCan::setCurrentRel(float current) {
+	vesc::SetCurrentRel command;
+	command.current = current;
+	return send(CAN_PACKET_SET_CURRENT_REL, command);
+}
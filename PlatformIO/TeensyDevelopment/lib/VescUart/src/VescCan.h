@@ -0,0 +1,75 @@
+#ifndef _VESCCAN_h
+#define _VESCCAN_h
+
+#include <Arduino.h>
+#include "VescPackets.h"
+
+/**
+ * VESC on a CAN bus.
+ *
+ * With CAN status messages enabled (VESC Tool > App Settings > General > CAN
+ * Status Message Mode and Rate) the VESC broadcasts CAN_PACKET_STATUS to
+ * STATUS_5 by itself, so telemetry needs no request round trip. Commands are
+ * single extended frames. The class does not own the bus: frames come in
+ * through onReceive() and go out through the function given to setSender().
+ */
+class VescCan
+{
+	public:
+		typedef bool (*SendFunction)(void* ctx, uint32_t id, uint8_t length, const uint8_t* data);
+
+		/**
+		 * @brief      Class constructor
+		 * @param      controllerId  - The VESC's CAN ID
+		 * @param      data          - Decoded statuses go here, usually a VescUart's data so
+		 *                             readers do not care which link filled it
+		 */
+		VescCan(uint8_t controllerId, vesc::Values& data);
+
+		/**
+		 * @brief      Set how command frames are sent
+		 * @param      send  - Called with the id (bit 31 = extended), length and payload
+		 * @param      ctx   - Passed back to send
+		 */
+		void setSender(SendFunction send, void* ctx);
+
+		/** Dispatcher mask and match selecting this VESC's frames (extended, low byte = controller ID) */
+		uint32_t filterMask() const;
+		uint32_t filterMatch() const;
+
+		/**
+		 * @brief      Decodes a received frame if it is a status from this VESC
+		 * @return     True if data was updated
+		 */
+		bool onReceive(uint32_t id, uint8_t length, const uint8_t* data);
+
+		/** millis() of the last decoded status, 0 before the first one */
+		uint32_t lastStatusMs() const { return _lastStatusMs; }
+
+		/** Statuses decoded and frames rejected as too short */
+		uint32_t statusFrames() const { return _statusFrames; }
+		uint32_t shortFrames() const { return _shortFrames; }
+
+		bool setCurrent(float current);
+		bool setBrakeCurrent(float brakeCurrent);
+		bool setRPM(float rpm);
+		bool setDuty(float duty);
+		bool setCurrentRel(float current);
+
+	private:
+		template <typename Packet>
+		bool send(uint8_t canPacketId, const Packet& packet);
+
+		template <typename Status>
+		bool decodeStatus(uint8_t length, const uint8_t* data);
+
+		const uint8_t _controllerId;
+		vesc::Values& _data;
+		SendFunction _send = NULL;
+		void* _sendCtx = NULL;
+		uint32_t _lastStatusMs = 0;
+		uint32_t _statusFrames = 0;
+		uint32_t _shortFrames = 0;
+};
+
+#endif
@@ -0,0 +1,249 @@
+#ifndef _VESCPACKETS_h
+#define _VESCPACKETS_h
+
+#include <stdint.h>
+#include "datatypes.h"
+#include "bufio.h"
+
+/*
+ * Wire layout of the VESC packets this library sends or decodes.
+ *
+ * Each schema lists X(member, C type, wire type, scale) in wire order, after
+ * the COMM_PACKET_ID byte. VESC_PACKET() turns a schema into a struct plus
+ * vesc::encode()/vesc::decode() and the masked variants used by the
+ * *_SELECTIVE / IMU packets, where a field's position in the list is its bit
+ * in the mask. Adding a field is one line here; nothing counts offsets.
+ *
+ * Wire types: U8, BOOL, I16, U16, I32, U32, F16 and F32 (fixed point,
+ * value = raw / scale) and F32_AUTO (VESC float32_auto, scale unused).
+ * Field order and scales follow commands.c in the VESC bldc firmware.
+ */
+
+#define VESC_FW_VERSION_FIELDS(X) \
+	X(major,			uint8_t,		U8,		1) \
+	X(minor,			uint8_t,		U8,		1)
+
+// Reply to COMM_GET_VALUES. The order is also the COMM_GET_VALUES_SELECTIVE mask.
+#define VESC_VALUES_FIELDS(X) \
+	X(tempMosfet,		float,			F16,	10)			/* mc_interface_temp_fet_filtered() */ \
+	X(tempMotor,		float,			F16,	10)			/* mc_interface_temp_motor_filtered() */ \
+	X(avgMotorCurrent,	float,			F32,	100)		/* mc_interface_read_reset_avg_motor_current() */ \
+	X(avgInputCurrent,	float,			F32,	100)		/* mc_interface_read_reset_avg_input_current() */ \
+	X(avgId,			float,			F32,	100)		/* mc_interface_read_reset_avg_id() */ \
+	X(avgIq,			float,			F32,	100)		/* mc_interface_read_reset_avg_iq() */ \
+	X(dutyCycleNow,		float,			F16,	1000)		/* mc_interface_get_duty_cycle_now() */ \
+	X(rpm,				float,			F32,	1)			/* mc_interface_get_rpm() */ \
+	X(inpVoltage,		float,			F16,	10)			/* GET_INPUT_VOLTAGE() */ \
+	X(ampHours,			float,			F32,	10000)		/* mc_interface_get_amp_hours(false) */ \
+	X(ampHoursCharged,	float,			F32,	10000)		/* mc_interface_get_amp_hours_charged(false) */ \
+	X(wattHours,		float,			F32,	10000)		/* mc_interface_get_watt_hours(false) */ \
+	X(wattHoursCharged,	float,			F32,	10000)		/* mc_interface_get_watt_hours_charged(false) */ \
+	X(tachometer,		long,			I32,	1)			/* mc_interface_get_tachometer_value(false) */ \
+	X(tachometerAbs,	long,			I32,	1)			/* mc_interface_get_tachometer_abs_value(false) */ \
+	X(error,			mc_fault_code,	U8,		1)			/* mc_interface_get_fault() */ \
+	X(pidPos,			float,			F32,	1000000)	/* mc_interface_get_pid_pos_now() */ \
+	X(id,				uint8_t,		U8,		1)			/* app_get_configuration()->controller_id */
+
+// Reply to COMM_GET_IMU_DATA after its uint16 mask; only the masked fields are sent.
+#define VESC_IMU_FIELDS(X) \
+	X(roll,				float,			F32_AUTO,	1) \
+	X(pitch,			float,			F32_AUTO,	1) \
+	X(yaw,				float,			F32_AUTO,	1) \
+	X(accX,				float,			F32_AUTO,	1) \
+	X(accY,				float,			F32_AUTO,	1) \
+	X(accZ,				float,			F32_AUTO,	1) \
+	X(gyroX,			float,			F32_AUTO,	1) \
+	X(gyroY,			float,			F32_AUTO,	1) \
+	X(gyroZ,			float,			F32_AUTO,	1) \
+	X(magX,				float,			F32_AUTO,	1) \
+	X(magY,				float,			F32_AUTO,	1) \
+	X(magZ,				float,			F32_AUTO,	1) \
+	X(q0,				float,			F32_AUTO,	1) \
+	X(q1,				float,			F32_AUTO,	1) \
+	X(q2,				float,			F32_AUTO,	1) \
+	X(q3,				float,			F32_AUTO,	1)
+
+#define VESC_NO_FIELDS(X)
+
+#define VESC_MASK32_FIELDS(X) \
+	X(mask,				uint32_t,		U32,	1)
+
+#define VESC_MASK16_FIELDS(X) \
+	X(mask,				uint16_t,		U16,	1)
+
+#define VESC_SET_DUTY_FIELDS(X) \
+	X(duty,				float,			F32,	100000)
+
+#define VESC_SET_CURRENT_FIELDS(X) \
+	X(current,			float,			F32,	1000)
+
+#define VESC_SET_CURRENT_REL_FIELDS(X) \
+	X(current,			float,			F32,	100000)		/* -1.0 to 1.0 of the configured max current */
+
+#define VESC_SET_RPM_FIELDS(X) \
+	X(rpm,				float,			F32,	1)
+
+// Acceleration is not used by the nunchuck app but is part of the packet.
+#define VESC_CHUCK_DATA_FIELDS(X) \
+	X(valueX,			int,			U8,		1) \
+	X(valueY,			int,			U8,		1) \
+	X(lowerButton,		bool,			BOOL,	1) \
+	X(upperButton,		bool,			BOOL,	1) \
+	X(accX,				int16_t,		I16,	1) \
+	X(accY,				int16_t,		I16,	1) \
+	X(accZ,				int16_t,		I16,	1)
+
+// CAN_PACKET_STATUS..STATUS_5, broadcast by the VESC without a request. The
+// members are the COMM_GET_VALUES ones they fill (comm_can.c in bldc). The
+// reserved int16 at the end of STATUS_5 is not read.
+#define VESC_CAN_STATUS_1_FIELDS(X) \
+	X(rpm,				float,			I32,	1) \
+	X(avgMotorCurrent,	float,			F16,	10) \
+	X(dutyCycleNow,		float,			F16,	1000)
+
+#define VESC_CAN_STATUS_2_FIELDS(X) \
+	X(ampHours,			float,			F32,	10000) \
+	X(ampHoursCharged,	float,			F32,	10000)
+
+#define VESC_CAN_STATUS_3_FIELDS(X) \
+	X(wattHours,		float,			F32,	10000) \
+	X(wattHoursCharged,	float,			F32,	10000)
+
+#define VESC_CAN_STATUS_4_FIELDS(X) \
+	X(tempMosfet,		float,			F16,	10) \
+	X(tempMotor,		float,			F16,	10) \
+	X(avgInputCurrent,	float,			F16,	10) \
+	X(pidPos,			float,			F16,	50)
+
+#define VESC_CAN_STATUS_5_FIELDS(X) \
+	X(tachometer,		long,			I32,	1) \
+	X(inpVoltage,		float,			F16,	10)
+
+namespace vesc {
+
+enum WireType { WIRE_U8, WIRE_BOOL, WIRE_I16, WIRE_U16, WIRE_I32, WIRE_U32, WIRE_F16, WIRE_F32, WIRE_F32_AUTO };
+
+/** Per wire type: encoded size and the BufReader/BufWriter call for it */
+template <WireType W, uint32_t Scale> struct Wire;
+
+template <uint32_t S> struct Wire<WIRE_U8, S> {
+	static const size_t size = 1;
+	template <typename T> static void get(util::BufReader& in, T& v) { v = (T)in.u8(); }
+	template <typename T> static void put(util::BufWriter& out, const T& v) { out.u8((uint8_t)v); }
+};
+template <uint32_t S> struct Wire<WIRE_BOOL, S> {
+	static const size_t size = 1;
+	template <typename T> static void get(util::BufReader& in, T& v) { v = in.boolean(); }
+	template <typename T> static void put(util::BufWriter& out, const T& v) { out.boolean(v); }
+};
+template <uint32_t S> struct Wire<WIRE_I16, S> {
+	static const size_t size = 2;
+	template <typename T> static void get(util::BufReader& in, T& v) { v = (T)in.i16(); }
+	template <typename T> static void put(util::BufWriter& out, const T& v) { out.i16((int16_t)v); }
+};
+template <uint32_t S> struct Wire<WIRE_U16, S> {
+	static const size_t size = 2;
+	template <typename T> static void get(util::BufReader& in, T& v) { v = (T)in.u16(); }
+	template <typename T> static void put(util::BufWriter& out, const T& v) { out.u16((uint16_t)v); }
+};
+template <uint32_t S> struct Wire<WIRE_I32, S> {
+	static const size_t size = 4;
+	template <typename T> static void get(util::BufReader& in, T& v) { v = (T)in.i32(); }
+	template <typename T> static void put(util::BufWriter& out, const T& v) { out.i32((int32_t)v); }
+};
+template <uint32_t S> struct Wire<WIRE_U32, S> {
+	static const size_t size = 4;
+	template <typename T> static void get(util::BufReader& in, T& v) { v = (T)in.u32(); }
+	template <typename T> static void put(util::BufWriter& out, const T& v) { out.u32((uint32_t)v); }
+};
+template <uint32_t S> struct Wire<WIRE_F16, S> {
+	static const size_t size = 2;
+	template <typename T> static void get(util::BufReader& in, T& v) { v = (T)in.f16<S>(); }
+	template <typename T> static void put(util::BufWriter& out, const T& v) { out.f16<S>((float)v); }
+};
+template <uint32_t S> struct Wire<WIRE_F32, S> {
+	static const size_t size = 4;
+	template <typename T> static void get(util::BufReader& in, T& v) { v = (T)in.f32<S>(); }
+	template <typename T> static void put(util::BufWriter& out, const T& v) { out.f32<S>((float)v); }
+};
+template <uint32_t S> struct Wire<WIRE_F32_AUTO, S> {
+	static const size_t size = 4;
+	template <typename T> static void get(util::BufReader& in, T& v) { v = (T)in.f32Auto(); }
+	template <typename T> static void put(util::BufWriter& out, const T& v) { out.f32Auto((float)v); }
+};
+
+#define VESC_WIRE(wire, scale)							vesc::Wire<vesc::WIRE_##wire, scale>
+#define VESC_FIELD_MEMBER(name, type, wire, scale)		type name;
+#define VESC_FIELD_INDEX(name, type, wire, scale)		FIELD_##name,
+#define VESC_FIELD_SIZE(name, type, wire, scale)		+ VESC_WIRE(wire, scale)::size
+#define VESC_FIELD_GET(name, type, wire, scale)			VESC_WIRE(wire, scale)::get(in, v.name);
+#define VESC_FIELD_PUT(name, type, wire, scale)			VESC_WIRE(wire, scale)::put(out, v.name);
+#define VESC_FIELD_GET_MASKED(name, type, wire, scale) \
+	if (mask & (1UL << Packet::FIELD_##name)) VESC_WIRE(wire, scale)::get(in, v.name);
+#define VESC_FIELD_PUT_MASKED(name, type, wire, scale) \
+	if (mask & (1UL << Packet::FIELD_##name)) VESC_WIRE(wire, scale)::put(out, v.name);
+
+/**
+ * Declares struct Name for packet ID with the fields of SCHEMA, and its
+ * encode()/decode() overloads. Name::FIELD_<member> is the member's mask bit,
+ * Name::WIRE_SIZE the encoded size without the ID byte.
+ */
+#define VESC_PACKET(Name, packetId, SCHEMA) \
+	struct Name { \
+		static const uint8_t ID = packetId; \
+		enum : uint8_t { SCHEMA(VESC_FIELD_INDEX) FIELD_COUNT }; \
+		static const size_t WIRE_SIZE = 0 SCHEMA(VESC_FIELD_SIZE); \
+		SCHEMA(VESC_FIELD_MEMBER) \
+	}; \
+	inline void decode(util::BufReader& in, Name& v) { (void)in; (void)v; SCHEMA(VESC_FIELD_GET) } \
+	inline void encode(util::BufWriter& out, const Name& v) { (void)out; (void)v; SCHEMA(VESC_FIELD_PUT) } \
+	inline void decode(util::BufReader& in, Name& v, uint32_t mask) { \
+		typedef Name Packet; (void)sizeof(Packet); (void)in; (void)v; (void)mask; SCHEMA(VESC_FIELD_GET_MASKED) } \
+	inline void encode(util::BufWriter& out, const Name& v, uint32_t mask) { \
+		typedef Name Packet; (void)sizeof(Packet); (void)out; (void)v; (void)mask; SCHEMA(VESC_FIELD_PUT_MASKED) }
+
+// Replies
+VESC_PACKET(FwVersion,			COMM_FW_VERSION,			VESC_FW_VERSION_FIELDS)
+VESC_PACKET(Values,				COMM_GET_VALUES,			VESC_VALUES_FIELDS)
+VESC_PACKET(ImuData,			COMM_GET_IMU_DATA,			VESC_IMU_FIELDS)
+
+// Requests and commands
+VESC_PACKET(GetFwVersion,		COMM_FW_VERSION,			VESC_NO_FIELDS)
+VESC_PACKET(GetValues,			COMM_GET_VALUES,			VESC_NO_FIELDS)
+VESC_PACKET(GetValuesSelective,	COMM_GET_VALUES_SELECTIVE,	VESC_MASK32_FIELDS)
+VESC_PACKET(GetImuData,			COMM_GET_IMU_DATA,			VESC_MASK16_FIELDS)
+VESC_PACKET(SetDuty,			COMM_SET_DUTY,				VESC_SET_DUTY_FIELDS)
+VESC_PACKET(SetCurrent,			COMM_SET_CURRENT,			VESC_SET_CURRENT_FIELDS)
+VESC_PACKET(SetCurrentBrake,	COMM_SET_CURRENT_BRAKE,		VESC_SET_CURRENT_FIELDS)
+VESC_PACKET(SetCurrentRel,		COMM_SET_CURRENT_REL,		VESC_SET_CURRENT_REL_FIELDS)
+VESC_PACKET(SetRpm,				COMM_SET_RPM,				VESC_SET_RPM_FIELDS)
+VESC_PACKET(ChuckData,			COMM_SET_CHUCK_DATA,		VESC_CHUCK_DATA_FIELDS)
+VESC_PACKET(Alive,				COMM_ALIVE,					VESC_NO_FIELDS)
+
+/**
+ * Declares tag struct Name for a CAN status frame whose SCHEMA fields land
+ * directly in Values, with decode(in, values, Name()) and the matching encode().
+ */
+#define VESC_CAN_STATUS(Name, packetId, SCHEMA) \
+	struct Name { \
+		static const uint8_t ID = packetId; \
+		static const size_t WIRE_SIZE = 0 SCHEMA(VESC_FIELD_SIZE); \
+	}; \
+	inline void decode(util::BufReader& in, Values& v, Name) { SCHEMA(VESC_FIELD_GET) } \
+	inline void encode(util::BufWriter& out, const Values& v, Name) { SCHEMA(VESC_FIELD_PUT) }
+
+VESC_CAN_STATUS(CanStatus1,		CAN_PACKET_STATUS,			VESC_CAN_STATUS_1_FIELDS)
+VESC_CAN_STATUS(CanStatus2,		CAN_PACKET_STATUS_2,		VESC_CAN_STATUS_2_FIELDS)
+VESC_CAN_STATUS(CanStatus3,		CAN_PACKET_STATUS_3,		VESC_CAN_STATUS_3_FIELDS)
+VESC_CAN_STATUS(CanStatus4,		CAN_PACKET_STATUS_4,		VESC_CAN_STATUS_4_FIELDS)
+VESC_CAN_STATUS(CanStatus5,		CAN_PACKET_STATUS_5,		VESC_CAN_STATUS_5_FIELDS)
+
+/** Mask with every field of Packet set, for the *_SELECTIVE / IMU requests */
+template <typename Packet>
+constexpr uint32_t allFields() {
+	return Packet::FIELD_COUNT >= 32 ? 0xFFFFFFFFUL : (1UL << Packet::FIELD_COUNT) - 1;
+}
+
+}  // namespace vesc
+
+#endif
@@ -1,11 +1,15 @@
 #include <stdint.h>
 #include "VescUart.h"
+#include "bufio.h"
 
 VescUart::VescUart(uint32_t timeout_ms) : _TIMEOUT(timeout_ms) {
 	nunchuck.valueX         = 127;
 	nunchuck.valueY         = 127;
 	nunchuck.lowerButton  	= false;
 	nunchuck.upperButton  	= false;
+	nunchuck.accX         	= 0;
+	nunchuck.accY         	= 0;
+	nunchuck.accZ         	= 0;
 }
 
 void VescUart::setSerialPort(Stream* port)
@@ -139,31 +143,37 @@ bool VescUart::unpackPayload(uint8_t * message, int lenMes, uint8_t * payload) {
 }
 
 
-int VescUart::packSendPayload(uint8_t * payload, int lenPay) {
+int VescUart::packPayload(const uint8_t * payload, int lenPay, uint8_t * frame) {
 
-	uint16_t crcPayload = crc16(payload, lenPay);
+	uint16_t crcPayload = crc16((unsigned char *)payload, lenPay);
 	int count = 0;
-	uint8_t messageSend[256];
-	
+
 	if (lenPay <= 256)
 	{
-		messageSend[count++] = 2;
-		messageSend[count++] = lenPay;
+		frame[count++] = 2;
+		frame[count++] = lenPay;
 	}
 	else
 	{
-		messageSend[count++] = 3;
-		messageSend[count++] = (uint8_t)(lenPay >> 8);
-		messageSend[count++] = (uint8_t)(lenPay & 0xFF);
+		frame[count++] = 3;
+		frame[count++] = (uint8_t)(lenPay >> 8);
+		frame[count++] = (uint8_t)(lenPay & 0xFF);
 	}
 
-	memcpy(messageSend + count, payload, lenPay);
+	memcpy(frame + count, payload, lenPay);
 	count += lenPay;
 
-	messageSend[count++] = (uint8_t)(crcPayload >> 8);
-	messageSend[count++] = (uint8_t)(crcPayload & 0xFF);
-	messageSend[count++] = 3;
-	// messageSend[count] = NULL;
+	frame[count++] = (uint8_t)(crcPayload >> 8);
+	frame[count++] = (uint8_t)(crcPayload & 0xFF);
+	frame[count++] = 3;
+
+	return count;
+}
+
+int VescUart::packSendPayload(uint8_t * payload, int lenPay) {
+
+	uint8_t messageSend[256];
+	int count = packPayload(payload, lenPay, messageSend);
 	
 	if(debugPort!=NULL){
 		debugPort->print("Package to send: "); serialPrint(messageSend, count);
@@ -178,48 +188,50 @@ int VescUart::packSendPayload(uint8_t * payload, int lenPay) {
 }
 
 
-bool VescUart::processReadPacket(uint8_t * message) {
-
-	COMM_PACKET_ID packetId;
-	int32_t index = 0;
+bool VescUart::processReadPacket(uint8_t * message, int length) {
 
-	packetId = (COMM_PACKET_ID)message[0];
-	message++; // Removes the packetId from the actual message (payload)
+	util::BufReader in(message, length);
+	COMM_PACKET_ID packetId = (COMM_PACKET_ID)in.u8();
 
 	switch (packetId){
-		case COMM_FW_VERSION: // Structure defined here: https://github.com/vedderb/bldc/blob/43c3bbaf91f5052a35b75c2ff17b5fe99fad94d1/commands.c#L164
-
-			fw_version.major = message[index++];
-			fw_version.minor = message[index++];
+		case COMM_FW_VERSION: { // Structure defined here: https://github.com/vedderb/bldc/blob/43c3bbaf91f5052a35b75c2ff17b5fe99fad94d1/commands.c#L164
+			FWversionPackage version;
+			vesc::decode(in, version);
+			if (!in.ok())
+				return false;
+			fw_version = version;
 			return true;
-		case COMM_GET_VALUES: // Structure defined here: https://github.com/vedderb/bldc/blob/43c3bbaf91f5052a35b75c2ff17b5fe99fad94d1/commands.c#L164
-
-			data.tempMosfet 		= buffer_get_float16(message, 10.0, &index); 	// 2 bytes - mc_interface_temp_fet_filtered()
-			data.tempMotor 			= buffer_get_float16(message, 10.0, &index); 	// 2 bytes - mc_interface_temp_motor_filtered()
-			data.avgMotorCurrent 	= buffer_get_float32(message, 100.0, &index); // 4 bytes - mc_interface_read_reset_avg_motor_current()
-			data.avgInputCurrent 	= buffer_get_float32(message, 100.0, &index); // 4 bytes - mc_interface_read_reset_avg_input_current()
-			index += 4; // Skip 4 bytes - mc_interface_read_reset_avg_id()
-			index += 4; // Skip 4 bytes - mc_interface_read_reset_avg_iq()
-			data.dutyCycleNow 		= buffer_get_float16(message, 1000.0, &index); 	// 2 bytes - mc_interface_get_duty_cycle_now()
-			data.rpm 				= buffer_get_float32(message, 1.0, &index);		// 4 bytes - mc_interface_get_rpm()
-			data.inpVoltage 		= buffer_get_float16(message, 10.0, &index);		// 2 bytes - GET_INPUT_VOLTAGE()
-			data.ampHours 			= buffer_get_float32(message, 10000.0, &index);	// 4 bytes - mc_interface_get_amp_hours(false)
-			data.ampHoursCharged 	= buffer_get_float32(message, 10000.0, &index);	// 4 bytes - mc_interface_get_amp_hours_charged(false)
-			data.wattHours			= buffer_get_float32(message, 10000.0, &index);	// 4 bytes - mc_interface_get_watt_hours(false)
-			data.wattHoursCharged	= buffer_get_float32(message, 10000.0, &index);	// 4 bytes - mc_interface_get_watt_hours_charged(false)
-			data.tachometer 		= buffer_get_int32(message, &index);				// 4 bytes - mc_interface_get_tachometer_value(false)
-			data.tachometerAbs 		= buffer_get_int32(message, &index);				// 4 bytes - mc_interface_get_tachometer_abs_value(false)
-			data.error 				= (mc_fault_code)message[index++];								// 1 byte  - mc_interface_get_fault()
-			data.pidPos				= buffer_get_float32(message, 1000000.0, &index);	// 4 bytes - mc_interface_get_pid_pos_now()
-			data.id					= message[index++];								// 1 byte  - app_get_configuration()->controller_id	
+		}
 
+		case COMM_GET_VALUES: {
+			// Decoded into a copy so a short packet leaves the last good values alone.
+			dataPackage values = data;
+			vesc::decode(in, values);
+			if (!in.ok())
+				return false;
+			data = values;
 			return true;
+		}
 
-		break;
-
-		/* case COMM_GET_VALUES_SELECTIVE:
+		case COMM_GET_VALUES_SELECTIVE: {
+			dataPackage values = data;
+			uint32_t mask = in.u32();
+			vesc::decode(in, values, mask);
+			if (!in.ok())
+				return false;
+			data = values;
+			return true;
+		}
 
-			uint32_t mask = 0xFFFFFFFF; */
+		case COMM_GET_IMU_DATA: {
+			vesc::ImuData values = imu;
+			uint16_t mask = in.u16();
+			vesc::decode(in, values, mask);
+			if (!in.ok())
+				return false;
+			imu = values;
+			return true;
+		}
 
 		default:
 			return false;
@@ -233,22 +245,12 @@ bool VescUart::getFWversion(void){
 
 bool VescUart::getFWversion(uint8_t canId){
 	
-	int32_t index = 0;
-	int payloadSize = (canId == 0 ? 1 : 3);
-	uint8_t payload[payloadSize];
-	
-	if (canId != 0) {
-		payload[index++] = { COMM_FORWARD_CAN };
-		payload[index++] = canId;
-	}
-	payload[index++] = { COMM_FW_VERSION };
-
-	packSendPayload(payload, payloadSize);
+	sendPacket(vesc::GetFwVersion(), canId);
 
 	uint8_t message[256];
 	int messageLength = receiveUartMessage(message);
 	if (messageLength > 0) { 
-		return processReadPacket(message); 
+		return processReadPacket(message, messageLength); 
 	}
 	return false;
 }
@@ -263,25 +265,65 @@ bool VescUart::getVescValues(uint8_t canId) {
 		debugPort->println("Command: COMM_GET_VALUES "+String(canId));
 	}
 
-	int32_t index = 0;
-	int payloadSize = (canId == 0 ? 1 : 3);
-	uint8_t payload[payloadSize];
-	if (canId != 0) {
-		payload[index++] = { COMM_FORWARD_CAN };
-		payload[index++] = canId;
-	}
-	payload[index++] = { COMM_GET_VALUES };
-
-	packSendPayload(payload, payloadSize);
+	sendPacket(vesc::GetValues(), canId);
 
 	uint8_t message[256];
 	int messageLength = receiveUartMessage(message);
 
 	if (messageLength > 55) {
-		return processReadPacket(message); 
+		return processReadPacket(message, messageLength); 
 	}
 	return false;
 }
+void VescUart::requestVescValues(uint8_t canId) {
+	sendPacket(vesc::GetValues(), canId);
+}
+
+void VescUart::requestVescValuesSelective(uint32_t mask, uint8_t canId) {
+	vesc::GetValuesSelective request;
+	request.mask = mask;
+	sendPacket(request, canId);
+}
+
+void VescUart::requestImuData(uint16_t mask, uint8_t canId) {
+	vesc::GetImuData request;
+	request.mask = mask;
+	sendPacket(request, canId);
+}
+
+int VescUart::pollMessage(void) {
+
+	if (serialPort == NULL)
+		return -1;
+
+	while (serialPort->available()) {
+		uint8_t byte = serialPort->read();
+
+		// Resynchronise on a short-frame start byte; long frames are not supported.
+		if (rxCount == 0 && byte != 2)
+			continue;
+
+		rxFrame[rxCount++] = byte;
+		if (rxCount == 2) {
+			rxEnd = byte + 5; // Payload size + 2 for size + 3 for CRC and end.
+			if (rxEnd > sizeof(rxFrame)) {
+				rxCount = 0;
+				continue;
+			}
+		}
+
+		if (rxCount > 2 && rxCount == rxEnd) {
+			rxCount = 0;
+			uint8_t payload[256];
+			if (rxFrame[rxEnd - 1] == 3 && unpackPayload(rxFrame, rxEnd, payload)) {
+				int packetId = payload[0];
+				return processReadPacket(payload, rxFrame[1]) ? packetId : -1;
+			}
+		}
+	}
+	return -1;
+}
+
 void VescUart::setNunchuckValues() {
 	return setNunchuckValues(0);
 }
@@ -291,27 +333,6 @@ void VescUart::setNunchuckValues(uint8_t canId) {
 	if(debugPort!=NULL){
 		debugPort->println("Command: COMM_SET_CHUCK_DATA "+String(canId));
 	}	
-	int32_t index = 0;
-	int payloadSize = (canId == 0 ? 11 : 13);
-	uint8_t payload[payloadSize];
-
-	if (canId != 0) {
-		payload[index++] = { COMM_FORWARD_CAN };
-		payload[index++] = canId;
-	}
-	payload[index++] = { COMM_SET_CHUCK_DATA };
-	payload[index++] = nunchuck.valueX;
-	payload[index++] = nunchuck.valueY;
-	buffer_append_bool(payload, nunchuck.lowerButton, &index);
-	buffer_append_bool(payload, nunchuck.upperButton, &index);
-	
-	// Acceleration Data. Not used, Int16 (2 byte)
-	payload[index++] = 0;
-	payload[index++] = 0;
-	payload[index++] = 0;
-	payload[index++] = 0;
-	payload[index++] = 0;
-	payload[index++] = 0;
 
 	if(debugPort != NULL){
 		debugPort->println("Nunchuck Values:");
@@ -319,7 +340,7 @@ void VescUart::setNunchuckValues(uint8_t canId) {
 		debugPort->print(" LBTN="); debugPort->print(nunchuck.lowerButton); debugPort->print(" UBTN="); debugPort->println(nunchuck.upperButton);
 	}
 
-	packSendPayload(payload, payloadSize);
+	sendPacket(nunchuck, canId);
 }
 
 void VescUart::setCurrent(float current) {
@@ -327,16 +348,9 @@ void VescUart::setCurrent(float current) {
 }
 
 void VescUart::setCurrent(float current, uint8_t canId) {
-	int32_t index = 0;
-	int payloadSize = (canId == 0 ? 5 : 7);
-	uint8_t payload[payloadSize];
-	if (canId != 0) {
-		payload[index++] = { COMM_FORWARD_CAN };
-		payload[index++] = canId;
-	}
-	payload[index++] = { COMM_SET_CURRENT };
-	buffer_append_int32(payload, (int32_t)(current * 1000), &index);
-	packSendPayload(payload, payloadSize);
+	vesc::SetCurrent command;
+	command.current = current;
+	sendPacket(command, canId);
 }
 
 void VescUart::setBrakeCurrent(float brakeCurrent) {
@@ -344,18 +358,9 @@ void VescUart::setBrakeCurrent(float brakeCurrent) {
 }
 
 void VescUart::setBrakeCurrent(float brakeCurrent, uint8_t canId) {
-	int32_t index = 0;
-	int payloadSize = (canId == 0 ? 5 : 7);
-	uint8_t payload[payloadSize];
-	if (canId != 0) {
-		payload[index++] = { COMM_FORWARD_CAN };
-		payload[index++] = canId;
-	}
-
-	payload[index++] = { COMM_SET_CURRENT_BRAKE };
-	buffer_append_int32(payload, (int32_t)(brakeCurrent * 1000), &index);
-
-	packSendPayload(payload, payloadSize);
+	vesc::SetCurrentBrake command;
+	command.current = brakeCurrent;
+	sendPacket(command, canId);
 }
 
 void VescUart::setRPM(float rpm) {
@@ -363,16 +368,9 @@ void VescUart::setRPM(float rpm) {
 }
 
 void VescUart::setRPM(float rpm, uint8_t canId) {
-	int32_t index = 0;
-	int payloadSize = (canId == 0 ? 5 : 7);
-	uint8_t payload[payloadSize];
-	if (canId != 0) {
-		payload[index++] = { COMM_FORWARD_CAN };
-		payload[index++] = canId;
-	}
-	payload[index++] = { COMM_SET_RPM };
-	buffer_append_int32(payload, (int32_t)(rpm), &index);
-	packSendPayload(payload, payloadSize);
+	vesc::SetRpm command;
+	command.rpm = rpm;
+	sendPacket(command, canId);
 }
 
 void VescUart::setDuty(float duty) {
@@ -380,17 +378,15 @@ void VescUart::setDuty(float duty) {
 }
 
 void VescUart::setDuty(float duty, uint8_t canId) {
-	int32_t index = 0;
-	int payloadSize = (canId == 0 ? 5 : 7);
-	uint8_t payload[payloadSize];
-	if (canId != 0) {
-		payload[index++] = { COMM_FORWARD_CAN };
-		payload[index++] = canId;
-	}
-	payload[index++] = { COMM_SET_DUTY };
-	buffer_append_int32(payload, (int32_t)(duty * 100000), &index);
+	vesc::SetDuty command;
+	command.duty = duty;
+	sendPacket(command, canId);
+}
 
-	packSendPayload(payload, payloadSize);
+void VescUart::setCurrentRel(float current, uint8_t canId) {
+	vesc::SetCurrentRel command;
+	command.current = current;
+	sendPacket(command, canId);
 }
 
 void VescUart::sendKeepalive(void) {
@@ -398,15 +394,7 @@ void VescUart::sendKeepalive(void) {
 }
 
 void VescUart::sendKeepalive(uint8_t canId) {
-	int32_t index = 0;
-	int payloadSize = (canId == 0 ? 1 : 3);
-	uint8_t payload[payloadSize];
-	if (canId != 0) {
-		payload[index++] = { COMM_FORWARD_CAN };
-		payload[index++] = canId;
-	}
-	payload[index++] = { COMM_ALIVE };
-	packSendPayload(payload, payloadSize);
+	sendPacket(vesc::Alive(), canId);
 }
 
 void VescUart::serialPrint(uint8_t * data, int len) {
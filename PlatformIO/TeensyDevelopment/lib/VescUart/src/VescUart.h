@@ -3,44 +3,19 @@
 
 #include <Arduino.h>
 #include "datatypes.h"
-#include "buffer.h"
 #include "crc.h"
+#include "VescPackets.h"
 
 class VescUart
 {
 
-	/** Struct to store the telemetry data returned by the VESC */
-	struct dataPackage {
-       float avgMotorCurrent;
-        float avgInputCurrent;
-        float dutyCycleNow;
-        float rpm;
-        float inpVoltage;
-        float ampHours;
-        float ampHoursCharged;
-        float wattHours;
-        float wattHoursCharged;
-        long tachometer;
-        long tachometerAbs;
-        float tempMosfet;
-        float tempMotor;
-        float pidPos;
-        uint8_t id;
-        mc_fault_code error; 
-	};
-
-	/** Struct to hold the nunchuck values to send over UART */
-	struct nunchuckPackage {
-		int	valueX;
-		int	valueY;
-		bool upperButton; // valUpperButton
-		bool lowerButton; // valLowerButton
-	};
-
-    struct FWversionPackage {
-        uint8_t major;
-        uint8_t minor;
-    };
+	/** Telemetry returned by the VESC, fields generated from VESC_VALUES_FIELDS */
+	typedef vesc::Values dataPackage;
+
+	/** Joystick and buttons sent to the nunchuck app, see VESC_CHUCK_DATA_FIELDS */
+	typedef vesc::ChuckData nunchuckPackage;
+
+	typedef vesc::FwVersion FWversionPackage;
 
 	//Timeout - specifies how long the function will wait for the vesc to respond
 	const uint32_t _TIMEOUT;
@@ -60,6 +35,9 @@ class VescUart
        /** Variable to hold firmware version */
         FWversionPackage fw_version; 
 
+        /** Variable to hold the IMU data, only the fields of the last request's mask are updated */
+        vesc::ImuData imu;
+
         /**
          * @brief      Set the serial port for uart communication
          * @param      port  - Reference to Serial port (pointer) 
@@ -102,6 +80,36 @@ class VescUart
          */
         bool getVescValues(uint8_t canId);
 
+        /**
+         * @brief      Sends COMM_GET_VALUES without waiting for the answer.
+         *             Pair with pollMessage() to receive it.
+         * @param      canId  - The CAN ID of the VESC, 0 for the local one
+         */
+        void requestVescValues(uint8_t canId = 0);
+
+        /**
+         * @brief      Sends COMM_GET_VALUES_SELECTIVE without waiting for the answer.
+         *             Only the fields in mask are sent back and updated in data.
+         * @param      mask   - Bits of vesc::Values::FIELD_*, e.g. 1UL << vesc::Values::FIELD_rpm
+         * @param      canId  - The CAN ID of the VESC, 0 for the local one
+         */
+        void requestVescValuesSelective(uint32_t mask, uint8_t canId = 0);
+
+        /**
+         * @brief      Sends COMM_GET_IMU_DATA without waiting for the answer.
+         * @param      mask   - Bits of vesc::ImuData::FIELD_*, all by default
+         * @param      canId  - The CAN ID of the VESC, 0 for the local one
+         */
+        void requestImuData(uint16_t mask = vesc::allFields<vesc::ImuData>(), uint8_t canId = 0);
+
+        /**
+         * @brief      Consumes whatever bytes are available without blocking and
+         *             processes a packet once a complete, CRC-valid one is in.
+         *
+         * @return     The COMM_PACKET_ID that was processed, or -1 if none yet
+         */
+        int pollMessage(void);
+
         /**
          * @brief      Sends values for joystick and buttons to the nunchuck app
          */
@@ -165,6 +173,13 @@ class VescUart
          */
         void setDuty(float duty, uint8_t canId);
 
+        /**
+         * @brief      Set the motor current relative to the configured maximum
+         * @param      current  - -1.0 to 1.0, negative values brake
+         * @param      canId  - The CAN ID of the VESC, 0 for the local one
+         */
+        void setCurrentRel(float current, uint8_t canId = 0);
+
         /**
          * @brief      Send a keepalive message
          */
@@ -181,6 +196,24 @@ class VescUart
          */
         void printVescValues(void);
 
+        /**
+         * @brief      Builds the complete UART frame for a packet without sending it
+         *
+         * @param      packet  - Any packet declared with VESC_PACKET()
+         * @param      frame   - Receives start byte, length, payload, CRC and end byte
+         * @param      size    - Size of frame
+         * @param      canId   - The CAN ID of the VESC, 0 for the local one
+         * @return     Frame length, or 0 if it does not fit
+         */
+		template <typename Packet>
+		static int packPacket(const Packet& packet, uint8_t* frame, int size, uint8_t canId = 0) {
+			uint8_t payload[3 + Packet::WIRE_SIZE];
+			int length = encodePayload(packet, canId, payload, sizeof(payload));
+			if (length + 5 > size)
+				return 0;
+			return packPayload(payload, length, frame);
+		}
+
 	private: 
 
 		/** Variabel to hold the reference to the Serial object to use for UART */
@@ -190,6 +223,11 @@ class VescUart
 		  * Uses the class Stream instead of HarwareSerial */
 		Stream* debugPort = NULL;
 
+		/** Partial frame kept between pollMessage() calls */
+		uint8_t rxFrame[256];
+		uint16_t rxCount = 0;
+		uint16_t rxEnd = 0;
+
 		/**
 		 * @brief      Packs the payload and sends it over Serial
 		 *
@@ -199,6 +237,26 @@ class VescUart
 		 */
 		int packSendPayload(uint8_t * payload, int lenPay);
 
+		/**
+		 * @brief      Frames a payload (start byte, length, CRC-16, end byte) into frame
+		 *
+		 * @param      frame   - Needs lenPay + 6 bytes
+		 * @return     Frame length
+		 */
+		static int packPayload(const uint8_t * payload, int lenPay, uint8_t * frame);
+
+		template <typename Packet>
+		static int encodePayload(const Packet& packet, uint8_t canId, uint8_t* payload, int size) {
+			util::BufWriter out(payload, size);
+			if (canId != 0) {
+				out.u8(COMM_FORWARD_CAN);
+				out.u8(canId);
+			}
+			out.u8(Packet::ID);
+			vesc::encode(out, packet);
+			return out.size();
+		}
+
 		/**
 		 * @brief      Receives the message over Serial
 		 *
@@ -221,9 +279,22 @@ class VescUart
 		 * @brief      Extracts the data from the received payload
 		 *
 		 * @param      message  - The payload to extract data from
-		 * @return     True if the process was a success
+		 * @param      length   - Payload bytes, reads are bounds checked against it
+		 * @return     True if the packet was known and long enough
+		 */
+		bool processReadPacket(uint8_t * message, int length);
+
+		/**
+		 * @brief      Encodes a vesc:: packet, forwarded over CAN when canId is set, and sends it
+		 *
+		 * @param      packet  - Any packet declared with VESC_PACKET()
+		 * @param      canId   - The CAN ID of the VESC, 0 for the local one
 		 */
-		bool processReadPacket(uint8_t * message);
+		template <typename Packet>
+		void sendPacket(const Packet& packet, uint8_t canId) {
+			uint8_t payload[3 + Packet::WIRE_SIZE];
+			packSendPayload(payload, encodePayload(packet, canId, payload, sizeof(payload)));
+		}
 
 		/**
 		 * @brief      Help Function to print uint8_t array over Serial for Debug
@@ -0,0 +1,61 @@
+#ifndef can_dispatch_h
+#define can_dispatch_h
+
+#include <stdint.h>
+
+namespace util {
+
+// Frame ids follow the ODriveCAN convention: the 11 or 29 bit id, with bit 31
+// set for an extended frame.
+static const uint32_t CAN_EXTENDED_FLAG = 0x80000000;
+
+typedef void (*CanHandler)(void* ctx, uint32_t id, uint8_t length, const uint8_t* data);
+
+// Routes received frames to the drivers sharing one bus (ODrive CANSimple on
+// standard ids, VESC on extended ids, ...). A frame goes to the first route
+// with (id & mask) == match. Fixed table, no allocation, not thread safe:
+// dispatch from the loop, not from the CAN interrupt.
+template <int MaxRoutes>
+class CanDispatcher {
+ public:
+  bool attach(uint32_t mask, uint32_t match, CanHandler handler, void* ctx) {
+    if (count_ >= MaxRoutes || handler == nullptr) return false;
+    routes_[count_++] = {mask, match, handler, ctx, 0};
+    return true;
+  }
+
+  bool dispatch(uint32_t id, uint8_t length, const uint8_t* data) {
+    for (int i = 0; i < count_; i++) {
+      Route& r = routes_[i];
+      if ((id & r.mask) == r.match) {
+        r.handler(r.ctx, id, length, data);
+        r.frames++;
+        return true;
+      }
+    }
+    unrouted_++;
+    return false;
+  }
+
+  int routes() const { return count_; }
+  uint32_t routedFrames(int route) const { return route < count_ ? routes_[route].frames : 0; }
+  // Frames nobody attached for, e.g. a node on the bus this firmware ignores.
+  uint32_t unroutedFrames() const { return unrouted_; }
+
+ private:
+  struct Route {
+    uint32_t mask;
+    uint32_t match;
+    CanHandler handler;
+    void* ctx;
+    uint32_t frames;
+  };
+
+  Route routes_[MaxRoutes];
+  int count_ = 0;
+  uint32_t unrouted_ = 0;
+};
+
+}  // namespace util
+
+#endif
@@ -0,0 +1,154 @@
+#ifndef bufio_h
+#define bufio_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+namespace util {
+
+// Big-endian (network order) field access for packed protocol payloads such as
+// the VESC ones. Every load is one unaligned word access plus a byte swap, and
+// the scale factors are template arguments so a fixed-layout decode compiles
+// to straight-line code. Running past the end does not touch memory: reads
+// return 0, writes are dropped, and ok() turns false.
+namespace detail {
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+static inline uint16_t toBig(uint16_t v) { return v; }
+static inline uint32_t toBig(uint32_t v) { return v; }
+#else
+static inline uint16_t toBig(uint16_t v) { return __builtin_bswap16(v); }
+static inline uint32_t toBig(uint32_t v) { return __builtin_bswap32(v); }
+#endif
+
+}  // namespace detail
+
+class BufReader {
+ public:
+  constexpr BufReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+  constexpr bool ok() const { return ok_; }
+  constexpr size_t position() const { return pos_; }
+  constexpr size_t remaining() const { return size_ - pos_; }
+
+  void skip(size_t n) {
+    if (n > size_ - pos_) {
+      ok_ = false;
+      pos_ = size_;
+    } else {
+      pos_ += n;
+    }
+  }
+
+  uint8_t u8() { return take(1) ? data_[pos_ - 1] : 0; }
+  bool boolean() { return u8() != 0; }
+  uint16_t u16() { return load<uint16_t>(); }
+  int16_t i16() { return (int16_t)load<uint16_t>(); }
+  uint32_t u32() { return load<uint32_t>(); }
+  int32_t i32() { return (int32_t)load<uint32_t>(); }
+
+  // Fixed point on the wire, value = raw / Scale (buffer_get_float16/32).
+  template <uint32_t Scale>
+  float f16() { return (float)i16() / (float)Scale; }
+  template <uint32_t Scale>
+  float f32() { return (float)i32() / (float)Scale; }
+
+  // VESC float32_auto. It matches IEEE single bits for every value the sender
+  // can produce, so only the exponent extremes take the slow path.
+  float f32Auto() {
+    uint32_t bits = u32();
+    uint32_t exponent = (bits >> 23) & 0xFF;
+    uint32_t mantissa = bits & 0x7FFFFF;
+    if ((exponent == 0 && mantissa != 0) || exponent == 0xFF) {
+      float sig = (float)mantissa / (8388608.0f * 2.0f) + 0.5f;
+      if (bits & (1U << 31)) sig = -sig;
+      return ldexpf(sig, (int)exponent - 126);
+    }
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+ private:
+  bool take(size_t n) {
+    if (n > size_ - pos_) {
+      ok_ = false;
+      pos_ = size_;
+      return false;
+    }
+    pos_ += n;
+    return true;
+  }
+
+  template <typename T>
+  T load() {
+    if (!take(sizeof(T))) return 0;
+    T raw;
+    memcpy(&raw, data_ + pos_ - sizeof(T), sizeof(T));
+    return detail::toBig(raw);
+  }
+
+  const uint8_t* data_;
+  size_t size_;
+  size_t pos_ = 0;
+  bool ok_ = true;
+};
+
+class BufWriter {
+ public:
+  constexpr BufWriter(uint8_t* data, size_t capacity) : data_(data), capacity_(capacity) {}
+
+  constexpr bool ok() const { return ok_; }
+  constexpr size_t size() const { return pos_; }
+
+  void u8(uint8_t v) {
+    if (reserve(1)) data_[pos_ - 1] = v;
+  }
+  void boolean(bool v) { u8(v ? 1 : 0); }
+  void u16(uint16_t v) { store<uint16_t>(v); }
+  void i16(int16_t v) { store<uint16_t>((uint16_t)v); }
+  void u32(uint32_t v) { store<uint32_t>(v); }
+  void i32(int32_t v) { store<uint32_t>((uint32_t)v); }
+
+  // raw = (int)(value * Scale), truncated like buffer_append_float16/32.
+  template <uint32_t Scale>
+  void f16(float v) { i16((int16_t)(v * (float)Scale)); }
+  template <uint32_t Scale>
+  void f32(float v) { i32((int32_t)(v * (float)Scale)); }
+
+  // VESC float32_auto for finite values. Like the VESC code, anything smaller
+  // than 1.5e-38 (subnormals included) goes out as +0.
+  void f32Auto(float v) {
+    uint32_t bits = 0;
+    if (fabsf(v) >= 1.5e-38f) memcpy(&bits, &v, sizeof(bits));
+    u32(bits);
+  }
+
+ private:
+  bool reserve(size_t n) {
+    if (n > capacity_ - pos_) {
+      ok_ = false;
+      return false;
+    }
+    pos_ += n;
+    return true;
+  }
+
+  template <typename T>
+  void store(T v) {
+    if (!reserve(sizeof(T))) return;
+    T raw = detail::toBig(v);
+    memcpy(data_ + pos_ - sizeof(T), &raw, sizeof(T));
+  }
+
+  uint8_t* data_;
+  size_t capacity_;
+  size_t pos_ = 0;
+  bool ok_ = true;
+};
+
+}  // namespace util
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef qformat_h
+#define qformat_h
+
+#include <stdint.h>
+
+namespace util {
+
+// Signed Q16.16 fixed point: range +-32768 with 1/65536 resolution.
+// Products and quotients go through 64 bit intermediates and saturate, so a
+// control loop running on it degrades gracefully instead of wrapping.
+struct q16 {
+  int32_t raw = 0;
+
+  static constexpr int32_t ONE = 1 << 16;
+
+  constexpr q16() {}
+  constexpr q16(float v) : raw(saturate((int64_t)(v * ONE))) {}
+  static constexpr q16 fromRaw(int32_t r) { q16 q; q.raw = r; return q; }
+  // num/den without touching the FPU, e.g. fromRatio(dtUs, 1000000).
+  static constexpr q16 fromRatio(int32_t num, int32_t den) {
+    return fromRaw(saturate(((int64_t)num << 16) / den));
+  }
+
+  constexpr float toFloat() const { return (float)raw / ONE; }
+
+  static constexpr int32_t saturate(int64_t v) {
+    return v > INT32_MAX ? INT32_MAX : (v < INT32_MIN ? INT32_MIN : (int32_t)v);
+  }
+
+  friend constexpr q16 operator+(q16 a, q16 b) { return fromRaw(saturate((int64_t)a.raw + b.raw)); }
+  friend constexpr q16 operator-(q16 a, q16 b) { return fromRaw(saturate((int64_t)a.raw - b.raw)); }
+  friend constexpr q16 operator-(q16 a) { return fromRaw(saturate(-(int64_t)a.raw)); }
+  friend constexpr q16 operator*(q16 a, q16 b) { return fromRaw(saturate(((int64_t)a.raw * b.raw) >> 16)); }
+  friend constexpr q16 operator/(q16 a, q16 b) {
+    return b.raw == 0 ? fromRaw(a.raw >= 0 ? INT32_MAX : INT32_MIN)
+                      : fromRaw(saturate(((int64_t)a.raw << 16) / b.raw));
+  }
+  q16& operator+=(q16 b) { return *this = *this + b; }
+  q16& operator-=(q16 b) { return *this = *this - b; }
+
+  friend constexpr bool operator<(q16 a, q16 b) { return a.raw < b.raw; }
+  friend constexpr bool operator>(q16 a, q16 b) { return a.raw > b.raw; }
+  friend constexpr bool operator<=(q16 a, q16 b) { return a.raw <= b.raw; }
+  friend constexpr bool operator>=(q16 a, q16 b) { return a.raw >= b.raw; }
+  friend constexpr bool operator==(q16 a, q16 b) { return a.raw == b.raw; }
+};
+
+}  // namespace util
+
+#endif
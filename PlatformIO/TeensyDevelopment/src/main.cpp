@@ -6,6 +6,14 @@
 #include "EVT_VescDriver.h"
 #include "EVT_AutoMode.h"
 #include "EVT_ODriver.h"
+#include "EVT_EventLog.h"
+#include "EVT_BlackBox.h"
+#include "EVT_Capture.h"
+#include "EVT_FaultManager.h"
+#include "EVT_CommandBus.h"
+#include "EVT_Throttle.h"
+#include "EVT_SteerTrajectory.h"
+#include "EVT_Params.h"
 
 
 void setup() {
@@ -20,23 +28,34 @@ void setup() {
   setupSbus();
   setupVesc();
   setupOdrv();
+  setupThrottle();
+  setupSteeringTrajectory();
+  setupBlackBox();
+  setupCapture();
+  setupHealthMonitor();
+  setupParams(); // After every module has registered its parameters
   delay(200);
   updateSbusData();
-  digitalWrite(3, HIGH); // Turn on relay 1 (odrive)
-  digitalWrite(4, HIGH); // Turn on relay 2 (vesc)
-  digitalWrite(5, HIGH); // Turn on relay 3 (contactor)
+  setupRelays(); // Turn on relays 1-3 (odrive, vesc, contactor)
 }
 
 void loop() {
-
+  // Parameter changes from last tick's UDP drain take effect here, between ticks.
+  applyParams();
 
   CheckForErrors();  
+  updateFaultManager();
   updateSbusData();
+  serviceVescTelemetry();
+  serviceOdrvFeedback();
+  serviceUdpLink();
+  serviceEndpointCapture();
+  serviceSteeringTune();
   
   switch (GetState())
   {
   case RC:
-    if (channels[6] > 1000) {
+    if (channels[6] > rcSwitches.autoOn) {
       SetState(AUTO);
     } else {
       updateVescControl();
@@ -46,43 +65,51 @@ void loop() {
     break;
 
   case AUTO:
-    if (channels[6] < 1000) {
+    if (channels[6] < rcSwitches.autoOn) {
       SetState(RC);
     } else {
       //updateAutonomousMode();
-      SetErrorState("Main","Do not be alarmed this is just a test");
+      // Nothing drives the car in AUTO yet; stop rather than coast on the last RC command.
+      reportFault(FAULT_CRITICAL, "Main", "AUTO mode not implemented");
+    }
     break;
 
   case ERR:
-      digitalWrite(3, LOW); // Turn off relay 1 (odrive)
-      digitalWrite(4, LOW); // Turn off relay 2 (vesc)
-      digitalWrite(5, LOW); // Turn off relay 3 (contactor)
+      applyFaultRelays(); // Open only the relays the fault calls for
     // check for reset
-    if (channels[4] > 1000){
+    if (channels[4] > rcSwitches.errorReset){
       // COLIN LOOK HERE!! we need to set this to not be channel 4 since that will cause issues down the line with our encoder.
       //check auto switch
-      digitalWrite(3, HIGH); // Turn off relay 1 (odrive)
-      digitalWrite(4, HIGH); // Turn off relay 2 (vesc)
-      digitalWrite(5, HIGH); // Turn off relay 3 (contactor)
       Serial.println("Attempting to clear errors...");
-      if (channels[6] > 1000) {
+      if (channels[6] > rcSwitches.autoOn) {
         Serial.println("TURN OFF AUTO SWITCH BEFORE ATTEMPTING TO CLEAR ERRORS");
       }else{
+        if (restoreFaultRelays()) {
+          // ODrive was powered down, it has to go through calibration again.
+          systemInitialized = false;
+        } else {
+          // ODrive kept power and only disarmed. It stays idle until the
+          // calibration switch re-arms it without recalibrating.
+          prepareOdrvRearm();
+        }
         Serial.println();
         Serial.println("yay! Errors cleared :D");
         SetState(IDLE);
-        odrive.setState(AXIS_STATE_UNDEFINED);
       }
     }
   break;
   
   case IDLE:
     // Check if the system is idle and not in error state. if idle, it waits for commands.
-    if (channels[8] > 400) {
+    if (channels[8] > rcSwitches.arm) {
       SetState(RC);
     } else {
-      Serial.println("System is idle. Waiting for commands...");
-      delay(1000); // Add a delay to avoid flooding the serial output
+      // Rate limited rather than delayed, so UDP and endpoint capture keep running in IDLE.
+      static uint32_t lastIdlePrint = 0;
+      if (millis() - lastIdlePrint > 1000) {
+        Serial.println("System is idle. Waiting for commands...");
+        lastIdlePrint = millis();
+      }
     }
     break;
 
@@ -93,6 +120,15 @@ void loop() {
     break;
   }
 
-  }
+  // Setpoints staged above go out here, one write per port.
+  flushCommandBus();
+
+  captureBlackBoxSample();
+  serviceTelemetry();
+
+  // Low priority: storage and a few pending state/error events once the control work is done.
+  serviceBlackBox();
+  serviceCapture();
+  printEventLog(Serial, 4);
 }
 // i put this here in case i need to test something in the future and replace the main file during testing.
\ No newline at end of file
@@ -0,0 +1,263 @@
+// Runs RelayAutoTune (lib/EVT_PID/RelayAutoTune.h) the way a Teensy loop
+// would, on the host Arduino shim. The steering rack is tuned through the real
+// ODriveUART against a simulated ODrive in velocity control:
+// - the loop runs at 1 kHz with jitter;
+// - position comes from the 200 Hz request-now, parse-later poll that
+//   serviceOdrvFeedback() does, with a reply lost now and then;
+// - relay and PID outputs go out as "v" commands with four decimals.
+// The result is compared with the tuner run directly on the same rack model,
+// and the Tyreus-Luyben gains then close the position loop over the same path.
+//
+// Build (from tools, one line):
+//   g++ -std=c++17 -O2 -Wall -D__IMXRT1062__ -Ireplay/host -I../lib/EVT_PID -I../lib/OdriveUART -I../lib/util -o autotune_loop_sim autotune_loop_sim.cpp replay/host/HostArduino.cpp ../lib/OdriveUART/ODriveUART.cpp
+// Usage:
+//   autotune_loop_sim
+//
+// Exits 1 if any check failed.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "Arduino.h"
+#include "ODriveUART.h"
+#include "EVT_PID.h"
+#include "RelayAutoTune.h"
+#include "checks.h"
+
+static const float RACK_VEL_TAU = 0.015f;    // ODrive velocity loop, s.
+static const uint32_t UART_REPLY_US = 600;   // "f 0" round trip on Serial6.
+static const float TUNE_AMPLITUDE = 1.0f;    // Relay velocity, turns/s.
+static const float TUNE_HYSTERESIS = 0.002f; // Turns.
+
+// Velocity setpoint in, position out: an integrator behind the ODrive's own
+// velocity loop.
+struct Rack {
+    float pos = 0.0f, vel = 0.0f;
+    void step(float velSetpoint, float dt) {
+        vel += (velSetpoint - vel) * dt / RACK_VEL_TAU;
+        pos += vel * dt;
+    }
+};
+
+// The ODrive end of Serial6: takes "v 0 <vel> <torque>" and answers "f 0"
+// after UART_REPLY_US. Every lostEvery-th reply is never sent.
+class SimOdrive : public Stream {
+public:
+    Rack rack;
+    float velSetpoint = 0.0f;
+    uint32_t lostEvery = 0;
+    uint32_t commands = 0;
+
+    // Moves the rack up to the virtual clock.
+    void advance() {
+        while (simUs_ + 100 <= hostClockUs) {
+            rack.step(velSetpoint, 100e-6f);
+            simUs_ += 100;
+        }
+    }
+
+    int available() override {
+        advance();
+        if (!pending_.empty() && hostClockUs >= replyAtUs_) {
+            rx_ += pending_;
+            pending_.clear();
+        }
+        return (int)rx_.size();
+    }
+    int read() override {
+        if (available() == 0) return -1;
+        char c = rx_[0];
+        rx_.erase(0, 1);
+        return (uint8_t)c;
+    }
+    int peek() override { return available() ? (uint8_t)rx_[0] : -1; }
+    size_t write(uint8_t b) override {
+        if (b == '\n') {
+            handle(line_);
+            line_.clear();
+        } else {
+            line_ += (char)b;
+        }
+        return 1;
+    }
+    using Print::write;
+
+private:
+    void handle(const std::string& line) {
+        advance();
+        float vel, torque;
+        if (sscanf(line.c_str(), "v 0 %f %f", &vel, &torque) == 2) {
+            velSetpoint = vel;
+            commands++;
+        } else if (line == "f 0") {
+            if (lostEvery && ++requests_ % lostEvery == 0) return;
+            char reply[48];
+            snprintf(reply, sizeof(reply), "%.6f %.6f\n", rack.pos, rack.vel);
+            pending_ = reply;
+            replyAtUs_ = hostClockUs + UART_REPLY_US;
+        }
+    }
+
+    std::string line_, rx_, pending_;
+    uint64_t simUs_ = 0;
+    uint64_t replyAtUs_ = 0;
+    uint32_t requests_ = 0;
+};
+
+// The feedback poll from EVT_ODriver.cpp: ask every 5 ms, read the reply on
+// later loops, ask again after 20 ms without one.
+class FeedbackPoll {
+public:
+    explicit FeedbackPoll(Stream& serial) : serial_(serial) {}
+
+    // True when a new position arrived this call.
+    bool service(float& pos) {
+        bool fresh = false;
+        uint32_t now = millis();
+        if (pending_) {
+            fresh = readReply(pos);
+            if (!fresh && now - requestMs_ < 20) return false;
+            pending_ = false;
+            length_ = 0;
+        }
+        if (now - requestMs_ < 5) return fresh;
+        while (serial_.available()) serial_.read();
+        serial_.print("f 0\n");
+        pending_ = true;
+        requestMs_ = now;
+        return fresh;
+    }
+
+private:
+    bool readReply(float& pos) {
+        while (serial_.available()) {
+            char c = serial_.read();
+            if (c == '\n') {
+                line_[length_] = '\0';
+                length_ = 0;
+                pending_ = false;
+                char* end;
+                float p = strtof(line_, &end);
+                if (end == line_) return false;
+                pos = p;
+                return true;
+            }
+            if (length_ < sizeof(line_) - 1) line_[length_++] = c;
+        }
+        return false;
+    }
+
+    Stream& serial_;
+    bool pending_ = false;
+    uint32_t requestMs_ = 0;
+    char line_[32];
+    uint8_t length_ = 0;
+};
+
+// One pass of loop(): 1 ms, with up to 300 us of jitter either way.
+static void loopTick() {
+    hostClockUs += 700 + rand() % 601;
+}
+
+struct LinkRun {
+    TUNE_STATUS status;
+    TuneResult result;
+    float seconds;
+    uint32_t commands;
+};
+
+static LinkRun tuneOverLink(uint32_t lostEvery) {
+    SimOdrive sim;
+    sim.lostEvery = lostEvery;
+    ODriveUART odrive(sim);
+    FeedbackPoll poll(sim);
+    RelayAutoTune tuner(0.0f, TUNE_AMPLITUDE, TUNE_HYSTERESIS);
+    tuner.setTimeout(20000000);
+    uint64_t startUs = hostClockUs;
+    sim.advance();
+    tuner.start(sim.rack.pos, micros());
+    float pos = sim.rack.pos;
+    while (tuner.status() == TUNE_RUNNING && hostClockUs - startUs < 30000000ULL) {
+        loopTick();
+        if (poll.service(pos)) odrive.setVelocity(tuner.update(pos, micros()));
+    }
+    odrive.setVelocity(0.0f);
+    return {tuner.status(), tuner.result(), (hostClockUs - startUs) * 1e-6f, sim.commands};
+}
+
+static TuneResult tuneDirect() {
+    Rack rack;
+    RelayAutoTune tuner(0.0f, TUNE_AMPLITUDE, TUNE_HYSTERESIS);
+    uint32_t now = 0;
+    tuner.start(0.0f, now);
+    while (tuner.status() == TUNE_RUNNING) {
+        float out = tuner.update(rack.pos, now);
+        for (int i = 0; i < 10; i++) rack.step(out, 100e-6f);
+        now += 1000;
+    }
+    return tuner.result();
+}
+
+// Steps the position setpoint by 0.5 turns and closes the loop over the link.
+static void stepOverLink(const TuneResult& gains, float& overshoot, float& settle) {
+    SimOdrive sim;
+    ODriveUART odrive(sim);
+    FeedbackPoll poll(sim);
+    PidController<float> pid(gains.kp, gains.ki, gains.kd, -5.0f, 5.0f);
+    pid.setDerivativeFilter(0.1f * gains.pu);
+    const float target = 0.5f;
+    uint64_t startUs = hostClockUs;
+    float pos = 0.0f;
+    overshoot = 0.0f;
+    settle = 0.0f;
+    while (hostClockUs - startUs < 5000000ULL) {
+        loopTick();
+        if (!poll.service(pos)) continue;
+        odrive.setVelocity(pid.update(target, pos, micros()));
+        overshoot = fmaxf(overshoot, pos - target);
+        if (fabsf(pos - target) > 0.02f * target) settle = (hostClockUs - startUs) * 1e-6f;
+    }
+}
+
+int main() {
+    srand(1);
+    hostClockUs = 1000000;
+
+    TuneResult direct = tuneDirect();
+    printf("direct 1 kHz:  Ku %.3f  Pu %.3f s\n", direct.ku, direct.pu);
+
+    printf("Tuning through the loop\n");
+    LinkRun link = tuneOverLink(0);
+    printf("  200 Hz link:  Ku %.3f (%+.0f%%)  Pu %.3f s (%+.0f%%)  in %.2f s\n", link.result.ku,
+           100.0f * (link.result.ku / direct.ku - 1.0f), link.result.pu, 100.0f * (link.result.pu / direct.pu - 1.0f),
+           link.seconds);
+    check(link.status == TUNE_DONE, "converges through ODriveUART and the feedback poll");
+    check(link.seconds < 2.0f, "within 2 s");
+    check(link.commands > 0 && link.commands <= (uint32_t)(link.seconds * 200.0f) + 1,
+          "one command per feedback sample, at most 200 Hz");
+    // The link adds about one poll period of delay, which the tuner should see
+    // as a lower Ku and a longer Pu, not as noise.
+    check(link.result.ku < direct.ku && link.result.ku > 0.5f * direct.ku, "Ku lower than direct, by less than half");
+    check(link.result.pu > direct.pu && link.result.pu < 2.0f * direct.pu, "Pu longer than direct, by less than double");
+
+    LinkRun lossy = tuneOverLink(50);
+    printf("  one reply in 50 lost:  Ku %.3f  Pu %.3f s  in %.2f s\n", lossy.result.ku, lossy.result.pu, lossy.seconds);
+    check(lossy.status == TUNE_DONE, "lost replies: still converges");
+
+    printf("Closing the loop with the tuned gains\n");
+    const LinkRun* runs[] = {&link, &lossy};
+    const char* names[] = {"clean-run gains", "lossy-run gains"};
+    for (int i = 0; i < 2; i++) {
+        const TuneResult& r = runs[i]->result;
+        float overshoot, settle;
+        stepOverLink(r, overshoot, settle);
+        printf("  Kp %.3f Ki %.3f Kd %.4f  ->  overshoot %.1f%%  settle(2%%) %.2f s\n", r.kp, r.ki, r.kd,
+               100.0f * overshoot / 0.5f, settle);
+        char what[80];
+        snprintf(what, sizeof(what), "%s: overshoot < 25%%, settles in 2 s", names[i]);
+        check(overshoot < 0.25f * 0.5f && settle < 2.0f, what);
+    }
+
+    return checkSummary();
+}
@@ -0,0 +1,103 @@
+// Runs RelayAutoTune against a simulated first-order-plus-dead-time plant and
+// checks the result against the analytic ultimate gain/period, then closes the
+// loop with PidController using both tuning rules.
+//
+// Build:  g++ -std=c++17 -O2 -I../lib/EVT_PID -I../lib/util -o autotune_sim autotune_sim.cpp
+// Usage:  autotune_sim [gain] [tau_s] [deadtime_s]
+//
+// Defaults approximate a VESC wheel-speed loop seen from the Teensy (output in
+// normalized command, measurement in normalized speed); adjust to match a
+// black-box capture of the real loop.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include "EVT_PID.h"
+#include "RelayAutoTune.h"
+
+static const uint32_t DT_US = 1000;   // 1 kHz control loop
+static const float DT = DT_US * 1e-6f;
+
+struct Fopdt {
+    float gain, tau, deadTime;
+    float y = 0.0f;
+    std::deque<float> delay;
+
+    Fopdt(float k, float t, float l) : gain(k), tau(t), deadTime(l) {
+        delay.assign((size_t)lroundf(l / DT) + 1, 0.0f);
+    }
+
+    float step(float u) {
+        delay.push_back(u);
+        float delayed = delay.front();
+        delay.pop_front();
+        y += (gain * delayed - y) * DT / tau;
+        return y;
+    }
+};
+
+// Frequency where the FOPDT phase reaches -180 deg, and the gain margin there.
+static void analyticUltimate(float k, float tau, float l, float& ku, float& pu) {
+    float lo = 1e-3f, hi = 1e4f;
+    for (int i = 0; i < 200; i++) {
+        float w = 0.5f * (lo + hi);
+        float phase = atanf(w * tau) + w * l;
+        (phase < 3.14159265f ? lo : hi) = w;
+    }
+    float w = 0.5f * (lo + hi);
+    ku = sqrtf(1.0f + w * w * tau * tau) / k;
+    pu = 2.0f * 3.14159265f / w;
+}
+
+static void closedLoop(const char* name, float k, float tau, float l, const TuneResult& r) {
+    Fopdt plant(k, tau, l);
+    PidController<float> pid(r.kp, r.ki, r.kd, -1.0f, 1.0f);
+    pid.setDerivativeFilter(0.1f * r.pu);
+    const float target = 0.5f;
+    float y = 0.0f, overshoot = 0.0f, settle = 0.0f;
+    uint32_t now = 0;
+    for (int i = 0; i < 20000; i++) {
+        float u = pid.update(target, y, now);
+        y = plant.step(u);
+        now += DT_US;
+        overshoot = fmaxf(overshoot, y - target);
+        if (fabsf(y - target) > 0.02f * target) settle = i * DT;
+    }
+    printf("  %-16s Kp %.3f Ki %.3f Kd %.4f  ->  overshoot %5.1f%%  settle(2%%) %.2f s\n",
+           name, r.kp, r.ki, r.kd, 100.0f * overshoot / target, settle);
+}
+
+int main(int argc, char** argv) {
+    float k = argc > 1 ? (float)atof(argv[1]) : 1.0f;
+    float tau = argc > 2 ? (float)atof(argv[2]) : 0.15f;
+    float l = argc > 3 ? (float)atof(argv[3]) : 0.03f;
+
+    float kuRef, puRef;
+    analyticUltimate(k, tau, l, kuRef, puRef);
+    printf("plant K %.2f tau %.3f s L %.3f s   analytic Ku %.3f Pu %.3f s\n", k, tau, l, kuRef, puRef);
+
+    const TUNE_RULE rules[] = {TUNE_ZIEGLER_NICHOLS, TUNE_TYREUS_LUYBEN};
+    const char* names[] = {"Ziegler-Nichols", "Tyreus-Luyben"};
+    for (int r = 0; r < 2; r++) {
+        Fopdt plant(k, tau, l);
+        RelayAutoTune tuner(0.0f, 0.2f, 0.005f);
+        tuner.setRule(rules[r]);
+        uint32_t now = 0;
+        tuner.start(0.0f, now);
+        float y = 0.0f;
+        while (tuner.status() == TUNE_RUNNING) {
+            y = plant.step(tuner.update(y, now));
+            now += DT_US;
+        }
+        if (tuner.status() != TUNE_DONE) {
+            printf("%s: tuning failed after %.1f s\n", names[r], now * 1e-6f);
+            return 1;
+        }
+        const TuneResult& res = tuner.result();
+        printf("%s: tuned in %.2f s (%u cycles)  Ku %.3f (%+.1f%%)  Pu %.3f s (%+.1f%%)\n", names[r], now * 1e-6f,
+               tuner.cycles(), res.ku, 100.0f * (res.ku / kuRef - 1.0f), res.pu, 100.0f * (res.pu / puRef - 1.0f));
+        closedLoop(names[r], k, tau, l, res);
+    }
+    return 0;
+}
@@ -0,0 +1,185 @@
+// Minimal micro-benchmark harness for the host tools.
+//
+// Works like nanobench / Google Benchmark, but in one header so it needs
+// nothing beyond a C++17 compiler. Each benchmark's batch size is grown until
+// a batch takes --batch-ms. Several batches are timed and the median per-op
+// time is reported. Results go to a table on stdout and optionally to JSON
+// and CSV. --baseline compares against an earlier JSON file and returns
+// nonzero when something got slower than --threshold percent.
+//
+// Options understood by Suite:
+//   --filter text     only run benchmarks whose name contains text
+//   --json out.json   write results as JSON (one benchmark per line)
+//   --csv out.csv     write results as CSV
+//   --baseline b.json compare against a previous --json file
+//   --threshold pct   slowdown counted as a regression (default 10)
+//   --batch-ms ms     minimum time per timed batch (default 2)
+//   --samples n       timed batches per benchmark (default 15)
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// Keeps a value (and everything it depends on) from being optimised away.
+template <class T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Forces pending stores to memory, for benchmarks that only write a buffer.
+inline void clobberMemory() {
+    asm volatile("" : : : "memory");
+}
+
+struct Result {
+    std::string name;
+    double nsPerOp;       // Median over the samples.
+    double minNsPerOp;
+    double spreadPct;     // Interquartile range relative to the median.
+    uint64_t batch;       // Operations per timed sample.
+};
+
+class Suite {
+public:
+    Suite(int argc, char** argv) {
+        for (int i = 1; i + 1 < argc; i += 2) {
+            const char* key = argv[i];
+            const char* value = argv[i + 1];
+            if (strcmp(key, "--filter") == 0) filter_ = value;
+            else if (strcmp(key, "--json") == 0) jsonPath_ = value;
+            else if (strcmp(key, "--csv") == 0) csvPath_ = value;
+            else if (strcmp(key, "--baseline") == 0) baselinePath_ = value;
+            else if (strcmp(key, "--threshold") == 0) thresholdPct_ = atof(value);
+            else if (strcmp(key, "--batch-ms") == 0) batchNs_ = atof(value) * 1e6;
+            else if (strcmp(key, "--samples") == 0) samples_ = std::max(3, atoi(value));
+            else fprintf(stderr, "ignoring unknown option %s\n", key);
+        }
+        printf("%-52s %12s %12s %8s %10s\n", "benchmark", "ns/op", "min ns/op", "spread", "batch");
+    }
+
+    template <class F>
+    void run(const std::string& name, F&& op) {
+        if (!filter_.empty() && name.find(filter_) == std::string::npos) return;
+
+        uint64_t batch = 1;
+        while (timeBatch(op, batch) < batchNs_ && batch < (1ULL << 40)) {
+            batch *= 2;
+        }
+
+        std::vector<double> perOp;
+        for (int s = 0; s < samples_; s++) {
+            perOp.push_back(timeBatch(op, batch) / batch);
+        }
+        std::sort(perOp.begin(), perOp.end());
+        double median = perOp[perOp.size() / 2];
+        double iqr = perOp[perOp.size() * 3 / 4] - perOp[perOp.size() / 4];
+        Result r = { name, median, perOp.front(), median > 0 ? 100.0 * iqr / median : 0.0, batch };
+        results_.push_back(r);
+        printf("%-52s %12.2f %12.2f %7.1f%% %10llu\n", name.c_str(), r.nsPerOp, r.minNsPerOp,
+               r.spreadPct, (unsigned long long)r.batch);
+    }
+
+    // Writes the requested files and compares with the baseline. Returns the exit code.
+    int finish() {
+        if (!jsonPath_.empty()) writeJson();
+        if (!csvPath_.empty()) writeCsv();
+        return baselinePath_.empty() ? 0 : compareBaseline();
+    }
+
+private:
+    template <class F>
+    static double timeBatch(F& op, uint64_t batch) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < batch; i++) op();
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void writeJson() const {
+        FILE* f = fopen(jsonPath_.c_str(), "w");
+        if (!f) {
+            fprintf(stderr, "cannot create %s\n", jsonPath_.c_str());
+            return;
+        }
+        fprintf(f, "{\n  \"unit\": \"ns\",\n  \"benchmarks\": [\n");
+        for (size_t i = 0; i < results_.size(); i++) {
+            const Result& r = results_[i];
+            fprintf(f, "    {\"name\": \"%s\", \"ns_per_op\": %.4f, \"min_ns_per_op\": %.4f, \"spread_pct\": %.2f, \"batch\": %llu}%s\n",
+                    r.name.c_str(), r.nsPerOp, r.minNsPerOp, r.spreadPct, (unsigned long long)r.batch,
+                    i + 1 < results_.size() ? "," : "");
+        }
+        fprintf(f, "  ]\n}\n");
+        fclose(f);
+    }
+
+    void writeCsv() const {
+        FILE* f = fopen(csvPath_.c_str(), "w");
+        if (!f) {
+            fprintf(stderr, "cannot create %s\n", csvPath_.c_str());
+            return;
+        }
+        fprintf(f, "name,ns_per_op,min_ns_per_op,spread_pct,batch\n");
+        for (const Result& r : results_) {
+            fprintf(f, "\"%s\",%.4f,%.4f,%.2f,%llu\n", r.name.c_str(), r.nsPerOp, r.minNsPerOp, r.spreadPct,
+                    (unsigned long long)r.batch);
+        }
+        fclose(f);
+    }
+
+    // Reads back the one-benchmark-per-line JSON that writeJson() produces.
+    int compareBaseline() const {
+        FILE* f = fopen(baselinePath_.c_str(), "r");
+        if (!f) {
+            fprintf(stderr, "cannot open %s\n", baselinePath_.c_str());
+            return 2;
+        }
+        std::map<std::string, double> baseline;
+        char line[512];
+        while (fgets(line, sizeof(line), f)) {
+            const char* name = strstr(line, "\"name\": \"");
+            const char* ns = strstr(line, "\"ns_per_op\": ");
+            if (!name || !ns) continue;
+            name += 9;
+            const char* end = strchr(name, '"');
+            if (!end) continue;
+            baseline[std::string(name, end)] = atof(ns + 13);
+        }
+        fclose(f);
+
+        int regressions = 0;
+        printf("\n%-52s %12s %12s %9s\n", "vs baseline", "old ns/op", "new ns/op", "change");
+        for (const Result& r : results_) {
+            auto it = baseline.find(r.name);
+            if (it == baseline.end()) {
+                printf("%-52s %12s %12.2f %9s\n", r.name.c_str(), "-", r.nsPerOp, "new");
+                continue;
+            }
+            double change = it->second > 0 ? 100.0 * (r.nsPerOp - it->second) / it->second : 0.0;
+            bool regressed = change > thresholdPct_;
+            regressions += regressed;
+            printf("%-52s %12.2f %12.2f %+8.1f%%%s\n", r.name.c_str(), it->second, r.nsPerOp, change,
+                   regressed ? "  REGRESSION" : "");
+        }
+        printf("%d regression(s) above %.0f%%\n", regressions, thresholdPct_);
+        return regressions ? 1 : 0;
+    }
+
+    std::string filter_, jsonPath_, csvPath_, baselinePath_;
+    double thresholdPct_ = 10.0;
+    double batchNs_ = 2e6;
+    int samples_ = 15;
+    std::vector<Result> results_;
+};
+
+}  // namespace bench
+
+#endif  // BENCH_H
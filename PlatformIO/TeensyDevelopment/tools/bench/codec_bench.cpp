@@ -0,0 +1,511 @@
+// Host micro-benchmarks for every protocol codec the firmware links:
+// VescUart (crc16, buffer.cpp and util::BufReader/BufWriter, framing), SBUS, the ODrive CAN signal helpers
+// and CANSimple messages, ODriveUART line parsing and the UDP command parser.
+//
+// Build (from tools/bench, one line):
+//   g++ -std=c++17 -O2 -D__IMXRT1062__ -I. -I../replay/host -I../../lib/SBUS -I../../lib/VescUart/src
+//       -I../../lib/util -I../../lib/OdriveUART -I../../lib/EVT_AutoMode -o codec_bench codec_bench.cpp
+//       ../replay/host/HostArduino.cpp ../../lib/SBUS/SBUS.cpp ../../lib/VescUart/src/VescUart.cpp
+//       ../../lib/VescUart/src/buffer.cpp ../../lib/VescUart/src/crc.cpp ../../lib/OdriveUART/ODriveUART.cpp
+// Usage:
+//   codec_bench                                  table on stdout
+//   codec_bench --json base.json                 save results
+//   codec_bench --baseline base.json             exit 1 if anything is >10% slower than base.json
+//   codec_bench --filter can/ --samples 31       see bench.h for all options
+//
+// The firmware sources are compiled against the host Arduino shim from
+// tools/replay. Byte streams come from in-memory Streams, so the numbers are
+// codec cost plus one virtual call per byte, as on the Teensy. Host numbers
+// only compare versions of the code with each other; they are not Cortex-M7 cycles.
+//
+// Before timing anything it checks that util::BufReader/BufWriter produce the
+// same bytes and values as the buffer.cpp helpers they replaced in VescUart,
+// and that the VescPackets.h schemas decode and round-trip, and exits 1 if not.
+
+#include <cmath>
+#include "bench.h"
+#include "Arduino.h"
+#include "SBUS.h"
+#include "VescUart.h"
+#include "buffer.h"
+#include "bufio.h"
+#include "crc.h"
+#include "ODriveUART.h"
+#include "can_helpers.hpp"
+#include "can_simple_messages.hpp"
+#include "ControlPacket.h"
+
+using bench::doNotOptimize;
+
+// Swallows everything written to it.
+class NullStream : public Stream {
+public:
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    size_t write(uint8_t) override { return 1; }
+    size_t write(const uint8_t*, size_t size) override { return size; }
+};
+
+// Serves one canned byte sequence. With replyOnNewline the bytes only become
+// readable after the code under test writes a '\n', like an ODrive answering.
+class CannedStream : public Stream {
+public:
+    CannedStream(const uint8_t* data, size_t length, bool replyOnNewline)
+        : data_(data), length_(length), pos_(replyOnNewline ? length : 0), replyOnNewline_(replyOnNewline) {}
+
+    void rewind() { pos_ = 0; }
+    int available() override { return (int)(length_ - pos_); }
+    int read() override { return pos_ < length_ ? data_[pos_++] : -1; }
+    int peek() override { return pos_ < length_ ? data_[pos_] : -1; }
+    size_t write(uint8_t b) override {
+        if (replyOnNewline_ && b == '\n') pos_ = 0;
+        return 1;
+    }
+    using Print::write;
+
+private:
+    const uint8_t* data_;
+    size_t length_;
+    size_t pos_;
+    bool replyOnNewline_;
+};
+
+// SBUS insists on a HardwareSerial; this one replays a single frame.
+class FrameSerial : public HardwareSerial {
+public:
+    FrameSerial(const uint8_t* frame, size_t length) : data_(frame), length_(length) {}
+
+    void rewind() { pos_ = 0; }
+    int available() override { return (int)(length_ - pos_); }
+    int read() override { return pos_ < length_ ? data_[pos_++] : -1; }
+    int peek() override { return pos_ < length_ ? data_[pos_] : -1; }
+
+private:
+    const uint8_t* data_;
+    size_t length_;
+    size_t pos_ = 0;
+};
+
+static size_t buildValuesFrame(uint8_t* frame) {
+    uint8_t payload[80];
+    int32_t index = 0;
+    payload[index++] = COMM_GET_VALUES;
+    buffer_append_float16(payload, 41.5f, 10.0f, &index);
+    buffer_append_float16(payload, 38.0f, 10.0f, &index);
+    buffer_append_float32(payload, 12.34f, 100.0f, &index);
+    buffer_append_float32(payload, 9.87f, 100.0f, &index);
+    buffer_append_int32(payload, 0, &index);
+    buffer_append_int32(payload, 0, &index);
+    buffer_append_float16(payload, 0.456f, 1000.0f, &index);
+    buffer_append_float32(payload, 5432.0f, 1.0f, &index);
+    buffer_append_float16(payload, 48.2f, 10.0f, &index);
+    for (int i = 0; i < 4; i++) buffer_append_float32(payload, 1.5f, 10000.0f, &index);
+    buffer_append_int32(payload, 123456, &index);
+    buffer_append_int32(payload, 123456, &index);
+    payload[index++] = 0;
+    buffer_append_float32(payload, 0.0f, 1000000.0f, &index);
+    payload[index++] = 1;
+
+    uint16_t crc = crc16(payload, index);
+    size_t n = 0;
+    frame[n++] = 2;
+    frame[n++] = (uint8_t)index;
+    memcpy(frame + n, payload, index);
+    n += index;
+    frame[n++] = (uint8_t)(crc >> 8);
+    frame[n++] = (uint8_t)(crc & 0xFF);
+    frame[n++] = 3;
+    return n;
+}
+
+static size_t buildSbusFrame(uint8_t* frame) {
+    memset(frame, 0, 25);
+    frame[0] = 0x0F;
+    for (int i = 0; i < 16 * 11; i++) {
+        uint16_t value = (uint16_t)(172 + 100 * (i / 11));
+        if (value & (1 << (i % 11))) frame[1 + i / 8] |= 1 << (i % 8);
+    }
+    return 25;
+}
+
+static void benchVescBuffer(bench::Suite& suite) {
+    static uint8_t data[256];
+    for (int i = 0; i < 256; i++) data[i] = (uint8_t)(i * 37 + 11);
+
+    suite.run("crc16/8B", [&] { data[0]++; doNotOptimize(crc16(data, 8)); });
+    suite.run("crc16/64B", [&] { data[0]++; doNotOptimize(crc16(data, 64)); });
+    suite.run("crc16/255B", [&] { data[0]++; doNotOptimize(crc16(data, 255)); });
+
+    static uint8_t buf[16];
+    int32_t value = 0;
+    float f = 0.0f;
+    suite.run("buffer_append_int16", [&] { int32_t i = 0; buffer_append_int16(buf, (int16_t)value++, &i); bench::clobberMemory(); });
+    suite.run("buffer_append_int32", [&] { int32_t i = 0; buffer_append_int32(buf, value++, &i); bench::clobberMemory(); });
+    suite.run("buffer_append_float16", [&] { int32_t i = 0; buffer_append_float16(buf, f += 0.1f, 10.0f, &i); bench::clobberMemory(); });
+    suite.run("buffer_append_float32", [&] { int32_t i = 0; buffer_append_float32(buf, f += 0.1f, 100.0f, &i); bench::clobberMemory(); });
+    suite.run("buffer_append_float32_auto", [&] { int32_t i = 0; buffer_append_float32_auto(buf, f += 0.1f, &i); bench::clobberMemory(); });
+
+    suite.run("buffer_get_int16", [&] { int32_t i = 0; buf[1]++; doNotOptimize(buffer_get_int16(buf, &i)); });
+    suite.run("buffer_get_uint16", [&] { int32_t i = 0; buf[1]++; doNotOptimize(buffer_get_uint16(buf, &i)); });
+    suite.run("buffer_get_int32", [&] { int32_t i = 0; buf[3]++; doNotOptimize(buffer_get_int32(buf, &i)); });
+    suite.run("buffer_get_uint32", [&] { int32_t i = 0; buf[3]++; doNotOptimize(buffer_get_uint32(buf, &i)); });
+    suite.run("buffer_get_float16", [&] { int32_t i = 0; buf[1]++; doNotOptimize(buffer_get_float16(buf, 10.0f, &i)); });
+    suite.run("buffer_get_float32", [&] { int32_t i = 0; buf[3]++; doNotOptimize(buffer_get_float32(buf, 100.0f, &i)); });
+    suite.run("buffer_get_float32_auto", [&] { int32_t i = 0; buf[3]++; doNotOptimize(buffer_get_float32_auto(buf, &i)); });
+}
+
+// ---- buffer.cpp vs bufio.h ------------------------------------------------
+
+static int bufioMismatches = 0;
+
+static void expectSame(const char* what, uint32_t input, const uint8_t* a, const uint8_t* b, size_t n) {
+    if (memcmp(a, b, n) == 0) return;
+    if (bufioMismatches++ < 10) fprintf(stderr, "bufio mismatch: %s input 0x%08X\n", what, input);
+}
+
+static void expectSame(const char* what, uint32_t input, float a, float b) {
+    if (memcmp(&a, &b, sizeof(a)) == 0 || (std::isnan(a) && std::isnan(b))) return;
+    if (bufioMismatches++ < 10) fprintf(stderr, "bufio mismatch: %s input 0x%08X (%g vs %g)\n", what, input, a, b);
+}
+
+// Encodes and decodes the same values both ways and compares bytes and bit
+// patterns. Integers and scaled floats are sampled with a stride that reaches
+// every byte position; float32_auto decode walks a stride through all 2^32
+// bit patterns, so subnormals, infinities and NaNs are covered too.
+static bool checkBufioEquivalence() {
+    uint8_t a[4], b[4];
+    for (uint64_t step = 0; step <= 0xFFFFFFFFULL; step += 65521) {
+        uint32_t bits = (uint32_t)step;
+        int32_t index = 0;
+        buffer_append_int16(a, (int16_t)bits, &index);
+        util::BufWriter w16(b, sizeof(b));
+        w16.i16((int16_t)bits);
+        expectSame("append_int16", bits, a, b, 2);
+        index = 0;
+        buffer_append_int32(a, (int32_t)bits, &index);
+        util::BufWriter w32(b, sizeof(b));
+        w32.i32((int32_t)bits);
+        expectSame("append_int32", bits, a, b, 4);
+
+        index = 0;
+        util::BufReader r(a, 4);
+        expectSame("get_int32", bits, (float)buffer_get_int32(a, &index), (float)r.i32());
+        index = 0;
+        util::BufReader r16(a, 2);
+        expectSame("get_uint16", bits, (float)buffer_get_uint16(a, &index), (float)r16.u16());
+        index = 0;
+        util::BufReader rf(a, 4);
+        expectSame("get_float32/100", bits, buffer_get_float32(a, 100.0f, &index), rf.f32<100>());
+        index = 0;
+        util::BufReader rf16(a, 2);
+        expectSame("get_float16/10", bits, buffer_get_float16(a, 10.0f, &index), rf16.f16<10>());
+        index = 0;
+        util::BufReader ra(a, 4);
+        expectSame("get_float32_auto", bits, buffer_get_float32_auto(a, &index), ra.f32Auto());
+
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        if (!std::isfinite(value)) continue;
+        // Scaled encodes: keep the product inside int32 so both sides are defined.
+        float scaled = fmodf(value, 2000.0f);
+        index = 0;
+        buffer_append_float32(a, scaled, 1000.0f, &index);
+        util::BufWriter wf(b, sizeof(b));
+        wf.f32<1000>(scaled);
+        expectSame("append_float32*1000", bits, a, b, 4);
+        index = 0;
+        buffer_append_float16(a, fmodf(value, 3000.0f), 10.0f, &index);
+        util::BufWriter wf16(b, sizeof(b));
+        wf16.f16<10>(fmodf(value, 3000.0f));
+        expectSame("append_float16*10", bits, a, b, 2);
+        index = 0;
+        buffer_append_float32_auto(a, value, &index);
+        util::BufWriter wa(b, sizeof(b));
+        wa.f32Auto(value);
+        expectSame("append_float32_auto", bits, a, b, 4);
+    }
+
+    // Bounds: a short buffer reads as zero and reports it.
+    util::BufReader shortRead(a, 3);
+    bool boundsOk = shortRead.i32() == 0 && !shortRead.ok() && shortRead.remaining() == 0;
+    util::BufWriter shortWrite(b, 3);
+    shortWrite.u16(1);
+    shortWrite.u16(2);
+    boundsOk = boundsOk && !shortWrite.ok() && shortWrite.size() == 2;
+    if (!boundsOk) {
+        fprintf(stderr, "bufio bounds check failed\n");
+        bufioMismatches++;
+    }
+
+    if (bufioMismatches) fprintf(stderr, "%d bufio mismatch(es)\n", bufioMismatches);
+    return bufioMismatches == 0;
+}
+
+struct ValuesFields {
+    float tempMosfet, tempMotor, avgMotorCurrent, avgInputCurrent, dutyCycleNow, rpm, inpVoltage;
+    float ampHours, ampHoursCharged, wattHours, wattHoursCharged, pidPos;
+    int32_t tachometer, tachometerAbs;
+    uint8_t error, id;
+};
+
+// The GET_VALUES decode as VescUart::processReadPacket() did it before bufio.h.
+static void decodeValuesBuffer(const uint8_t* message, ValuesFields& d) {
+    int32_t index = 0;
+    d.tempMosfet = buffer_get_float16(message, 10.0, &index);
+    d.tempMotor = buffer_get_float16(message, 10.0, &index);
+    d.avgMotorCurrent = buffer_get_float32(message, 100.0, &index);
+    d.avgInputCurrent = buffer_get_float32(message, 100.0, &index);
+    index += 8;
+    d.dutyCycleNow = buffer_get_float16(message, 1000.0, &index);
+    d.rpm = buffer_get_float32(message, 1.0, &index);
+    d.inpVoltage = buffer_get_float16(message, 10.0, &index);
+    d.ampHours = buffer_get_float32(message, 10000.0, &index);
+    d.ampHoursCharged = buffer_get_float32(message, 10000.0, &index);
+    d.wattHours = buffer_get_float32(message, 10000.0, &index);
+    d.wattHoursCharged = buffer_get_float32(message, 10000.0, &index);
+    d.tachometer = buffer_get_int32(message, &index);
+    d.tachometerAbs = buffer_get_int32(message, &index);
+    d.error = message[index++];
+    d.pidPos = buffer_get_float32(message, 1000000.0, &index);
+    d.id = message[index++];
+}
+
+// Hand-written BufReader decode, the floor for the generated vesc::decode().
+static bool decodeValuesBufio(const uint8_t* message, size_t length, ValuesFields& d) {
+    util::BufReader in(message, length);
+    d.tempMosfet = in.f16<10>();
+    d.tempMotor = in.f16<10>();
+    d.avgMotorCurrent = in.f32<100>();
+    d.avgInputCurrent = in.f32<100>();
+    in.skip(8);
+    d.dutyCycleNow = in.f16<1000>();
+    d.rpm = in.f32<1>();
+    d.inpVoltage = in.f16<10>();
+    d.ampHours = in.f32<10000>();
+    d.ampHoursCharged = in.f32<10000>();
+    d.wattHours = in.f32<10000>();
+    d.wattHoursCharged = in.f32<10000>();
+    d.tachometer = in.i32();
+    d.tachometerAbs = in.i32();
+    d.error = in.u8();
+    d.pidPos = in.f32<1000000>();
+    d.id = in.u8();
+    return in.ok();
+}
+
+static void benchBufio(bench::Suite& suite) {
+    static uint8_t buf[16];
+    int32_t value = 0;
+    float f = 0.0f;
+    suite.run("BufWriter::i16", [&] { util::BufWriter w(buf, sizeof(buf)); w.i16((int16_t)value++); bench::clobberMemory(); });
+    suite.run("BufWriter::i32", [&] { util::BufWriter w(buf, sizeof(buf)); w.i32(value++); bench::clobberMemory(); });
+    suite.run("BufWriter::f16<10>", [&] { util::BufWriter w(buf, sizeof(buf)); w.f16<10>(f += 0.1f); bench::clobberMemory(); });
+    suite.run("BufWriter::f32<100>", [&] { util::BufWriter w(buf, sizeof(buf)); w.f32<100>(f += 0.1f); bench::clobberMemory(); });
+    suite.run("BufWriter::f32Auto", [&] { util::BufWriter w(buf, sizeof(buf)); w.f32Auto(f += 0.1f); bench::clobberMemory(); });
+
+    suite.run("BufReader::i16", [&] { buf[1]++; util::BufReader r(buf, sizeof(buf)); doNotOptimize(r.i16()); });
+    suite.run("BufReader::u16", [&] { buf[1]++; util::BufReader r(buf, sizeof(buf)); doNotOptimize(r.u16()); });
+    suite.run("BufReader::i32", [&] { buf[3]++; util::BufReader r(buf, sizeof(buf)); doNotOptimize(r.i32()); });
+    suite.run("BufReader::u32", [&] { buf[3]++; util::BufReader r(buf, sizeof(buf)); doNotOptimize(r.u32()); });
+    suite.run("BufReader::f16<10>", [&] { buf[1]++; util::BufReader r(buf, sizeof(buf)); doNotOptimize(r.f16<10>()); });
+    suite.run("BufReader::f32<100>", [&] { buf[3]++; util::BufReader r(buf, sizeof(buf)); doNotOptimize(r.f32<100>()); });
+    suite.run("BufReader::f32Auto", [&] { buf[3]++; util::BufReader r(buf, sizeof(buf)); doNotOptimize(r.f32Auto()); });
+
+    static uint8_t frame[128];
+    buildValuesFrame(frame);
+    const uint8_t* message = frame + 3;     // Past start byte, length and packet id.
+    size_t length = frame[1] - 1;
+    ValuesFields d;
+    suite.run("GET_VALUES decode (buffer.cpp)", [&] {
+        frame[40]++;
+        decodeValuesBuffer(message, d);
+        doNotOptimize(d);
+    });
+    suite.run("GET_VALUES decode (BufReader)", [&] {
+        frame[40]++;
+        doNotOptimize(decodeValuesBufio(message, length, d));
+        doNotOptimize(d);
+    });
+    vesc::Values values;
+    suite.run("GET_VALUES decode (vesc:: schema)", [&] {
+        frame[40]++;
+        util::BufReader in(message, length);
+        vesc::decode(in, values);
+        doNotOptimize(in.ok());
+        doNotOptimize(values);
+    });
+    suite.run("GET_VALUES_SELECTIVE decode (rpm, current, voltage)", [&] {
+        frame[40]++;
+        util::BufReader in(message, length);
+        vesc::decode(in, values, (1UL << vesc::Values::FIELD_rpm) | (1UL << vesc::Values::FIELD_avgMotorCurrent) |
+                                     (1UL << vesc::Values::FIELD_inpVoltage));
+        doNotOptimize(values);
+    });
+}
+
+// The generated GET_VALUES decode must agree with the hand-indexed one, and
+// every schema must round-trip through encode()/decode(), masked or not.
+static bool checkVescSchema() {
+    uint8_t frame[128];
+    buildValuesFrame(frame);
+    ValuesFields expected;
+    decodeValuesBuffer(frame + 3, expected);
+    vesc::Values values;
+    util::BufReader in(frame + 3, frame[1] - 1);
+    vesc::decode(in, values);
+    bool ok = in.ok() && in.remaining() == 0 && values.tempMosfet == expected.tempMosfet &&
+              values.avgInputCurrent == expected.avgInputCurrent && values.dutyCycleNow == expected.dutyCycleNow &&
+              values.rpm == expected.rpm && values.wattHoursCharged == expected.wattHoursCharged &&
+              values.tachometerAbs == expected.tachometerAbs && values.error == expected.error &&
+              values.pidPos == expected.pidPos && values.id == expected.id;
+    ok = ok && vesc::Values::WIRE_SIZE == (size_t)frame[1] - 1;
+
+    // Masked round trip: only the selected fields travel and get written.
+    uint8_t payload[128];
+    uint32_t mask = (1UL << vesc::Values::FIELD_rpm) | (1UL << vesc::Values::FIELD_id);
+    util::BufWriter out(payload, sizeof(payload));
+    vesc::encode(out, values, mask);
+    vesc::Values partial = {};
+    util::BufReader back(payload, out.size());
+    vesc::decode(back, partial, mask);
+    ok = ok && out.size() == 5 && back.ok() && partial.rpm == values.rpm && partial.id == values.id &&
+         partial.tempMosfet == 0.0f;
+
+    vesc::ImuData imu = {};
+    imu.roll = 0.25f;
+    imu.q3 = -1.0f;
+    util::BufWriter imuOut(payload, sizeof(payload));
+    vesc::encode(imuOut, imu, vesc::allFields<vesc::ImuData>());
+    vesc::ImuData imuBack = {};
+    util::BufReader imuIn(payload, imuOut.size());
+    vesc::decode(imuIn, imuBack, vesc::allFields<vesc::ImuData>());
+    ok = ok && imuOut.size() == vesc::ImuData::WIRE_SIZE && imuBack.roll == imu.roll && imuBack.q3 == imu.q3;
+
+    // A truncated reply is rejected.
+    util::BufReader shortIn(frame + 3, frame[1] - 2);
+    vesc::decode(shortIn, values);
+    ok = ok && !shortIn.ok();
+
+    if (!ok) fprintf(stderr, "vesc schema check failed\n");
+    return ok;
+}
+
+static void benchVescUart(bench::Suite& suite) {
+    static NullStream sink;
+    static VescUart tx;
+    tx.setSerialPort(&sink);
+    float current = 0.0f;
+    suite.run("VescUart::setCurrent (packSendPayload)", [&] { tx.setCurrent(current += 0.01f); });
+    suite.run("VescUart::requestVescValues", [&] { tx.requestVescValues(); });
+
+    static uint8_t frame[128];
+    size_t length = buildValuesFrame(frame);
+    static CannedStream source(frame, length, false);
+    static VescUart rx;
+    rx.setSerialPort(&source);
+    suite.run("VescUart::pollMessage GET_VALUES (unpack+process)", [&] {
+        source.rewind();
+        doNotOptimize(rx.pollMessage());
+        doNotOptimize(rx.data.rpm);
+    });
+}
+
+static void benchSbus(bench::Suite& suite) {
+    static uint8_t frame[25];
+    size_t length = buildSbusFrame(frame);
+    static FrameSerial port(frame, length);
+    static SBUS sbus(port);
+    sbus.begin();
+    uint16_t channels[10];
+    bool failsafe, lostFrame;
+    suite.run("SBUS::read (25B frame)", [&] {
+        port.rewind();
+        doNotOptimize(sbus.read(channels, &failsafe, &lostFrame));
+        doNotOptimize(channels);
+    });
+}
+
+static void benchCanSignals(bench::Suite& suite) {
+    static uint8_t buf[8] = { 0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0 };
+    uint32_t u = 0;
+    float f = 0.0f;
+    suite.run("can_get_signal_raw<uint32_t> intel", [&] { buf[0]++; doNotOptimize(can_get_signal_raw<uint32_t>(buf, 0, 32, true)); });
+    suite.run("can_get_signal_raw<float> intel", [&] { buf[4]++; doNotOptimize(can_get_signal_raw<float>(buf, 32, 32, true)); });
+    suite.run("can_get_signal_raw<uint16_t> motorola", [&] { buf[1]++; doNotOptimize(can_get_signal_raw<uint16_t>(buf, 7, 16, false)); });
+    suite.run("can_get_signal_raw<int16_t> scaled", [&] { buf[2]++; doNotOptimize(can_get_signal_raw<int16_t>(buf, 16, 16, true, 0.01f, 0.0f)); });
+    suite.run("can_set_signal_raw<uint32_t> intel", [&] { can_set_signal_raw<uint32_t>(buf, u++, 0, 32, true); bench::clobberMemory(); });
+    suite.run("can_set_signal_raw<float> intel", [&] { can_set_signal_raw<float>(buf, f += 0.1f, 32, 32, true); bench::clobberMemory(); });
+    suite.run("can_set_signal_raw<uint16_t> motorola", [&] { can_set_signal_raw<uint16_t>(buf, (uint16_t)u++, 7, 16, false); bench::clobberMemory(); });
+    suite.run("can_set_signal_raw<int16_t> scaled", [&] { can_set_signal_raw<int16_t>(buf, f += 0.1f, 16, 16, true, 0.01f, 0.0f); bench::clobberMemory(); });
+}
+
+// One encode and one decode benchmark per CANSimple message.
+template <class TMsg>
+static void benchCanMessage(bench::Suite& suite, const char* name) {
+    static uint8_t buf[8] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF };
+    static TMsg msg;
+    suite.run(std::string("can/") + name + "/encode", [&] {
+        msg.encode_buf(buf);
+        bench::clobberMemory();
+    });
+    suite.run(std::string("can/") + name + "/decode", [&] {
+        buf[0]++;
+        msg.decode_buf(buf);
+        doNotOptimize(msg);
+    });
+}
+
+#define CAN_MESSAGES(X) \
+    X(Get_Version) X(Heartbeat) X(Estop) X(Get_Error) X(Address) X(Set_Axis_State) \
+    X(Get_Encoder_Estimates) X(Set_Controller_Mode) X(Set_Input_Pos) X(Set_Input_Vel) \
+    X(Set_Input_Torque) X(Set_Limits) X(Set_Traj_Vel_Limit) X(Set_Traj_Accel_Limits) \
+    X(Set_Traj_Inertia) X(Get_Iq) X(Get_Temperature) X(Reboot) X(Get_Bus_Voltage_Current) \
+    X(Clear_Errors) X(Set_Absolute_Position) X(Set_Pos_Gain) X(Set_Vel_Gains) X(Get_Torques) \
+    X(Get_Powers) X(Enter_DFU_Mode)
+
+static void benchCanMessages(bench::Suite& suite) {
+#define BENCH_CAN_MESSAGE(name) benchCanMessage<name##_msg_t>(suite, #name);
+    CAN_MESSAGES(BENCH_CAN_MESSAGE)
+#undef BENCH_CAN_MESSAGE
+}
+
+static void benchOdriveUart(bench::Suite& suite) {
+    static const char feedback[] = "1.2345 -0.5000\r\n";
+    static CannedStream feedbackPort((const uint8_t*)feedback, sizeof(feedback) - 1, true);
+    static ODriveUART feedbackOdrive(feedbackPort);
+    suite.run("ODriveUART::getFeedback", [&] { doNotOptimize(feedbackOdrive.getFeedback()); });
+
+    static const char voltage[] = "48.1234\r\n";
+    static CannedStream voltagePort((const uint8_t*)voltage, sizeof(voltage) - 1, true);
+    static ODriveUART voltageOdrive(voltagePort);
+    suite.run("ODriveUART::getParameterAsFloat", [&] { doNotOptimize(voltageOdrive.getParameterAsFloat("vbus_voltage")); });
+
+    static NullStream sink;
+    static ODriveUART commandOdrive(sink);
+    float pos = 0.0f;
+    suite.run("ODriveUART::setPosition (3 args)", [&] { commandOdrive.setPosition(pos += 0.001f, 0.25f, 0.0f); });
+}
+
+static void benchControlPacket(bench::Suite& suite) {
+    static const std::string packet = "1.234,56.7,0";
+    ControlPacket out;
+    suite.run("parseControlPacket (setControls)", [&] {
+        doNotOptimize(parseControlPacket(packet, out));
+        doNotOptimize(out);
+    });
+}
+
+int main(int argc, char** argv) {
+    if (!checkBufioEquivalence() || !checkVescSchema()) return 1;
+    bench::Suite suite(argc, argv);
+    benchVescBuffer(suite);
+    benchBufio(suite);
+    benchVescUart(suite);
+    benchSbus(suite);
+    benchCanSignals(suite);
+    benchCanMessages(suite);
+    benchOdriveUart(suite);
+    benchControlPacket(suite);
+    return suite.finish();
+}
@@ -0,0 +1,116 @@
+// Host measurement of what the old std::map<uint32_t, String> error tables
+// cost at static initialisation, against the EVT_ErrorCodes tables that
+// replaced them.
+//
+// Build (from tools/bench, one line):
+//   g++ -std=c++17 -O2 -D__IMXRT1062__ -I. -I../replay/host -I../../lib/EVT_ErrorCodes -I../../lib/OdriveUART
+//       -I../../lib/VescUart/src -I../../lib/util -o errorcodes_bench errorcodes_bench.cpp
+//       ../replay/host/HostArduino.cpp ../../lib/EVT_ErrorCodes/EVT_ErrorCodes.cpp
+// Usage:
+//   errorcodes_bench                             table on stdout
+//   errorcodes_bench --samples 31                see bench.h for all options
+//
+// The old maps are rebuilt from ODRIVE_ERROR_LIST / VESC_FAULT_LIST with the
+// same brace initialiser the headers used, so each entry makes a temporary
+// String, copies it into the node and frees the temporary. TeensyString
+// allocates like the Teensy core's WString (one realloc of length + 1 per
+// copy); the shim's String is a std::string and would hide that. Every
+// translation unit that included a header built its own copy, so one startup
+// is ODRIVE_COPIES ODrive maps and VESC_COPIES VESC maps. The timed op builds
+// and frees them, where startup only builds; the allocator calls are counted
+// separately. Host numbers only compare the two versions; they are not
+// Cortex-M7 cycles.
+
+#include <map>
+#include "bench.h"
+#include "EVT_ErrorCodes.h"
+
+using bench::doNotOptimize;
+
+static const int ODRIVE_COPIES = 6;   // Firmware .cpp files that included EVT_ODriver.h.
+static const int VESC_COPIES   = 7;   // And EVT_VescDriver.h.
+
+struct AllocCounts {
+    uint64_t stringAllocs = 0, stringBytes = 0;
+    uint64_t nodeAllocs = 0;
+};
+static AllocCounts counts;
+
+// The allocation behaviour of Teensy's WString, nothing else.
+class TeensyString {
+public:
+    TeensyString(const char* s) { copy(s, strlen(s)); }
+    TeensyString(const TeensyString& other) { copy(other.buffer_, other.length_); }
+    ~TeensyString() { free(buffer_); }
+    TeensyString& operator=(const TeensyString&) = delete;
+    const char* c_str() const { return buffer_; }
+
+private:
+    void copy(const char* s, size_t length) {
+        buffer_ = (char*)realloc(buffer_, length + 1);
+        counts.stringAllocs++;
+        counts.stringBytes += length + 1;
+        memcpy(buffer_, s, length + 1);
+        length_ = length;
+    }
+    char* buffer_ = nullptr;
+    size_t length_ = 0;
+};
+
+// Counts the map's node allocations.
+template <class T>
+struct CountingAllocator {
+    typedef T value_type;
+    CountingAllocator() = default;
+    template <class U> CountingAllocator(const CountingAllocator<U>&) {}
+    T* allocate(size_t n) {
+        counts.nodeAllocs += n;
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n) { std::allocator<T>().deallocate(p, n); }
+    template <class U> bool operator==(const CountingAllocator<U>&) const { return true; }
+    template <class U> bool operator!=(const CountingAllocator<U>&) const { return false; }
+};
+
+typedef std::map<uint32_t, TeensyString, std::less<uint32_t>,
+                 CountingAllocator<std::pair<const uint32_t, TeensyString>>> OldErrorMap;
+
+#define OLD_MAP_ENTRY(code, name) { code, name },
+
+static void buildOldTables() {
+    for (int i = 0; i < ODRIVE_COPIES; i++) {
+        const OldErrorMap odrvErrorMap = { ODRIVE_ERROR_LIST(OLD_MAP_ENTRY) };
+        doNotOptimize(odrvErrorMap);
+    }
+    for (int i = 0; i < VESC_COPIES; i++) {
+        const OldErrorMap vescErrorMap = { VESC_FAULT_LIST(OLD_MAP_ENTRY) };
+        doNotOptimize(vescErrorMap);
+    }
+}
+
+int main(int argc, char** argv) {
+    // One startup's worth, counted before anything is timed.
+    counts = AllocCounts();
+    buildOldTables();
+    AllocCounts once = counts;
+
+    bench::Suite suite(argc, argv);
+    suite.run("old/static-init maps (build + free)", [] { buildOldTables(); });
+    // The new tables are constant-initialised arrays; the nearest thing to
+    // touching them at startup is one lookup in each.
+    suite.run("new/one lookup per table", [] {
+        doNotOptimize(odriveErrorBitName(ODRIVE_ERROR_CALIBRATION_ERROR));
+        doNotOptimize(vescFaultToString(FAULT_CODE_PHASE_FILTER));
+    });
+
+    // One node per entry, and each node holds one String; the other Strings were the temporaries.
+    printf("\nold tables, one startup: %d + %d maps, %llu entries\n", ODRIVE_COPIES, VESC_COPIES,
+           (unsigned long long)once.nodeAllocs);
+    printf("  allocations    %6llu (%llu nodes, %llu String buffers)\n",
+           (unsigned long long)(once.nodeAllocs + once.stringAllocs), (unsigned long long)once.nodeAllocs,
+           (unsigned long long)once.stringAllocs);
+    printf("  frees          %6llu (the temporary Strings)\n",
+           (unsigned long long)(once.stringAllocs - once.nodeAllocs));
+    printf("  String bytes   %6llu requested, half of them kept\n", (unsigned long long)once.stringBytes);
+    return suite.finish();
+}
@@ -0,0 +1,121 @@
+// Host-side decoder for the black-box logs written by EVT_BlackBox.
+//
+// Build:  g++ -std=c++17 -O2 -I../lib/EVT_BlackBox -I../lib/util -o blackbox_decode blackbox_decode.cpp
+// Usage:  blackbox_decode LOG000.BIN out.csv          (one CSV row per sample)
+//         blackbox_decode LOG000.BIN outdir --columns (one raw little-endian file per field)
+//
+// Chunks with a bad magic or CRC are skipped and reported; sequence gaps mean
+// the SD card fell behind on the vehicle and chunks were dropped there.
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "EVT_BlackBoxFormat.h"
+
+struct Column {
+    const char* name;
+    const char* type;   // "u32", "u16", "u8" or "f32"
+    size_t offset;
+    size_t size;
+};
+
+#define COL(field, type) { #field, type, offsetof(BlackBoxSample, field), sizeof(((BlackBoxSample*)0)->field) }
+#define COL_AT(name, type, field, idx) \
+    { name, type, offsetof(BlackBoxSample, field) + idx * sizeof(((BlackBoxSample*)0)->field[0]), sizeof(((BlackBoxSample*)0)->field[0]) }
+
+static const Column columns[] = {
+    COL(timestampUs, "u32"),
+    COL_AT("ch0", "u16", channels, 0), COL_AT("ch1", "u16", channels, 1), COL_AT("ch2", "u16", channels, 2),
+    COL_AT("ch3", "u16", channels, 3), COL_AT("ch4", "u16", channels, 4), COL_AT("ch5", "u16", channels, 5),
+    COL_AT("ch6", "u16", channels, 6), COL_AT("ch7", "u16", channels, 7), COL_AT("ch8", "u16", channels, 8),
+    COL_AT("ch9", "u16", channels, 9),
+    COL_AT("vesc1Rpm", "f32", vescRpm, 0),                   COL_AT("vesc2Rpm", "f32", vescRpm, 1),
+    COL_AT("vesc1MotorCurrent", "f32", vescMotorCurrent, 0), COL_AT("vesc2MotorCurrent", "f32", vescMotorCurrent, 1),
+    COL_AT("vesc1InputCurrent", "f32", vescInputCurrent, 0), COL_AT("vesc2InputCurrent", "f32", vescInputCurrent, 1),
+    COL_AT("vesc1Duty", "f32", vescDuty, 0),                 COL_AT("vesc2Duty", "f32", vescDuty, 1),
+    COL_AT("vesc1TempMosfet", "f32", vescTempMosfet, 0),     COL_AT("vesc2TempMosfet", "f32", vescTempMosfet, 1),
+    COL(vescVoltage, "f32"),
+    COL(odrvPos, "f32"),
+    COL(odrvVel, "f32"),
+    COL(steeringTarget, "f32"),
+    COL(rpmCommand, "f32"),
+    COL_AT("vesc1Fault", "u8", vescFault, 0),                COL_AT("vesc2Fault", "u8", vescFault, 1),
+    COL(state, "u8"),
+    COL(flags, "u8"),
+};
+static const size_t numColumns = sizeof(columns) / sizeof(columns[0]);
+
+static void printValue(FILE* out, const Column& c, const BlackBoxSample& s) {
+    const uint8_t* p = (const uint8_t*)&s + c.offset;
+    if (strcmp(c.type, "f32") == 0) {
+        float v; memcpy(&v, p, 4); fprintf(out, "%.6g", v);
+    } else if (strcmp(c.type, "u32") == 0) {
+        uint32_t v; memcpy(&v, p, 4); fprintf(out, "%u", v);
+    } else if (strcmp(c.type, "u16") == 0) {
+        uint16_t v; memcpy(&v, p, 2); fprintf(out, "%u", v);
+    } else {
+        fprintf(out, "%u", *p);
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s LOG.BIN out.csv | %s LOG.BIN outdir --columns\n", argv[0], argv[0]);
+        return 1;
+    }
+    bool columnar = argc > 3 && strcmp(argv[3], "--columns") == 0;
+
+    FILE* in = fopen(argv[1], "rb");
+    if (!in) { perror(argv[1]); return 1; }
+
+    std::vector<BlackBoxSample> samples;
+    BlackBoxChunk chunk;
+    uint32_t expectedSeq = 0, chunks = 0, badChunks = 0, gaps = 0;
+    while (fread(&chunk, sizeof(chunk), 1, in) == 1) {
+        const BlackBoxChunkHeader& h = chunk.header;
+        if (h.magic != BLACKBOX_MAGIC || h.version != BLACKBOX_VERSION ||
+            h.sampleCount > BLACKBOX_SAMPLES_PER_CHUNK ||
+            h.crc32 != blackBoxCrc32((const uint8_t*)chunk.samples, h.sampleCount * sizeof(BlackBoxSample))) {
+            badChunks++;
+            continue;
+        }
+        if (chunks > 0 && h.sequence != expectedSeq) gaps += h.sequence - expectedSeq;
+        expectedSeq = h.sequence + 1;
+        chunks++;
+        samples.insert(samples.end(), chunk.samples, chunk.samples + h.sampleCount);
+    }
+    fclose(in);
+
+    if (columnar) {
+        std::string dir = argv[2];
+        FILE* schema = fopen((dir + "/schema.txt").c_str(), "w");
+        if (!schema) { perror(dir.c_str()); return 1; }
+        for (size_t c = 0; c < numColumns; c++) {
+            fprintf(schema, "%s %s %zu\n", columns[c].name, columns[c].type, samples.size());
+            FILE* col = fopen((dir + "/" + columns[c].name + ".bin").c_str(), "wb");
+            for (const BlackBoxSample& s : samples) {
+                fwrite((const uint8_t*)&s + columns[c].offset, columns[c].size, 1, col);
+            }
+            fclose(col);
+        }
+        fclose(schema);
+    } else {
+        FILE* out = fopen(argv[2], "w");
+        if (!out) { perror(argv[2]); return 1; }
+        for (size_t c = 0; c < numColumns; c++) fprintf(out, c ? ",%s" : "%s", columns[c].name);
+        fputc('\n', out);
+        for (const BlackBoxSample& s : samples) {
+            for (size_t c = 0; c < numColumns; c++) {
+                if (c) fputc(',', out);
+                printValue(out, columns[c], s);
+            }
+            fputc('\n', out);
+        }
+        fclose(out);
+    }
+
+    fprintf(stderr, "%u chunks, %zu samples, %u bad chunks skipped, %u chunks missing\n",
+            chunks, samples.size(), badChunks, gaps);
+    return 0;
+}
@@ -0,0 +1,217 @@
+// Host run of the ODrive calibration sequencer (lib/EVT_ODriver/CalibSequencer.h)
+// through the real ODriveUART against a simulated ODrive that answers the
+// ASCII protocol: requested states take a while to run, then drop back to IDLE,
+// optionally with a disarm reason, the way firmware 0.6 does.
+//
+// Build (from tools, one line):
+//   g++ -std=c++17 -O2 -Wall -D__IMXRT1062__ -Ireplay/host -I../lib/EVT_ODriver -I../lib/OdriveUART -o calib_sim calib_sim.cpp replay/host/HostArduino.cpp ../lib/OdriveUART/ODriveUART.cpp
+// Usage:
+//   calib_sim
+//
+// Covers the full run, a phase that never finishes, the abort switch, a phase
+// that ends with an axis error, a closed-loop-only arm that is refused, and
+// that channel 5 has to be released before a failed run starts again. Exits 1
+// if any check failed.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "Arduino.h"
+#include "CalibSequencer.h"
+#include "checks.h"
+
+// The ODrive end of Serial6. Requested states run for a set time, then the
+// axis drops back to IDLE with disarmError latched if one is configured.
+class SimOdrive : public Stream {
+public:
+    uint32_t motorCalMs = 3000;
+    uint32_t encoderCalMs = 4000;
+    uint32_t armMs = 100;
+    bool hangMotorCal = false;        // Motor calibration never finishes.
+    uint32_t motorCalError = 0;       // Disarm reason at the end of motor calibration.
+    bool refuseClosedLoop = false;    // Closed loop requests are ignored (e.g. encoder not ready).
+    float pos = -0.4f;
+
+    ODriveAxisState state = AXIS_STATE_IDLE;
+    uint32_t disarmReason = 0;
+    int inputMode = 3;
+    std::vector<int> requested;       // Every requested state, in order.
+
+    int available() override {
+        advance();
+        if (rx_.empty()) {
+            hostClockUs += HOST_IDLE_POLL_US;
+            return 0;
+        }
+        return (int)rx_.size();
+    }
+    int read() override {
+        if (rx_.empty()) return -1;
+        char c = rx_[0];
+        rx_.erase(0, 1);
+        return (uint8_t)c;
+    }
+    int peek() override { return rx_.empty() ? -1 : (uint8_t)rx_[0]; }
+    size_t write(uint8_t b) override {
+        if (b == '\n') {
+            handle(line_);
+            line_.clear();
+        } else if (b != '\r') {
+            line_ += (char)b;
+        }
+        return 1;
+    }
+    using Print::write;
+
+private:
+    void handle(const std::string& line) {
+        advance();
+        char path[64];
+        int value;
+        if (line == "sc") {
+            disarmReason = 0;
+        } else if (line == "f 0") {
+            reply(std::to_string(pos) + " 0.0");
+        } else if (sscanf(line.c_str(), "r %63s", path) == 1) {
+            std::string p = path;
+            if (p == "axis0.current_state") reply(std::to_string((int)state));
+            else if (p == "axis0.disarm_reason") reply(std::to_string(disarmReason));
+            else reply("invalid property");
+        } else if (sscanf(line.c_str(), "w axis0.requested_state %d", &value) == 1) {
+            request((ODriveAxisState)value);
+        } else if (sscanf(line.c_str(), "w axis0.controller.config.input_mode %d", &value) == 1) {
+            inputMode = value;
+        }
+    }
+
+    void request(ODriveAxisState next) {
+        requested.push_back(next);
+        // A latched error keeps the axis from arming, like the real one.
+        if (next == AXIS_STATE_CLOSED_LOOP_CONTROL && (refuseClosedLoop || disarmReason != 0)) return;
+        state = next;
+        sinceMs_ = millis();
+    }
+
+    void advance() {
+        uint32_t elapsed = millis() - sinceMs_;
+        if (state == AXIS_STATE_MOTOR_CALIBRATION && !hangMotorCal && elapsed >= motorCalMs) {
+            state = AXIS_STATE_IDLE;
+            disarmReason = motorCalError;
+        } else if (state == AXIS_STATE_ENCODER_OFFSET_CALIBRATION && elapsed >= encoderCalMs) {
+            state = AXIS_STATE_IDLE;
+            pos += 0.05f;   // The offset search leaves the rotor a little off where it started.
+        }
+    }
+
+    void reply(const std::string& text) { rx_ += text + "\n"; }
+
+    std::string line_;
+    std::string rx_;
+    uint32_t sinceMs_ = 0;
+};
+
+static std::vector<CALIB_STEP> steps;
+
+static void recordStep(CALIB_STEP step, uint32_t) {
+    steps.push_back(step);
+}
+
+// Channel 5 as the sequencer sees it from updateOdrvControl().
+enum Switch { OFF, MIDDLE, ON };
+
+// Runs the 1 kHz loop for ms milliseconds with the switch held.
+static CALIB_STEP run(CalibSequencer& seq, Switch ch5, uint32_t ms) {
+    CALIB_STEP step = seq.step();
+    for (uint32_t i = 0; i < ms; i++) {
+        hostClockUs += 1000;
+        step = seq.service(ch5 == ON, ch5 == OFF, millis());
+    }
+    return step;
+}
+
+static bool sawSteps(std::initializer_list<CALIB_STEP> expected) {
+    return std::vector<CALIB_STEP>(expected) == steps;
+}
+
+int main() {
+    hostClockUs = 1000000;
+
+    printf("Full calibration\n");
+    {
+        SimOdrive sim;
+        ODriveUART odrive(sim);
+        CalibSequencer seq(odrive, recordStep);
+        steps.clear();
+        check(run(seq, ON, 2000) == CALIB_STEP_MOTOR && seq.progress() == 10, "switch starts motor calibration");
+        check(run(seq, ON, 4000) == CALIB_STEP_ENCODER, "encoder offset once the motor phase is back in IDLE");
+        check(run(seq, ON, 5000) == CALIB_STEP_DONE && seq.progress() == 100, "armed");
+        check(sawSteps({CALIB_STEP_MOTOR, CALIB_STEP_ENCODER, CALIB_STEP_CLOSED_LOOP, CALIB_STEP_DONE}),
+              "every step entered once, in order");
+        check(sim.state == AXIS_STATE_CLOSED_LOOP_CONTROL && sim.inputMode == 1, "closed loop, passthrough input");
+        check(fabsf(seq.startPos() + 0.4f) < 1e-3f && fabsf(seq.armedPos() + 0.35f) < 1e-3f,
+              "start and armed positions read from the axis");
+        check(run(seq, ON, 20000) == CALIB_STEP_DONE && steps.size() == 4, "held switch does not start another run");
+    }
+
+    printf("Phase timeout\n");
+    {
+        SimOdrive sim;
+        sim.hangMotorCal = true;
+        ODriveUART odrive(sim);
+        CalibSequencer seq(odrive, recordStep);
+        steps.clear();
+        check(run(seq, ON, CALIB_PHASE_TIMEOUT_MS - 200) == CALIB_STEP_MOTOR, "still waiting before the timeout");
+        check(run(seq, ON, 400) == CALIB_STEP_FAILED && seq.axisError() == 0, "failed at the timeout, no axis error");
+        check(sim.state == AXIS_STATE_IDLE, "axis sent to IDLE");
+        sim.hangMotorCal = false;
+        check(run(seq, ON, 10000) == CALIB_STEP_FAILED, "held switch does not restart the run");
+        run(seq, MIDDLE, 100);
+        check(run(seq, ON, 100) == CALIB_STEP_MOTOR, "released and raised again, it restarts");
+    }
+
+    printf("Abort switch\n");
+    {
+        SimOdrive sim;
+        ODriveUART odrive(sim);
+        CalibSequencer seq(odrive, recordStep);
+        steps.clear();
+        run(seq, ON, 5000);
+        check(seq.step() == CALIB_STEP_ENCODER, "in the encoder phase");
+        check(run(seq, OFF, 1) == CALIB_STEP_ABORTED, "switch off aborts within the tick");
+        check(sim.requested.back() == AXIS_STATE_IDLE && sim.state == AXIS_STATE_IDLE, "axis sent to IDLE");
+        check(run(seq, OFF, 2000) == CALIB_STEP_ABORTED, "stays aborted");
+        check(run(seq, ON, 100) == CALIB_STEP_MOTOR, "switch on again restarts");
+    }
+
+    printf("Axis error at the end of a phase\n");
+    {
+        SimOdrive sim;
+        sim.motorCalError = ODRIVE_ERROR_CALIBRATION_ERROR;
+        ODriveUART odrive(sim);
+        CalibSequencer seq(odrive, recordStep);
+        steps.clear();
+        check(run(seq, ON, 4000) == CALIB_STEP_FAILED, "failed instead of moving on to the encoder");
+        check(seq.axisError() == ODRIVE_ERROR_CALIBRATION_ERROR, "disarm reason reported");
+        check(sawSteps({CALIB_STEP_MOTOR, CALIB_STEP_FAILED}), "encoder phase never requested");
+    }
+
+    printf("Closed-loop-only arm refused\n");
+    {
+        SimOdrive sim;
+        sim.refuseClosedLoop = true;
+        ODriveUART odrive(sim);
+        CalibSequencer seq(odrive, recordStep);
+        seq.setStoreMatches(true);
+        steps.clear();
+        check(run(seq, ON, 100) == CALIB_STEP_CLOSED_LOOP, "stored calibration matches, only arms");
+        check(run(seq, ON, CALIB_ARM_TIMEOUT_MS + 100) == CALIB_STEP_FAILED, "arm timed out");
+        check(!seq.storeMatches(), "stored calibration no longer trusted");
+        sim.refuseClosedLoop = false;
+        run(seq, MIDDLE, 100);
+        check(run(seq, ON, 100) == CALIB_STEP_MOTOR, "next press runs the full sequence");
+    }
+
+    return checkSummary();
+}
@@ -0,0 +1,46 @@
+// Pass/fail checks for the self-checking host tools.
+//
+// check() prints one labelled line per check. expect() is for checks made
+// inside a long run: it is silent when it passes and prints got/want for the
+// first 20 failures. A tool running on the host shim's virtual clock can
+// define CHECK_CLOCK_US (e.g. hostClockUs) before including this file, and
+// each failure then says when it happened. main() ends with
+// `return checkSummary();`, which exits 1 if anything failed.
+
+#ifndef CHECKS_H
+#define CHECKS_H
+
+#include <cmath>
+#include <cstdio>
+
+static int checkFailures = 0;
+
+static inline void check(bool ok, const char* what) {
+    printf("  %-56s %s\n", what, ok ? "ok" : "FAILED");
+    if (!ok) checkFailures++;
+}
+
+static inline void expect(bool ok, const char* what, double got, double want) {
+    if (ok) return;
+    if (checkFailures++ >= 20) return;
+#ifdef CHECK_CLOCK_US
+    printf("FAIL %s: got %.6f want %.6f at %.3f s\n", what, got, want, CHECK_CLOCK_US * 1e-6);
+#else
+    printf("FAIL %s: got %.6f want %.6f\n", what, got, want);
+#endif
+}
+
+static inline void expectNear(const char* what, double got, double want, double tolerance) {
+    expect(fabs(got - want) <= tolerance, what, got, want);
+}
+
+static inline int checkSummary() {
+    if (checkFailures) {
+        printf("%d check(s) FAILED\n", checkFailures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
+
+#endif // CHECKS_H
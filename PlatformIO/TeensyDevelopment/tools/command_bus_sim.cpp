@@ -0,0 +1,245 @@
+// Host run of EVT_CommandBus against the RC-mode command pattern: both VESCs
+// commanded every 1 kHz loop, the steering trajectory and the ODrive feedback
+// poll at 200 Hz, a stretch
+// where the emergency path stages a second VESC command in the same loop, and
+// a 300 ms loop stall during which the VESC supervisor interrupt (modelled
+// here as in EVT_VescDriver) writes zero current behind the bus's back.
+//
+// Build (from tools, one line):
+//   g++ -std=c++17 -O2 -Wall -D__IMXRT1062__ -Ireplay/host -I../lib/EVT_CommandBus -I../lib/EVT_SteerTrajectory
+//       -I../lib/VescUart/src -I../lib/OdriveUART -I../lib/util -o command_bus_sim command_bus_sim.cpp
+//       replay/host/HostArduino.cpp ../lib/EVT_CommandBus/EVT_CommandBus.cpp ../lib/VescUart/src/VescUart.cpp
+//       ../lib/VescUart/src/buffer.cpp ../lib/VescUart/src/crc.cpp ../lib/OdriveUART/ODriveUART.cpp
+// Usage:
+//   command_bus_sim [seconds]
+//
+// Prints bytes/sec per port as written by the bus and as the same commands
+// would have cost written one by one. Checks that every port gets at most one
+// write per loop, that after each flush the device holds the newest command
+// staged for it, and that an unchanged command is repeated at least every
+// COMMAND_BUS_KEEPALIVE_MS. During the stall it checks the supervisor stops
+// the VESCs within its deadline, and afterwards that the bus resends the
+// unchanged command it would otherwise have suppressed. Every feedback poll must
+// reach the ODrive, though its text never changes. Exits 1 on a failed check.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "Arduino.h"
+#include "EVT_CommandBus.h"
+#include "SteerTrajectory.h"
+#include "VescUart.h"
+#include "ODriveUART.h"
+#include "crc.h"
+
+#define CHECK_CLOCK_US hostClockUs
+#include "checks.h"
+
+// As in EVT_VescDriver.h.
+static const uint32_t SUPERVISOR_PERIOD_US = 5000;
+static const uint32_t COMMAND_TIMEOUT_MS   = 100;
+static const uint32_t STOP_REFRESH_MS      = 50;
+static const double   STALL_START = 7.0, STALL_END = 7.3;
+
+// A port as the device sees it: the bytes of the last write and how many
+// writes came in during the current loop.
+class DevicePort : public Print {
+public:
+    std::vector<uint8_t> last;
+    uint32_t writesThisLoop = 0;
+    uint32_t lastWriteMs = 0;
+
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        last.assign(buffer, buffer + size);
+        writesThisLoop++;
+        lastWriteMs = millis();
+        return size;
+    }
+    using Print::write;
+};
+
+// The ODrive port also carries the feedback poll. The device holds the last
+// position line; a poll only asks for a reply.
+class OdrivePort : public DevicePort {
+public:
+    uint32_t polls = 0;
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+        writesThisLoop++;
+        std::string text((const char*)buffer, size);
+        for (size_t start = 0; start < text.size();) {
+            size_t end = text.find('\n', start);
+            end = end == std::string::npos ? text.size() : end + 1;
+            std::string line = text.substr(start, end - start);
+            if (line == "f 0\n") {
+                polls++;
+            } else {
+                last.assign(line.begin(), line.end());
+                lastWriteMs = millis();
+            }
+            start = end;
+        }
+        return size;
+    }
+    using Print::write;
+};
+
+// Collects what ODriveUART::printPosition() would send.
+class LinePrint : public Print {
+public:
+    std::string line;
+    size_t write(uint8_t b) override { line.push_back((char)b); return 1; }
+    using Print::write;
+};
+
+static std::vector<uint8_t> rpmFrame(float rpm) {
+    vesc::SetRpm command;
+    command.rpm = rpm;
+    uint8_t frame[COMMAND_SLOT_BYTES];
+    int length = VescUart::packPacket(command, frame, sizeof(frame));
+    return std::vector<uint8_t>(frame, frame + length);
+}
+
+// RPM the drivetrain would ask for: idle, ramp, cruise, and an emergency stop.
+static float throttleRpm(double t) {
+    if (t < 1.0) return 0.0f;
+    if (t < 3.0) return floorf(3000.0f * (float)(t - 1.0));
+    return 6000.0f;
+}
+
+static std::vector<uint8_t> stopFrame() {
+    vesc::SetCurrent command;
+    command.current = 0.0f;
+    uint8_t frame[COMMAND_SLOT_BYTES];
+    int length = VescUart::packPacket(command, frame, sizeof(frame));
+    return std::vector<uint8_t>(frame, frame + length);
+}
+
+int main(int argc, char** argv) {
+    double seconds = argc > 1 ? atof(argv[1]) : 8.0;
+
+    DevicePort vescPort[2];
+    OdrivePort odrivePort;
+    bindCommandPort(COMMAND_PORT_VESC1, &vescPort[0]);
+    bindCommandPort(COMMAND_PORT_VESC2, &vescPort[1]);
+    bindCommandPort(COMMAND_PORT_ODRIVE, &odrivePort);
+    DevicePort* const ports[3] = { &vescPort[0], &vescPort[1], &odrivePort };
+    const char* const names[3] = { "vesc1", "vesc2", "odrive" };
+    const COMMAND_PORT portIds[3] = { COMMAND_PORT_VESC1, COMMAND_PORT_VESC2, COMMAND_PORT_ODRIVE };
+
+    SteerTrajectory trajectory(STEER_TRAJ_CONFIG);
+    trajectory.reset(0.0f);
+    uint32_t lastSteerUs = 0, lastPollUs = 0, polls = 0;
+    std::vector<uint8_t> newest[3];
+    uint32_t maxGapMs[3] = {0, 0, 0};
+    uint32_t loops = 0;
+    uint32_t stops = 0, lastSupervisorUs = 0;
+    uint32_t stopSentMs[2] = {0, 0};
+    bool stopped[2] = {false, false};
+    double firstStop = 0.0;
+    const std::vector<uint8_t> stop = stopFrame();
+
+    hostClockUs = 1000;
+    for (; hostClockUs < (uint64_t)(seconds * 1e6); hostClockUs += 1000, loops++) {
+        double t = hostClockUs * 1e-6;
+
+        if (micros() - lastSupervisorUs >= SUPERVISOR_PERIOD_US) {
+            lastSupervisorUs = micros();
+            for (uint8_t i = 0; i < 2; i++) {
+                uint32_t confirmedMs = getCommandConfirmedMs((COMMAND_SLOT)i);
+                if (confirmedMs == 0 || millis() - confirmedMs <= COMMAND_TIMEOUT_MS) {
+                    stopped[i] = false;
+                    continue;
+                }
+                if (stopped[i] && millis() - stopSentMs[i] < STOP_REFRESH_MS) continue;
+                stopped[i] = true;
+                stopSentMs[i] = millis();
+                vescPort[i].write(stop.data(), stop.size());
+                forceCommandResend((COMMAND_SLOT)i);
+                if (stops++ == 0) firstStop = t;
+            }
+        }
+        // The loop is stuck (a blocking call); only the interrupt runs.
+        if (t >= STALL_START && t < STALL_END) {
+            for (uint8_t i = 0; i < 2; i++)
+                if (t > STALL_START + (COMMAND_TIMEOUT_MS + 10) * 1e-3)
+                    expect(vescPort[i].last == stop, "vesc stopped during stall", vescPort[i].last.size(), stop.size());
+            continue;
+        }
+
+        // Only the bus's own writes count towards one per port per loop.
+        for (DevicePort* p : ports) p->writesThisLoop = 0;
+
+        // Drivetrain: both wheels every loop. From 6 s the emergency path also
+        // stops them, after the drivetrain already staged its command.
+        for (uint8_t i = 0; i < 2; i++) {
+            newest[i] = rpmFrame(throttleRpm(t) * (i == 0 ? 1.0f : 0.98f));
+            stageCommand((COMMAND_SLOT)i, newest[i].data(), newest[i].size());
+            if (t >= 6.0) {
+                newest[i] = rpmFrame(0.0f);
+                stageCommand((COMMAND_SLOT)i, newest[i].data(), newest[i].size());
+            }
+        }
+
+        // Steering: a step at 0.5 s and another at 4 s, streamed at 200 Hz.
+        if (micros() - lastSteerUs >= STEER_TRAJ_PERIOD_US) {
+            lastSteerUs = micros();
+            float target = t < 0.5 ? 0.0f : (t < 4.0 ? 1.0f : -0.5f);
+            SteerSetpoint sp = trajectory.step(target, STEER_TRAJ_PERIOD_US * 1e-6f);
+            LinePrint line;
+            ODriveUART::printPosition(line, sp.pos, sp.vel, sp.torque);
+            newest[2].assign(line.line.begin(), line.line.end());
+            ODriveUART::printPosition(beginCommand(COMMAND_SLOT_STEERING), sp.pos, sp.vel, sp.torque);
+        }
+
+        // Feedback poll, as serviceOdrvFeedback() stages it.
+        if (micros() - lastPollUs >= STEER_TRAJ_PERIOD_US) {
+            lastPollUs = micros();
+            forceCommandResend(COMMAND_SLOT_ODRIVE_FEEDBACK);
+            beginCommand(COMMAND_SLOT_ODRIVE_FEEDBACK).print("f 0\n");
+            polls++;
+        }
+
+        flushCommandBus();
+
+        for (uint8_t p = 0; p < 3; p++) {
+            expect(ports[p]->writesThisLoop <= 1, names[p], ports[p]->writesThisLoop, 1);
+            if (newest[p].empty()) continue;
+            expect(ports[p]->last == newest[p], "device holds newest command", ports[p]->last.size(), newest[p].size());
+            uint32_t gap = millis() - ports[p]->lastWriteMs;
+            if (gap > maxGapMs[p]) maxGapMs[p] = gap;
+        }
+    }
+
+    // Frames on the VESC ports must still be valid UART frames.
+    for (uint8_t i = 0; i < 2; i++) {
+        const std::vector<uint8_t>& f = vescPort[i].last;
+        uint16_t crc = crc16((unsigned char*)&f[2], f[1]);
+        expect(f[0] == 2 && f.back() == 3 && f[2] == COMM_SET_RPM && crc == (uint16_t)(f[2 + f[1]] << 8 | f[3 + f[1]]),
+               "vesc frame", f.size(), 10);
+    }
+
+    if (seconds > STALL_END) {
+        expect(stops > 0 && firstStop - STALL_START <= (COMMAND_TIMEOUT_MS + 10) * 1e-3, "stop latency", firstStop - STALL_START, COMMAND_TIMEOUT_MS * 1e-3);
+        printf("stall at %.1f s: supervisor stopped the VESCs after %.0f ms, %u stop frames\n",
+               STALL_START, (firstStop - STALL_START) * 1e3, stops);
+    }
+    printf("%.1f s, %u loops, %u of %u feedback polls written\n", seconds, loops, odrivePort.polls, polls);
+    expect(odrivePort.polls == polls, "feedback polls", odrivePort.polls, polls);
+    printf("%-8s %12s %12s %8s %8s %10s %10s %8s\n", "port", "requested", "written", "saved", "writes", "coalesced", "suppressed", "max gap");
+    for (uint8_t p = 0; p < 3; p++) {
+        const CommandPortStats& s = getCommandPortStats(portIds[p]);
+        double requested = s.bytesRequested / seconds, written = s.bytesWritten / seconds;
+        printf("%-8s %10.0f/s %10.0f/s %7.1f%% %8u %10u %10u %6u ms\n", names[p], requested, written,
+               requested > 0 ? 100.0 * (requested - written) / requested : 0.0,
+               s.writes, s.commandsCoalesced, s.commandsSuppressed, maxGapMs[p]);
+        expect(maxGapMs[p] <= COMMAND_BUS_KEEPALIVE_MS, "keepalive gap", maxGapMs[p], COMMAND_BUS_KEEPALIVE_MS);
+        expect(s.overflows == 0, "overflows", s.overflows, 0);
+    }
+
+    return checkSummary();
+}
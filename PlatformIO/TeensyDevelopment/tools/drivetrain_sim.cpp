@@ -0,0 +1,117 @@
+// Two-wheel longitudinal model for validating Drivetrain (electronic
+// differential + traction control) before it goes on the car.
+//
+// Build:  g++ -std=c++17 -O2 -I../lib/EVT_Drivetrain -o drivetrain_sim drivetrain_sim.cpp
+// Usage:  drivetrain_sim [left_mu] [right_mu] [steer_turns] [out.csv]
+//
+// Each rear wheel is a VESC speed loop (PI on rpm, current limited) driving a
+// wheel through a Pacejka-style tyre; both push one vehicle mass, and in a turn
+// each wheel's ground speed follows its turning radius. The default
+// is a split-mu launch: left wheel on a slippery patch, full throttle.
+// Vehicle numbers are estimates for the kart, not measurements.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include "Drivetrain.h"
+
+static const float DT = 0.001f;
+static const float CONTROL_DT = 0.01f;        // Drivetrain runs at the 100 Hz telemetry rate
+static const float SIM_TIME = 3.0f;
+
+static const float MASS = 150.0f;              // kg with driver
+static const float WHEEL_RADIUS = 0.14f;       // m
+static const float WHEEL_INERTIA = 0.05f;      // kg m^2, wheel + motor reflected
+static const float REAR_LOAD = 0.3f * MASS * 9.81f;  // N per driven wheel
+static const float ERPM_PER_WHEEL_RPM = 28.0f; // 7 pole pairs * 4:1 gear
+static const float TORQUE_PER_AMP = 0.06f * 4.0f;    // Nm at the wheel per A (Kt * gear)
+static const float MAX_CURRENT = 80.0f;        // A, VESC motor current limit
+static const float THROTTLE_ERPM = 7500.0f;
+
+struct Wheel {
+    float mu;
+    float omega = 0.0f;       // rad/s
+    float integrator = 0.0f;
+    float current = 0.0f;
+
+    float rpmErpm() const { return omega * 60.0f / (2.0f * 3.14159265f) * ERPM_PER_WHEEL_RPM; }
+
+    // VESC speed loop, returns tyre force on the vehicle.
+    float step(float targetErpm, float vehicleSpeed) {
+        float err = targetErpm - rpmErpm();
+        integrator += 0.02f * err * DT;
+        integrator = fmaxf(-MAX_CURRENT, fminf(MAX_CURRENT, integrator));
+        current = fmaxf(-MAX_CURRENT, fminf(MAX_CURRENT, 0.05f * err + integrator));
+
+        float surface = omega * WHEEL_RADIUS;
+        float slip = (surface - vehicleSpeed) / fmaxf(fmaxf(fabsf(surface), fabsf(vehicleSpeed)), 0.5f);
+        float force = REAR_LOAD * mu * sinf(1.9f * atanf(10.0f * slip));
+        omega += (current * TORQUE_PER_AMP - force * WHEEL_RADIUS) / WHEEL_INERTIA * DT;
+        return force;
+    }
+};
+
+struct Result {
+    float speed, distance, peakSlip, slipTime;
+};
+
+static Result run(float muL, float muR, float steer, bool tc, FILE* csv) {
+    Wheel wheels[WHEEL_COUNT] = {{muL}, {muR}};
+    Drivetrain drive(DRIVETRAIN_CONFIG);
+    drive.setTractionControl(tc);
+    float cmd[WHEEL_COUNT] = {0.0f, 0.0f};
+    float v = 0.0f, x = 0.0f, peakSlip = 0.0f, slipTime = 0.0f, nextControl = 0.0f;
+
+    // In a steady turn each wheel's contact patch moves at v times its radius ratio.
+    const DrivetrainConfig& cfg = DRIVETRAIN_CONFIG;
+    float halfTrackOverR = 0.5f * cfg.trackWidth * tanf(steer * cfg.steerRadPerTurn) / cfg.wheelBase;
+    float path[WHEEL_COUNT] = {1.0f + halfTrackOverR, 1.0f - halfTrackOverR};
+
+    for (float t = 0.0f; t < SIM_TIME; t += DT) {
+        if (t >= nextControl) {
+            float rpm[WHEEL_COUNT] = {wheels[0].rpmErpm(), wheels[1].rpmErpm()};
+            float current[WHEEL_COUNT] = {wheels[0].current, wheels[1].current};
+            drive.update(THROTTLE_ERPM, steer, rpm, current, CONTROL_DT, cmd);
+            nextControl += CONTROL_DT;
+        }
+        float force = wheels[0].step(cmd[0], v * path[0]) + wheels[1].step(cmd[1], v * path[1]);
+        v += force / MASS * DT;
+        x += v * DT;
+
+        for (int w = 0; w < WHEEL_COUNT; w++) {
+            float ground = v * path[w];
+            float slip = (wheels[w].omega * WHEEL_RADIUS - ground) / fmaxf(ground, 0.5f);
+            peakSlip = fmaxf(peakSlip, slip);
+            if (slip > 0.3f) slipTime += DT;
+        }
+        if (csv) {
+            fprintf(csv, "%d,%.3f,%.3f,%.1f,%.1f,%.3f,%.3f\n", tc, t, v, wheels[0].rpmErpm(), wheels[1].rpmErpm(),
+                    drive.scale(WHEEL_LEFT), drive.scale(WHEEL_RIGHT));
+        }
+    }
+    return {v, x, peakSlip, slipTime};
+}
+
+int main(int argc, char** argv) {
+    float muL = argc > 1 ? (float)atof(argv[1]) : 0.25f;
+    float muR = argc > 2 ? (float)atof(argv[2]) : 0.9f;
+    float steer = argc > 3 ? (float)atof(argv[3]) : 0.0f;
+    FILE* csv = argc > 4 ? fopen(argv[4], "w") : nullptr;
+    if (csv) fprintf(csv, "tc,t,speed,rpm_left,rpm_right,scale_left,scale_right\n");
+
+    printf("mu left %.2f right %.2f, steer %.2f turns, %.0f ERPM step for %.1f s\n", muL, muR, steer,
+           THROTTLE_ERPM, SIM_TIME);
+    for (int tc = 0; tc <= 1; tc++) {
+        Result r = run(muL, muR, steer, tc, csv);
+        printf("  traction control %-3s  speed %.2f m/s  distance %.2f m  peak slip %.0f%%  time >30%% slip %.2f s\n",
+               tc ? "on" : "off", r.speed, r.distance, 100.0f * r.peakSlip, r.slipTime);
+    }
+
+    Drivetrain drive(DRIVETRAIN_CONFIG);
+    float zero[WHEEL_COUNT] = {0.0f, 0.0f}, out[WHEEL_COUNT];
+    drive.setTractionControl(false);
+    drive.update(1000.0f, steer, zero, zero, CONTROL_DT, out);
+    printf("  differential at %.2f turns: left x%.3f right x%.3f\n", steer, out[0] / 1000.0f, out[1] / 1000.0f);
+    if (csv) fclose(csv);
+    return 0;
+}
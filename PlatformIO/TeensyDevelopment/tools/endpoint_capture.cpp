@@ -0,0 +1,71 @@
+// Host run of the steering/stick endpoint capture (lib/EVT_CalibStore/EndpointCapture.h)
+// behind the CALBEGIN / CALSAVE link commands. Feeds it a simulated sweep of
+// the steering between its hard stops and of the sticks, then checks what it
+// writes into the calibration record and that a short sweep is refused.
+//
+// Build (from tools, one line):
+//   g++ -std=c++17 -O2 -Wall -I../lib/EVT_CalibStore -I../lib/util -o endpoint_capture endpoint_capture.cpp ../lib/EVT_CalibStore/EVT_CalibStore.cpp
+// Usage:
+//   endpoint_capture
+//
+// Exits 1 if any check failed.
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include "EndpointCapture.h"
+#include "checks.h"
+
+// Sticks centred (992) except the steering stick, which sweeps with the wheels.
+static void sweep(EndpointCapture& capture, float leftStop, float rightStop, uint16_t stickMin, uint16_t stickMax) {
+    uint16_t channels[CALIB_SBUS_CHANNELS];
+    for (int tick = 0; tick <= 200; tick++) {
+        float phase = 0.5f - 0.5f * cosf(tick * 2.0f * 3.14159265f / 200.0f);   // 0 -> 1 -> 0
+        for (uint8_t i = 0; i < CALIB_SBUS_CHANNELS; i++) channels[i] = 992;
+        channels[CALIB_CAPTURE_STEER_CHANNEL] = (uint16_t)(stickMin + phase * (stickMax - stickMin));
+        capture.addSteering(leftStop + phase * (rightStop - leftStop));
+        capture.addSticks(channels);
+    }
+}
+
+int main() {
+    CalibRecord record;
+    const char* reason = "";
+
+    printf("Full sweep\n");
+    resetCalibrationDefaults();
+    record = calibRecord;
+    EndpointCapture capture;
+    capture.begin();
+    sweep(capture, -2.1f, 1.3f, 380, 1790);
+    uint16_t throttleMin = record.sbusMin[1];
+    check(capture.finish(record, &reason), "capture accepted");
+    check(fabsf(record.steeringLeftPos + 2.1f) < 1e-4f && fabsf(record.steeringRightPos - 1.3f) < 1e-4f,
+          "steering endpoints are the measured stops");
+    check(fabsf(record.steeringZero + 0.4f) < 1e-4f, "midpoint between them");
+    check(record.sbusMin[3] == 380 && record.sbusMax[3] == 1790, "steering stick travel");
+    check(record.sbusMin[1] == throttleMin, "untouched channel keeps its travel");
+    check(!capture.active() && !capture.finish(record, &reason) && strcmp(reason, "idle") == 0,
+          "second save without a new capture refused");
+
+    printf("Refused captures\n");
+    CalibRecord before = record;
+    capture.begin();
+    sweep(capture, -0.2f, 0.1f, 380, 1790);
+    check(!capture.finish(record, &reason) && strcmp(reason, "steering") == 0, "wheels barely turned");
+    capture.begin();
+    sweep(capture, -2.1f, 1.3f, 1000, 1230);
+    check(!capture.finish(record, &reason) && strcmp(reason, "stick") == 0, "stick never crossed the centre band");
+    capture.begin();
+    capture.addSteering(NAN);
+    check(!capture.finish(record, &reason), "no readings");
+    check(memcmp(&before, &record, sizeof(record)) == 0, "record untouched by refused captures");
+
+    printf("Cancel\n");
+    capture.begin();
+    capture.cancel();
+    sweep(capture, -2.1f, 1.3f, 380, 1790);
+    check(!capture.finish(record, &reason), "samples after a cancel are ignored");
+
+    return checkSummary();
+}
@@ -0,0 +1,137 @@
+// Host-side decoder for the binary event log frames from drainEventLog()
+// (lib/EVT_EventLog), e.g. saved from the UDP socket or serial port they were
+// sent to. Lines are formatted by the firmware's own formatEventRecord(), so
+// they read exactly like printEventLog() on the Teensy.
+//
+// Build (from tools, one line):
+//   g++ -std=c++17 -O2 -Wall -D__IMXRT1062__ -Ireplay/host -I../lib/EVT_EventLog -I../lib/EVT_StateMachine -I../lib/EVT_ErrorCodes -I../lib/OdriveUART -I../lib/VescUart/src -I../lib/util -o eventlog_decode eventlog_decode.cpp replay/host/HostArduino.cpp ../lib/EVT_EventLog/EVT_EventLog.cpp ../lib/EVT_ErrorCodes/EVT_ErrorCodes.cpp ../lib/EVT_StateMachine/StateNames.cpp
+// Usage:
+//   eventlog_decode events.bin           print one line per record, then a summary
+//   eventlog_decode -                    read the frames from stdin
+//   eventlog_decode --synth events.bin   write a sample stream through logEvent() and drainEventLog()
+//
+// Bytes that are not part of a frame are skipped, so a stream picked up
+// mid-frame or after a reset resyncs on the next one. Sequence gaps mean the
+// ring on the car overflowed before it was drained.
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "Arduino.h"
+#include "EVT_EventLog.h"
+#include "EVT_ErrorCodes.h"
+#include "EVT_StateMachine.h"
+
+class FilePrint : public Print {
+public:
+    explicit FilePrint(FILE* f) : f_(f) {}
+    size_t write(uint8_t b) override { return fwrite(&b, 1, 1, f_); }
+    size_t write(const uint8_t* buffer, size_t size) override { return fwrite(buffer, 1, size, f_); }
+    using Print::write;
+private:
+    FILE* f_;
+};
+
+// A short session: start-up, a parameter change, motor faults, and more
+// reasons than the ring keeps before the next drain.
+static int synth(const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        perror(path);
+        return 1;
+    }
+    FilePrint out(f);
+    hostClockUs = 1000000;
+
+    logEvent(EVT_STATE_CHANGE, LOC_MAIN, NONE, INIT);
+    hostClockUs += 250000;
+    logEvent(EVT_STATE_CHANGE, LOC_MAIN, INIT, IDLE);
+    logEvent(EVT_PARAM, LOC_ETHERNET, 3, 1250);
+    drainEventLog(out, 16);
+
+    out.write((const uint8_t*)"\r\nboot\r\n", 8);   // Noise between frames.
+
+    hostClockUs += 1000000;
+    logEvent(EVT_STATE_CHANGE, LOC_MAIN, IDLE, RC);
+    logEvent(EVT_VESC_FAULT, LOC_VESC, 1, FAULT_CODE_OVER_TEMP_FET);
+    logEvent(EVT_ODRIVE_ERROR, LOC_ODRIVE, ODRIVE_ERROR_DC_BUS_UNDER_VOLTAGE | ODRIVE_ERROR_CURRENT_LIMIT_VIOLATION);
+    char reason[32];
+    for (int i = 0; i < 10; i++) {
+        hostClockUs += 1000;
+        snprintf(reason, sizeof(reason), "VESC2 fault %d", i);
+        logEvent(EVT_FAULT, LOC_VESC, 0, storeEventReason(reason));
+    }
+    logEvent(EVT_ERROR, LOC_ODRIVE, RC, storeEventReason("Axis disarmed"));
+    drainEventLog(out, 32);
+
+    fclose(f);
+    printf("wrote %s\n", path);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 3 && strcmp(argv[1], "--synth") == 0) return synth(argv[2]);
+    if (argc != 2) {
+        fprintf(stderr, "usage: eventlog_decode events.bin | -\n"
+                        "       eventlog_decode --synth events.bin\n");
+        return 2;
+    }
+
+    FILE* in = strcmp(argv[1], "-") == 0 ? stdin : fopen(argv[1], "rb");
+    if (!in) {
+        perror(argv[1]);
+        return 1;
+    }
+    std::vector<uint8_t> data;
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), in)) > 0) data.insert(data.end(), buf, buf + n);
+    if (in != stdin) fclose(in);
+
+    size_t records = 0, skipped = 0, reasonsLost = 0, gaps = 0, missing = 0;
+    bool haveSequence = false;
+    uint16_t nextSequence = 0;
+    char line[160];
+    size_t i = 0;
+    while (i < data.size()) {
+        if (data[i] != EVENT_FRAME_SYNC || i + 1 >= data.size() || data[i + 1] != EVENT_FRAME_RECORD ||
+            i + 2 + sizeof(EventRecord) > data.size()) {
+            // Reason frames are consumed with their record; a stray one is skipped as well.
+            skipped++;
+            i++;
+            continue;
+        }
+        EventRecord rec;
+        memcpy(&rec, &data[i + 2], sizeof(rec));
+        i += 2 + sizeof(rec);
+
+        char reason[EVENT_REASON_LEN];
+        const char* reasonText = nullptr;
+        if (i + 3 <= data.size() && data[i] == EVENT_FRAME_SYNC && data[i + 1] == EVENT_FRAME_REASON &&
+            data[i + 2] < EVENT_REASON_LEN && i + 3 + data[i + 2] <= data.size()) {
+            uint8_t length = data[i + 2];
+            memcpy(reason, &data[i + 3], length);
+            reason[length] = '\0';
+            i += 3 + length;
+            if (length > 0) reasonText = reason;
+            else reasonsLost++;
+        }
+
+        if (haveSequence && rec.sequence != nextSequence) {
+            uint16_t lost = (uint16_t)(rec.sequence - nextSequence);
+            printf("[event log] %u records dropped\n", lost);
+            gaps++;
+            missing += lost;
+        }
+        haveSequence = true;
+        nextSequence = rec.sequence + 1;
+
+        formatEventRecord(rec, reasonText, line, sizeof(line));
+        printf("%s\n", line);
+        records++;
+    }
+
+    printf("%zu records, %zu sequence gaps (%zu missing), %zu reasons overwritten, %zu bytes skipped\n",
+           records, gaps, missing, reasonsLost, skipped);
+    return 0;
+}
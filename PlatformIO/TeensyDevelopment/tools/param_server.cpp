@@ -0,0 +1,218 @@
+// Host run of the runtime parameter server (lib/EVT_Params/ParamRegistry.h,
+// the same code the firmware runs) against a file-backed store. A simulated
+// loop applies staged values at the top of each tick, runs a throttle pipeline
+// off the registered config and then handles the requests of that tick, the
+// order serviceUdpLink() and applyParams() give on the car.
+//
+// Build (from tools, one line):
+//   g++ -std=c++17 -O2 -Wall -I../lib/EVT_Params -I../lib/EVT_CalibStore -I../lib/EVT_Throttle -I../lib/EVT_Ethernet -I../lib/EVT_AutoMode -I../lib/util -o param_server param_server.cpp ../lib/EVT_CalibStore/EVT_CalibStore.cpp
+// Usage:
+//   param_server [store_file]
+//
+// Checks get/set/list replies, range and format rejection, refusal of values
+// that are each in range but leave the throttle no travel, that a multi-value
+// PSET never shows up half applied in a tick, that a long PSET survives the
+// UDP receive ring whole or is refused, that a save survives a reboot and that
+// a corrupted store falls back to the defaults. Exits 1 if any check failed.
+
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <string>
+#include "ParamRegistry.h"
+#include "ThrottlePipeline.h"
+#include "UdpRxRing.h"
+#include "checks.h"
+
+static const uint32_t STORE_ADDR = 256;   // PARAM_EEPROM_ADDR
+static const float MIN_SPAN = 200.0f;      // RC_THROTTLE_MIN_SPAN
+
+// Mirrors of a few firmware ids (EVT_Params.h needs Arduino.h).
+enum {
+    NEUTRAL = 1,       // PARAM_RC_THROTTLE_NEUTRAL
+    FORWARD_FULL = 2,  // PARAM_RC_THROTTLE_FORWARD_FULL
+    DEADBAND = 4,      // PARAM_RC_THROTTLE_DEADBAND
+    MAX_RPM = 8,       // PARAM_RC_THROTTLE_MAX_RPM
+    AUTO_SWITCH = 60,  // PARAM_RC_AUTO_SWITCH
+    LEFT_POS = 80      // PARAM_STEER_LEFT_POS, kept in the calibration record
+};
+
+// What one boot of the firmware registers, trimmed to a few parameters.
+struct Firmware {
+    ThrottleConfig config = THROTTLE_RC_CONFIG;
+    ThrottlePipeline pipeline{THROTTLE_RC_CONFIG};
+    int32_t autoSwitch = 1000;
+    float leftPos = -2.33f;
+    ParamRegistry registry;
+    int hookCalls = 0;
+    int calibSaves = 0;
+
+    static Firmware* current;
+    static void onApply() {
+        current->pipeline.setConfig(current->config);
+        current->hookCalls++;
+    }
+    // As checkThrottleParams(); reverse stays at its default here.
+    static bool checkSpans(const ParamRegistry& registry) {
+        ThrottleConfig next = current->config;
+        next.neutral = registry.next(&current->config.neutral);
+        next.forwardFull = registry.next(&current->config.forwardFull);
+        next.deadband = registry.next(&current->config.deadband);
+        return throttleSpan(next, true) >= MIN_SPAN && throttleSpan(next, false) >= MIN_SPAN;
+    }
+    static bool saveCalibration() {
+        current->calibSaves++;
+        return true;
+    }
+
+    Firmware() {
+        current = this;
+        registry.add(NEUTRAL, "rc_throttle.neutral", &config.neutral, 800.0f, 1200.0f, onApply);
+        registry.add(FORWARD_FULL, "rc_throttle.forward_full", &config.forwardFull, 1300.0f, 1811.0f, onApply);
+        registry.add(DEADBAND, "rc_throttle.deadband", &config.deadband, 0.0f, 100.0f, onApply);
+        registry.add(MAX_RPM, "rc_throttle.max_rpm", &config.maxRpm, 0.0f, 10000.0f, onApply);
+        registry.add(AUTO_SWITCH, "rc.auto_switch", &autoSwitch, 400, 1600);
+        registry.add(LEFT_POS, "steer.left_pos", &leftPos, -5.0f, -0.1f, NULL, false);
+        registry.addCheck(checkSpans);
+        registry.setSaveHook(saveCalibration);
+    }
+};
+Firmware* Firmware::current = nullptr;
+
+static std::string request(Firmware& fw, CalibStorage& store, const char* text) {
+    char reply[1472];
+    int length = fw.registry.handle(text, strlen(text), false, reply, sizeof(reply), &store, STORE_ADDR);
+    return length < 0 ? std::string("<not a parameter message>") : std::string(reply, length);
+}
+
+// Hands queued datagrams to drainDatagrams() the way a socket would, cut to
+// the caller's buffer.
+class QueueTransport : public DatagramTransport {
+public:
+    std::deque<std::string> pending;
+    bool begin(const DatagramConfig&) override { return true; }
+    int receive(char* buffer, size_t size) override {
+        if (pending.empty()) return -1;
+        size_t length = pending.front().size() < size ? pending.front().size() : size;
+        memcpy(buffer, pending.front().data(), length);
+        pending.pop_front();
+        return (int)length;
+    }
+    bool send(const uint8_t*, size_t) override { return true; }
+};
+
+// One datagram through the receive ring and into the registry, as
+// onRxDatagram() passes it on the car.
+static std::string requestOverUdp(Firmware& fw, CalibStorage& store, const std::string& text) {
+    QueueTransport link;
+    UdpRxRing ring;
+    link.pending.push_back(text);
+    ring.clear();
+    drainDatagrams(link, ring, 0);
+    const UdpDatagram& d = ring.at(ring.size() - 1);
+    char reply[1472];
+    int length = fw.registry.handle(d.data, d.length, d.truncated, reply, sizeof(reply), &store, STORE_ADDR);
+    return length < 0 ? std::string("<not a parameter message>") : std::string(reply, length);
+}
+
+int main(int argc, char** argv) {
+    const char* path = argc > 1 ? argv[1] : "param_store.bin";
+    remove(path);
+    FileCalibStorage store(path);
+
+    printf("First boot, empty store\n");
+    Firmware fw;
+    check(fw.registry.load(store, STORE_ADDR) < 0, "no record, defaults kept");
+    check(request(fw, store, "PGET,4") == "PVAL,4,rc_throttle.deadband,f,20,0,100,20", "PGET");
+    check(request(fw, store, "PGET,99") == "PERR,99,unknown", "unknown id");
+    check(request(fw, store, "PSET,4,150") == "PERR,4,range", "out of range");
+    check(request(fw, store, "PSET,60,10.5") == "PERR,60,format", "float into an int parameter");
+    check(request(fw, store, "PSET,4,nan") == "PERR,4,range", "NaN");
+    check(request(fw, store, "PSET,4,30,8,99999") == "PERR,8,range" && fw.registry.apply() == 0,
+          "one bad pair stages nothing");
+    check(request(fw, store, "SYNCR,1,2,3,4") == "<not a parameter message>", "other tagged messages passed on");
+
+    std::string list = request(fw, store, "PLIST,0");
+    int lines = 0;
+    for (char c : list) lines += c == '\n';
+    check(list.compare(0, 10, "PLIST,0,6\n") == 0 && lines == 6, "PLIST returns every parameter");
+
+    // Neutral and deadband move together; a tick must see both old or both new.
+    printf("Atomic apply across ticks\n");
+    bool torn = false;
+    int appliedTick = -1;
+    for (int tick = 0; tick < 10; tick++) {
+        if (fw.registry.apply() > 0) appliedTick = tick;
+        bool oldPair = fw.config.neutral == 990.0f && fw.config.deadband == 20.0f;
+        bool newPair = fw.config.neutral == 1000.0f && fw.config.deadband == 40.0f;
+        torn |= !oldPair && !newPair;
+        if (tick == 3) request(fw, store, "PSET,1,1000,4,40");
+    }
+    check(!torn, "no tick saw half the change");
+    check(appliedTick == 4, "applied at the next tick boundary");
+    check(fw.hookCalls == 1, "hook ran once for two parameters");
+    check(fw.pipeline.normalize(1030.0f) == 0.0f && fw.pipeline.normalize(1041.0f) > 0.0f,
+          "pipeline uses the new deadband");
+
+    // Each value in range, together leaving no forward travel past the deadband.
+    printf("Checks across parameters\n");
+    check(request(fw, store, "PSET,1,1200,2,1300,4,100") == "PERR,0,conflict" && fw.registry.apply() == 0,
+          "zero-width span refused, nothing staged");
+    check(request(fw, store, "PSET,2,1300") == "POK,1" && fw.registry.apply() == 1, "260 counts of travel accepted");
+    check(request(fw, store, "PSET,1,1100") == "PERR,0,conflict", "neutral moved into the forward span");
+    check(request(fw, store, "PSET,4,100") == "POK,1" && request(fw, store, "PSET,1,1050") == "PERR,0,conflict",
+          "checked against a value staged but not yet applied");
+    check(request(fw, store, "PSET,1,1000,4,40,2,1700") == "POK,3" && fw.registry.apply() == 3 &&
+          fw.config.forwardFull == 1700.0f && fw.config.deadband == 40.0f, "back to the defaults");
+    ThrottleConfig narrow = THROTTLE_RC_CONFIG;
+    narrow.neutral = 1200.0f;
+    narrow.forwardFull = 1300.0f;
+    narrow.deadband = 100.0f;
+    ThrottlePipeline unchecked(narrow);
+    check(unchecked.normalize(1301.0f) == 0.0f, "an unchecked zero-width span normalizes to 0");
+
+    // Longer than the 128 bytes the ring used to keep; the last pair sits past that.
+    printf("Long PSET over UDP\n");
+    std::string longSet = "PSET";
+    for (int i = 0; i < 9; i++) longSet += ",1,1000.000000000";
+    longSet += ",8,7500";
+    check(longSet.size() > 128, "request is longer than 128 bytes");
+    check(requestOverUdp(fw, store, longSet) == "POK,10" && fw.registry.apply() == 2 && fw.config.maxRpm == 7500.0f,
+          "every pair arrives and is applied");
+    std::string tooLong = "PSET";
+    while (tooLong.size() <= UDP_RX_DATAGRAM_MAX) tooLong += ",8,6000";
+    check(requestOverUdp(fw, store, tooLong) == "PERR,0,format" && fw.registry.apply() == 0 &&
+          fw.config.maxRpm == 7500.0f, "longer than the ring slot, refused whole");
+
+    printf("Change hook\n");
+    static uint8_t loggedType = 0xFF;
+    static int32_t loggedValue = 0;
+    request(fw, store, "PSET,60,1200");
+    fw.registry.apply([](uint16_t, uint8_t type, ParamValue value) {
+        loggedType = type;
+        loggedValue = value.i;
+    });
+    check(loggedType == PARAM_INT && loggedValue == 1200, "told the type with the value");
+    fw.registry.setSaveAllowed(false);
+    check(request(fw, store, "PSAVE") == "PERR,0,busy", "save refused while driving");
+    fw.registry.setSaveAllowed(true);
+    check(request(fw, store, "PSAVE") == "POK,5" && fw.calibSaves == 1, "save, endpoint left to the calibration record");
+
+    printf("Second boot\n");
+    Firmware fw2;
+    check(fw2.registry.load(store, STORE_ADDR) == 5, "all five restored");
+    check(fw2.config.deadband == 40.0f && fw2.autoSwitch == 1200 && fw2.config.maxRpm == 7500.0f, "values restored");
+    check(fw2.pipeline.normalize(1030.0f) == 0.0f, "restored values reach the pipeline");
+    check(request(fw2, store, "PGET,4") == "PVAL,4,rc_throttle.deadband,f,40,0,100,20", "default still the compiled one");
+    check(request(fw2, store, "PDEFAULTS") == "POK,6" && fw2.registry.apply() == 6 && fw2.config.deadband == 20.0f,
+          "PDEFAULTS");
+
+    printf("Corrupted store\n");
+    uint8_t junk = 0x5A;
+    store.write(STORE_ADDR + sizeof(ParamRecordHeader) + 5, &junk, 1);
+    Firmware fw3;
+    check(fw3.registry.load(store, STORE_ADDR) < 0 && fw3.config.deadband == 20.0f, "CRC mismatch, defaults kept");
+
+    remove(path);
+    return checkSummary();
+}
@@ -0,0 +1,123 @@
+// Host benchmark: PidBank<N> against N separate controllers, at N = 4, 16, 64.
+//
+// Build:  g++ -std=c++17 -O3 -fno-trapping-math -I../lib/EVT_PID -I../lib/util -o pid_bank_bench pid_bank_bench.cpp
+//         (-fno-trapping-math lets GCC if-convert the float compares; without it
+//         the bank loop is left scalar. Check with -fopt-info-vec.)
+// Usage:  pid_bank_bench [ticks]
+//
+// "AutoPID xN" mimics the current layout: each controller owns pointers to
+// double inputs allocated separately on the heap. "PidController xN" is the
+// same control law as the bank, one object per loop. The bank outputs are
+// checked against PidController so the speedup is not from doing less work.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+#include "EVT_PID.h"
+#include "PidBank.h"
+
+static const float DT = 0.001f;
+
+struct LegacyPid {
+    double *input, *setpoint, *output;
+    double kp, ki, kd, outMin, outMax;
+    double integral = 0.0, previousError = 0.0;
+
+    void run(unsigned long dT) {
+        double error = *setpoint - *input;
+        integral += (error + previousError) / 2 * dT / 1000.0;
+        double dError = (error - previousError) / dT / 1000.0;
+        previousError = error;
+        double pid = kp * error + ki * integral + kd * dError;
+        *output = pid < outMin ? outMin : (pid > outMax ? outMax : pid);
+    }
+};
+
+static double nsPerTick(std::chrono::steady_clock::time_point start, long ticks) {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    return (double)ns / ticks;
+}
+
+static float setpointFor(int i, long t) { return ((t / 500 + i) % 2 ? 1.0f : -1.0f) * (1.0f + 0.1f * i); }
+
+template <int N>
+static void benchN(long ticks) {
+    // Plants: y += (u - y) * rate, one per loop.
+    float rate[N];
+    for (int i = 0; i < N; i++) rate[i] = 0.005f + 0.0005f * i;
+
+    // --- N AutoPID-style objects with scattered inputs ---
+    std::vector<std::unique_ptr<double>> storage;
+    std::vector<std::unique_ptr<LegacyPid>> legacy;
+    for (int i = 0; i < N; i++) {
+        double* in = new double(0.0);
+        double* sp = new double(0.0);
+        double* out = new double(0.0);
+        storage.emplace_back(in);
+        storage.emplace_back(sp);
+        storage.emplace_back(out);
+        legacy.emplace_back(new LegacyPid{in, sp, out, 2.0, 0.5, 0.01, -10.0, 10.0});
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (long t = 0; t < ticks; t++) {
+        for (int i = 0; i < N; i++) {
+            LegacyPid& pid = *legacy[i];
+            *pid.setpoint = setpointFor(i, t);
+            pid.run(1);
+            *pid.input += (*pid.output - *pid.input) * rate[i];
+        }
+    }
+    double legacyNs = nsPerTick(start, ticks);
+
+    // --- N PidController<float> objects ---
+    std::vector<PidController<float>> single;
+    for (int i = 0; i < N; i++) {
+        single.emplace_back(2.0f, 0.5f, 0.01f, -10.0f, 10.0f);
+        single.back().setDerivativeFilter(0.005f);
+        single.back().setSetpointWeight(0.8f);
+    }
+    float ySingle[N] = {};
+    start = std::chrono::steady_clock::now();
+    for (long t = 0; t < ticks; t++) {
+        for (int i = 0; i < N; i++) {
+            float u = single[i].step(setpointFor(i, t), ySingle[i], DT);
+            ySingle[i] += (u - ySingle[i]) * rate[i];
+        }
+    }
+    double singleNs = nsPerTick(start, ticks);
+
+    // --- One PidBank<N> ---
+    PidBank<N> bank;
+    for (int i = 0; i < N; i++) {
+        bank.configure(i, 2.0f, 0.5f, 0.01f, -10.0f, 10.0f);
+        bank.setDerivativeFilter(i, 0.005f);
+        bank.setSetpointWeight(i, 0.8f);
+    }
+    float yBank[N] = {};
+    float sp[N];
+    start = std::chrono::steady_clock::now();
+    for (long t = 0; t < ticks; t++) {
+        for (int i = 0; i < N; i++) sp[i] = setpointFor(i, t);
+        bank.update(sp, yBank, DT);
+        for (int i = 0; i < N; i++) yBank[i] += (bank.output[i] - yBank[i]) * rate[i];
+    }
+    double bankNs = nsPerTick(start, ticks);
+
+    float maxDiff = 0.0f;
+    for (int i = 0; i < N; i++) maxDiff = fmaxf(maxDiff, fabsf(yBank[i] - ySingle[i]));
+
+    printf("N=%-3d  AutoPID x%-3d %8.1f ns/tick   PidController x%-3d %8.1f ns/tick   PidBank %8.1f ns/tick"
+           "   (%.1fx vs AutoPID, %.1fx vs PidController, max |dy| %.2g)\n",
+           N, N, legacyNs, N, singleNs, bankNs, legacyNs / bankNs, singleNs / bankNs, maxDiff);
+}
+
+int main(int argc, char** argv) {
+    long ticks = argc > 1 ? atol(argv[1]) : 200000;
+    benchN<4>(ticks);
+    benchN<16>(ticks);
+    benchN<64>(ticks);
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Host benchmark for EVT_PID against the AutoPID update math.
+//
+// Build:  g++ -std=c++17 -O2 -I../lib/EVT_PID -I../lib/util -o pid_bench pid_bench.cpp
+// Usage:  pid_bench [iterations]
+//
+// A desktop FPU runs double as fast as float, so the host numbers only compare
+// algorithm cost. For Cortex-M7 numbers (single precision FPU only, double in
+// software) run LearningExamples/PidBench.cpp on the Teensy, which reports
+// ARM_DWT_CYCCNT cycles for the same three variants.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "EVT_PID.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint64_t cycles() { return __rdtsc(); }
+static const char* CYCLE_UNIT = "tsc";
+#else
+static inline uint64_t cycles() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+static const char* CYCLE_UNIT = "ns";
+#endif
+
+// AutoPID::run() body with the millis() gate removed: double math, trapezoid
+// integral, unclamped integrator.
+struct LegacyPid {
+    double kp, ki, kd, outMin, outMax;
+    double integral = 0.0, previousError = 0.0;
+
+    double update(double setpoint, double input, unsigned long dT) {
+        double error = setpoint - input;
+        integral += (error + previousError) / 2 * dT / 1000.0;
+        double dError = (error - previousError) / dT / 1000.0;
+        previousError = error;
+        double pid = kp * error + ki * integral + kd * dError;
+        return pid < outMin ? outMin : (pid > outMax ? outMax : pid);
+    }
+};
+
+// First-order plant so the controllers see realistic, changing inputs.
+template <typename F>
+static double run(const char* name, long iterations, F&& update) {
+    float y = 0.0f;
+    float sink = 0.0f;
+    uint64_t start = cycles();
+    for (long i = 0; i < iterations; i++) {
+        float setpoint = (i / 2000) % 2 ? 1.0f : -1.0f;
+        float u = update(setpoint, y);
+        y += (u - y) * 0.01f;
+        sink += u;
+    }
+    uint64_t elapsed = cycles() - start;
+    double perUpdate = (double)elapsed / iterations;
+    volatile float keep = sink;  // stop the loop being optimised away
+    (void)keep;
+    printf("%-22s %8.2f %s/update\n", name, perUpdate, CYCLE_UNIT);
+    return perUpdate;
+}
+
+int main(int argc, char** argv) {
+    long iterations = argc > 1 ? atol(argv[1]) : 2000000;
+
+    LegacyPid legacy = {2.0, 0.5, 0.01, -10.0, 10.0};
+    run("AutoPID (double)", iterations, [&](float sp, float y) {
+        return (float)legacy.update(sp, y, 1);
+    });
+
+    PidController<float> pidF(2.0f, 0.5f, 0.01f, -10.0f, 10.0f);
+    pidF.setDerivativeFilter(0.005f);
+    pidF.setSetpointWeight(0.8f);
+    run("PidController<float>", iterations, [&](float sp, float y) {
+        return pidF.step(sp, y, 0.001f);
+    });
+
+    PidController<util::q16> pidQ(2.0f, 0.5f, 0.01f, -10.0f, 10.0f);
+    pidQ.setDerivativeFilter(0.005f);
+    pidQ.setSetpointWeight(0.8f);
+    const util::q16 dtQ = pidSeconds(1000, util::q16());
+    run("PidController<q16>", iterations, [&](float sp, float y) {
+        return pidQ.step(sp, y, dtQ).toFloat();
+    });
+    return 0;
+}
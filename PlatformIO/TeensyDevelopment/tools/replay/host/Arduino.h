@@ -0,0 +1,182 @@
+// Minimal Arduino core for running the firmware's protocol parsers on a host.
+//
+// Only what SBUS, VescUart and ODriveUART touch is here. Time is virtual: the
+// replay engine moves it to each record's capture timestamp, and polling an
+// empty serial port moves it forward a little so the libraries' busy-wait
+// timeouts still expire.
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <deque>
+#include <string>
+
+typedef uint8_t byte;
+
+#define DEC 10
+#define HEX 16
+
+#define SERIAL_8N1              0
+#define SERIAL_8E2              1
+#define SERIAL_8E2_RXINV_TXINV  2
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+#define PROGMEM
+
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+// ---- Virtual clock ----------------------------------------------------------
+
+extern uint64_t hostClockUs;
+static const uint32_t HOST_IDLE_POLL_US = 10;   // Cost of one poll on an empty port.
+
+inline uint32_t micros() { return (uint32_t)hostClockUs; }
+inline uint32_t millis() { return (uint32_t)(hostClockUs / 1000); }
+inline void delay(uint32_t ms) { hostClockUs += (uint64_t)ms * 1000; }
+inline void delayMicroseconds(uint32_t us) { hostClockUs += us; }
+
+// ---- String ----------------------------------------------------------------
+
+class String {
+public:
+    String(const char* s = "") : s_(s ? s : "") {}
+    String(const __FlashStringHelper* s) : s_(reinterpret_cast<const char*>(s)) {}
+    String(const std::string& s) : s_(s) {}
+    explicit String(char c) : s_(1, c) {}
+    String(int v) : s_(std::to_string(v)) {}
+    String(unsigned v) : s_(std::to_string(v)) {}
+    String(long v) : s_(std::to_string(v)) {}
+    String(unsigned long v) : s_(std::to_string(v)) {}
+    String(float v, int decimals = 2) { format(v, decimals); }
+    String(double v, int decimals = 2) { format(v, decimals); }
+
+    const char* c_str() const { return s_.c_str(); }
+    unsigned length() const { return (unsigned)s_.size(); }
+    long toInt() const { return atol(s_.c_str()); }
+    float toFloat() const { return (float)atof(s_.c_str()); }
+    int indexOf(char c) const {
+        size_t p = s_.find(c);
+        return p == std::string::npos ? -1 : (int)p;
+    }
+    String substring(unsigned from) const { return from < s_.size() ? String(s_.substr(from)) : String(); }
+    String substring(unsigned from, unsigned to) const {
+        return from < s_.size() && to > from ? String(s_.substr(from, to - from)) : String();
+    }
+
+    String& operator+=(const String& o) { s_ += o.s_; return *this; }
+    String& operator+=(const char* o) { s_ += o; return *this; }
+    String& operator+=(char c) { s_ += c; return *this; }
+    bool operator==(const String& o) const { return s_ == o.s_; }
+    bool operator!=(const String& o) const { return s_ != o.s_; }
+    friend String operator+(const String& a, const String& b) { return String(a.s_ + b.s_); }
+
+private:
+    void format(double v, int decimals) {
+        char buf[48];
+        snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+        s_ = buf;
+    }
+    std::string s_;
+};
+
+// ---- Print / Stream --------------------------------------------------------
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t b) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        for (size_t i = 0; i < size; i++) write(buffer[i]);
+        return size;
+    }
+    size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    virtual int availableForWrite() { return 64; }
+    virtual void flush() {}
+
+    size_t print(const char* s) { return write(s); }
+    size_t print(const __FlashStringHelper* s) { return write(reinterpret_cast<const char*>(s)); }
+    size_t print(const String& s) { return write(s.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v, int base = DEC) { return print((long)v, base); }
+    size_t print(unsigned v, int base = DEC) { return print((unsigned long)v, base); }
+    size_t print(long v, int base = DEC) {
+        if (base == DEC) return printf("%ld", v);
+        return print((unsigned long)v, base);
+    }
+    size_t print(unsigned long v, int base = DEC) { return printf(base == HEX ? "%lX" : "%lu", v); }
+    size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+
+    size_t println() { return write("\r\n"); }
+    template <class T> size_t println(T v) { return print(v) + println(); }
+    template <class T> size_t println(T v, int format) { return print(v, format) + println(); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
+
+/**
+ * Serial port fed by the replay engine.
+ *
+ * feed() makes bytes readable at once. hold() keeps them back until the code
+ * under test finishes writing a line, which is how request/reply protocols
+ * (the ODrive ASCII one) see their reply only after they asked for it.
+ */
+class HardwareSerial : public Stream {
+public:
+    void begin(uint32_t baud, uint32_t format = SERIAL_8N1) { (void)baud; (void)format; }
+    operator bool() const { return true; }
+
+    int available() override {
+        if (rx_.empty()) {
+            hostClockUs += HOST_IDLE_POLL_US;
+            return 0;
+        }
+        return (int)rx_.size();
+    }
+    int read() override {
+        if (rx_.empty()) return -1;
+        uint8_t b = rx_.front();
+        rx_.pop_front();
+        return b;
+    }
+    int peek() override { return rx_.empty() ? -1 : rx_.front(); }
+    size_t write(uint8_t b) override {
+        tx_ += (char)b;
+        if (b == '\n' && !held_.empty()) {
+            rx_.insert(rx_.end(), held_.begin(), held_.end());
+            held_.clear();
+        }
+        return 1;
+    }
+    using Print::write;
+
+    void feed(const uint8_t* data, size_t length) { rx_.insert(rx_.end(), data, data + length); }
+    void hold(const uint8_t* data, size_t length) { held_.insert(held_.end(), data, data + length); }
+    void release() { rx_.insert(rx_.end(), held_.begin(), held_.end()); held_.clear(); }
+    size_t pending() const { return rx_.size() + held_.size(); }
+    void discard() { rx_.clear(); held_.clear(); }
+    std::string takeWritten() { std::string out; out.swap(tx_); return out; }
+
+private:
+    std::deque<uint8_t> rx_;
+    std::deque<uint8_t> held_;
+    std::string tx_;
+};
+
+extern HardwareSerial Serial, Serial1, Serial2, Serial5, Serial6;
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,18 @@
+// Globals behind the host Arduino shim.
+
+#include "Arduino.h"
+#include <stdarg.h>
+
+uint64_t hostClockUs = 0;
+
+HardwareSerial Serial, Serial1, Serial2, Serial5, Serial6;
+
+size_t Print::printf(const char* format, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (n < 0) return 0;
+    return write((const uint8_t*)buf, (size_t)n < sizeof(buf) ? (size_t)n : sizeof(buf) - 1);
+}
@@ -0,0 +1,28 @@
+// Host stand-in for the Teensy elapsedMicros / elapsedMillis helpers, on the virtual clock.
+
+#ifndef HOST_ELAPSEDMILLIS_H
+#define HOST_ELAPSEDMILLIS_H
+
+#include "Arduino.h"
+
+class elapsedMicros {
+public:
+    elapsedMicros(uint32_t value = 0) : start_(micros() - value) {}
+    operator uint32_t() const { return micros() - start_; }
+    elapsedMicros& operator=(uint32_t value) { start_ = micros() - value; return *this; }
+
+private:
+    uint32_t start_;
+};
+
+class elapsedMillis {
+public:
+    elapsedMillis(uint32_t value = 0) : start_(millis() - value) {}
+    operator uint32_t() const { return millis() - start_; }
+    elapsedMillis& operator=(uint32_t value) { start_ = millis() - value; return *this; }
+
+private:
+    uint32_t start_;
+};
+
+#endif // HOST_ELAPSEDMILLIS_H
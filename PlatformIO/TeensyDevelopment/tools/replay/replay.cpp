@@ -0,0 +1,599 @@
+// Replays a wire capture written by EVT_Capture through the firmware's own
+// SBUS, VescUart, ODriveUART and autonomous-command parsers, on a host.
+//
+// Build (from tools/replay, one line):
+//   g++ -std=c++17 -O2 -D__IMXRT1062__ -Ihost -I../../lib/SBUS -I../../lib/VescUart/src
+//       -I../../lib/OdriveUART -I../../lib/EVT_Capture -I../../lib/EVT_AutoMode -I../../lib/util
+//       -o replay replay.cpp host/HostArduino.cpp ../../lib/SBUS/SBUS.cpp
+//       ../../lib/VescUart/src/VescUart.cpp ../../lib/VescUart/src/buffer.cpp
+//       ../../lib/VescUart/src/crc.cpp ../../lib/OdriveUART/ODriveUART.cpp
+// Usage:
+//   replay CAP000.BIN                     decode as fast as possible, print summary and parser throughput
+//   replay CAP000.BIN --speed 1           pace to the capture timestamps (2 = double speed, 0 = no pacing)
+//   replay CAP000.BIN --repeat 20         decode 20 times for steadier throughput numbers
+//   replay CAP000.BIN --summary base.txt  also write the decode summary to a file
+//   replay CAP000.BIN --check base.txt    exit 1 if the decode summary differs from a saved one
+//   replay --synth out.BIN [seconds]      write a synthetic capture exercising every port
+//
+// The summary holds counts and CRC digests of everything the parsers decoded,
+// so a saved one is a regression baseline for parser changes. Time in the
+// libraries is virtual (see host/Arduino.h), so timeouts behave as on the car.
+//
+// ODrive requests are matched with the reply bytes that followed them on the
+// wire. Each request line is re-issued through the ODriveUART call that sends
+// it, and the bytes the library writes are compared with the captured line.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Arduino.h"
+#include "SBUS.h"
+#include "VescUart.h"
+#include "buffer.h"
+#include "crc.h"
+#include "ODriveUART.h"
+#include "ControlPacket.h"
+#include "CaptureFormat.h"
+#include "crc32.h"
+
+typedef std::chrono::steady_clock Clock;
+
+struct Record {
+    uint64_t timeUs;        // Unwrapped capture time since the first record.
+    uint8_t  port;
+    uint8_t  direction;
+    std::vector<uint8_t> data;
+};
+
+static const char* const port_names[CAPTURE_PORT_COUNT] = { "vesc1", "sbus", "vesc2", "odrive", "udp" };
+
+// ---- Capture file IO ------------------------------------------------------
+
+static bool loadCapture(const char* path, std::vector<Record>& records) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    CaptureFileHeader file;
+    if (fread(&file, sizeof(file), 1, f) != 1 || file.magic != CAPTURE_MAGIC || file.version != CAPTURE_VERSION) {
+        fprintf(stderr, "%s is not a version %d capture\n", path, CAPTURE_VERSION);
+        fclose(f);
+        return false;
+    }
+
+    int64_t unwrapped = 0, earliest = 0;
+    uint32_t previous = 0;
+    bool first = true;
+    std::vector<uint8_t> header(file.recordHeaderSize);
+    while (fread(header.data(), header.size(), 1, f) == 1) {
+        CaptureRecordHeader h;
+        memcpy(&h, header.data(), sizeof(h));
+        Record r;
+        r.port = h.port;
+        r.direction = h.direction;
+        r.data.resize(h.length);
+        if (h.length && fread(r.data.data(), h.length, 1, f) != 1) {
+            fprintf(stderr, "truncated record at the end of %s\n", path);
+            break;
+        }
+        if (h.port >= CAPTURE_PORT_COUNT) {
+            fprintf(stderr, "skipping record for unknown port %u\n", h.port);
+            continue;
+        }
+        // micros() wraps every 71 minutes; records are close enough together to
+        // unwrap. The delta is signed: a stage sealed late lands after records
+        // of other ports that are newer than it.
+        if (!first) unwrapped += (int32_t)(h.timestampUs - previous);
+        previous = h.timestampUs;
+        first = false;
+        earliest = std::min(earliest, unwrapped);
+        r.timeUs = (uint64_t)unwrapped;
+        records.push_back(std::move(r));
+    }
+    fclose(f);
+
+    // Back into time order; each port's own records are already in order.
+    for (Record& r : records) r.timeUs -= (uint64_t)earliest;
+    std::stable_sort(records.begin(), records.end(),
+                     [](const Record& a, const Record& b) { return a.timeUs < b.timeUs; });
+    return true;
+}
+
+static bool writeCapture(const char* path, const std::vector<Record>& records) {
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "cannot create %s\n", path);
+        return false;
+    }
+    CaptureFileHeader file = { CAPTURE_MAGIC, CAPTURE_VERSION, sizeof(CaptureRecordHeader), 0, 0 };
+    fwrite(&file, sizeof(file), 1, f);
+    for (const Record& r : records) {
+        CaptureRecordHeader h = { (uint32_t)r.timeUs, r.port, r.direction, (uint16_t)r.data.size() };
+        fwrite(&h, sizeof(h), 1, f);
+        fwrite(r.data.data(), r.data.size(), 1, f);
+    }
+    fclose(f);
+    return true;
+}
+
+// ---- Decode ---------------------------------------------------------------
+
+struct Summary {
+    std::map<std::string, uint64_t> counts;
+    std::map<std::string, uint32_t> digests;
+
+    void count(const std::string& key, uint64_t n = 1) { counts[key] += n; }
+    template <class T> void digest(const std::string& key, const T& value) {
+        digests[key] = util::crc32((const uint8_t*)&value, sizeof(value), digests[key]);
+    }
+    void digestBytes(const std::string& key, const char* data, size_t length) {
+        digests[key] = util::crc32((const uint8_t*)data, length, digests[key]);
+    }
+};
+
+struct ParserTiming {
+    uint64_t bytes = 0;
+    uint64_t frames = 0;
+    double seconds = 0.0;
+};
+
+class Replayer {
+public:
+    Replayer() {
+        sbus_.begin();
+        vesc_[0].setSerialPort(&Serial1);
+        vesc_[1].setSerialPort(&Serial5);
+        for (HardwareSerial* port : { &Serial1, &Serial2, &Serial5, &Serial6 }) {
+            port->discard();
+            port->takeWritten();
+        }
+    }
+
+    // base offsets the virtual clock; it has to keep rising across passes because
+    // SBUS::parse() keeps its frame timer in a function static.
+    void run(const std::vector<Record>& records, double speed, uint64_t base) {
+        Clock::time_point wallStart = Clock::now();
+        for (size_t i = 0; i < records.size(); i++) {
+            const Record& r = records[i];
+            if (speed > 0.0) {
+                std::this_thread::sleep_until(wallStart + std::chrono::microseconds((uint64_t)(r.timeUs / speed)));
+            }
+            if (hostClockUs < base + r.timeUs) hostClockUs = base + r.timeUs;
+            summary.count(std::string(port_names[r.port]) + (r.direction == CAPTURE_RX ? ".rx_bytes" : ".tx_bytes"), r.data.size());
+
+            switch (r.port) {
+            case CAPTURE_PORT_SERIAL2: if (r.direction == CAPTURE_RX) replaySbus(r); break;
+            case CAPTURE_PORT_SERIAL1: if (r.direction == CAPTURE_RX) replayVesc(0, Serial1, r); break;
+            case CAPTURE_PORT_SERIAL5: if (r.direction == CAPTURE_RX) replayVesc(1, Serial5, r); break;
+            case CAPTURE_PORT_SERIAL6: if (r.direction == CAPTURE_TX) replayOdrive(records, i); break;
+            case CAPTURE_PORT_UDP:     replayUdp(r); break;
+            }
+        }
+    }
+
+    Summary summary;
+    ParserTiming timing[CAPTURE_PORT_COUNT];
+
+private:
+    void replaySbus(const Record& r) {
+        uint16_t channels[10] = {};   // SBUS::read() decodes the first 10.
+        bool failsafe = false, lostFrame = false;
+        Serial2.feed(r.data.data(), r.data.size());
+
+        Clock::time_point start = Clock::now();
+        uint64_t frames = 0;
+        while (sbus_.read(channels, &failsafe, &lostFrame)) {
+            frames++;
+            summary.digest("sbus", channels);
+            if (failsafe) summary.count("sbus.failsafe");
+            if (lostFrame) summary.count("sbus.lost_frame");
+        }
+        addTiming(CAPTURE_PORT_SERIAL2, start, r.data.size(), frames);
+        summary.count("sbus.frames", frames);
+    }
+
+    void replayVesc(int index, HardwareSerial& port, const Record& r) {
+        const std::string name = index == 0 ? "vesc1" : "vesc2";
+        port.feed(r.data.data(), r.data.size());
+
+        Clock::time_point start = Clock::now();
+        uint64_t frames = 0;
+        while (port.pending() > 0) {
+            int id = vesc_[index].pollMessage();
+            if (id < 0) continue;
+            frames++;
+            if (id == COMM_GET_VALUES) {
+                const auto& d = vesc_[index].data;
+                float values[] = { d.rpm, d.inpVoltage, d.avgMotorCurrent, d.avgInputCurrent, d.dutyCycleNow, d.tempMosfet };
+                summary.digest(name, values);
+                summary.digest(name, d.tachometer);
+            }
+        }
+        addTiming((CAPTURE_PORT)r.port, start, r.data.size(), frames);
+        summary.count(name + ".packets", frames);
+    }
+
+    void replayOdrive(const std::vector<Record>& records, size_t index) {
+        odriveLine_.append(records[index].data.begin(), records[index].data.end());
+
+        // Reply bytes are the RX records up to the next request.
+        std::vector<uint8_t> reply;
+        for (size_t i = index + 1; i < records.size(); i++) {
+            const Record& r = records[i];
+            if (r.port != CAPTURE_PORT_SERIAL6) continue;
+            if (r.direction == CAPTURE_TX) break;
+            reply.insert(reply.end(), r.data.begin(), r.data.end());
+        }
+
+        size_t newline;
+        while ((newline = odriveLine_.find('\n')) != std::string::npos) {
+            std::string line = odriveLine_.substr(0, newline + 1);
+            odriveLine_.erase(0, newline + 1);
+            bool last = odriveLine_.find('\n') == std::string::npos;
+            replayOdriveRequest(line, last ? reply : std::vector<uint8_t>());
+        }
+    }
+
+    void replayOdriveRequest(const std::string& captured, const std::vector<uint8_t>& reply) {
+        std::string line = stripLineEnd(captured);
+        char path[128];
+        float a = 0.0f, b = 0.0f, c = 0.0f;
+        bool expectsReply = true;
+
+        Serial6.takeWritten();
+        Serial6.hold(reply.data(), reply.size());
+        Clock::time_point start = Clock::now();
+
+        if (line == "f 0") {
+            ODriveFeedback fb = odrive_.getFeedback();
+            summary.digest("odrive", fb);
+            summary.count("odrive.feedback");
+        } else if (sscanf(line.c_str(), "r %127s", path) == 1) {
+            String value = odrive_.getParameterAsString(path);
+            summary.digestBytes("odrive", value.c_str(), value.length());
+            summary.count("odrive.parameter_reads");
+        } else {
+            expectsReply = false;
+            if (sscanf(line.c_str(), "p 0 %f %f %f", &a, &b, &c) == 3) {
+                odrive_.setPosition(a, b, c);
+            } else if (sscanf(line.c_str(), "v 0 %f %f", &a, &b) == 2) {
+                odrive_.setVelocity(a, b);
+            } else if (sscanf(line.c_str(), "c 0 %f", &a) == 1) {
+                odrive_.setTorque(a);
+            } else if (line == "sc") {
+                odrive_.clearErrors();
+            } else if (sscanf(line.c_str(), "w %127s", path) == 1) {
+                const char* value = line.c_str() + 2 + strlen(path);
+                odrive_.setParameter(path, *value == ' ' ? value + 1 : value);
+            } else {
+                summary.count("odrive.unknown_requests");
+                Serial6.write((const uint8_t*)captured.data(), captured.size());
+            }
+        }
+        addTiming(CAPTURE_PORT_SERIAL6, start, captured.size() + reply.size(), 1);
+        summary.count("odrive.requests");
+
+        // The library has to produce the request exactly as it went out on the car.
+        if (stripLineEnd(Serial6.takeWritten()) != line) {
+            summary.count("odrive.request_mismatch");
+        }
+        if (!expectsReply && !reply.empty()) {
+            // A late reply or noise; it stays queued like it would on the UART.
+            summary.count("odrive.unsolicited_bytes", reply.size());
+            Serial6.release();
+        }
+    }
+
+    void replayUdp(const Record& r) {
+        if (r.direction == CAPTURE_TX) {
+            summary.count("udp.telemetry");
+            return;
+        }
+        // Clock sync replies (ClockSync.h) never reach the control path.
+        if (r.data.size() >= 6 && memcmp(r.data.data(), "SYNCR,", 6) == 0) {
+            summary.count("udp.sync");
+            return;
+        }
+        Clock::time_point start = Clock::now();
+        ControlPacket packet;
+        bool ok = parseControlPacket(std::string(r.data.begin(), r.data.end()), packet);
+        addTiming(CAPTURE_PORT_UDP, start, r.data.size(), ok ? 1 : 0);
+        if (ok) {
+            float values[] = { packet.steering, packet.throttle, packet.emergency ? 1.0f : 0.0f };
+            summary.digest("udp", values);
+            summary.count("udp.commands");
+        } else {
+            summary.count("udp.rejected");
+        }
+    }
+
+    void addTiming(CAPTURE_PORT port, Clock::time_point start, size_t bytes, uint64_t frames) {
+        timing[port].seconds += std::chrono::duration<double>(Clock::now() - start).count();
+        timing[port].bytes += bytes;
+        timing[port].frames += frames;
+    }
+
+    static std::string stripLineEnd(std::string s) {
+        while (!s.empty() && (s.back() == '\n' || s.back() == '\r')) s.pop_back();
+        return s;
+    }
+
+    SBUS sbus_{Serial2};
+    VescUart vesc_[2];
+    ODriveUART odrive_{Serial6};
+    std::string odriveLine_;
+};
+
+// ---- Summary files --------------------------------------------------------
+
+static std::vector<std::string> summaryLines(const Summary& s, size_t records) {
+    std::vector<std::string> lines;
+    char buf[160];
+    snprintf(buf, sizeof(buf), "records %zu", records);
+    lines.push_back(buf);
+    for (const auto& kv : s.counts) {
+        snprintf(buf, sizeof(buf), "%s %llu", kv.first.c_str(), (unsigned long long)kv.second);
+        lines.push_back(buf);
+    }
+    for (const auto& kv : s.digests) {
+        snprintf(buf, sizeof(buf), "%s.digest 0x%08x", kv.first.c_str(), kv.second);
+        lines.push_back(buf);
+    }
+    return lines;
+}
+
+static bool checkSummary(const char* path, const std::vector<std::string>& lines) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    std::map<std::string, std::string> baseline;
+    char buf[160];
+    while (fgets(buf, sizeof(buf), f)) {
+        char key[128], value[32];
+        if (sscanf(buf, "%127s %31s", key, value) == 2) baseline[key] = value;
+    }
+    fclose(f);
+
+    bool same = true;
+    for (const std::string& line : lines) {
+        std::string key = line.substr(0, line.find(' '));
+        std::string value = line.substr(line.find(' ') + 1);
+        auto it = baseline.find(key);
+        if (it == baseline.end()) {
+            printf("CHANGED %s: new, %s\n", key.c_str(), value.c_str());
+            same = false;
+        } else {
+            if (it->second != value) {
+                printf("CHANGED %s: %s -> %s\n", key.c_str(), it->second.c_str(), value.c_str());
+                same = false;
+            }
+            baseline.erase(it);
+        }
+    }
+    for (const auto& kv : baseline) {
+        printf("CHANGED %s: %s -> missing\n", kv.first.c_str(), kv.second.c_str());
+        same = false;
+    }
+    printf(same ? "decode matches %s\n" : "decode differs from %s\n", path);
+    return same;
+}
+
+// ---- Synthetic capture ----------------------------------------------------
+
+static uint32_t rngState = 12345;
+static uint32_t rng() {
+    rngState = rngState * 1664525u + 1013904223u;
+    return rngState >> 8;
+}
+
+// Splits a burst into records the way the tap's staging would, one byte every byteUs.
+// Transmit bursts use byteUs = 0: the tap sees the whole write at once.
+static void addBurst(std::vector<Record>& out, uint64_t t, uint8_t port, uint8_t direction,
+                     const uint8_t* data, size_t length, uint32_t byteUs) {
+    size_t offset = 0;
+    while (offset < length) {
+        size_t n = 1 + rng() % 40;
+        if (n > length - offset) n = length - offset;
+        out.push_back({ t + offset * byteUs, port, direction, std::vector<uint8_t>(data + offset, data + offset + n) });
+        offset += n;
+    }
+}
+
+static void addText(std::vector<Record>& out, uint64_t t, uint8_t port, uint8_t direction, const char* text, uint32_t byteUs) {
+    addBurst(out, t, port, direction, (const uint8_t*)text, strlen(text), byteUs);
+}
+
+static size_t sbusFrame(uint8_t* frame, uint64_t t, bool corrupt) {
+    uint16_t channels[16];
+    for (int i = 0; i < 16; i++) {
+        channels[i] = (uint16_t)(992 + 800 * sin(t * 1e-6 * (0.3 + 0.1 * i)));
+    }
+    memset(frame, 0, 25);
+    frame[0] = 0x0F;
+    for (int i = 0; i < 16 * 11; i++) {
+        if (channels[i / 11] & (1 << (i % 11))) frame[1 + i / 8] |= 1 << (i % 8);
+    }
+    frame[23] = (t / 1000000) % 7 == 6 ? 0x04 : 0x00;   // A lost-frame flag now and then.
+    frame[24] = corrupt ? 0x55 : 0x00;
+    return 25;
+}
+
+static size_t vescFrame(uint8_t* frame, const uint8_t* payload, int length, bool corrupt) {
+    uint16_t crc = crc16((unsigned char*)payload, length);
+    size_t n = 0;
+    frame[n++] = 2;
+    frame[n++] = (uint8_t)length;
+    memcpy(frame + n, payload, length);
+    n += length;
+    frame[n++] = (uint8_t)(crc >> 8);
+    frame[n++] = (uint8_t)(crc & 0xFF) ^ (corrupt ? 0x5A : 0);
+    frame[n++] = 3;
+    return n;
+}
+
+static size_t vescValuesReply(uint8_t* frame, uint64_t t, int wheel, bool corrupt) {
+    uint8_t payload[80];
+    int32_t index = 0;
+    float rpm = 6000.0f * sin(t * 1e-6 * 0.2) + wheel * 150.0f;
+    payload[index++] = COMM_GET_VALUES;
+    buffer_append_float16(payload, 41.5f, 10.0f, &index);               // tempMosfet
+    buffer_append_float16(payload, 38.0f, 10.0f, &index);               // tempMotor
+    buffer_append_float32(payload, rpm / 300.0f, 100.0f, &index);       // avgMotorCurrent
+    buffer_append_float32(payload, rpm / 400.0f, 100.0f, &index);       // avgInputCurrent
+    buffer_append_int32(payload, 0, &index);                            // avg id
+    buffer_append_int32(payload, 0, &index);                            // avg iq
+    buffer_append_float16(payload, rpm / 20000.0f, 1000.0f, &index);    // duty
+    buffer_append_float32(payload, rpm, 1.0f, &index);                  // rpm
+    buffer_append_float16(payload, 48.2f, 10.0f, &index);               // input voltage
+    for (int i = 0; i < 4; i++) buffer_append_float32(payload, 0.0f, 10000.0f, &index);
+    buffer_append_int32(payload, (int32_t)(t / 1000), &index);          // tachometer
+    buffer_append_int32(payload, (int32_t)(t / 1000), &index);          // tachometer abs
+    payload[index++] = 0;                                               // fault
+    buffer_append_float32(payload, 0.0f, 1000000.0f, &index);           // pid pos
+    payload[index++] = (uint8_t)wheel;                                  // controller id
+    return vescFrame(frame, payload, index, corrupt);
+}
+
+static int synthesize(const char* path, double seconds) {
+    static const uint32_t UART_BYTE_US = 87;    // 115200 Bd 8N1
+    static const uint32_t SBUS_BYTE_US = 120;   // 100000 Bd 8E2
+    std::vector<Record> records;
+    uint8_t frame[128];
+    char text[128];
+    uint64_t end = (uint64_t)(seconds * 1e6);
+
+    for (uint64_t t = 0; t < end; t += 1000) {
+        uint64_t ms = t / 1000;
+        if (ms % 7 == 0) {
+            size_t n = sbusFrame(frame, t, rng() % 100 == 0);
+            addBurst(records, t, CAPTURE_PORT_SERIAL2, CAPTURE_RX, frame, n, SBUS_BYTE_US);
+        }
+        if (ms % 10 == 0) {
+            for (int wheel = 0; wheel < 2; wheel++) {
+                uint8_t port = wheel == 0 ? CAPTURE_PORT_SERIAL1 : CAPTURE_PORT_SERIAL5;
+                uint8_t request = COMM_GET_VALUES;
+                size_t n = vescFrame(frame, &request, 1, false);
+                addBurst(records, t + 100, port, CAPTURE_TX, frame, n, 0);
+                n = vescValuesReply(frame, t, wheel, rng() % 200 == 0);
+                addBurst(records, t + 900, port, CAPTURE_RX, frame, n, UART_BYTE_US);
+            }
+        }
+        if (ms % 5 == 0) {
+            snprintf(text, sizeof(text), "p 0 %.4f %.4f %.4f\n", 1.5 * sin(t * 1e-6), 0.25 * cos(t * 1e-6), 0.0);
+            addText(records, t + 200, CAPTURE_PORT_SERIAL6, CAPTURE_TX, text, 0);
+        }
+        if (ms % 20 == 10) {
+            addText(records, t + 300, CAPTURE_PORT_SERIAL6, CAPTURE_TX, "f 0\n", 0);
+            snprintf(text, sizeof(text), "%.4f %.4f\r\n", 1.5 * sin(t * 1e-6), 1.5 * cos(t * 1e-6));
+            addText(records, t + 800, CAPTURE_PORT_SERIAL6, CAPTURE_RX, text, UART_BYTE_US);
+        }
+        if (ms % 100 == 55) {
+            addText(records, t + 300, CAPTURE_PORT_SERIAL6, CAPTURE_TX, "r vbus_voltage\n", 0);
+            snprintf(text, sizeof(text), "%.4f\r\n", 48.0 + (rng() % 100) * 0.01);
+            addText(records, t + 1800, CAPTURE_PORT_SERIAL6, CAPTURE_RX, text, UART_BYTE_US);
+        }
+        if (ms % 20 == 0) {
+            if (rng() % 100 == 0) {
+                snprintf(text, sizeof(text), "garbage");
+            } else {
+                snprintf(text, sizeof(text), "%.3f,%.1f,0", 2.0 * sin(t * 1e-6 * 0.5), 40.0 * sin(t * 1e-6 * 0.1));
+            }
+            records.push_back({ t + 400, CAPTURE_PORT_UDP, CAPTURE_RX, std::vector<uint8_t>(text, text + strlen(text)) });
+            snprintf(text, sizeof(text), "RC,%.2f,48.20,48.10,10.00,1.00,%.2f, 0.00,100", 6000.0 * sin(t * 1e-6 * 0.2), 1.5 * sin(t * 1e-6));
+            records.push_back({ t + 500, CAPTURE_PORT_UDP, CAPTURE_TX, std::vector<uint8_t>(text, text + strlen(text)) });
+        }
+    }
+
+    // Interleave the ports in the order the tap writes them: a datagram is
+    // committed when it arrives, serial bytes when serviceCapture() seals their
+    // stage at the start of the next 1 ms loop. So serial records land after
+    // datagrams up to a loop newer than them, as in a capture from the car.
+    auto written = [](const Record& r) {
+        return r.port == CAPTURE_PORT_UDP ? r.timeUs : (r.timeUs / 1000 + 1) * 1000;
+    };
+    std::stable_sort(records.begin(), records.end(),
+                     [&](const Record& a, const Record& b) { return written(a) < written(b); });
+    if (!writeCapture(path, records)) return 1;
+    printf("wrote %zu records (%.1f s) to %s\n", records.size(), seconds, path);
+    return 0;
+}
+
+// ---- Main -----------------------------------------------------------------
+
+int main(int argc, char** argv) {
+    if (argc >= 3 && strcmp(argv[1], "--synth") == 0) {
+        return synthesize(argv[2], argc >= 4 ? atof(argv[3]) : 10.0);
+    }
+    if (argc < 2) {
+        fprintf(stderr, "usage: replay CAP000.BIN [--speed x] [--repeat n] [--summary out.txt] [--check base.txt]\n"
+                        "       replay --synth out.BIN [seconds]\n");
+        return 2;
+    }
+
+    double speed = 0.0;
+    int repeat = 1;
+    const char* summaryPath = nullptr;
+    const char* checkPath = nullptr;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--speed") == 0) speed = atof(argv[i + 1]);
+        else if (strcmp(argv[i], "--repeat") == 0) repeat = atoi(argv[i + 1]) > 0 ? atoi(argv[i + 1]) : 1;
+        else if (strcmp(argv[i], "--summary") == 0) summaryPath = argv[i + 1];
+        else if (strcmp(argv[i], "--check") == 0) checkPath = argv[i + 1];
+    }
+
+    std::vector<Record> records;
+    if (!loadCapture(argv[1], records)) return 1;
+    if (records.empty()) {
+        fprintf(stderr, "%s holds no records\n", argv[1]);
+        return 1;
+    }
+
+    // Every pass starts from fresh parsers so each produces the same summary.
+    std::vector<std::string> lines;
+    ParserTiming total[CAPTURE_PORT_COUNT];
+    Clock::time_point wallStart = Clock::now();
+    for (int pass = 0; pass < repeat; pass++) {
+        Replayer replayer;
+        replayer.run(records, speed, hostClockUs + 1000000);
+        for (int p = 0; p < CAPTURE_PORT_COUNT; p++) {
+            total[p].bytes += replayer.timing[p].bytes;
+            total[p].frames += replayer.timing[p].frames;
+            total[p].seconds += replayer.timing[p].seconds;
+        }
+        if (pass == 0) lines = summaryLines(replayer.summary, records.size());
+    }
+    double wall = std::chrono::duration<double>(Clock::now() - wallStart).count();
+
+    for (const std::string& line : lines) printf("%s\n", line.c_str());
+    double captured = records.back().timeUs * 1e-6;
+    printf("\n%.2f s of capture replayed %d time(s) in %.3f s wall (%.0fx real time)\n",
+           captured, repeat, wall, wall > 0 ? captured * repeat / wall : 0.0);
+    printf("%-8s %12s %10s %10s %12s\n", "parser", "bytes", "frames", "MB/s", "ns/frame");
+    for (int p = 0; p < CAPTURE_PORT_COUNT; p++) {
+        const ParserTiming& t = total[p];
+        if (t.bytes == 0) continue;
+        printf("%-8s %12llu %10llu %10.1f %12.0f\n", port_names[p], (unsigned long long)t.bytes,
+               (unsigned long long)t.frames, t.seconds > 0 ? t.bytes / t.seconds / 1e6 : 0.0,
+               t.frames ? t.seconds * 1e9 / t.frames : 0.0);
+    }
+
+    if (summaryPath) {
+        FILE* f = fopen(summaryPath, "w");
+        if (!f) {
+            fprintf(stderr, "cannot create %s\n", summaryPath);
+            return 1;
+        }
+        for (const std::string& line : lines) fprintf(f, "%s\n", line.c_str());
+        fclose(f);
+    }
+    if (checkPath && !checkSummary(checkPath, lines)) return 1;
+    return 0;
+}
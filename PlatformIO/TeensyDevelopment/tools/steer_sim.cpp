@@ -0,0 +1,103 @@
+// Host simulation of the steering step response: raw position steps (the old
+// updateOdrvControl behaviour) against the jerk-limited trajectory generator.
+//
+// Build:  g++ -std=c++17 -O2 -I../lib/EVT_SteerTrajectory -o steer_sim steer_sim.cpp
+// Usage:  steer_sim [step_turns] [out.csv]
+//
+// The ODrive is modelled as its cascaded position/velocity loop (0.6 firmware
+// structure) driving a motor coupled to the wheels through a compliant rack,
+// and the response is measured at the wheels. Gains and plant values
+// below are estimates for the steering rack, not measurements; adjust them to
+// match a logged black-box step before trusting absolute numbers. The CSV has
+// one row per ODrive tick and plots directly (t, raw, traj, traj_setpoint).
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include "SteerTrajectory.h"
+
+static const float ODRIVE_DT = 1.0f / 8000.0f;  // ODrive control loop
+static const float TEENSY_DT = STEER_TRAJ_PERIOD_US * 1e-6f;
+static const float SIM_TIME  = 1.5f;
+
+// ODrive controller (axis0.controller.config.*)
+static const float POS_GAIN   = 20.0f;   // (turns/s) / turn
+static const float VEL_GAIN   = 0.16f;   // Nm / (turns/s)
+static const float VEL_I_GAIN = 0.32f;   // Nm / turn
+static const float VEL_LIMIT  = 10.0f;   // turns/s
+static const float TORQUE_LIM = 2.0f;    // Nm
+
+// Plant: motor (where the ODrive encoder sits) coupled to the wheels through a
+// compliant rack. The compliance is what a raw step rings on.
+static const float MOTOR_INERTIA = 0.001f;  // Nm / (turns/s^2)
+static const float LOAD_INERTIA  = 0.004f;  // Nm / (turns/s^2), reflected to the motor
+static const float RACK_STIFF    = 2.0f;    // Nm / turn
+static const float RACK_DAMP     = 0.02f;   // Nm / (turns/s)
+static const float FRICTION      = 0.01f;   // Nm / (turns/s), on the load
+static const float INERTIA       = MOTOR_INERTIA + LOAD_INERTIA;
+
+struct Axis {
+    float pos = 0.0f, vel = 0.0f, integrator = 0.0f;  // motor side
+    float loadPos = 0.0f, loadVel = 0.0f;
+
+    void step(float posSp, float velFf, float torqueFf) {
+        float velCmd = POS_GAIN * (posSp - pos) + velFf;
+        velCmd = fmaxf(-VEL_LIMIT, fminf(VEL_LIMIT, velCmd));
+        float velErr = velCmd - vel;
+        float torque = VEL_GAIN * velErr + integrator + torqueFf;
+        if (fabsf(torque) > TORQUE_LIM) {
+            torque = copysignf(TORQUE_LIM, torque);  // integrator frozen while saturated
+        } else {
+            integrator += VEL_I_GAIN * velErr * ODRIVE_DT;
+        }
+        float spring = RACK_STIFF * (pos - loadPos) + RACK_DAMP * (vel - loadVel);
+        vel += (torque - spring) / MOTOR_INERTIA * ODRIVE_DT;
+        loadVel += (spring - FRICTION * loadVel) / LOAD_INERTIA * ODRIVE_DT;
+        pos += vel * ODRIVE_DT;
+        loadPos += loadVel * ODRIVE_DT;
+    }
+};
+
+struct Metrics {
+    float overshoot = 0.0f;   // turns past the target
+    float settleTime = -1.0f; // last time the response left the 2% band
+};
+
+static void track(Metrics& m, float t, float pos, float target, float step) {
+    m.overshoot = fmaxf(m.overshoot, (pos - target) * (step >= 0.0f ? 1.0f : -1.0f));
+    if (fabsf(pos - target) > 0.02f * fabsf(step)) m.settleTime = t;
+}
+
+int main(int argc, char** argv) {
+    float step = argc > 1 ? (float)atof(argv[1]) : 1.665f;  // centre to full lock
+    FILE* out = argc > 2 ? fopen(argv[2], "w") : nullptr;
+    if (out) fprintf(out, "t,raw,traj,traj_setpoint\n");
+
+    Axis raw, traj;
+    // Firmware limits, but with torque feedforward matched to the modelled plant.
+    SteerTrajectoryConfig cfg = STEER_TRAJ_CONFIG;
+    cfg.inertia = INERTIA;
+    SteerTrajectory gen(cfg);
+    gen.reset(0.0f);
+    SteerSetpoint sp = {0.0f, 0.0f, 0.0f};
+    Metrics rawM, trajM;
+
+    int ticksPerCommand = (int)lroundf(TEENSY_DT / ODRIVE_DT);
+    int ticks = (int)(SIM_TIME / ODRIVE_DT);
+    for (int i = 0; i < ticks; i++) {
+        float t = i * ODRIVE_DT;
+        if (i % ticksPerCommand == 0) sp = gen.step(step, TEENSY_DT);
+        raw.step(step, 0.0f, 0.0f);
+        traj.step(sp.pos, sp.vel, sp.torque);
+        track(rawM, t, raw.loadPos, step, step);
+        track(trajM, t, traj.loadPos, step, step);
+        if (out) fprintf(out, "%.5f,%.5f,%.5f,%.5f\n", t, raw.loadPos, traj.loadPos, sp.pos);
+    }
+    if (out) fclose(out);
+
+    printf("step %.3f turns\n", step);
+    printf("%-12s %12s %12s\n", "", "overshoot", "settle(2%)");
+    printf("%-12s %10.4f t %10.3f s\n", "raw step", rawM.overshoot, rawM.settleTime);
+    printf("%-12s %10.4f t %10.3f s\n", "trajectory", trajM.overshoot, trajM.settleTime);
+    return 0;
+}
@@ -0,0 +1,166 @@
+// Host simulation of the telemetry publisher (lib/EVT_Ethernet/TelemetryPublisher.h,
+// the same code the firmware runs) with the firmware's topics and rates. Every
+// datagram is decoded as the Pi would and checked; the report compares the
+// batched stream with one datagram per sample, which is what a per-topic
+// sendTelemetry() would cost.
+//
+// Build (from tools, one line):
+//   g++ -std=c++17 -O2 -Wall -I../lib/EVT_Ethernet -o telemetry_sim telemetry_sim.cpp
+// Usage:
+//   telemetry_sim [seconds] [tight_budget_bytes_per_s]
+//
+// Three runs: a 1 ms loop on the firmware budget, a 12 ms loop with a 40 ms
+// stall every 500 ms (AUTO with SD flushes), and the 1 ms loop on a tight
+// budget. Exits 1 on a malformed or out-of-sequence datagram, a topic more
+// than 2% off its rate in the first run, or a run sending more than its
+// budget allows.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "TelemetryPublisher.h"
+
+// Mirrors of the firmware config (module headers need Arduino.h).
+static const uint32_t BUDGET_BYTES_PER_S = 100000;   // TELEMETRY_BUDGET_BYTES_PER_S
+struct TopicConfig {
+    const char* name;
+    uint8_t topic;
+    uint16_t rateHz;
+    uint8_t length;
+};
+static const TopicConfig topicConfigs[] = {
+    { "drive",    TELEMETRY_TOPIC_DRIVE,    100, sizeof(TelemetryDrive)    },  // VESC_TOPIC_DRIVE_HZ
+    { "steering", TELEMETRY_TOPIC_STEERING,  50, sizeof(TelemetrySteering) },  // ODRV_TOPIC_STEERING_HZ
+    { "power",    TELEMETRY_TOPIC_POWER,     10, sizeof(TelemetryPower)    },  // VESC_TOPIC_POWER_HZ
+    { "rc link",  TELEMETRY_TOPIC_RC_LINK,   50, sizeof(TelemetryRcLink)   },  // SBUS_TOPIC_RC_LINK_HZ
+    { "loop",     TELEMETRY_TOPIC_LOOP,      10, sizeof(TelemetryLoop)     },  // TELEMETRY_TOPIC_LOOP_HZ
+    { "health",   TELEMETRY_TOPIC_HEALTH,     2, sizeof(TelemetryHealth)   },  // HEALTH_TOPIC_HZ
+};
+static const int TOPIC_CONFIGS = sizeof(topicConfigs) / sizeof(topicConfigs[0]);
+
+static void fillPayload(void* payload, size_t length) {
+    memset(payload, 0xA5, length);
+}
+static void sampleDrive(void* p)    { fillPayload(p, sizeof(TelemetryDrive)); }
+static void sampleSteering(void* p) { fillPayload(p, sizeof(TelemetrySteering)); }
+static void samplePower(void* p)    { fillPayload(p, sizeof(TelemetryPower)); }
+static void sampleRcLink(void* p)   { fillPayload(p, sizeof(TelemetryRcLink)); }
+static void sampleLoop(void* p)     { fillPayload(p, sizeof(TelemetryLoop)); }
+static void sampleHealth(void* p)   { fillPayload(p, sizeof(TelemetryHealth)); }
+static const TelemetrySampler samplers[] = { sampleDrive, sampleSteering, samplePower, sampleRcLink, sampleLoop,
+                                             sampleHealth };
+
+// Decodes every datagram the way the Pi does.
+class DecodingTransport : public DatagramTransport {
+public:
+    bool begin(const DatagramConfig&) override { return true; }
+    int receive(char*, size_t) override { return -1; }
+
+    bool send(const uint8_t* data, size_t length) override {
+        datagrams++;
+        bytes += length;
+        TelemetryBatchHeader header;
+        if (length < sizeof(header)) return fail("short datagram");
+        memcpy(&header, data, sizeof(header));
+        if (header.magic != TELEMETRY_MAGIC || header.version != TELEMETRY_VERSION) return fail("bad magic/version");
+        if (datagrams > 1 && header.sequence != lastSequence + 1) return fail("sequence gap");
+        lastSequence = header.sequence;
+
+        size_t at = sizeof(header);
+        for (int r = 0; r < header.records; r++) {
+            TelemetryRecordHeader record;
+            if (at + sizeof(record) > length) return fail("record header past the end");
+            memcpy(&record, data + at, sizeof(record));
+            at += sizeof(record);
+            if (record.topic >= TELEMETRY_TOPIC_COUNT || at + record.length > length) return fail("bad record");
+            for (uint8_t i = 0; i < record.length; i++)
+                if (data[at + i] != 0xA5) return fail("payload corrupted");
+            at += record.length;
+            records[record.topic]++;
+            holdUs.push_back((double)(uint32_t)(header.localUs - record.localUs));
+        }
+        if (at != length) return fail("trailing bytes");
+        return true;
+    }
+
+    bool fail(const char* why) {
+        if (errors++ == 0) printf("  decode error: %s (datagram %u)\n", why, datagrams);
+        return true;
+    }
+
+    uint32_t datagrams = 0, bytes = 0, errors = 0, lastSequence = 0;
+    uint32_t records[TELEMETRY_TOPIC_COUNT] = {};
+    std::vector<double> holdUs;
+};
+
+static double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, (size_t)(p * (v.size() - 1) + 0.5))];
+}
+
+static bool run(const char* name, double seconds, uint32_t loopUs, bool stalls, uint32_t budget, bool checkRates) {
+    TelemetryPublisher publisher;
+    publisher.setBudget(budget);
+    for (int i = 0; i < TOPIC_CONFIGS; i++)
+        publisher.addTopic(topicConfigs[i].topic, topicConfigs[i].rateHz, samplers[i], topicConfigs[i].length);
+
+    DecodingTransport link;
+    uint64_t endUs = (uint64_t)(seconds * 1e6);
+    uint64_t nextStallUs = 500000;
+    uint32_t ticks = 0;
+    // Start near the micros() wrap so it is crossed.
+    const uint32_t base = UINT32_MAX - 1000000;
+    for (uint64_t now = 0; now < endUs; ticks++) {
+        publisher.service((uint32_t)(base + now), 0, link);
+        now += loopUs;
+        if (stalls && now >= nextStallUs) {
+            now += 40000;
+            nextStallUs += 500000;
+        }
+    }
+
+    const TelemetryStats& s = publisher.stats();
+    uint32_t perSampleBytes = 0;
+    for (int i = 0; i < TOPIC_CONFIGS; i++)
+        perSampleBytes += link.records[topicConfigs[i].topic] *
+                          (sizeof(TelemetryBatchHeader) + sizeof(TelemetryRecordHeader) + topicConfigs[i].length);
+
+    printf("%s: loop %u us%s, budget %u B/s, %.0f s, %u ticks\n", name, loopUs, stalls ? " + stalls" : "", budget,
+           seconds, ticks);
+    printf("  batched     %6.1f datagrams/s  %8.0f B/s  %5.1f samples/datagram\n", link.datagrams / seconds,
+           link.bytes / seconds, link.datagrams ? (double)s.samples / link.datagrams : 0.0);
+    printf("  per sample  %6.1f datagrams/s  %8.0f B/s\n", s.samples / seconds, perSampleBytes / seconds);
+    printf("  hold us p50 %6.0f  p99 %6.0f  max %6.0f   dropped %u, budget stalls %u\n", percentile(link.holdUs, 0.5),
+           percentile(link.holdUs, 0.99),
+           link.holdUs.empty() ? 0.0 : *std::max_element(link.holdUs.begin(), link.holdUs.end()), s.dropped,
+           s.budgetStalls);
+
+    bool ok = link.errors == 0;
+    for (int i = 0; i < TOPIC_CONFIGS; i++) {
+        double hz = link.records[topicConfigs[i].topic] / seconds;
+        TelemetryTopicStats t = publisher.topicStats(topicConfigs[i].topic);
+        printf("  %-9s %4u Hz -> %7.1f Hz  dropped %u\n", topicConfigs[i].name, topicConfigs[i].rateHz, hz, t.dropped);
+        if (checkRates && (hz < topicConfigs[i].rateHz * 0.98 || hz > topicConfigs[i].rateHz * 1.02)) ok = false;
+    }
+    if (link.bytes > budget * seconds + TELEMETRY_BURST_BYTES) {
+        printf("  over budget\n");
+        ok = false;
+    }
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    double seconds = argc > 1 ? atof(argv[1]) : 60.0;
+    uint32_t tight = argc > 2 ? (uint32_t)atoi(argv[2]) : 4000;
+
+    bool ok = run("RC/AUTO", seconds, 1000, false, BUDGET_BYTES_PER_S, true);
+    ok &= run("AUTO with SD stalls", seconds, 12000, true, BUDGET_BYTES_PER_S, false);
+    ok &= run("tight budget", seconds, 1000, false, tight, false);
+    if (!ok) {
+        printf("FAILED\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,124 @@
+// Host run of the throttle shaping (lib/EVT_Throttle/ThrottlePipeline.h) with
+// the RC config: the deadband edge, expo over the whole stick travel, the ramp
+// on a full step and back, and where pulling back turns from reverse into regen.
+//
+// Build (from tools, one line):
+//   g++ -std=c++17 -O2 -Wall -I../lib/EVT_Throttle -o throttle_sim throttle_sim.cpp
+// Usage:
+//   throttle_sim
+//
+// Exits 1 if any check failed.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include "ThrottlePipeline.h"
+#include "checks.h"
+
+static const float DT = 0.001f;   // 1 kHz loop.
+
+// Runs the pipeline for ms milliseconds with the stick held at raw.
+static ThrottleCommand hold(ThrottlePipeline& throttle, float raw, float rpmNow, uint32_t ms) {
+    ThrottleCommand cmd = {THROTTLE_OUT_RPM, 0.0f};
+    for (uint32_t i = 0; i < ms; i++) cmd = throttle.update(raw, rpmNow, 1.0f, DT);
+    return cmd;
+}
+
+int main() {
+    const ThrottleConfig& rc = THROTTLE_RC_CONFIG;
+
+    printf("Deadband edge\n");
+    {
+        ThrottlePipeline throttle(rc);
+        float forwardStep = 1.0f / (rc.forwardFull - rc.neutral - rc.deadband);
+        float reverseStep = 1.0f / (rc.neutral - rc.reverseFull - rc.deadband);
+        check(throttle.normalize(rc.neutral) == 0.0f, "neutral is zero");
+        check(throttle.normalize(rc.neutral + rc.deadband) == 0.0f &&
+              throttle.normalize(rc.neutral - rc.deadband) == 0.0f, "both edges of the deadband are still zero");
+        check(fabsf(throttle.normalize(rc.neutral + rc.deadband + 1.0f) - forwardStep) < 1e-6f,
+              "first count forward is one step, not a jump");
+        check(fabsf(throttle.normalize(rc.neutral - rc.deadband - 1.0f) + reverseStep) < 1e-6f,
+              "first count back is one step, not a jump");
+        check(throttle.normalize(rc.forwardFull) == 1.0f && throttle.normalize(rc.reverseFull) == -1.0f,
+              "endpoints are full scale");
+        check(throttle.normalize(1811.0f) == 1.0f && throttle.normalize(172.0f) == -1.0f,
+              "past the endpoints clamps");
+    }
+
+    printf("Expo\n");
+    {
+        ThrottlePipeline throttle(rc);
+        bool monotonic = true;
+        bool inRange = true;
+        float last = -2.0f;
+        for (int raw = 172; raw <= 1811; raw++) {
+            float y = throttle.expo(throttle.normalize((float)raw));
+            if (y < last) monotonic = false;
+            if (y < -1.0f || y > 1.0f) inRange = false;
+            last = y;
+        }
+        check(monotonic, "never decreases over the stick travel");
+        check(inRange, "stays within -1..1");
+        check(throttle.expo(1.0f) == 1.0f && throttle.expo(-1.0f) == -1.0f, "full stick is still full command");
+        check(throttle.expo(0.5f) < 0.5f && throttle.expo(-0.5f) > -0.5f, "softer than linear around centre");
+    }
+
+    printf("Slew on a step\n");
+    {
+        ThrottlePipeline throttle(rc);
+        float riseMs = 1000.0f / rc.riseRate;
+        float fallMs = 1000.0f / rc.fallRate;
+        hold(throttle, rc.forwardFull, 0.0f, 1);
+        check(fabsf(throttle.shaped() - rc.riseRate * DT) < 1e-6f, "one tick moves by riseRate * dt");
+        hold(throttle, rc.forwardFull, 0.0f, (uint32_t)(riseMs / 2) - 1);
+        check(fabsf(throttle.shaped() - 0.5f) < 1e-3f, "half way at half the rise time");
+        ThrottleCommand cmd = hold(throttle, rc.forwardFull, 0.0f, (uint32_t)(riseMs / 2) + 5);
+        check(throttle.shaped() == 1.0f && cmd.type == THROTTLE_OUT_RPM && cmd.value == rc.maxRpm,
+              "full rpm after the rise time, no overshoot");
+        hold(throttle, rc.neutral, 0.0f, 100);
+        check(fabsf(throttle.shaped() - (1.0f - 100 * rc.fallRate * DT)) < 1e-3f, "release falls at fallRate");
+        hold(throttle, rc.neutral, 0.0f, (uint32_t)fallMs);
+        check(throttle.shaped() == 0.0f, "back to zero, no undershoot");
+
+        hold(throttle, rc.forwardFull, 0.0f, (uint32_t)riseMs + 5);
+        hold(throttle, rc.reverseFull, 0.0f, (uint32_t)fallMs);
+        check(fabsf(throttle.shaped()) <= rc.fallRate * DT, "forward to reverse unwinds at fallRate");
+        hold(throttle, rc.reverseFull, 0.0f, (uint32_t)(riseMs / 2));
+        check(fabsf(throttle.shaped() + 0.5f) < 1e-2f, "then builds reverse at riseRate");
+    }
+
+    printf("Brake / reverse transition\n");
+    {
+        ThrottlePipeline throttle(rc);
+        hold(throttle, rc.reverseFull, 0.0f, 2000);
+        ThrottleCommand cmd = throttle.update(rc.reverseFull, rc.brakeRpm + 1.0f, 1.0f, DT);
+        check(cmd.type == THROTTLE_OUT_BRAKE && fabsf(cmd.value - rc.maxBrakeCurrent) < 1e-3f,
+              "pulled back above brakeRpm brakes at full current");
+        cmd = throttle.update(rc.reverseFull, rc.brakeRpm, 1.0f, DT);
+        check(cmd.type == THROTTLE_OUT_RPM && cmd.value == -rc.maxRpm, "at brakeRpm it reverses");
+        cmd = throttle.update(rc.reverseFull, rc.brakeRpm + 1.0f, 0.5f, DT);
+        check(cmd.type == THROTTLE_OUT_BRAKE && fabsf(cmd.value - rc.maxBrakeCurrent) < 1e-3f,
+              "degraded limit does not reduce braking");
+        cmd = throttle.update(rc.reverseFull, 0.0f, 0.5f, DT);
+        check(cmd.type == THROTTLE_OUT_RPM && cmd.value == -0.5f * rc.maxRpm, "but does scale reverse");
+        cmd = hold(throttle, rc.forwardFull, rc.brakeRpm + 1000.0f, 2000);
+        check(cmd.type == THROTTLE_OUT_RPM && cmd.value == rc.maxRpm, "forward while rolling is never a brake");
+
+        ThrottleConfig noBrake = rc;
+        noBrake.brakeRpm = 0.0f;
+        throttle.setConfig(noBrake);
+        cmd = hold(throttle, rc.reverseFull, 3000.0f, 2000);
+        check(cmd.type == THROTTLE_OUT_RPM && cmd.value < 0.0f, "brakeRpm 0 disables braking");
+
+        ThrottleConfig current = rc;
+        current.mode = THROTTLE_MODE_CURRENT;
+        throttle.setConfig(current);
+        cmd = hold(throttle, rc.reverseFull, 0.0f, 2000);
+        check(cmd.type == THROTTLE_OUT_CURRENT && fabsf(cmd.value + rc.maxCurrent) < 1e-3f,
+              "current mode reverses with current");
+        cmd = throttle.update(rc.reverseFull, rc.brakeRpm + 1.0f, 1.0f, DT);
+        check(cmd.type == THROTTLE_OUT_BRAKE, "and brakes above brakeRpm as well");
+    }
+
+    return checkSummary();
+}
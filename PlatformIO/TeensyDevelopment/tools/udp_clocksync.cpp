@@ -0,0 +1,238 @@
+// Clock sync test over loopback with two processes. The parent is the Teensy:
+// it runs the receive path of serviceUdpLink() (drainDatagrams(), ClockSync.h,
+// newestControlPacket()) on a clock that runs fast by drift_ppm and wraps its
+// 32-bit micros() two seconds in. The child is the Pi: it answers SYNC,
+// streams stamped commands at 100 Hz, and delays everything it sends by
+// delay_us plus up to jitter_us (1% of datagrams get another 5 ms) and
+// everything it receives by in_delay_us. Both read the same CLOCK_MONOTONIC,
+// so each side knows the true time of the other.
+//
+// Build (from tools, one line):
+//   g++ -std=c++17 -O2 -Wall -I../lib/EVT_Ethernet -I../lib/EVT_AutoMode -o udp_clocksync udp_clocksync.cpp ../lib/EVT_Ethernet/PosixUdpTransport.cpp
+// Usage:
+//   udp_clocksync [seconds] [drift_ppm] [delay_us] [jitter_us] [in_delay_us]
+//
+// Defaults: 60 s, 50 ppm, 2000 us out, 1000 us jitter, 2000 us in. The
+// offset error is checked once the estimate has had 5 s; the expected
+// bias of an NTP exchange is half the delay asymmetry. The drift estimate
+// rings for about a minute before it settles to a few ppm against the tick's
+// 1 ms quantization, so shorter runs are refused. Exits 1 if the p99 error is
+// more than 500 us past that bias, or the drift estimate is more than
+// DRIFT_TOLERANCE_PPM off the injected drift.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "ClockSync.h"
+#include "PosixUdpTransport.h"
+#include "UdpRxRing.h"
+
+static const uint16_t TEENSY_PORT = 8888;
+static const uint16_t PI_PORT     = 8889;
+static const uint64_t PI_CLOCK_BASE_US = 1000000000000ULL;   // Pi uptime at the start, arbitrary.
+static const uint32_t TEENSY_WRAP_AFTER_US = 2000000;
+static const uint32_t COMMAND_PERIOD_US = 10000;
+static const uint32_t TICK_US = 1000;
+// The drift loop's time constant is about 2 * CLOCK_SYNC_TAU_S; four of them.
+static const double   SETTLE_S = 60.0;
+static const double   DRIFT_TOLERANCE_PPM = 10.0;
+
+struct Config {
+    double seconds = 60.0, driftPpm = 50.0;
+    uint32_t delayUs = 2000, jitterUs = 1000, inDelayUs = 2000;
+};
+
+static std::chrono::steady_clock::time_point epoch;
+
+static uint64_t trueUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+static uint64_t piUs() {
+    return PI_CLOCK_BASE_US + trueUs();
+}
+
+static double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, (size_t)(p * (v.size() - 1) + 0.5))];
+}
+
+// ---- Pi process ----------------------------------------------------------
+
+static int runPi(const Config& c) {
+    PosixUdpTransport link;
+    DatagramConfig config = { {127, 0, 0, 1}, PI_PORT, {127, 0, 0, 1}, TEENSY_PORT };
+    if (!link.begin(config)) return 1;
+
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<uint32_t> jitter(0, c.jitterUs);
+    std::uniform_int_distribution<int> spike(0, 99);
+    auto delay = [&]() { return c.delayUs + jitter(rng) + (spike(rng) == 0 ? 5000 : 0); };
+
+    std::multimap<uint64_t, std::string> outbound, inbound;   // By release time (true us).
+    std::vector<double> telemetryUs;
+    std::string lastReport;
+    uint64_t nextCommandUs = 0;
+    uint32_t seq = 0;
+    uint64_t endUs = (uint64_t)((c.seconds + 0.5) * 1e6);
+
+    char buffer[UDP_RX_DATAGRAM_MAX];
+    while (trueUs() < endUs) {
+        int length;
+        while ((length = link.receive(buffer, sizeof(buffer))) >= 0)
+            inbound.emplace(trueUs() + c.inDelayUs, std::string(buffer, length));
+
+        uint64_t now = trueUs();
+        while (!inbound.empty() && inbound.begin()->first <= now) {
+            std::string text = inbound.begin()->second;
+            inbound.erase(inbound.begin());
+            unsigned long rseq;
+            unsigned long long t1;
+            if (sscanf(text.c_str(), "SYNC,%lu,%llu", &rseq, &t1) == 2) {
+                uint64_t t2 = piUs();
+                char reply[96];
+                snprintf(reply, sizeof(reply), "SYNCR,%lu,%llu,%llu,%llu", rseq, t1, (unsigned long long)t2,
+                         (unsigned long long)piUs());
+                outbound.emplace(trueUs() + delay(), reply);
+            } else if (text.compare(0, 4, "TEL,") == 0) {
+                unsigned long long stamp = strtoull(text.c_str() + 4, NULL, 10);
+                if (stamp != 0) telemetryUs.push_back((double)(int64_t)(piUs() - stamp));
+            } else if (text.compare(0, 4, "LAT,") == 0) {
+                lastReport = text;
+            }
+        }
+
+        if (now >= nextCommandUs) {
+            char command[64];
+            snprintf(command, sizeof(command), "%u,0.0,0,%llu", seq++, (unsigned long long)piUs());
+            outbound.emplace(now + delay(), command);
+            nextCommandUs += COMMAND_PERIOD_US;
+        }
+
+        now = trueUs();
+        while (!outbound.empty() && outbound.begin()->first <= now) {
+            link.send((const uint8_t*)outbound.begin()->second.data(), outbound.begin()->second.size());
+            outbound.erase(outbound.begin());
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    printf("pi: last report %s\n", lastReport.c_str());
+    // Telemetry one-way is what the Pi sees of the Teensy's stamps.
+    size_t skip = telemetryUs.size() / 4;
+    std::vector<double> settled(telemetryUs.begin() + skip, telemetryUs.end());
+    printf("pi: telemetry one-way us p50 %6.0f  p99 %6.0f  (expected ~%u + up to a %u us tick)\n",
+           percentile(settled, 0.5), percentile(settled, 0.99), c.inDelayUs, TICK_US);
+    return 0;
+}
+
+// ---- Teensy process ------------------------------------------------------
+
+static Config config;
+static ClockSync clockSync;
+static uint64_t drainLocalUs;
+
+static uint32_t teensyMicros() {
+    return (uint32_t)(UINT32_MAX - TEENSY_WRAP_AFTER_US + (uint64_t)(trueUs() * (1.0 + config.driftPpm * 1e-6)));
+}
+
+static void onRxDatagram(const UdpDatagram& d) {
+    if (isTaggedDatagram(d.data, d.length)) clockSync.handleReply(d.data, d.length, drainLocalUs);
+}
+
+static int runTeensy(pid_t pi) {
+    PosixUdpTransport link;
+    DatagramConfig linkConfig = { {127, 0, 0, 1}, TEENSY_PORT, {127, 0, 0, 1}, PI_PORT };
+    if (!link.begin(linkConfig)) return 1;
+
+    MonotonicUs localClock;
+    UdpRxRing ring;
+    std::vector<double> errorUs;
+    uint64_t firstSyncUs = 0;
+    uint64_t endUs = (uint64_t)(config.seconds * 1e6);
+    auto next = std::chrono::steady_clock::now();
+
+    while (trueUs() < endUs) {
+        next += std::chrono::microseconds(TICK_US);
+        std::this_thread::sleep_until(next);
+
+        // serviceUdpLink()
+        uint32_t nowUs = teensyMicros();
+        drainLocalUs = localClock.extend(nowUs);
+        ring.clear();
+        drainDatagrams(link, ring, nowUs, onRxDatagram);
+        ControlRx rx;
+        if (newestControlPacket(ring, rx)) clockSync.noteCommand(rx.packet.stampUs, drainLocalUs);
+        char message[128];
+        int length = clockSync.pollRequest(drainLocalUs, message, sizeof(message));
+        if (length > 0) link.send((const uint8_t*)message, length);
+        length = clockSync.pollReport(drainLocalUs, message, sizeof(message));
+        if (length > 0) link.send((const uint8_t*)message, length);
+
+        // Telemetry, the batch header's shared time only.
+        uint64_t local = localClock.extend(teensyMicros());
+        uint64_t shared = clockSync.synced() ? clockSync.toShared(local) : 0;
+        length = snprintf(message, sizeof(message), "TEL,%llu", (unsigned long long)shared);
+        link.send((const uint8_t*)message, length);
+
+        if (clockSync.synced()) {
+            if (firstSyncUs == 0) firstSyncUs = trueUs();
+            if (trueUs() - firstSyncUs > 5000000) errorUs.push_back((double)(int64_t)(shared - piUs()));
+        }
+    }
+
+    waitpid(pi, NULL, 0);
+    LinkLatency l = clockSync.latency();
+    std::vector<double> absError(errorUs.size());
+    std::transform(errorUs.begin(), errorUs.end(), absError.begin(), [](double e) { return std::fabs(e); });
+    // The shortest exchanges win the filter, so the bias is from the minimum
+    // delays; the Teensy's tick adds to the return leg.
+    double bias = ((double)config.inDelayUs - config.delayUs - TICK_US / 2.0) / 2.0;
+
+    printf("teensy: %.0f s, clock %+.0f ppm, wrapped at 2 s, %u restarts\n", config.seconds, config.driftPpm,
+           clockSync.restarts());
+    printf("teensy: drift estimate %+.2f ppm (tolerance %.0f)\n", l.driftPpm, DRIFT_TOLERANCE_PPM);
+    printf("teensy: offset error us p50 %+6.0f  |p99| %6.0f  max %6.0f  (NTP bias from asymmetry ~%+.0f)\n",
+           percentile(errorUs, 0.5), percentile(absError, 0.99),
+           absError.empty() ? 0.0 : *std::max_element(absError.begin(), absError.end()), bias);
+    printf("teensy: RTT us p50 %6u  p99 %6u  max %6u\n", l.rttP50, l.rttP99, l.rttMax);
+    printf("teensy: command one-way us p50 %6u  p99 %6u  max %6u  (expected ~%u + jitter, + up to a %u us tick)\n",
+           l.oneWayP50, l.oneWayP99, l.oneWayMax, config.delayUs, TICK_US);
+
+    if (errorUs.empty() || percentile(absError, 0.99) > std::fabs(bias) + 500.0 ||
+        std::fabs(l.driftPpm - config.driftPpm) > DRIFT_TOLERANCE_PPM) {
+        printf("FAILED\n");
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) config.seconds = atof(argv[1]);
+    if (argc > 2) config.driftPpm = atof(argv[2]);
+    if (argc > 3) config.delayUs = (uint32_t)atoi(argv[3]);
+    if (argc > 4) config.jitterUs = (uint32_t)atoi(argv[4]);
+    if (argc > 5) config.inDelayUs = (uint32_t)atoi(argv[5]);
+    if (config.seconds < SETTLE_S) {
+        printf("udp_clocksync: %.0f s is too short, the drift estimate needs %.0f s to settle\n",
+               config.seconds, SETTLE_S);
+        return 1;
+    }
+
+    epoch = std::chrono::steady_clock::now();
+    fflush(stdout);
+    pid_t pi = fork();
+    if (pi < 0) return 1;
+    if (pi == 0) return runPi(config);
+    return runTeensy(pi);
+}
@@ -0,0 +1,134 @@
+// Host simulation of command latency on the autonomous UDP link, from the Pi
+// sending a command to the loop tick that acts on it. Compares the old
+// receiveUdp() (one datagram per tick, oldest first) with the drain-all ring
+// in EVT_Ethernet (UdpRxRing.h, the same code the firmware runs).
+//
+// Build (from tools, one line):
+//   g++ -std=c++17 -O2 -Wall -I../lib/EVT_Ethernet -I../lib/EVT_AutoMode -o udp_latency_sim udp_latency_sim.cpp
+// Usage:
+//   udp_latency_sim [pi_hz] [loop_ms] [seconds]
+//
+// The AUTO loop is modelled as loop_ms per tick (~12 ms by default, what the
+// ODrive round trips of the old per-tick telemetry cost) plus a 40 ms stall every 500 ms
+// for an SD flush. The socket holds SOCKET_QUEUE datagrams and drops new ones
+// when full. "Latency" is send to the tick that applied a command; "age" is
+// how old the command in effect was, sampled at every tick. Exits 1 if the
+// drain-all ring is not better than the old path on p99 age.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+#include "UdpRxRing.h"
+
+static const int      SOCKET_QUEUE  = 16;
+static const uint64_t NET_DELAY_US  = 200;
+static const uint64_t STALL_EVERY_US = 500000;
+static const uint64_t STALL_US      = 40000;
+
+struct Sent {
+    uint64_t sendUs;
+    uint64_t arriveUs;
+    uint32_t seq;
+};
+
+struct Result {
+    std::vector<double> latencyMs;
+    std::vector<double> ageMs;
+    uint32_t applied = 0, socketDrops = 0, discarded = 0;
+};
+
+static double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, (size_t)(p * (v.size() - 1) + 0.5))];
+}
+
+static Result run(bool drainAll, double piHz, double loopMs, double seconds) {
+    Result r;
+    std::deque<Sent> socket;
+    uint64_t piPeriodUs = (uint64_t)(1e6 / piHz);
+    uint64_t nextSendUs = 0;
+    uint32_t seq = 0;
+    uint64_t nextStallUs = STALL_EVERY_US;
+    bool haveCommand = false;
+    uint64_t commandSentUs = 0;
+    std::vector<uint64_t> sendTimes;   // By sequence number.
+    UdpRxRing ring;
+
+    for (uint64_t now = 0; now < (uint64_t)(seconds * 1e6);) {
+        // Everything the Pi sent that has reached the socket by now.
+        while (nextSendUs + NET_DELAY_US <= now) {
+            sendTimes.push_back(nextSendUs);
+            if ((int)socket.size() < SOCKET_QUEUE) socket.push_back({ nextSendUs, nextSendUs + NET_DELAY_US, seq });
+            else r.socketDrops++;
+            seq++;
+            nextSendUs += piPeriodUs;
+        }
+
+        // The receive step of updateAutonomousMode().
+        if (drainAll) {
+            ring.clear();
+            uint32_t overwritten = ring.overwritten();
+            for (int n = 0; n < UDP_RX_DRAIN_MAX && !socket.empty(); n++) {
+                char text[UDP_RX_DATAGRAM_MAX];
+                int len = snprintf(text, sizeof(text), "%u,10.0,0", socket.front().seq);
+                ring.push(text, len, (uint32_t)now);
+                socket.pop_front();
+            }
+            r.discarded += ring.overwritten() - overwritten;
+            ControlRx rx;
+            if (newestControlPacket(ring, rx)) {
+                r.discarded += rx.superseded;
+                commandSentUs = sendTimes[(uint32_t)rx.packet.steering];
+                haveCommand = true;
+                r.latencyMs.push_back((now - commandSentUs) * 1e-3);
+                r.applied++;
+            }
+        } else if (!socket.empty()) {
+            commandSentUs = socket.front().sendUs;
+            socket.pop_front();
+            haveCommand = true;
+            r.latencyMs.push_back((now - commandSentUs) * 1e-3);
+            r.applied++;
+        }
+        if (haveCommand) r.ageMs.push_back((now - commandSentUs) * 1e-3);
+
+        now += (uint64_t)(loopMs * 1000);
+        if (now >= nextStallUs) {
+            now += STALL_US;
+            nextStallUs += STALL_EVERY_US;
+        }
+    }
+    return r;
+}
+
+static void print(const char* name, const Result& r) {
+    printf("%-10s %8u %8u %8u  %7.1f %7.1f %7.1f  %7.1f %7.1f\n", name, r.applied, r.discarded, r.socketDrops,
+           percentile(r.latencyMs, 0.5), percentile(r.latencyMs, 0.99),
+           r.latencyMs.empty() ? 0.0 : *std::max_element(r.latencyMs.begin(), r.latencyMs.end()),
+           percentile(r.ageMs, 0.5), percentile(r.ageMs, 0.99));
+}
+
+int main(int argc, char** argv) {
+    double piHz = argc > 1 ? atof(argv[1]) : 100.0;
+    double loopMs = argc > 2 ? atof(argv[2]) : 12.0;
+    double seconds = argc > 3 ? atof(argv[3]) : 20.0;
+
+    Result before = run(false, piHz, loopMs, seconds);
+    Result after = run(true, piHz, loopMs, seconds);
+
+    printf("Pi at %.0f Hz, loop %.1f ms + %.0f ms stall every %.0f ms, %.0f s\n",
+           piHz, loopMs, STALL_US * 1e-3, STALL_EVERY_US * 1e-3, seconds);
+    printf("%-10s %8s %8s %8s  %7s %7s %7s  %7s %7s\n", "", "applied", "discard", "sockdrop",
+           "lat p50", "lat p99", "lat max", "age p50", "age p99");
+    print("one/tick", before);
+    print("drain-all", after);
+
+    if (percentile(after.ageMs, 0.99) > percentile(before.ageMs, 0.99)) {
+        printf("FAILED: drain-all p99 age is worse\n");
+        return 1;
+    }
+    return 0;
+}
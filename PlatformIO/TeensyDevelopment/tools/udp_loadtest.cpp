@@ -0,0 +1,183 @@
+// Load test of the autonomous UDP link over loopback. One thread stands in for
+// the Pi and streams commands at a fixed rate; the other runs the Teensy side
+// of it with the firmware's own code (PosixUdpTransport behind the same
+// DatagramTransport interface, drainDatagrams() and newestControlPacket() from
+// UdpRxRing.h) once per loop tick, and answers every applied command with a
+// datagram the way telemetry would go back.
+//
+// Build (from tools, one line):
+//   g++ -std=c++17 -O2 -Wall -pthread -I../lib/EVT_Ethernet -I../lib/EVT_AutoMode -o udp_loadtest udp_loadtest.cpp ../lib/EVT_Ethernet/PosixUdpTransport.cpp
+// Usage:
+//   udp_loadtest [rate_hz] [seconds] [tick_us]
+//
+// Defaults are 10 kHz for 5 s against a 1000 us loop. The command's steering
+// field carries its sequence number so either side can time it; every 1000th
+// command sets the emergency flag. "Apply" is send to the tick that acted on a
+// command, "RTT" is send to the Pi receiving the telemetry for it, both on one
+// steady clock. Exits 1 if nothing was applied or a tick that drained an
+// emergency command did not act on it.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "PosixUdpTransport.h"
+#include "UdpRxRing.h"
+
+static const uint16_t TEENSY_PORT = 8888;   // ETHERNET_LOCAL_PORT
+static const uint16_t PI_PORT     = 8889;   // Own port; both ends share loopback.
+static const uint32_t EMERGENCY_EVERY = 1000;
+
+typedef std::chrono::steady_clock Clock;
+static const Clock::time_point epoch = Clock::now();
+
+static uint64_t nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - epoch).count();
+}
+
+static std::vector<std::atomic<uint64_t>>* sendTimes;   // By sequence number.
+static std::atomic<bool> piDone(false);
+
+struct TeensyStats {
+    uint64_t ticks = 0, drained = 0, applied = 0, discarded = 0, rejected = 0;
+    uint64_t emergencyTicks = 0, emergencyMissed = 0;
+    std::vector<double> applyUs;
+};
+
+struct PiStats {
+    uint64_t sent = 0, sendFailed = 0, acks = 0;
+    std::vector<double> rttUs;
+};
+
+static double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, (size_t)(p * (v.size() - 1) + 0.5))];
+}
+
+static bool drainedEmergency(const UdpRxRing& ring) {
+    if (ring.lostEmergency()) return true;
+    for (int i = 0; i < ring.size(); i++) {
+        const UdpDatagram& d = ring.at(i);
+        ControlPacket packet;
+        if (parseControlPacket(std::string(d.data, d.length), packet) && packet.emergency) return true;
+    }
+    return false;
+}
+
+// The receive half of serviceUdpLink() plus the telemetry reply.
+static void teensy(DatagramTransport& link, uint32_t tickUs, TeensyStats& s) {
+    UdpRxRing ring;
+    Clock::time_point next = Clock::now();
+    while (!piDone.load()) {
+        next += std::chrono::microseconds(tickUs);
+        std::this_thread::sleep_until(next);
+        s.ticks++;
+
+        ring.clear();
+        uint32_t overwritten = ring.overwritten();
+        s.drained += drainDatagrams(link, ring, (uint32_t)nowUs());
+        s.discarded += ring.overwritten() - overwritten;
+
+        ControlRx rx;
+        if (!newestControlPacket(ring, rx)) continue;
+        uint64_t appliedUs = nowUs();
+        s.applied++;
+        s.discarded += rx.superseded;
+        s.rejected += rx.rejected;
+        if (drainedEmergency(ring)) {
+            s.emergencyTicks++;
+            if (!rx.packet.emergency) s.emergencyMissed++;
+        }
+
+        uint32_t seq = (uint32_t)rx.packet.steering;
+        if (seq < sendTimes->size()) s.applyUs.push_back((double)(appliedUs - (*sendTimes)[seq].load()));
+
+        char reply[32];
+        int length = snprintf(reply, sizeof(reply), "ack,%u", seq);
+        link.send((const uint8_t*)reply, length);
+    }
+}
+
+static void pollAcks(DatagramTransport& link, PiStats& s) {
+    char buffer[UDP_RX_DATAGRAM_MAX];
+    int length;
+    while ((length = link.receive(buffer, sizeof(buffer) - 1)) >= 0) {
+        buffer[length] = '\0';
+        uint32_t seq;
+        if (sscanf(buffer, "ack,%u", &seq) != 1 || seq >= sendTimes->size()) continue;
+        s.acks++;
+        s.rttUs.push_back((double)(nowUs() - (*sendTimes)[seq].load()));
+    }
+}
+
+static void pi(DatagramTransport& link, double rateHz, double seconds, PiStats& s) {
+    uint32_t count = (uint32_t)(rateHz * seconds);
+    Clock::time_point start = Clock::now();
+    for (uint32_t seq = 0; seq < count; seq++) {
+        // Sleep in 100 us steps at most; below the scheduler's granularity the
+        // sends go out in small bursts that keep the average rate.
+        Clock::time_point due = start + std::chrono::microseconds((uint64_t)(seq * 1e6 / rateHz));
+        if (due > Clock::now()) std::this_thread::sleep_until(due);
+        pollAcks(link, s);
+
+        char text[48];
+        int length = snprintf(text, sizeof(text), "%u,10.0,%d", seq, seq % EMERGENCY_EVERY == 0 ? 1 : 0);
+        (*sendTimes)[seq].store(nowUs());
+        if (link.send((const uint8_t*)text, length)) s.sent++;
+        else s.sendFailed++;
+    }
+    // Let the last commands reach a tick and their acks come back.
+    Clock::time_point end = Clock::now() + std::chrono::milliseconds(50);
+    while (Clock::now() < end) {
+        pollAcks(link, s);
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    piDone.store(true);
+}
+
+int main(int argc, char** argv) {
+    double rateHz = argc > 1 ? atof(argv[1]) : 10000.0;
+    double seconds = argc > 2 ? atof(argv[2]) : 5.0;
+    uint32_t tickUs = argc > 3 ? (uint32_t)atoi(argv[3]) : 1000;
+
+    PosixUdpTransport teensyLink, piLink;
+    DatagramConfig teensyConfig = { {127, 0, 0, 1}, TEENSY_PORT, {127, 0, 0, 1}, PI_PORT };
+    DatagramConfig piConfig = { {127, 0, 0, 1}, PI_PORT, {127, 0, 0, 1}, TEENSY_PORT };
+    if (!teensyLink.begin(teensyConfig) || !piLink.begin(piConfig)) {
+        fprintf(stderr, "cannot bind UDP ports %u and %u\n", TEENSY_PORT, PI_PORT);
+        return 1;
+    }
+
+    sendTimes = new std::vector<std::atomic<uint64_t>>((size_t)(rateHz * seconds) + 1);
+    TeensyStats t;
+    PiStats p;
+    std::thread teensyThread(teensy, std::ref(teensyLink), tickUs, std::ref(t));
+    pi(piLink, rateHz, seconds, p);
+    teensyThread.join();
+
+    double elapsed = seconds + 0.05;
+    printf("Pi at %.0f Hz for %.1f s, loop tick %u us, loopback\n", rateHz, seconds, tickUs);
+    printf("  sent     %8llu (%.0f/s), send failures %llu\n", (unsigned long long)p.sent, p.sent / seconds,
+           (unsigned long long)p.sendFailed);
+    printf("  drained  %8llu (%.0f/s), lost in socket %lld\n", (unsigned long long)t.drained, t.drained / elapsed,
+           (long long)p.sent - (long long)t.drained);
+    printf("  ticks    %8llu, applied %llu, discarded %llu, rejected %llu\n", (unsigned long long)t.ticks,
+           (unsigned long long)t.applied, (unsigned long long)t.discarded, (unsigned long long)t.rejected);
+    printf("  emergency ticks %llu, missed %llu\n", (unsigned long long)t.emergencyTicks,
+           (unsigned long long)t.emergencyMissed);
+    printf("  apply us p50 %7.0f  p99 %7.0f  max %7.0f\n", percentile(t.applyUs, 0.5), percentile(t.applyUs, 0.99),
+           t.applyUs.empty() ? 0.0 : *std::max_element(t.applyUs.begin(), t.applyUs.end()));
+    printf("  RTT   us p50 %7.0f  p99 %7.0f  max %7.0f  (%llu acks)\n", percentile(p.rttUs, 0.5),
+           percentile(p.rttUs, 0.99), p.rttUs.empty() ? 0.0 : *std::max_element(p.rttUs.begin(), p.rttUs.end()),
+           (unsigned long long)p.acks);
+
+    if (t.applied == 0 || t.emergencyMissed > 0) {
+        printf("FAILED\n");
+        return 1;
+    }
+    return 0;
+}
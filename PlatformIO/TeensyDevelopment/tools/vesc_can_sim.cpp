@@ -0,0 +1,276 @@
+// Virtual CAN bus check for VescCan and the shared CAN dispatcher.
+//
+// Build (from tools, one line):
+//   g++ -std=c++17 -O2 -D__IMXRT1062__ -Ireplay/host -I../lib/util -I../lib/VescUart/src -I../lib/OdriveUART
+//       -o vesc_can_sim vesc_can_sim.cpp replay/host/HostArduino.cpp ../lib/VescUart/src/VescCan.cpp
+//       ../lib/OdriveUART/ODriveCAN.cpp
+// Usage:  vesc_can_sim [seconds] [status_hz]
+//
+// Two simulated VESCs broadcast CAN_PACKET_STATUS 1-5 at status_hz (default
+// 1000) and follow the SET_RPM frames they receive. An ODrive node sends
+// heartbeats and encoder estimates, and a node the firmware does not know
+// sends extended frames too. On the firmware side the real VescCan and
+// ODriveCAN classes share one util::CanDispatcher, fed from a 1 kHz loop
+// as serviceCanBus() would be. The simulated VESCs pack their frames by
+// hand, independently of VescPackets.h.
+//
+// Checks that every decoded field matches what was sent, that commands arrive
+// intact, that ODrive and VESC frames never reach each other's driver, and
+// that a truncated status is rejected without touching the data. Exits 1 on
+// any failure.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include "Arduino.h"
+#include "CanDispatch.h"
+#include "VescCan.h"
+#include "ODriveCAN.h"
+#include "checks.h"
+
+struct Frame {
+    uint32_t id;    // bit 31 = extended
+    uint8_t length;
+    uint8_t data[8];
+    bool fromFirmware;
+};
+
+// Frames on the wire, delivered in order on the next loop pass. A node does
+// not receive what it sent itself.
+static std::deque<Frame> bus;
+static uint64_t busFrames = 0;
+
+static void put(uint32_t id, uint8_t length, const uint8_t* data, bool fromFirmware = false) {
+    Frame f = { id, length, {}, fromFirmware };
+    memcpy(f.data, data, length);
+    bus.push_back(f);
+    busFrames++;
+}
+
+static void be16(uint8_t* p, int16_t v) { p[0] = (uint8_t)(v >> 8); p[1] = (uint8_t)v; }
+static void be32(uint8_t* p, int32_t v) { p[0] = (uint8_t)(v >> 24); p[1] = (uint8_t)(v >> 16); p[2] = (uint8_t)(v >> 8); p[3] = (uint8_t)v; }
+static int32_t get32(const uint8_t* p) { return (int32_t)((uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3]); }
+
+// ---- Simulated devices ----------------------------------------------------
+
+struct VescState {
+    float erpm = 0.0f;
+    float motorCurrent = 0.0f, inputCurrent = 0.0f, duty = 0.0f;
+    float ampHours = 0.0f, ampHoursCharged = 0.0f, wattHours = 0.0f, wattHoursCharged = 0.0f;
+    float tempFet = 30.0f, tempMotor = 28.0f, voltage = 48.0f, pidPos = 0.0f;
+    int32_t tachometer = 0;
+};
+
+struct SimVesc : VescState {
+    uint8_t id;
+    float targetErpm = 0.0f;
+    uint32_t commands = 0;
+    float lastCommand = 0.0f;
+    VescState sent;     // As of the last broadcast.
+
+    explicit SimVesc(uint8_t controllerId) : id(controllerId) {}
+
+    void step(float dt) {
+        erpm += (targetErpm - erpm) * fminf(1.0f, dt * 8.0f);
+        motorCurrent = (targetErpm - erpm) * 0.01f + erpm * 0.0005f;
+        duty = erpm / 40000.0f;
+        inputCurrent = motorCurrent * fabsf(duty);
+        ampHours += fabsf(inputCurrent) * dt / 3600.0f;
+        wattHours += fabsf(inputCurrent) * voltage * dt / 3600.0f;
+        tachometer += (int32_t)(erpm * dt / 60.0f * 6.0f);
+        tempFet += fabsf(motorCurrent) * 1e-4f;
+        voltage = 48.0f - inputCurrent * 0.05f;
+        pidPos = fmodf(pidPos + erpm * dt * 6.0f, 360.0f);
+    }
+
+    void broadcast() {
+        sent = *this;
+        uint32_t base = util::CAN_EXTENDED_FLAG | id;
+        uint8_t b[8];
+        be32(b, (int32_t)erpm); be16(b + 4, (int16_t)(motorCurrent * 10.0f)); be16(b + 6, (int16_t)(duty * 1000.0f));
+        put(base | (CAN_PACKET_STATUS << 8), 8, b);
+        be32(b, (int32_t)(ampHours * 1e4f)); be32(b + 4, (int32_t)(ampHoursCharged * 1e4f));
+        put(base | (CAN_PACKET_STATUS_2 << 8), 8, b);
+        be32(b, (int32_t)(wattHours * 1e4f)); be32(b + 4, (int32_t)(wattHoursCharged * 1e4f));
+        put(base | (CAN_PACKET_STATUS_3 << 8), 8, b);
+        be16(b, (int16_t)(tempFet * 10.0f)); be16(b + 2, (int16_t)(tempMotor * 10.0f));
+        be16(b + 4, (int16_t)(inputCurrent * 10.0f)); be16(b + 6, (int16_t)(pidPos * 50.0f));
+        put(base | (CAN_PACKET_STATUS_4 << 8), 8, b);
+        be32(b, tachometer); be16(b + 4, (int16_t)(voltage * 10.0f)); be16(b + 6, 0);
+        put(base | (CAN_PACKET_STATUS_5 << 8), 8, b);
+    }
+
+    void receive(const Frame& f) {
+        if ((f.id & 0x800000FF) != (util::CAN_EXTENDED_FLAG | id)) return;
+        if (((f.id & 0x1FFFFFFF) >> 8) == CAN_PACKET_SET_RPM && f.length == 4) {
+            targetErpm = (float)get32(f.data);
+            lastCommand = targetErpm;
+            commands++;
+        }
+    }
+};
+
+struct SimOdrive {
+    uint8_t node;
+    uint32_t heartbeats = 0, estimates = 0;
+    float pos = 0.0f;
+
+    void send(uint32_t ms) {
+        uint8_t b[8] = {};
+        if (ms % 100 == 0) {
+            Heartbeat_msg_t hb;
+            hb.Axis_State = 8;
+            hb.encode_buf(b);
+            put((uint32_t)node << 5 | Heartbeat_msg_t::cmd_id, 8, b);
+            heartbeats++;
+        }
+        if (ms % 10 == 0) {
+            Get_Encoder_Estimates_msg_t est;
+            est.Pos_Estimate = pos += 0.01f;
+            est.Vel_Estimate = 1.0f;
+            est.encode_buf(b);
+            put((uint32_t)node << 5 | Get_Encoder_Estimates_msg_t::cmd_id, 8, b);
+            estimates++;
+        }
+    }
+};
+
+// ---- Firmware side -------------------------------------------------------
+
+static bool firmwareSend(void* ctx, uint32_t id, uint8_t length, const uint8_t* data) {
+    (void)ctx;
+    put(id, length, data, true);
+    return true;
+}
+
+static void vescFrame(void* ctx, uint32_t id, uint8_t length, const uint8_t* data) {
+    static_cast<VescCan*>(ctx)->onReceive(id, length, data);
+}
+
+static void odriveFrame(void* ctx, uint32_t id, uint8_t length, const uint8_t* data) {
+    static_cast<ODriveCAN*>(ctx)->onReceive(id, length, data);
+}
+
+static uint32_t odriveHeartbeats = 0, odriveEstimates = 0;
+static float odrivePos = 0.0f;
+
+int main(int argc, char** argv) {
+    double seconds = argc > 1 ? atof(argv[1]) : 2.0;
+    double statusHz = argc > 2 ? atof(argv[2]) : 1000.0;
+    uint32_t statusEveryUs = (uint32_t)(1e6 / statusHz);
+
+    SimVesc simVesc[2] = { SimVesc(1), SimVesc(2) };
+    SimOdrive simOdrive = { 0 };
+
+    vesc::Values values[2] = {};
+    VescCan vescCan[2] = { VescCan(1, values[0]), VescCan(2, values[1]) };
+    ODriveCanIntfWrapper odriveIntf = { nullptr, firmwareSend, [](void*) {} };
+    ODriveCAN odrive(odriveIntf, simOdrive.node);
+    odrive.onStatus([](Heartbeat_msg_t& hb, void*) { odriveHeartbeats += hb.Axis_State == 8; });
+    odrive.onFeedback([](Get_Encoder_Estimates_msg_t& est, void*) { odriveEstimates++; odrivePos = est.Pos_Estimate; });
+
+    util::CanDispatcher<8> dispatcher;
+    for (int i = 0; i < 2; i++) {
+        vescCan[i].setSender(firmwareSend, nullptr);
+        dispatcher.attach(vescCan[i].filterMask(), vescCan[i].filterMatch(), vescFrame, &vescCan[i]);
+    }
+    // Same route canBusAttachOdrive() installs.
+    dispatcher.attach(util::CAN_EXTENDED_FLAG | 0x7E0, (uint32_t)simOdrive.node << 5, odriveFrame, &odrive);
+
+    uint32_t maxAgeUs = 0, strangers = 0, lastStatusUs = 0;
+    float lastTarget[2] = {};
+    uint64_t endUs = (uint64_t)(seconds * 1e6);
+    for (hostClockUs = 1000; hostClockUs < endUs; hostClockUs += 100) {
+        uint32_t now = (uint32_t)hostClockUs;
+
+        // Devices: statuses at the configured rate, physics at 10 kHz.
+        for (SimVesc& v : simVesc) v.step(100e-6f);
+        if (now - lastStatusUs >= statusEveryUs) {
+            lastStatusUs = now;
+            for (SimVesc& v : simVesc) v.broadcast();
+        }
+        if (now % 1000 == 0) {
+            simOdrive.send(now / 1000);
+            if (now % 50000 == 0) {
+                // A BMS or another VESC the firmware does not listen to.
+                uint8_t b[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+                put(util::CAN_EXTENDED_FLAG | (CAN_PACKET_STATUS << 8) | 0x55, 8, b);
+                strangers++;
+            }
+        }
+
+        if (now % 1000 != 0) continue;
+
+        // Firmware loop at 1 kHz: deliver what is on the wire, then command.
+        std::deque<Frame> wire;
+        wire.swap(bus);
+        for (const Frame& f : wire) {
+            if (f.fromFirmware) {
+                for (SimVesc& v : simVesc) v.receive(f);
+            } else {
+                dispatcher.dispatch(f.id, f.length, f.data);
+            }
+        }
+
+        for (int i = 0; i < 2; i++) {
+            const VescState& v = simVesc[i].sent;
+            const vesc::Values& d = values[i];
+            // Every broadcast is on the wire drained above, so after the
+            // first one the values must equal the last one sent.
+            bool seen = vescCan[i].statusFrames() > 0;
+            char name[48];
+            snprintf(name, sizeof(name), "vesc%d rpm", i + 1);
+            if (seen) {
+                expect(d.rpm == (float)(int32_t)v.erpm, name, d.rpm, v.erpm);
+                expectNear("motor current", d.avgMotorCurrent, v.motorCurrent, 0.1);
+                expectNear("duty", d.dutyCycleNow, v.duty, 0.001);
+                expectNear("amp hours", d.ampHours, v.ampHours, 1e-4);
+                expectNear("watt hours", d.wattHours, v.wattHours, 1e-4);
+                expectNear("fet temp", d.tempMosfet, v.tempFet, 0.1);
+                expectNear("input current", d.avgInputCurrent, v.inputCurrent, 0.1);
+                expectNear("pid pos", d.pidPos, v.pidPos, 0.02);
+                expectNear("voltage", d.inpVoltage, v.voltage, 0.1);
+                expect(d.tachometer == v.tachometer, "tachometer", d.tachometer, v.tachometer);
+            }
+
+            uint32_t ageUs = now - vescCan[i].lastStatusMs() * 1000;
+            if (ageUs > maxAgeUs) maxAgeUs = ageUs;
+
+            lastTarget[i] = 3000.0f * (i + 1) * sinf(now * 1e-6f);
+            vescCan[i].setRPM(lastTarget[i]);
+        }
+    }
+    // Last commands are still on the wire.
+    for (const Frame& f : bus)
+        if (f.fromFirmware)
+            for (SimVesc& v : simVesc) v.receive(f);
+
+    for (int i = 0; i < 2; i++) {
+        float want = lastTarget[i];
+        expect(simVesc[i].lastCommand == (float)(int32_t)want, "last SET_RPM", simVesc[i].lastCommand, want);
+        expect(simVesc[i].commands > 0, "SET_RPM frames", simVesc[i].commands, 1);
+    }
+    expect(odriveHeartbeats == simOdrive.heartbeats, "odrive heartbeats", odriveHeartbeats, simOdrive.heartbeats);
+    expect(odriveEstimates == simOdrive.estimates, "odrive estimates", odriveEstimates, simOdrive.estimates);
+    expectNear("odrive position", odrivePos, simOdrive.pos, 1e-6);
+    expect(dispatcher.unroutedFrames() == strangers, "unrouted frames", dispatcher.unroutedFrames(), strangers);
+
+    // A truncated STATUS must be dropped whole.
+    vesc::Values before = values[0];
+    uint8_t shortFrame[3] = { 0x7F, 0x00, 0x00 };
+    dispatcher.dispatch(util::CAN_EXTENDED_FLAG | (CAN_PACKET_STATUS << 8) | 1, 3, shortFrame);
+    expect(vescCan[0].shortFrames() == 1 && values[0].rpm == before.rpm, "short frame", values[0].rpm, before.rpm);
+
+    printf("%.1f s, statuses at %.0f Hz: %llu frames on the bus\n", seconds, statusHz, (unsigned long long)busFrames);
+    for (int i = 0; i < 2; i++) {
+        printf("  vesc%d: %u statuses decoded, %u SET_RPM received, route frames %u\n", i + 1,
+               (unsigned)vescCan[i].statusFrames(), (unsigned)simVesc[i].commands,
+               (unsigned)dispatcher.routedFrames(i));
+    }
+    printf("  odrive: %u heartbeats, %u encoder estimates, route frames %u\n", (unsigned)odriveHeartbeats,
+           (unsigned)odriveEstimates, (unsigned)dispatcher.routedFrames(2));
+    printf("  unrouted: %u\n", (unsigned)dispatcher.unroutedFrames());
+    printf("  oldest telemetry seen by the loop: %.1f ms\n", maxAgeUs / 1000.0);
+    return checkSummary();
+}